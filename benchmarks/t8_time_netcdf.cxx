@@ -0,0 +1,231 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <sc_flops.h>
+#include <sc_options.h>
+#include <sc_statistics.h>
+
+#include <t8.h>
+#if T8_WITH_NETCDF
+#include <netcdf.h>
+#else
+/* Normally defined in 'netcdf.h' */
+#define NC_CHUNKED 0
+#define NC_CONTIGUOUS 1
+#endif
+#if T8_WITH_NETCDF_PAR
+#include <netcdf_par.h>
+#else
+/* Normally defined in 'netcdf_par.h' */
+#define NC_INDEPENDENT 0
+#define NC_COLLECTIVE 1
+#endif
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_forest_netcdf.h>
+#include <t8_netcdf.h>
+
+/* This benchmark times the netCDF output of a uniform hybrid hypercube forest with one
+ * element data variable for different variable storage and MPI access patterns:
+ *
+ *  - contiguous storage, independent access (the default of t8_forest_write_netcdf),
+ *  - contiguous storage, collective access,
+ *  - chunked storage with the given chunk sizes, collective access,
+ *  - chunked storage with the shuffle and the deflate filter, collective access,
+ *  - a time series: the forest is written once and the remaining time steps are
+ *    appended with t8_forest_write_netcdf_time_step,
+ *  - the same time series written as one complete file per time step.
+ *
+ * The collective writes use the given MPI-IO hints for collective buffering.
+ * For example, on 64 ranks with 8 aggregators:
+ *
+ *   mpirun -n 64 ./t8_time_netcdf -l 6 -c 65536 -d 1 -a 8 -t 10
+ */
+
+/* Time writing the forest with the given options and add the result to stats */
+static void
+t8_time_netcdf_write (t8_forest_t forest, t8_netcdf_variable_t *var, const char *prefix,
+                      const t8_forest_netcdf_options_t *options, sc_statinfo_t *stats)
+{
+  sc_flopinfo_t fi, snapshot;
+  int mpiret;
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sc_flops_start (&fi);
+  sc_flops_snap (&fi, &snapshot);
+
+  t8_forest_write_netcdf_opt (forest, prefix, "t8_time_netcdf", 3, 1, &var, sc_MPI_COMM_WORLD, options);
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sc_flops_shot (&fi, &snapshot);
+  sc_stats_set1 (stats, snapshot.iwtime, prefix);
+}
+
+/* Time writing num_steps time steps of the element data, either by appending them to one
+ * file or by writing a complete file per step, and add the result to stats */
+static void
+t8_time_netcdf_time_series (t8_forest_t forest, t8_netcdf_variable_t *var, const int num_steps, const int append,
+                            const t8_forest_netcdf_options_t *options, sc_statinfo_t *stats)
+{
+  sc_flopinfo_t fi, snapshot;
+  t8_forest_netcdf_options_t series_options = *options;
+  char prefix[BUFSIZ];
+  int mpiret;
+
+  series_options.time_dependent = append;
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sc_flops_start (&fi);
+  sc_flops_snap (&fi, &snapshot);
+
+  for (int istep = 0; istep < num_steps; istep++) {
+    if (append && istep > 0) {
+      t8_forest_write_netcdf_time_step (forest, "t8_time_netcdf_append", 3, istep, 1, &var, sc_MPI_COMM_WORLD,
+                                        &series_options);
+    }
+    else {
+      if (append) {
+        snprintf (prefix, BUFSIZ, "t8_time_netcdf_append");
+      }
+      else {
+        snprintf (prefix, BUFSIZ, "t8_time_netcdf_rewrite_%04i", istep);
+      }
+      t8_forest_write_netcdf_opt (forest, prefix, "t8_time_netcdf", 3, 1, &var, sc_MPI_COMM_WORLD,
+                                  &series_options);
+    }
+  }
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  sc_flops_shot (&fi, &snapshot);
+  sc_stats_set1 (stats, snapshot.iwtime, append ? "t8_time_netcdf_append" : "t8_time_netcdf_rewrite");
+}
+
+static void
+t8_time_netcdf (const int level, const t8_forest_netcdf_options_t *base_options, const int num_steps)
+{
+  const int num_stats = 6;
+  sc_statinfo_t stats[6];
+  t8_forest_netcdf_options_t options;
+
+  t8_forest_t forest = t8_forest_new_uniform (t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0),
+                                              t8_scheme_new_default_cxx (), level, 0, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  const t8_gloidx_t first_element = t8_forest_get_first_local_element_id (forest);
+  sc_array_t *values = sc_array_new_count (sizeof (double), num_elements);
+  for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+    *(double *) sc_array_index_int (values, ielem) = first_element + ielem;
+  }
+  t8_netcdf_variable_t *var = t8_netcdf_create_double_var ("value", "Global element id", "1", values);
+  t8_global_productionf ("Writing a forest with %lli global elements.\n",
+                         (long long) t8_forest_get_global_num_elements (forest));
+
+  options = *base_options;
+  options.storage_mode = NC_CONTIGUOUS;
+  options.mpi_access = NC_INDEPENDENT;
+  t8_time_netcdf_write (forest, var, "t8_time_netcdf_contiguous_independent", &options, &stats[0]);
+
+  options.mpi_access = NC_COLLECTIVE;
+  t8_time_netcdf_write (forest, var, "t8_time_netcdf_contiguous_collective", &options, &stats[1]);
+
+  options.storage_mode = NC_CHUNKED;
+  t8_time_netcdf_write (forest, var, "t8_time_netcdf_chunked_collective", &options, &stats[2]);
+
+  /* Use the default deflate level if none was given */
+  options.deflate_level = base_options->deflate_level > 0 ? base_options->deflate_level : 1;
+  options.shuffle = 1;
+  t8_time_netcdf_write (forest, var, "t8_time_netcdf_chunked_deflate", &options, &stats[3]);
+
+  /* Time series with the storage options of the chunked collective output */
+  options.deflate_level = 0;
+  options.shuffle = 0;
+  t8_time_netcdf_time_series (forest, var, num_steps, 1, &options, &stats[4]);
+  t8_time_netcdf_time_series (forest, var, num_steps, 0, &options, &stats[5]);
+
+  sc_stats_compute (sc_MPI_COMM_WORLD, num_stats, stats);
+  sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS, num_stats, stats, 1, 1);
+
+  t8_netcdf_variable_destroy (var);
+  sc_array_destroy (values);
+  t8_forest_unref (&forest);
+}
+
+int
+main (int argc, char **argv)
+{
+  int mpiret, parsed, helpme;
+  int level, chunk_elements, chunk_nodes, num_steps;
+  t8_forest_netcdf_options_t options;
+  sc_options_t *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_forest_netcdf_options_init (&options);
+  opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &helpme, "Display a short help message.");
+  sc_options_add_int (opt, 'l', "level", &level, 4, "The uniform refinement level of the forest.");
+  sc_options_add_int (opt, 'c', "chunk-elements", &chunk_elements, 0,
+                      "The chunk size along the element dimension, 0 for netCDF's default.");
+  sc_options_add_int (opt, 'n', "chunk-nodes", &chunk_nodes, 0,
+                      "The chunk size along the node dimension, 0 for netCDF's default.");
+  sc_options_add_int (opt, 'd', "deflate", &options.deflate_level, 1,
+                      "The level of the deflate filter of the compressed output.");
+  sc_options_add_int (opt, 'a', "cb-nodes", &options.cb_nodes, 0,
+                      "The number of MPI-IO aggregators of the collective writes, 0 for the MPI default.");
+  sc_options_add_int (opt, 'b', "cb-buffer-size", &options.cb_buffer_size, 0,
+                      "The collective buffer size in bytes, 0 for the MPI default.");
+  sc_options_add_int (opt, 't', "time-steps", &num_steps, 4, "The number of steps of the time series.");
+
+  parsed = sc_options_parse (t8_get_package_id (), SC_LP_ERROR, opt, argc, argv);
+  if (helpme) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else if (parsed < 0 || level < 0 || chunk_elements < 0 || chunk_nodes < 0 || num_steps < 1) {
+    t8_global_productionf ("Wrong usage.\n");
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else {
+#if !T8_WITH_NETCDF_PAR
+    t8_global_productionf ("This version of t8code is not compiled with parallel netCDF support, "
+                           "the access patterns do not differ.\n");
+#endif
+    options.chunk_elements = chunk_elements;
+    options.chunk_nodes = chunk_nodes;
+    t8_time_netcdf (level, &options, num_steps);
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -50,6 +50,7 @@ AC_DEFUN([T8_CHECK_LIBRARIES],
 T8_CHECK_NETCDF([$1])
 T8_CHECK_VTK([$1])
 T8_CHECK_OCC([$1])
+T8_CHECK_OPENMP([$1])
 T8_CHECK_CPPSTDLIB([$1])
 ])
 AC_DEFUN([T8_CHECK_CPPSTD],[AX_CXX_COMPILE_STDCXX([17],[noext],[mandatory])])
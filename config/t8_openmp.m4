@@ -0,0 +1,23 @@
+dnl T8_CHECK_OPENMP
+dnl Check for OpenMP support and add the compiler flags
+dnl
+dnl Use --enable-openmp to compile t8code with OpenMP.
+dnl This enables threading in selected algorithms, e.g. t8_forest_search_threaded.
+dnl
+AC_DEFUN([T8_CHECK_OPENMP], [
+T8_ARG_ENABLE([openmp],
+  [enable OpenMP threading in selected algorithms],
+  [OPENMP])
+
+if test "x$T8_ENABLE_OPENMP" != xno ; then
+  dnl The threaded algorithms are implemented in C++
+  AC_LANG_PUSH([C++])
+  AC_OPENMP
+  AC_LANG_POP([C++])
+  if test "x$ac_cv_prog_cxx_openmp" = "xunsupported" ; then
+    AC_MSG_ERROR([Unable to compile with OpenMP])
+  fi
+  CXXFLAGS="$CXXFLAGS $OPENMP_CXXFLAGS"
+  LDFLAGS="$LDFLAGS $OPENMP_CXXFLAGS"
+fi
+])
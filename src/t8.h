@@ -131,6 +131,9 @@ typedef enum {
   T8_MPI_PARTITION_FOREST,              /**< Used for forest partitioning */
   T8_MPI_GHOST_FOREST,                  /**< Used for for ghost layer creation */
   T8_MPI_GHOST_EXC_FOREST,              /**< Used for ghost data exchange */
+  T8_MPI_LOCATE_POINTS,                 /**< Used for distributed point location */
+  T8_MPI_GHOST_LAYERS,                  /**< Used for growing ghost layers of width larger than one */
+  T8_MPI_GLOBAL_NODES,                  /**< Used for the global numbering of element vertices */
   T8_MPI_TAG_LAST
 } t8_MPI_tag_t;
 
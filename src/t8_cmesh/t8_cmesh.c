@@ -23,6 +23,7 @@
 #include <sc_statistics.h>
 #include <t8_cmesh.h>
 #include <t8_cmesh/t8_cmesh_geometry.h>
+#include <t8_cmesh/t8_cmesh_locate.h>
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear.h>
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear_axis_aligned.h>
 #include <t8_refcount.h>
@@ -172,6 +173,8 @@ t8_cmesh_init (t8_cmesh_t *pcmesh)
    * It will get initialized either when a geometry is registered
    * or when the cmesh gets committed. */
   cmesh->geometry_handler = NULL;
+  /* The point location cache is built on first use */
+  cmesh->locate_cache = NULL;
 
   T8_ASSERT (t8_cmesh_is_initialized (cmesh));
 }
@@ -1202,6 +1205,7 @@ t8_cmesh_reset (t8_cmesh_t *pcmesh)
   if (cmesh->geometry_handler != NULL) {
     t8_geom_handler_unref (&cmesh->geometry_handler);
   }
+  t8_cmesh_locate_reset (cmesh);
 
   T8_FREE (cmesh);
   *pcmesh = NULL;
@@ -0,0 +1,328 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_cmesh_locate.c
+ *
+ * Bounding boxes of the coarse mesh trees and a uniform bucket grid over them.
+ */
+
+#include <t8_cmesh.h>
+#include <t8_eclass.h>
+#include <t8_cmesh/t8_cmesh_types.h>
+#include <t8_cmesh/t8_cmesh_locate.h>
+#include <t8_geometry/t8_geometry.h>
+
+/* The number of sample points per coordinate direction of the reference element
+ * at which the geometry is evaluated to compute a tree's bounding box. */
+#define T8_CMESH_LOCATE_NUM_SAMPLES 5
+
+/* The relative margin by which the bounding box of a tree with non-linear geometry is enlarged */
+#define T8_CMESH_LOCATE_CURVED_MARGIN 0.05
+
+/* The relative margin by which the bounding box of a tree with linear geometry is enlarged
+ * to account for rounding errors */
+#define T8_CMESH_LOCATE_LINEAR_MARGIN 1e-10
+
+/* The maximum number of buckets in one coordinate direction */
+#define T8_CMESH_LOCATE_MAX_BUCKETS 1024
+
+/* Return true if the given reference coordinates lie inside the reference element of eclass */
+static int
+t8_cmesh_locate_ref_coords_inside (const t8_eclass_t eclass, const double *ref_coords)
+{
+  switch (eclass) {
+  case T8_ECLASS_TRIANGLE:
+  case T8_ECLASS_PRISM:
+    return ref_coords[1] <= ref_coords[0];
+  case T8_ECLASS_TET:
+    return ref_coords[1] <= ref_coords[2] && ref_coords[2] <= ref_coords[0];
+  case T8_ECLASS_PYRAMID:
+    return ref_coords[2] <= ref_coords[0] && ref_coords[2] <= ref_coords[1];
+  default:
+    return 1;
+  }
+}
+
+/* Compute the bounding box of a local tree by evaluating its geometry at sample points */
+static void
+t8_cmesh_locate_compute_tree_bounds (t8_cmesh_t cmesh, const t8_locidx_t ltreeid, double *lower, double *upper)
+{
+  const t8_eclass_t eclass = t8_cmesh_get_tree_class (cmesh, ltreeid);
+  const int dim = t8_eclass_to_dimension[eclass];
+  const t8_gloidx_t gtreeid = t8_cmesh_get_global_id (cmesh, ltreeid);
+  int num_points = 1;
+  int idim;
+
+  for (idim = 0; idim < dim; ++idim) {
+    num_points *= T8_CMESH_LOCATE_NUM_SAMPLES;
+  }
+  /* Build a lattice of reference points, keeping those inside the reference element.
+   * The lattice contains all vertices of the reference element. */
+  double *ref_coords = T8_ALLOC_ZERO (double, SC_MAX (dim, 1) * num_points);
+  double *coords = T8_ALLOC (double, 3 * num_points);
+  int num_inside = 0;
+  for (int ipoint = 0; ipoint < num_points; ++ipoint) {
+    double *point = ref_coords + dim * num_inside;
+    int index = ipoint;
+    for (idim = 0; idim < dim; ++idim) {
+      point[idim] = (index % T8_CMESH_LOCATE_NUM_SAMPLES) / (double) (T8_CMESH_LOCATE_NUM_SAMPLES - 1);
+      index /= T8_CMESH_LOCATE_NUM_SAMPLES;
+    }
+    if (t8_cmesh_locate_ref_coords_inside (eclass, point)) {
+      num_inside++;
+    }
+  }
+  T8_ASSERT (num_inside > 0);
+  t8_geometry_evaluate (cmesh, gtreeid, ref_coords, num_inside, coords);
+
+  for (idim = 0; idim < 3; ++idim) {
+    lower[idim] = upper[idim] = coords[idim];
+  }
+  for (int ipoint = 1; ipoint < num_inside; ++ipoint) {
+    for (idim = 0; idim < 3; ++idim) {
+      lower[idim] = SC_MIN (lower[idim], coords[3 * ipoint + idim]);
+      upper[idim] = SC_MAX (upper[idim], coords[3 * ipoint + idim]);
+    }
+  }
+
+  /* Enlarge the box. Linear geometries are exactly bounded by their vertices,
+   * other geometries may leave the box between the sample points. */
+  const t8_geometry_type_t geom_type = t8_geometry_get_type (cmesh, gtreeid);
+  const double relative_margin
+    = geom_type == T8_GEOMETRY_TYPE_LINEAR || geom_type == T8_GEOMETRY_TYPE_LINEAR_AXIS_ALIGNED
+        ? T8_CMESH_LOCATE_LINEAR_MARGIN
+        : T8_CMESH_LOCATE_CURVED_MARGIN;
+  double diameter = 0;
+  for (idim = 0; idim < 3; ++idim) {
+    diameter = SC_MAX (diameter, upper[idim] - lower[idim]);
+  }
+  for (idim = 0; idim < 3; ++idim) {
+    lower[idim] -= relative_margin * diameter;
+    upper[idim] += relative_margin * diameter;
+  }
+
+  T8_FREE (ref_coords);
+  T8_FREE (coords);
+}
+
+/* Compute the bucket index of a coordinate in direction idim, clamped to the grid */
+static int
+t8_cmesh_locate_bucket_coord (const t8_cmesh_locate_cache_t *cache, const int idim, const double coord)
+{
+  const int ibucket = (int) floor ((coord - cache->lower[idim]) / cache->bucket_width[idim]);
+  return SC_MIN (SC_MAX (ibucket, 0), cache->num_buckets[idim] - 1);
+}
+
+/* Compute the range of buckets that intersect a box */
+static void
+t8_cmesh_locate_bucket_range (const t8_cmesh_locate_cache_t *cache, const double *lower, const double *upper,
+                              int *first, int *last)
+{
+  for (int idim = 0; idim < 3; ++idim) {
+    first[idim] = t8_cmesh_locate_bucket_coord (cache, idim, lower[idim]);
+    last[idim] = t8_cmesh_locate_bucket_coord (cache, idim, upper[idim]);
+  }
+}
+
+static size_t
+t8_cmesh_locate_bucket_index (const t8_cmesh_locate_cache_t *cache, const int ix, const int iy, const int iz)
+{
+  return ((size_t) iz * cache->num_buckets[1] + iy) * cache->num_buckets[0] + ix;
+}
+
+/* Build the bounding boxes of all local trees and the bucket grid */
+static void
+t8_cmesh_locate_build (t8_cmesh_t cmesh)
+{
+  const t8_locidx_t num_trees = t8_cmesh_get_num_local_trees (cmesh);
+  t8_cmesh_locate_cache_t *cache = T8_ALLOC_ZERO (t8_cmesh_locate_cache_t, 1);
+  t8_locidx_t itree;
+  int idim, first[3], last[3];
+
+  /* Compute the bounding boxes of the trees and of their union */
+  cache->tree_bounds = T8_ALLOC (double, 6 * SC_MAX (num_trees, 1));
+  for (idim = 0; idim < 3; ++idim) {
+    cache->lower[idim] = 0;
+    cache->upper[idim] = 0;
+  }
+  for (itree = 0; itree < num_trees; ++itree) {
+    double *tree_lower = cache->tree_bounds + 6 * itree;
+    double *tree_upper = tree_lower + 3;
+    t8_cmesh_locate_compute_tree_bounds (cmesh, itree, tree_lower, tree_upper);
+    for (idim = 0; idim < 3; ++idim) {
+      cache->lower[idim] = itree == 0 ? tree_lower[idim] : SC_MIN (cache->lower[idim], tree_lower[idim]);
+      cache->upper[idim] = itree == 0 ? tree_upper[idim] : SC_MAX (cache->upper[idim], tree_upper[idim]);
+    }
+  }
+
+  /* Choose the number of buckets such that there are about as many buckets as trees.
+   * Directions in which the mesh is flat get only one bucket. */
+  int num_directions = 0;
+  for (idim = 0; idim < 3; ++idim) {
+    num_directions += cache->upper[idim] > cache->lower[idim];
+  }
+  const int buckets_per_direction
+    = num_directions == 0 ? 1 : (int) ceil (pow ((double) SC_MAX (num_trees, 1), 1. / num_directions));
+  for (idim = 0; idim < 3; ++idim) {
+    const double extent = cache->upper[idim] - cache->lower[idim];
+    cache->num_buckets[idim] = extent > 0 ? SC_MIN (buckets_per_direction, T8_CMESH_LOCATE_MAX_BUCKETS) : 1;
+    cache->bucket_width[idim] = extent > 0 ? extent / cache->num_buckets[idim] : 1;
+  }
+  const size_t num_buckets = (size_t) cache->num_buckets[0] * cache->num_buckets[1] * cache->num_buckets[2];
+
+  /* Count the trees in each bucket and build the offsets */
+  cache->bucket_offsets = T8_ALLOC_ZERO (t8_locidx_t, num_buckets + 1);
+  for (itree = 0; itree < num_trees; ++itree) {
+    const double *tree_lower = cache->tree_bounds + 6 * itree;
+    t8_cmesh_locate_bucket_range (cache, tree_lower, tree_lower + 3, first, last);
+    for (int iz = first[2]; iz <= last[2]; ++iz) {
+      for (int iy = first[1]; iy <= last[1]; ++iy) {
+        for (int ix = first[0]; ix <= last[0]; ++ix) {
+          cache->bucket_offsets[t8_cmesh_locate_bucket_index (cache, ix, iy, iz) + 1]++;
+        }
+      }
+    }
+  }
+  for (size_t ibucket = 0; ibucket < num_buckets; ++ibucket) {
+    cache->bucket_offsets[ibucket + 1] += cache->bucket_offsets[ibucket];
+  }
+
+  /* Fill the buckets. Since we iterate over the trees in order,
+   * the trees of each bucket are sorted. */
+  t8_locidx_t *fill = T8_ALLOC (t8_locidx_t, num_buckets);
+  memcpy (fill, cache->bucket_offsets, num_buckets * sizeof (t8_locidx_t));
+  cache->bucket_trees = T8_ALLOC (t8_locidx_t, SC_MAX (cache->bucket_offsets[num_buckets], 1));
+  for (itree = 0; itree < num_trees; ++itree) {
+    const double *tree_lower = cache->tree_bounds + 6 * itree;
+    t8_cmesh_locate_bucket_range (cache, tree_lower, tree_lower + 3, first, last);
+    for (int iz = first[2]; iz <= last[2]; ++iz) {
+      for (int iy = first[1]; iy <= last[1]; ++iy) {
+        for (int ix = first[0]; ix <= last[0]; ++ix) {
+          cache->bucket_trees[fill[t8_cmesh_locate_bucket_index (cache, ix, iy, iz)]++] = itree;
+        }
+      }
+    }
+  }
+  T8_FREE (fill);
+
+  cmesh->locate_cache = cache;
+}
+
+/* Return the locate cache of a cmesh, build it if necessary */
+static const t8_cmesh_locate_cache_t *
+t8_cmesh_locate_get_cache (t8_cmesh_t cmesh)
+{
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  if (cmesh->locate_cache == NULL) {
+    t8_cmesh_locate_build (cmesh);
+  }
+  return cmesh->locate_cache;
+}
+
+void
+t8_cmesh_get_tree_bounding_box (t8_cmesh_t cmesh, t8_locidx_t ltreeid, double lower[3], double upper[3])
+{
+  const t8_cmesh_locate_cache_t *cache = t8_cmesh_locate_get_cache (cmesh);
+
+  T8_ASSERT (0 <= ltreeid && ltreeid < t8_cmesh_get_num_local_trees (cmesh));
+  memcpy (lower, cache->tree_bounds + 6 * ltreeid, 3 * sizeof (double));
+  memcpy (upper, cache->tree_bounds + 6 * ltreeid + 3, 3 * sizeof (double));
+}
+
+void
+t8_cmesh_locate_candidate_trees (t8_cmesh_t cmesh, const double point[3], double tolerance,
+                                 sc_array_t *candidate_trees)
+{
+  const t8_cmesh_locate_cache_t *cache = t8_cmesh_locate_get_cache (cmesh);
+  double lower[3], upper[3];
+  int idim, first[3], last[3];
+
+  T8_ASSERT (tolerance >= 0);
+  T8_ASSERT (candidate_trees != NULL && candidate_trees->elem_size == sizeof (t8_locidx_t));
+
+  if (t8_cmesh_get_num_local_trees (cmesh) == 0) {
+    return;
+  }
+  for (idim = 0; idim < 3; ++idim) {
+    lower[idim] = point[idim] - tolerance;
+    upper[idim] = point[idim] + tolerance;
+    if (upper[idim] < cache->lower[idim] || lower[idim] > cache->upper[idim]) {
+      /* The point is outside of all trees */
+      return;
+    }
+  }
+
+  /* Collect the trees of all buckets that intersect the box around the point */
+  const size_t first_candidate = candidate_trees->elem_count;
+  t8_cmesh_locate_bucket_range (cache, lower, upper, first, last);
+  for (int iz = first[2]; iz <= last[2]; ++iz) {
+    for (int iy = first[1]; iy <= last[1]; ++iy) {
+      for (int ix = first[0]; ix <= last[0]; ++ix) {
+        const size_t ibucket = t8_cmesh_locate_bucket_index (cache, ix, iy, iz);
+        for (t8_locidx_t ientry = cache->bucket_offsets[ibucket]; ientry < cache->bucket_offsets[ibucket + 1];
+             ++ientry) {
+          const t8_locidx_t itree = cache->bucket_trees[ientry];
+          const double *tree_lower = cache->tree_bounds + 6 * itree;
+          const double *tree_upper = tree_lower + 3;
+          int inside = 1;
+          for (idim = 0; idim < 3 && inside; ++idim) {
+            inside = tree_lower[idim] <= upper[idim] && lower[idim] <= tree_upper[idim];
+          }
+          if (inside) {
+            *(t8_locidx_t *) sc_array_push (candidate_trees) = itree;
+          }
+        }
+      }
+    }
+  }
+
+  /* If the box intersects more than one bucket, a tree may have been added multiple times */
+  const size_t num_found = candidate_trees->elem_count - first_candidate;
+  if (num_found > 1) {
+    sc_array_t found;
+    sc_array_init_view (&found, candidate_trees, first_candidate, num_found);
+    sc_array_sort (&found, sc_int32_compare);
+    size_t num_unique = 1;
+    for (size_t ifound = 1; ifound < num_found; ++ifound) {
+      const t8_locidx_t itree = *(t8_locidx_t *) sc_array_index (&found, ifound);
+      if (itree != *(t8_locidx_t *) sc_array_index (&found, num_unique - 1)) {
+        *(t8_locidx_t *) sc_array_index (&found, num_unique++) = itree;
+      }
+    }
+    sc_array_resize (candidate_trees, first_candidate + num_unique);
+  }
+}
+
+void
+t8_cmesh_locate_reset (t8_cmesh_t cmesh)
+{
+  t8_cmesh_locate_cache_t *cache = cmesh->locate_cache;
+
+  if (cache == NULL) {
+    return;
+  }
+  T8_FREE (cache->tree_bounds);
+  T8_FREE (cache->bucket_offsets);
+  T8_FREE (cache->bucket_trees);
+  T8_FREE (cache);
+  cmesh->locate_cache = NULL;
+}
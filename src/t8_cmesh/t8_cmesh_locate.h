@@ -0,0 +1,78 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_cmesh_locate.h
+ *
+ * Bounding boxes of the coarse mesh trees and a uniform bucket grid over them.
+ * The bucket grid is used to quickly find the trees that may contain a given point,
+ * such that point location does not need to search all trees.
+ * The bounding boxes are computed through the geometry of the cmesh and cached on the cmesh.
+ */
+
+#ifndef T8_CMESH_LOCATE_H
+#define T8_CMESH_LOCATE_H
+
+#include <t8.h>
+#include <t8_cmesh.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Get the axis-aligned bounding box of a local tree of a cmesh.
+ * The box is computed by evaluating the tree's geometry at sample points
+ * of the reference element. For non-linear geometries the box is enlarged
+ * by a safety margin, since the geometry may bulge between the sample points.
+ * The first call builds the bounding boxes and bucket grid of all local trees
+ * and caches them on the cmesh.
+ * \param [in]  cmesh   A committed cmesh.
+ * \param [in]  ltreeid A local tree id of \a cmesh.
+ * \param [out] lower   On output the lower corner of the tree's bounding box.
+ * \param [out] upper   On output the upper corner of the tree's bounding box.
+ */
+void
+t8_cmesh_get_tree_bounding_box (t8_cmesh_t cmesh, t8_locidx_t ltreeid, double lower[3], double upper[3]);
+
+/** Find all local trees of a cmesh whose bounding box contains a point.
+ * The first call builds the bounding boxes and bucket grid of all local trees
+ * and caches them on the cmesh.
+ * \param [in]  cmesh           A committed cmesh.
+ * \param [in]  point           The coordinates of the point.
+ * \param [in]  tolerance       The bounding boxes are enlarged by \a tolerance in each direction. Must be >= 0.
+ * \param [in,out] candidate_trees An initialized sc_array of t8_locidx_t.
+ *                              On output the local ids of all trees whose bounding box contains \a point
+ *                              are appended, in ascending order.
+ * \note A tree whose bounding box contains \a point does not necessarily contain
+ *       \a point itself. Use for example \ref t8_forest_element_points_inside to check.
+ */
+void
+t8_cmesh_locate_candidate_trees (t8_cmesh_t cmesh, const double point[3], double tolerance,
+                                 sc_array_t *candidate_trees);
+
+/** Free the cached bounding boxes and bucket grid of a cmesh.
+ * This is called when the cmesh is destroyed. The cache is rebuilt at the next query.
+ * \param [in,out] cmesh  A cmesh.
+ */
+void
+t8_cmesh_locate_reset (t8_cmesh_t cmesh);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_CMESH_LOCATE_H */
@@ -62,6 +62,20 @@ typedef struct t8_cprofile t8_cprofile_t; /* Defined below */
 #define T8_CMESH_NEXT_POSSIBLE_KEY \
   T8_CMESH_CAD_FACE_PARAMETERS_ATTRIBUTE_KEY + T8_ECLASS_MAX_FACES /* The next free value for a t8code attribute key */
 
+/** Bounding boxes of the local trees of a cmesh and a uniform bucket grid over them.
+ * \see t8_cmesh_locate.h */
+typedef struct t8_cmesh_locate_cache
+{
+  double *tree_bounds;         /**< For each local tree the lower and upper corner of its bounding box. */
+  double lower[3];             /**< The lower corner of the bounding box of all local trees. */
+  double upper[3];             /**< The upper corner of the bounding box of all local trees. */
+  int num_buckets[3];          /**< The number of buckets in each coordinate direction. */
+  double bucket_width[3];      /**< The width of a bucket in each coordinate direction. */
+  t8_locidx_t *bucket_offsets; /**< For each bucket the position of its first tree in \a bucket_trees.
+                                    Has one more entry than there are buckets. */
+  t8_locidx_t *bucket_trees;   /**< For each bucket the local trees whose bounding boxes intersect it. */
+} t8_cmesh_locate_cache_t;
+
 /** This structure holds the connectivity data of the coarse mesh.
  *  It can either be replicated, then each process stores a copy of the whole
  *  mesh, or partitioned. In the latter case, each process only stores a local
@@ -135,6 +149,8 @@ typedef struct t8_cmesh
                                         Since this is very memory consuming we only fill it when needed. */
 
   t8_geometry_handler_t *geometry_handler; /**< Handles all geometries that are used by trees in this cmesh. */
+  t8_cmesh_locate_cache_t *locate_cache;   /**< Bounding boxes of the local trees for point location.
+                                                Built on first use, see \ref t8_cmesh_locate.h */
 
 #ifdef T8_ENABLE_DEBUG
   t8_locidx_t inserted_trees;  /**< Count the number of inserted trees to
@@ -55,8 +55,85 @@ t8_cmesh_get_num_vertices (t8_cmesh_t cmesh, int count_ghosts)
   return num_vertices;
 }
 
+/* Write the points, cells and cell data of the local trees, and of the ghost trees
+ * if \a write_ghosts is true, as binary data arrays to an open .vtu file.
+ * Returns 0 on success and -1 otherwise. */
 static int
-t8_cmesh_vtk_write_file_ext (t8_cmesh_t cmesh, const char *fileprefix, int write_ghosts)
+t8_cmesh_vtk_write_binary_arrays (t8_cmesh_t cmesh, t8_vtk_file_t *file, const int write_ghosts,
+                                  const t8_locidx_t num_vertices, const t8_locidx_t num_trees)
+{
+  const t8_locidx_t num_local_trees = t8_cmesh_get_num_local_trees (cmesh);
+  T8_VTK_FLOAT_TYPE *positions = T8_ALLOC (T8_VTK_FLOAT_TYPE, 3 * num_vertices);
+  int32_t *connectivity = T8_ALLOC (int32_t, num_vertices);
+  int32_t *offsets = T8_ALLOC (int32_t, num_trees);
+  uint8_t *types = T8_ALLOC (uint8_t, num_trees);
+  int32_t *treeids = T8_ALLOC (int32_t, num_trees);
+  int32_t *ranks = T8_ALLOC (int32_t, num_trees);
+  t8_locidx_t itree, ivertex;
+  int icorner, idim, retval = 0;
+
+  /* The integer arrays are written with the types of the ascii output */
+  T8_ASSERT (t8_vtk_type_size (T8_VTK_LOCIDX) == sizeof (int32_t));
+  T8_ASSERT (t8_vtk_type_size (T8_VTK_GLOIDX) == sizeof (int32_t));
+  T8_ASSERT (write_ghosts || num_trees == num_local_trees);
+
+  for (itree = 0, ivertex = 0; itree < num_trees; itree++) {
+    const int *corner_number;
+    const double *vertices;
+    t8_eclass_t eclass;
+
+    if (itree < num_local_trees) {
+      eclass = t8_cmesh_get_tree_class (cmesh, itree);
+      vertices = t8_cmesh_get_tree_vertices (cmesh, itree);
+      corner_number = t8_eclass_t8_to_vtk_corner_number[eclass];
+      treeids[itree] = (int32_t) (itree + cmesh->first_tree);
+    }
+    else {
+      eclass = t8_cmesh_get_ghost_class (cmesh, itree - num_local_trees);
+      vertices = (double *) t8_cmesh_get_attribute (cmesh, t8_get_package_id (), 0, itree);
+      corner_number = t8_eclass_vtk_to_t8_corner_number[eclass];
+      /* Write -1 as tree_id so that we can distinguish ghosts from normal trees */
+      treeids[itree] = -1;
+    }
+    T8_ASSERT (vertices != NULL);
+    for (icorner = 0; icorner < t8_eclass_num_vertices[eclass]; icorner++, ivertex++) {
+      for (idim = 0; idim < 3; idim++) {
+        positions[3 * ivertex + idim] = (T8_VTK_FLOAT_TYPE) vertices[3 * corner_number[icorner] + idim];
+      }
+      connectivity[ivertex] = ivertex;
+    }
+    offsets[itree] = ivertex;
+    types[itree] = (uint8_t) t8_eclass_vtk_type[eclass];
+    ranks[itree] = cmesh->mpirank;
+  }
+  T8_ASSERT (ivertex == num_vertices);
+
+  fprintf (file->vtufile, "      <Points>\n");
+  retval |= t8_vtk_write_binary_data_array (file, T8_VTK_FLOAT_NAME, "Position", "NumberOfComponents=\"3\"", positions,
+                                            3 * num_vertices * sizeof (T8_VTK_FLOAT_TYPE));
+  fprintf (file->vtufile, "      </Points>\n");
+  fprintf (file->vtufile, "      <Cells>\n");
+  retval |= t8_vtk_write_binary_data_array (file, T8_VTK_LOCIDX, "connectivity", "", connectivity,
+                                            num_vertices * sizeof (int32_t));
+  retval |= t8_vtk_write_binary_data_array (file, T8_VTK_LOCIDX, "offsets", "", offsets, num_trees * sizeof (int32_t));
+  retval |= t8_vtk_write_binary_data_array (file, "UInt8", "types", "", types, num_trees * sizeof (uint8_t));
+  fprintf (file->vtufile, "      </Cells>\n");
+  fprintf (file->vtufile, "      <CellData Scalars=\"treeid,mpirank\">\n");
+  retval |= t8_vtk_write_binary_data_array (file, T8_VTK_GLOIDX, "treeid", "", treeids, num_trees * sizeof (int32_t));
+  retval |= t8_vtk_write_binary_data_array (file, "Int32", "mpirank", "", ranks, num_trees * sizeof (int32_t));
+  fprintf (file->vtufile, "      </CellData>\n");
+
+  T8_FREE (positions);
+  T8_FREE (connectivity);
+  T8_FREE (offsets);
+  T8_FREE (types);
+  T8_FREE (treeids);
+  T8_FREE (ranks);
+  return retval || ferror (file->vtufile) ? -1 : 0;
+}
+
+int
+t8_cmesh_vtk_write_file_format (t8_cmesh_t cmesh, const char *fileprefix, int write_ghosts, t8_vtk_format_t format)
 {
   T8_ASSERT (cmesh != NULL);
   T8_ASSERT (t8_cmesh_is_committed (cmesh));
@@ -73,6 +150,7 @@ t8_cmesh_vtk_write_file_ext (t8_cmesh_t cmesh, const char *fileprefix, int write
    * otherwise each process prints its part of the cmesh.*/
   if (cmesh->mpirank == 0 || cmesh->set_partition) {
     char vtufilename[BUFSIZ];
+    t8_vtk_file_t file;
     FILE *vtufile;
     t8_locidx_t num_vertices, ivertex;
     t8_locidx_t num_trees;
@@ -94,21 +172,18 @@ t8_cmesh_vtk_write_file_ext (t8_cmesh_t cmesh, const char *fileprefix, int write
     }
 
     snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, cmesh->mpirank);
-    vtufile = fopen (vtufilename, "wb");
-    if (vtufile == NULL) {
-      t8_global_errorf ("Could not open file %s for output.\n", vtufilename);
+    if (t8_vtk_file_open (&file, vtufilename, format, num_vertices, num_trees)) {
       return -1;
     }
-    fprintf (vtufile, "<?xml version=\"1.0\"?>\n");
-    fprintf (vtufile, "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
-#ifdef SC_IS_BIGENDIAN
-    fprintf (vtufile, " byte_order=\"BigEndian\">\n");
-#else
-    fprintf (vtufile, " byte_order=\"LittleEndian\">\n");
-#endif
-    fprintf (vtufile, "  <UnstructuredGrid>\n");
-    fprintf (vtufile, "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n", (long long) num_vertices,
-             (long long) num_trees);
+    if (format != T8_VTK_ASCII) {
+      if (t8_cmesh_vtk_write_binary_arrays (cmesh, &file, write_ghosts, num_vertices, num_trees)) {
+        t8_global_errorf ("Error when writing file %s.\n", vtufilename);
+        t8_vtk_file_close (&file);
+        return -1;
+      }
+      return t8_vtk_file_close (&file);
+    }
+    vtufile = file.vtufile;
     fprintf (vtufile, "      <Points>\n");
 
     /* write point position data */
@@ -294,11 +369,7 @@ t8_cmesh_vtk_write_file_ext (t8_cmesh_t cmesh, const char *fileprefix, int write
     fprintf (vtufile, "\n");
     fprintf (vtufile, "        </DataArray>\n");
     fprintf (vtufile, "      </CellData>\n");
-    /* write type data */
-    fprintf (vtufile, "    </Piece>\n");
-    fprintf (vtufile, "  </UnstructuredGrid>\n");
-    fprintf (vtufile, "</VTKFile>\n");
-    fclose (vtufile);
+    return t8_vtk_file_close (&file);
   }
   return 0;
 }
@@ -306,5 +377,5 @@ t8_cmesh_vtk_write_file_ext (t8_cmesh_t cmesh, const char *fileprefix, int write
 int
 t8_cmesh_vtk_write_file (t8_cmesh_t cmesh, const char *fileprefix)
 {
-  return t8_cmesh_vtk_write_file_ext (cmesh, fileprefix, 1);
+  return t8_cmesh_vtk_write_file_format (cmesh, fileprefix, 1, T8_VTK_ASCII);
 }
@@ -28,6 +28,7 @@
 #define T8_CMESH_VTK_H
 
 #include <t8_cmesh.h>
+#include <t8_vtk.h>
 
 /* typedef and macros */
 
@@ -38,6 +39,17 @@ T8_EXTERN_C_BEGIN ();
 int
 t8_cmesh_vtk_write_file (t8_cmesh_t cmesh, const char *fileprefix);
 
+/** Write the trees of a cmesh in .pvtu file format with a given encoding of the data arrays.
+ * If the cmesh is replicated, only rank 0 writes a .vtu file.
+ * \param [in] cmesh        A committed cmesh.
+ * \param [in] fileprefix   The prefix of the output files.
+ * \param [in] write_ghosts If true, each process additionally writes its ghost trees with tree id -1.
+ * \param [in] format       The encoding of the data arrays in the .vtu files.
+ * \return                  0 on success, -1 if writing the .vtu file failed.
+ */
+int
+t8_cmesh_vtk_write_file_format (t8_cmesh_t cmesh, const char *fileprefix, int write_ghosts, t8_vtk_format_t format);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_CMESH_VTK_H */
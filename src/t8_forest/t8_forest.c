@@ -32,6 +32,8 @@
 #include <t8_forest/t8_forest_adapt.h>
 #include <t8_forest/t8_forest_balance.h>
 #include <t8_forest/t8_forest_vtk.h>
+#include <t8_forest/t8_forest_face_connectivity.h>
+#include <t8_forest/t8_forest_global_nodes.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
 #include <t8_cmesh/t8_cmesh_trees.h>
 #include <t8_element_c_interface.h>
@@ -60,6 +62,8 @@ t8_forest_init (t8_forest_t *pforest)
   forest->maxlevel_existing = -1;
   forest->stats_computed = 0;
   forest->incomplete_trees = -1;
+  forest->ghost_width = 1;
+  forest->cache_linear_ids = 0;
 }
 
 int
@@ -139,6 +143,20 @@ t8_forest_set_level (t8_forest_t forest, int level)
   forest->set_level = level;
 }
 
+void
+t8_forest_set_load (t8_forest_t forest, const char *filename)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->rc.refcount > 0);
+  T8_ASSERT (!forest->committed);
+  T8_ASSERT (forest->set_from == NULL);
+  T8_ASSERT (filename != NULL);
+
+  T8_FREE (forest->set_load_filename);
+  forest->set_load_filename = T8_ALLOC (char, strlen (filename) + 1);
+  strcpy (forest->set_load_filename, filename);
+}
+
 void
 t8_forest_set_copy (t8_forest_t forest, const t8_forest_t set_from)
 {
@@ -222,9 +240,6 @@ void
 t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost, t8_ghost_type_t ghost_type, int ghost_version)
 {
   T8_ASSERT (t8_forest_is_initialized (forest));
-  /* We currently only support face ghosts */
-  SC_CHECK_ABORT (do_ghost == 0 || ghost_type == T8_GHOST_FACES,
-                  "Ghost neighbors other than face-neighbors are not supported.\n");
   SC_CHECK_ABORT (1 <= ghost_version && ghost_version <= 3, "Invalid choice for ghost version. Choose 1, 2, or 3.\n");
 
   if (ghost_type == T8_GHOST_NONE) {
@@ -247,6 +262,39 @@ t8_forest_set_ghost (t8_forest_t forest, int do_ghost, t8_ghost_type_t ghost_typ
   t8_forest_set_ghost_ext (forest, do_ghost, ghost_type, 3);
 }
 
+void
+t8_forest_set_ghost_width (t8_forest_t forest, int ghost_width)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  SC_CHECK_ABORT (ghost_width >= 1, "The ghost width must be at least 1.\n");
+
+  forest->ghost_width = ghost_width;
+}
+
+void
+t8_forest_set_ghost_incremental (t8_forest_t forest, int incremental)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->ghost_incremental = (incremental != 0);
+}
+
+void
+t8_forest_set_linear_id_cache (t8_forest_t forest, int do_cache)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->cache_linear_ids = (do_cache != 0);
+}
+
+int
+t8_forest_get_ghost_width (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest) || t8_forest_is_committed (forest));
+
+  return forest->ghost_width;
+}
+
 void
 t8_forest_set_adapt (t8_forest_t forest, const t8_forest_t set_from, t8_forest_adapt_t adapt_fn, int recursive)
 {
@@ -412,6 +460,71 @@ t8_forest_populate_irregular (t8_forest_t forest)
   t8_forest_unref (&forest_tmp_partition);
 }
 
+/* Return true if the element elem_a is an ancestor of or equal to the element elem_b. */
+static int
+t8_forest_cost_is_ancestor (t8_eclass_scheme_c *ts, const t8_element_t *elem_a, const t8_element_t *elem_b)
+{
+  const int level_a = t8_element_level (ts, elem_a);
+
+  return level_a <= t8_element_level (ts, elem_b)
+         && t8_element_get_linear_id (ts, elem_a, level_a) == t8_element_get_linear_id (ts, elem_b, level_a);
+}
+
+/* Carry the element costs of forest_old over to forest_new, which was adapted from forest_old.
+ * Since the adaptation may be recursive, the elements of both forests are matched along the SFC:
+ * A refined element passes its cost evenly to all its descendants in forest_new, the elements
+ * that were coarsened pass the sum of their costs to their ancestor in forest_new.
+ * Removed elements pass their cost to no element. */
+static void
+t8_forest_cost_carry_over (t8_forest_t forest_new, t8_forest_t forest_old)
+{
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest_old);
+
+  T8_ASSERT (forest_old->element_costs != NULL);
+  T8_ASSERT (num_local_trees == t8_forest_get_num_local_trees (forest_new));
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest_old, t8_forest_get_tree_class (forest_old, itree));
+    const t8_locidx_t num_old = t8_forest_get_tree_num_elements (forest_old, itree);
+    const t8_locidx_t num_new = t8_forest_get_tree_num_elements (forest_new, itree);
+    const t8_locidx_t offset_old = t8_forest_get_tree_element_offset (forest_old, itree);
+    const t8_locidx_t offset_new = t8_forest_get_tree_element_offset (forest_new, itree);
+    t8_locidx_t iold = 0;
+    t8_locidx_t inew = 0;
+
+    while (iold < num_old && inew < num_new) {
+      const t8_element_t *elem_old = t8_forest_get_element_in_tree (forest_old, itree, iold);
+      const t8_element_t *elem_new = t8_forest_get_element_in_tree (forest_new, itree, inew);
+      const double cost = forest_old->element_costs[offset_old + iold];
+
+      if (t8_forest_cost_is_ancestor (ts, elem_new, elem_old)) {
+        /* elem_old was kept or coarsened into elem_new */
+        t8_forest_cost_add_range (forest_new, offset_new + inew, 1, cost);
+        iold++;
+      }
+      else if (t8_forest_cost_is_ancestor (ts, elem_old, elem_new)) {
+        /* elem_old was refined, find all its descendants in forest_new */
+        t8_locidx_t num_descendants = 1;
+        while (inew + num_descendants < num_new
+               && t8_forest_cost_is_ancestor (
+                 ts, elem_old, t8_forest_get_element_in_tree (forest_new, itree, inew + num_descendants))) {
+          num_descendants++;
+        }
+        t8_forest_cost_add_range (forest_new, offset_new + inew, num_descendants, cost);
+        inew += num_descendants;
+        iold++;
+      }
+      else if (t8_element_compare (ts, elem_old, elem_new) < 0) {
+        /* elem_old was removed */
+        iold++;
+      }
+      else {
+        /* All elements of forest_old that belong to elem_new were processed */
+        inew++;
+      }
+    }
+  }
+}
+
 void
 t8_forest_commit (t8_forest_t forest)
 {
@@ -452,16 +565,24 @@ t8_forest_commit (t8_forest_t forest)
     /* Compute the maximum allowed refinement level */
     t8_forest_compute_maxlevel (forest);
     T8_ASSERT (forest->set_level <= forest->maxlevel);
-    /* populate a new forest with tree and quadrant objects */
-    if (t8_forest_refines_irregular (forest) && forest->set_level > 0) {
-      /* On root level we will also use the normal algorithm */
-      t8_forest_populate_irregular (forest);
+    if (forest->set_load_filename != NULL) {
+      /* Read the leaves from a checkpoint file */
+      t8_forest_load_leaves (forest);
+      T8_FREE (forest->set_load_filename);
+      forest->set_load_filename = NULL;
     }
     else {
-      t8_forest_populate (forest);
+      /* populate a new forest with tree and quadrant objects */
+      if (t8_forest_refines_irregular (forest) && forest->set_level > 0) {
+        /* On root level we will also use the normal algorithm */
+        t8_forest_populate_irregular (forest);
+      }
+      else {
+        t8_forest_populate (forest);
+      }
+      forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
+      forest->incomplete_trees = 0;
     }
-    forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
-    forest->incomplete_trees = 0;
   }
   else {                                        /* set_from != NULL */
     t8_forest_t forest_from = forest->set_from; /* temporarily store set_from, since we may overwrite it */
@@ -472,6 +593,7 @@ t8_forest_commit (t8_forest_t forest)
     T8_ASSERT (!forest->do_dup);
     T8_ASSERT (forest->from_method >= T8_FOREST_FROM_FIRST && forest->from_method < T8_FOREST_FROM_LAST);
     T8_ASSERT (forest->set_from->incomplete_trees > -1);
+    T8_ASSERT (forest->set_load_filename == NULL);
 
     /* TODO: optimize all this when forest->set_from has reference count one */
     /* TODO: Get rid of duping the communicator */
@@ -502,6 +624,14 @@ t8_forest_commit (t8_forest_t forest)
 
     /* Compute the maximum allowed refinement level */
     t8_forest_compute_maxlevel (forest);
+    if (forest->do_ghost && forest->ghost_incremental && forest->mpisize > 1
+        && (forest->from_method == T8_FOREST_FROM_ADAPT || forest->from_method == T8_FOREST_FROM_COPY)
+        && forest->ghost_type == T8_GHOST_FACES && forest->ghost_width == 1 && forest_from->ghost_type == T8_GHOST_FACES
+        && forest_from->ghost_width == 1 && !forest_from->incomplete_trees) {
+      /* Keep the input forest, such that we can derive the new ghost layer from its ghost layer */
+      t8_forest_ref (forest_from);
+      forest->ghost_from = forest_from;
+    }
     if (forest->from_method == T8_FOREST_FROM_COPY) {
       SC_CHECK_ABORT (forest->set_from != NULL, "No forest to copy from was specified.");
       t8_forest_copy_trees (forest, forest->set_from, 1);
@@ -535,6 +665,11 @@ t8_forest_commit (t8_forest_t forest)
         if (forest->profile != NULL) {
           forest->profile->adapt_runtime = forest_adapt->profile->adapt_runtime;
         }
+        if (forest_from->element_costs != NULL && (forest->from_method & T8_FOREST_FROM_PARTITION)) {
+          /* Carry the measured element costs over to the adapted forest, such that
+           * they can be used as weights in the following partition. */
+          t8_forest_cost_carry_over (forest_adapt, forest_from);
+        }
       }
       else {
         /* This forest should only be adapted */
@@ -636,6 +771,11 @@ t8_forest_commit (t8_forest_t forest)
     /* Compute global first desc array */
     t8_forest_partition_create_first_desc (forest);
   }
+  if (forest->cache_linear_ids) {
+    /* Cache the linear ids of the local elements. We do this here and not on demand,
+     * such that the read-only queries on the forest can be run from multiple threads. */
+    t8_forest_build_tree_keys (forest);
+  }
 
   if (forest->profile != NULL) {
     /* If profiling is enabled, we measure the runtime of commit */
@@ -652,7 +792,8 @@ t8_forest_commit (t8_forest_t forest)
   if (forest->mpisize > 1) {
     /* Construct a ghost layer, if desired */
     if (forest->do_ghost) {
-      /* TODO: ghost type */
+      /* Edge and vertex ghosts are always computed with the same algorithm,
+       * see t8_forest_ghost_create_ext. */
       switch (forest->ghost_algorithm) {
       case 1:
         t8_forest_ghost_create_balanced_only (forest);
@@ -669,6 +810,10 @@ t8_forest_commit (t8_forest_t forest)
     }
     forest->do_ghost = 0;
   }
+  if (forest->ghost_from != NULL) {
+    /* We do not need the previous forest anymore */
+    t8_forest_unref (&forest->ghost_from);
+  }
 #ifdef T8_ENABLE_DEBUG
   t8_forest_partition_test_boundary_element (forest);
 #endif
@@ -1338,6 +1483,111 @@ t8_forest_profile_get_balance (t8_forest_t forest, int *balance_rounds)
   return 0;
 }
 
+/* Return the element cost array of a forest, allocate and zero it if
+ * it does not exist yet. */
+static double *
+t8_forest_cost_get_array_for_writing (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->element_costs == NULL) {
+    forest->element_costs = T8_ALLOC_ZERO (double, forest->local_num_elements);
+  }
+  return forest->element_costs;
+}
+
+void
+t8_forest_cost_add_range (t8_forest_t forest, t8_locidx_t first_lelement, t8_locidx_t num_elements, double cost)
+{
+  double *costs;
+  double cost_per_element;
+  t8_locidx_t ielement;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= first_lelement && 0 <= num_elements);
+  T8_ASSERT (first_lelement + num_elements <= forest->local_num_elements);
+  T8_ASSERT (cost >= 0);
+
+  if (num_elements == 0) {
+    return;
+  }
+  costs = t8_forest_cost_get_array_for_writing (forest);
+  cost_per_element = cost / num_elements;
+  for (ielement = first_lelement; ielement < first_lelement + num_elements; ielement++) {
+    costs[ielement] += cost_per_element;
+  }
+}
+
+void
+t8_forest_cost_add_element (t8_forest_t forest, t8_locidx_t ltreeid, t8_locidx_t leid_in_tree, double cost)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= leid_in_tree && leid_in_tree < t8_forest_get_tree_num_elements (forest, ltreeid));
+
+  t8_forest_cost_add_range (forest, t8_forest_get_tree_element_offset (forest, ltreeid) + leid_in_tree, 1, cost);
+}
+
+void
+t8_forest_cost_add_tree (t8_forest_t forest, t8_locidx_t ltreeid, double cost)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  t8_forest_cost_add_range (forest, t8_forest_get_tree_element_offset (forest, ltreeid),
+                            t8_forest_get_tree_num_elements (forest, ltreeid), cost);
+}
+
+void
+t8_forest_cost_reset (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->element_costs != NULL) {
+    memset (forest->element_costs, 0, forest->local_num_elements * sizeof (double));
+  }
+}
+
+const double *
+t8_forest_cost_get_array (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  return forest->element_costs;
+}
+
+double
+t8_forest_compute_cost_imbalance (t8_forest_t forest)
+{
+  double local_cost = 0;
+  double max_cost, sum_cost;
+  t8_locidx_t ielement;
+  int mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (forest->element_costs != NULL) {
+    for (ielement = 0; ielement < forest->local_num_elements; ielement++) {
+      local_cost += forest->element_costs[ielement];
+    }
+  }
+  mpiret = sc_MPI_Allreduce (&local_cost, &max_cost, 1, sc_MPI_DOUBLE, sc_MPI_MAX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&local_cost, &sum_cost, 1, sc_MPI_DOUBLE, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  if (sum_cost > 0) {
+    return max_cost * forest->mpisize / sum_cost;
+  }
+  /* No process recorded any cost, we consider the forest balanced. */
+  return 1;
+}
+
+int
+t8_forest_should_repartition (t8_forest_t forest, double threshold)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (threshold >= 1);
+
+  /* The imbalance is the result of an Allreduce and hence the same on all processes. */
+  return t8_forest_compute_cost_imbalance (forest) > threshold;
+}
+
 void
 t8_forest_compute_elements_offset (t8_forest_t forest)
 {
@@ -1460,6 +1710,15 @@ t8_forest_free_trees (t8_forest_t forest)
   T8_ASSERT (forest->committed);
 
   number_of_trees = forest->trees->elem_count;
+  if (forest->tree_keys != NULL) {
+    /* Free the cached linear ids of the trees */
+    for (jt = 0; jt < number_of_trees; jt++) {
+      T8_FREE (forest->tree_keys[jt].linear_ids);
+      T8_FREE (forest->tree_keys[jt].levels);
+    }
+    T8_FREE (forest->tree_keys);
+    forest->tree_keys = NULL;
+  }
   for (jt = 0; jt < number_of_trees; jt++) {
     tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, jt);
     if (t8_forest_get_tree_element_count (tree) < 1) {
@@ -1496,6 +1755,9 @@ t8_forest_reset (t8_forest_t *pforest)
       /* in this case we have taken ownership and not released it yet */
       t8_forest_unref (&forest->set_from);
     }
+    if (forest->set_load_filename != NULL) {
+      T8_FREE (forest->set_load_filename);
+    }
   }
   else {
     T8_ASSERT (forest->set_from == NULL);
@@ -1514,6 +1776,10 @@ t8_forest_reset (t8_forest_t *pforest)
   if (forest->ghosts != NULL) {
     t8_forest_ghost_unref (&forest->ghosts);
   }
+  /* Destroy the face connectivity table if it exists */
+  t8_forest_face_connectivity_reset (forest);
+  /* Destroy the global node numbering if it exists */
+  t8_forest_global_nodes_reset (forest);
   /* we have taken ownership on calling t8_forest_set_* */
   if (forest->scheme_cxx != NULL) {
     t8_scheme_cxx_unref (&forest->scheme_cxx);
@@ -1537,6 +1803,9 @@ t8_forest_reset (t8_forest_t *pforest)
   if (forest->profile != NULL) {
     T8_FREE (forest->profile);
   }
+  if (forest->element_costs != NULL) {
+    T8_FREE (forest->element_costs);
+  }
   T8_FREE (forest);
   *pforest = NULL;
 }
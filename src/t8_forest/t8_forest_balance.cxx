@@ -184,6 +184,8 @@ t8_forest_balance (t8_forest_t forest, int repartition)
     forest_temp->maxlevel_existing = forest_from->maxlevel_existing;
     /* Adapt the forest */
     t8_forest_set_adapt (forest_temp, forest_from, t8_forest_balance_adapt, 0);
+    /* The next round searches the leaves of forest_temp */
+    t8_forest_set_linear_id_cache (forest_temp, 1);
     if (!repartition) {
       t8_forest_set_ghost (forest_temp, 1, T8_GHOST_FACES);
     }
@@ -228,6 +230,7 @@ t8_forest_balance (t8_forest_t forest, int repartition)
       /* Update the maximum occurring level */
       forest_partition->maxlevel_existing = forest_temp->maxlevel_existing;
       t8_forest_set_partition (forest_partition, forest_temp, 0);
+      t8_forest_set_linear_id_cache (forest_partition, 1);
       t8_forest_set_ghost (forest_partition, 1, T8_GHOST_FACES);
       /* If profiling is enabled, measure partition rumtimes */
       if (forest->profile != NULL) {
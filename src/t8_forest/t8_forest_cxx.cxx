@@ -30,6 +30,7 @@
 #include <t8_forest/t8_forest_partition.h>
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_iterate.h>
 #include <t8_forest/t8_forest_balance.h>
 #include <t8_element_cxx.hxx>
 #include <t8_element_c_interface.h>
@@ -40,6 +41,8 @@
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear.h>
 #include <t8_geometry/t8_geometry_implementations/t8_geometry_linear_axis_aligned.h>
 #endif
+#include <map>
+#include <vector>
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -1470,6 +1473,82 @@ t8_forest_bin_search_lower (t8_element_array_t *elements, t8_linearidx_t element
   return low;
 }
 
+void
+t8_forest_build_tree_keys (t8_forest_t forest)
+{
+  t8_forest_tree_keys_t *keys;
+  t8_element_array_t *elements;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t num_trees, num_elements, itree, ielement;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->tree_keys == NULL);
+  num_trees = t8_forest_get_num_local_trees (forest);
+  forest->tree_keys = T8_ALLOC_ZERO (t8_forest_tree_keys_t, SC_MAX (num_trees, 1));
+  for (itree = 0; itree < num_trees; itree++) {
+    /* Compute the keys of this tree */
+    keys = forest->tree_keys + itree;
+    elements = t8_forest_get_tree_element_array (forest, itree);
+    ts = t8_element_array_get_scheme (elements);
+    num_elements = t8_element_array_get_count (elements);
+    keys->linear_ids = T8_ALLOC (t8_linearidx_t, SC_MAX (num_elements, 1));
+    keys->levels = T8_ALLOC (int8_t, SC_MAX (num_elements, 1));
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_element_array_index_locidx (elements, ielement);
+      keys->linear_ids[ielement] = ts->t8_element_get_linear_id (element, forest->maxlevel);
+      keys->levels[ielement] = ts->t8_element_level (element);
+    }
+  }
+}
+
+const t8_linearidx_t *
+t8_forest_tree_get_linear_ids (const t8_forest_t forest, t8_locidx_t ltreeid, const int8_t **levels)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid && ltreeid < t8_forest_get_num_local_trees (forest));
+  if (forest->tree_keys == NULL) {
+    /* The linear ids are not cached */
+    if (levels != NULL) {
+      *levels = NULL;
+    }
+    return NULL;
+  }
+  if (levels != NULL) {
+    *levels = forest->tree_keys[ltreeid].levels;
+  }
+  return forest->tree_keys[ltreeid].linear_ids;
+}
+
+t8_locidx_t
+t8_forest_tree_bin_search_lower (const t8_forest_t forest, t8_locidx_t ltreeid, t8_linearidx_t element_id)
+{
+  const t8_linearidx_t *linear_ids = t8_forest_tree_get_linear_ids (forest, ltreeid, NULL);
+  const t8_linearidx_t *base = linear_ids;
+  t8_locidx_t count = t8_forest_get_tree_num_elements (forest, ltreeid);
+  t8_locidx_t half;
+
+  if (count == 0) {
+    return -1;
+  }
+  if (linear_ids == NULL) {
+    /* The linear ids are not cached, we decode the elements */
+    return t8_forest_bin_search_lower (t8_forest_get_tree_element_array (forest, ltreeid), element_id,
+                                       forest->maxlevel);
+  }
+  if (linear_ids[0] > element_id) {
+    /* No element has id smaller than the given one */
+    return -1;
+  }
+  /* base[0] <= element_id is invariant, we halve the range in each step */
+  while (count > 1) {
+    half = count / 2;
+    base = base[half] <= element_id ? base + half : base;
+    count -= half;
+  }
+  return base - linear_ids;
+}
+
 t8_eclass_t
 t8_forest_element_neighbor_eclass (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *elem, int face)
 {
@@ -1513,6 +1592,105 @@ t8_forest_element_neighbor_eclass (t8_forest_t forest, t8_locidx_t ltreeid, cons
   }
 }
 
+/* Construct the face neighbor of an element across a tree boundary.
+ * lctree_id is the cmesh local id of the tree of elem, which must be a local tree of the cmesh. */
+static t8_gloidx_t
+t8_forest_element_face_neighbor_across_trees (t8_forest_t forest, t8_locidx_t lctree_id, t8_eclass_t eclass,
+                                              t8_eclass_scheme_c *ts, const t8_element_t *elem, t8_element_t *neigh,
+                                              int face, int *neigh_face)
+{
+  t8_eclass_scheme_c *boundary_scheme, *neighbor_scheme;
+  t8_eclass_t neigh_eclass, boundary_class;
+  t8_element_t *face_element;
+  t8_cmesh_t cmesh;
+  t8_locidx_t lcneigh_id;
+  t8_locidx_t *face_neighbor;
+  t8_gloidx_t global_neigh_id;
+  t8_cghost_t ghost;
+  int8_t *ttf;
+  int tree_face, tree_neigh_face;
+  int is_smaller, eclass_compare;
+  int F, sign;
+
+  cmesh = forest->cmesh;
+  /* Get the scheme associated to the element class of the boundary element. */
+  /* Compute the face of elem_tree at which the face connection is. */
+  tree_face = ts->t8_element_tree_face (elem, face);
+  if (t8_cmesh_tree_face_is_boundary (cmesh, lctree_id, tree_face)) {
+    /* This face is a domain boundary. We do not need to continue */
+    return -1;
+  }
+  /* Get the eclass scheme for the boundary */
+  boundary_class = (t8_eclass_t) t8_eclass_face_types[eclass][tree_face];
+  boundary_scheme = t8_forest_get_eclass_scheme (forest, boundary_class);
+  /* Allocate the face element */
+  boundary_scheme->t8_element_new (1, &face_element);
+  /* Compute the face element. */
+  ts->t8_element_boundary_face (elem, face, face_element, boundary_scheme);
+  /* Get the coarse tree that contains elem.
+   * Also get the face neighbor information of the coarse tree. */
+  (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, lctree_id, &face_neighbor, &ttf);
+  /* Compute the local id of the face neighbor tree. */
+  lcneigh_id = face_neighbor[tree_face];
+  /* F is needed to compute the neighbor face number and the orientation.
+   * tree_neigh_face = ttf % F
+   * or = ttf / F
+   */
+  F = t8_eclass_max_num_faces[cmesh->dimension];
+  /* compute the neighbor face */
+  tree_neigh_face = ttf[tree_face] % F;
+  if (lcneigh_id == lctree_id && tree_face == tree_neigh_face) {
+    /* This face is a domain boundary and there is no neighbor */
+    return -1;
+  }
+  /* We now compute the eclass of the neighbor tree. */
+  if (lcneigh_id < t8_cmesh_get_num_local_trees (cmesh)) {
+    /* The face neighbor is a local tree */
+    /* Get the eclass of the neighbor tree */
+    neigh_eclass = t8_cmesh_get_tree_class (cmesh, lcneigh_id);
+    global_neigh_id = lcneigh_id + t8_cmesh_get_first_treeid (cmesh);
+  }
+  else {
+    /* The face neighbor is a ghost tree */
+    T8_ASSERT (cmesh->num_local_trees <= lcneigh_id && lcneigh_id < cmesh->num_ghosts + cmesh->num_local_trees);
+    /* Get the eclass of the neighbor tree */
+    ghost = t8_cmesh_trees_get_ghost (cmesh->trees, lcneigh_id - t8_cmesh_get_num_local_trees (cmesh));
+    neigh_eclass = ghost->eclass;
+    global_neigh_id = ghost->treeid;
+  }
+  /* We need to find out which face is the smaller one that is the one
+   * according to which the orientation was computed.
+   * face_a is smaller then face_b if either eclass_a < eclass_b
+   * or eclass_a = eclass_b and face_a < face_b. */
+  /* -1 eclass < neigh_eclass, 0 eclass = neigh_eclass, 1 eclass > neigh_eclass */
+  eclass_compare = t8_eclass_compare (eclass, neigh_eclass);
+  is_smaller = 0;
+  if (eclass_compare == -1) {
+    /* The face in the current tree is the smaller one */
+    is_smaller = 1;
+  }
+  else if (eclass_compare == 1) {
+    /* The face in the other tree is the smaller one */
+    is_smaller = 0;
+  }
+  else {
+
+    T8_ASSERT (eclass_compare == 0);
+    /* Check if the face of the current tree has a smaller index then the face of the neighbor tree. */
+    is_smaller = tree_face <= tree_neigh_face;
+  }
+  /* We now transform the face element to the other tree. */
+  sign = t8_eclass_face_orientation[eclass][tree_face] == t8_eclass_face_orientation[neigh_eclass][tree_neigh_face];
+  boundary_scheme->t8_element_transform_face (face_element, face_element, ttf[tree_face] / F, sign, is_smaller);
+  /* And now we extrude the face to the new neighbor element */
+  neighbor_scheme = forest->scheme_cxx->eclass_schemes[neigh_eclass];
+  *neigh_face = neighbor_scheme->t8_element_extrude_face (face_element, boundary_scheme, neigh, tree_neigh_face);
+  /* Free the face_element */
+  boundary_scheme->t8_element_destroy (1, &face_element);
+
+  return global_neigh_id;
+}
+
 t8_gloidx_t
 t8_forest_element_face_neighbor (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *elem, t8_element_t *neigh,
                                  t8_eclass_scheme_c *neigh_scheme, int face, int *neigh_face)
@@ -1531,99 +1709,364 @@ t8_forest_element_face_neighbor (t8_forest_t forest, t8_locidx_t ltreeid, const
   }
   else {
     /* The neighbor does not lie inside the current tree. The content of neigh is undefined right now. */
-    t8_eclass_scheme_c *boundary_scheme, *neighbor_scheme;
-    t8_eclass_t neigh_eclass, boundary_class;
-    t8_element_t *face_element;
-    t8_cmesh_t cmesh;
-    t8_locidx_t lctree_id, lcneigh_id;
-    t8_locidx_t *face_neighbor;
-    t8_gloidx_t global_neigh_id;
-    t8_cghost_t ghost;
-    int8_t *ttf;
-    int tree_face, tree_neigh_face;
-    int is_smaller, eclass_compare;
-    int F, sign;
-
-    cmesh = forest->cmesh;
-    /* Get the scheme associated to the element class of the boundary element. */
-    /* Compute the face of elem_tree at which the face connection is. */
-    tree_face = ts->t8_element_tree_face (elem, face);
-    /* compute coarse tree id */
-    lctree_id = t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid);
-    if (t8_cmesh_tree_face_is_boundary (cmesh, lctree_id, tree_face)) {
-      /* This face is a domain boundary. We do not need to continue */
-      return -1;
+    return t8_forest_element_face_neighbor_across_trees (forest, t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid),
+                                                         eclass, ts, elem, neigh, face, neigh_face);
+  }
+}
+
+t8_gloidx_t
+t8_forest_element_face_neighbor_cmesh (t8_forest_t forest, t8_locidx_t lctreeid, const t8_element_t *elem,
+                                       t8_element_t *neigh, t8_eclass_scheme_c *neigh_scheme, int face,
+                                       int *neigh_face)
+{
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t eclass;
+  t8_cmesh_t cmesh = t8_forest_get_cmesh (forest);
+
+  T8_ASSERT (t8_cmesh_treeid_is_local_tree (cmesh, lctreeid));
+  eclass = t8_cmesh_get_tree_class (cmesh, lctreeid);
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  if (neigh_scheme == ts && ts->t8_element_face_neighbor_inside (elem, neigh, face, neigh_face)) {
+    /* The neighbor was constructed and is inside the current tree. */
+    return t8_cmesh_get_global_id (cmesh, lctreeid);
+  }
+  return t8_forest_element_face_neighbor_across_trees (forest, lctreeid, eclass, ts, elem, neigh, face, neigh_face);
+}
+
+/* Compute for the vertices of the face tree_face of the cmesh local tree lctreeid the corresponding
+ * tree vertices of the face neighbor tree of class neigh_class.
+ * We take the level 1 child of the root at each face vertex, construct its face neighbor across the tree face
+ * and find the vertex of the neighbor root that the neighbor child touches. Thus, the correspondence follows
+ * from the face connection of the cmesh and no coordinates are compared across trees. */
+static void
+t8_forest_tree_face_vertex_map (t8_forest_t forest, t8_locidx_t lctreeid, int tree_face, t8_eclass_t neigh_class,
+                                int *neigh_vertices)
+{
+  const t8_eclass_t eclass = t8_cmesh_get_tree_class (t8_forest_get_cmesh (forest), lctreeid);
+  const int num_face_vertices = t8_eclass_num_vertices[t8_eclass_face_types[eclass][tree_face]];
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+  t8_eclass_scheme_c *neigh_ts = t8_forest_get_eclass_scheme (forest, neigh_class);
+  t8_element_t *root, *neigh, **children;
+  double vertex_coords[3];
+  int num_children, ivertex, tree_vertex, ichild, icorner, iface, neigh_face, found;
+
+  ts->t8_element_new (1, &root);
+  ts->t8_element_root (root);
+  num_children = ts->t8_element_num_children (root);
+  children = T8_ALLOC (t8_element_t *, num_children);
+  ts->t8_element_new (num_children, children);
+  ts->t8_element_children (root, num_children, children);
+  neigh_ts->t8_element_new (1, &neigh);
+
+  for (ivertex = 0; ivertex < num_face_vertices; ivertex++) {
+    tree_vertex = t8_face_vertex_to_tree_vertex[eclass][tree_face][ivertex];
+    neigh_vertices[ivertex] = -1;
+    /* Find the child at the tree vertex and its face at the tree face */
+    for (ichild = 0, found = 0; ichild < num_children && !found; ichild++) {
+      for (icorner = 0; icorner < ts->t8_element_num_corners (children[ichild]) && !found; icorner++) {
+        memset (vertex_coords, 0, 3 * sizeof (double));
+        ts->t8_element_vertex_reference_coords (children[ichild], icorner, vertex_coords);
+        found = t8_vec_dist (vertex_coords, t8_element_corner_ref_coords[eclass][tree_vertex]) == 0;
+      }
     }
-    /* Get the eclass scheme for the boundary */
-    boundary_class = (t8_eclass_t) t8_eclass_face_types[eclass][tree_face];
-    boundary_scheme = t8_forest_get_eclass_scheme (forest, boundary_class);
-    /* Allocate the face element */
-    boundary_scheme->t8_element_new (1, &face_element);
-    /* Compute the face element. */
-    ts->t8_element_boundary_face (elem, face, face_element, boundary_scheme);
-    /* Get the coarse tree that contains elem.
-     * Also get the face neighbor information of the coarse tree. */
-    (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, lctree_id, &face_neighbor, &ttf);
-    /* Compute the local id of the face neighbor tree. */
-    lcneigh_id = face_neighbor[tree_face];
-    /* F is needed to compute the neighbor face number and the orientation.
-     * tree_neigh_face = ttf % F
-     * or = ttf / F
-     */
-    F = t8_eclass_max_num_faces[cmesh->dimension];
-    /* compute the neighbor face */
-    tree_neigh_face = ttf[tree_face] % F;
-    if (lcneigh_id == lctree_id && tree_face == tree_neigh_face) {
-      /* This face is a domain boundary and there is no neighbor */
-      return -1;
+    T8_ASSERT (found);
+    ichild--;
+    for (iface = 0; iface < ts->t8_element_num_faces (children[ichild]); iface++) {
+      if (ts->t8_element_is_root_boundary (children[ichild], iface)
+          && ts->t8_element_tree_face (children[ichild], iface) == tree_face) {
+        break;
+      }
     }
-    /* We now compute the eclass of the neighbor tree. */
-    if (lcneigh_id < t8_cmesh_get_num_local_trees (cmesh)) {
-      /* The face neighbor is a local tree */
-      /* Get the eclass of the neighbor tree */
-      neigh_eclass = t8_cmesh_get_tree_class (cmesh, lcneigh_id);
-      global_neigh_id = lcneigh_id + t8_cmesh_get_first_treeid (cmesh);
+    T8_ASSERT (iface < ts->t8_element_num_faces (children[ichild]));
+    t8_forest_element_face_neighbor_cmesh (forest, lctreeid, children[ichild], neigh, neigh_ts, iface, &neigh_face);
+    /* The neighbor child touches exactly one vertex of the neighbor root */
+    for (icorner = 0; icorner < neigh_ts->t8_element_num_corners (neigh); icorner++) {
+      memset (vertex_coords, 0, 3 * sizeof (double));
+      neigh_ts->t8_element_vertex_reference_coords (neigh, icorner, vertex_coords);
+      for (tree_vertex = 0; tree_vertex < t8_eclass_num_vertices[neigh_class]; tree_vertex++) {
+        if (t8_vec_dist (vertex_coords, t8_element_corner_ref_coords[neigh_class][tree_vertex]) == 0) {
+          T8_ASSERT (neigh_vertices[ivertex] < 0 || neigh_vertices[ivertex] == tree_vertex);
+          neigh_vertices[ivertex] = tree_vertex;
+        }
+      }
     }
-    else {
-      /* The face neighbor is a ghost tree */
-      T8_ASSERT (cmesh->num_local_trees <= lcneigh_id && lcneigh_id < cmesh->num_ghosts + cmesh->num_local_trees);
-      /* Get the eclass of the neighbor tree */
-      ghost = t8_cmesh_trees_get_ghost (cmesh->trees, lcneigh_id - t8_cmesh_get_num_local_trees (cmesh));
-      neigh_eclass = ghost->eclass;
-      global_neigh_id = ghost->treeid;
-    }
-    /* We need to find out which face is the smaller one that is the one
-     * according to which the orientation was computed.
-     * face_a is smaller then face_b if either eclass_a < eclass_b
-     * or eclass_a = eclass_b and face_a < face_b. */
-    /* -1 eclass < neigh_eclass, 0 eclass = neigh_eclass, 1 eclass > neigh_eclass */
-    eclass_compare = t8_eclass_compare (eclass, neigh_eclass);
-    is_smaller = 0;
-    if (eclass_compare == -1) {
-      /* The face in the current tree is the smaller one */
-      is_smaller = 1;
+    T8_ASSERT (neigh_vertices[ivertex] >= 0);
+  }
+
+  neigh_ts->t8_element_destroy (1, &neigh);
+  ts->t8_element_destroy (num_children, children);
+  ts->t8_element_destroy (1, &root);
+  T8_FREE (children);
+}
+
+/* Map a point on the face tree_face of a tree of class eclass to the reference coordinates of the
+ * neighbor tree of class neigh_class. neigh_vertices are the corresponding vertices of the neighbor tree
+ * as computed by t8_forest_tree_face_vertex_map. Since the faces of the reference elements are affine
+ * images of each other, we write the point in the affine coordinates of the first (up to) three face
+ * vertices and evaluate these coordinates at the corresponding neighbor vertices. */
+static void
+t8_forest_tree_face_map_point (t8_eclass_t eclass, int tree_face, t8_eclass_t neigh_class,
+                               const int *neigh_vertices, const double *point, double *neigh_point)
+{
+  const int num_face_vertices = t8_eclass_num_vertices[t8_eclass_face_types[eclass][tree_face]];
+  const double *origin = t8_element_corner_ref_coords[eclass][t8_face_vertex_to_tree_vertex[eclass][tree_face][0]];
+  const double *neigh_origin = t8_element_corner_ref_coords[neigh_class][neigh_vertices[0]];
+  double axes[2][3], to_point[3], gram[2][2], rhs[2], param[2] = { 0, 0 }, det;
+  int iaxis, jaxis;
+  const int num_axes = SC_MIN (num_face_vertices - 1, 2);
+
+  for (iaxis = 0; iaxis < num_axes; iaxis++) {
+    const int tree_vertex = t8_face_vertex_to_tree_vertex[eclass][tree_face][iaxis + 1];
+    t8_vec_axpyz (origin, t8_element_corner_ref_coords[eclass][tree_vertex], axes[iaxis], -1);
+  }
+  t8_vec_axpyz (origin, point, to_point, -1);
+  for (iaxis = 0; iaxis < num_axes; iaxis++) {
+    rhs[iaxis] = t8_vec_dot (axes[iaxis], to_point);
+    for (jaxis = 0; jaxis < num_axes; jaxis++) {
+      gram[iaxis][jaxis] = t8_vec_dot (axes[iaxis], axes[jaxis]);
+    }
+  }
+  if (num_axes == 1) {
+    param[0] = rhs[0] / gram[0][0];
+  }
+  else if (num_axes == 2) {
+    det = gram[0][0] * gram[1][1] - gram[0][1] * gram[1][0];
+    param[0] = (rhs[0] * gram[1][1] - rhs[1] * gram[0][1]) / det;
+    param[1] = (rhs[1] * gram[0][0] - rhs[0] * gram[1][0]) / det;
+  }
+  t8_vec_copy (neigh_origin, neigh_point);
+  for (iaxis = 0; iaxis < num_axes; iaxis++) {
+    t8_vec_axpy (t8_element_corner_ref_coords[neigh_class][neigh_vertices[iaxis + 1]], neigh_point, param[iaxis]);
+    t8_vec_axpy (neigh_origin, neigh_point, -param[iaxis]);
+  }
+}
+
+/* The tree vertex map of a tree face, cached while computing the neighbors of one leaf */
+typedef struct
+{
+  t8_locidx_t lctreeid;
+  int tree_face;
+  int neigh_vertices[T8_ECLASS_MAX_CORNERS_2D];
+} t8_forest_tree_face_vertices_t;
+
+/* For a face of an element, compute for each corner of the element at the face the corresponding
+ * corner of its face neighbor neigh. The neighbor is given by its tree class and its face neigh_face at
+ * the connection. If the face is a tree face, the corners are mapped through the face connection of
+ * the cmesh, otherwise both elements are in the same tree and their corners have the same reference
+ * coordinates. In both cases we pick the corner of neigh at neigh_face that is closest in reference
+ * coordinates, thus no tolerance is needed. */
+static void
+t8_forest_element_face_corner_map (t8_forest_t forest, const t8_forest_vertex_neighbor_t *current,
+                                   t8_eclass_scheme_c *ts, int face, t8_eclass_t neigh_class,
+                                   t8_eclass_scheme_c *neigh_ts, const t8_element_t *neigh, int neigh_face,
+                                   sc_array_t *face_vertices, int *neigh_corners)
+{
+  t8_forest_tree_face_vertices_t *map = NULL;
+  double point[3], mapped[3], neigh_point[3], dist, min_dist;
+  size_t imap;
+  int tree_face = -1, num_face_corners, iface_corner, jface_corner, icorner, jcorner;
+
+  if (ts->t8_element_is_root_boundary (current->element, face)) {
+    tree_face = ts->t8_element_tree_face (current->element, face);
+    for (imap = 0; imap < face_vertices->elem_count; imap++) {
+      map = (t8_forest_tree_face_vertices_t *) sc_array_index (face_vertices, imap);
+      if (map->lctreeid == current->lctreeid && map->tree_face == tree_face) {
+        break;
+      }
     }
-    else if (eclass_compare == 1) {
-      /* The face in the other tree is the smaller one */
-      is_smaller = 0;
+    if (imap == face_vertices->elem_count) {
+      map = (t8_forest_tree_face_vertices_t *) sc_array_push (face_vertices);
+      map->lctreeid = current->lctreeid;
+      map->tree_face = tree_face;
+      t8_forest_tree_face_vertex_map (forest, current->lctreeid, tree_face, neigh_class, map->neigh_vertices);
+    }
+  }
+
+  num_face_corners = t8_eclass_num_vertices[ts->t8_element_face_shape (current->element, face)];
+  T8_ASSERT (num_face_corners == t8_eclass_num_vertices[neigh_ts->t8_element_face_shape (neigh, neigh_face)]);
+  for (iface_corner = 0; iface_corner < num_face_corners; iface_corner++) {
+    icorner = ts->t8_element_get_face_corner (current->element, face, iface_corner);
+    memset (point, 0, 3 * sizeof (double));
+    ts->t8_element_vertex_reference_coords (current->element, icorner, point);
+    if (tree_face >= 0) {
+      t8_forest_tree_face_map_point (current->eclass, tree_face, neigh_class, map->neigh_vertices, point, mapped);
     }
     else {
+      t8_vec_copy (point, mapped);
+    }
+    neigh_corners[icorner] = -1;
+    min_dist = -1;
+    for (jface_corner = 0; jface_corner < num_face_corners; jface_corner++) {
+      jcorner = neigh_ts->t8_element_get_face_corner (neigh, neigh_face, jface_corner);
+      memset (neigh_point, 0, 3 * sizeof (double));
+      neigh_ts->t8_element_vertex_reference_coords (neigh, jcorner, neigh_point);
+      dist = t8_vec_dist (mapped, neigh_point);
+      if (min_dist < 0 || dist < min_dist) {
+        min_dist = dist;
+        neigh_corners[icorner] = jcorner;
+      }
+    }
+  }
+}
+
+/* Count the corners of a vertex neighbor that are vertices of the leaf */
+static int
+t8_forest_vertex_neighbor_num_shared (const t8_forest_vertex_neighbor_t *neighbor, int num_corners)
+{
+  int icorner, num_shared = 0;
 
-      T8_ASSERT (eclass_compare == 0);
-      /* Check if the face of the current tree has a smaller index then the face of the neighbor tree. */
-      is_smaller = tree_face <= tree_neigh_face;
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    num_shared += neighbor->leaf_corners[icorner] != 0;
+  }
+  return num_shared;
+}
+
+/* We start at the leaf and add face neighbors as long as they share vertices with the leaf.
+ * Since the elements around a vertex or an edge of the leaf are connected via their faces,
+ * we find all of them. Which corners of a neighbor are vertices of the leaf is passed on from
+ * element to element through the shared faces. An element that gains shared vertices on a
+ * second path (for example around a periodic boundary) is processed again. */
+void
+t8_forest_element_vertex_neighbors (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *leaf, int min_touch,
+                                    sc_array_t *neighbors)
+{
+  t8_cmesh_t cmesh = t8_forest_get_cmesh (forest);
+  const size_t first_entry = neighbors->elem_count;
+  const int level = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, ltreeid))
+                      ->t8_element_level (leaf);
+  std::map<std::pair<t8_gloidx_t, t8_linearidx_t>, size_t> known;
+  std::vector<size_t> queue;
+  t8_forest_vertex_neighbor_t *current, *candidate;
+  t8_eclass_scheme_c *ts, *neigh_ts;
+  t8_eclass_t neigh_class;
+  t8_element_t *neigh;
+  t8_gloidx_t gneigh_treeid;
+  t8_locidx_t lcneigh_treeid;
+  sc_array_t face_vertices;
+  size_t icurrent, ineigh, inew;
+  int neigh_corners[T8_ECLASS_MAX_CORNERS], iface, icorner, num_corners, num_face_corners, neigh_face, has_shared;
+  int grown;
+
+  T8_ASSERT (neighbors->elem_size == sizeof (t8_forest_vertex_neighbor_t));
+  sc_array_init (&face_vertices, sizeof (t8_forest_tree_face_vertices_t));
+  /* Store the leaf as the first entry. Each of its corners is the corresponding leaf vertex. */
+  current = (t8_forest_vertex_neighbor_t *) sc_array_push (neighbors);
+  current->lctreeid = t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid);
+  current->gtreeid = t8_forest_global_tree_id (forest, ltreeid);
+  current->eclass = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, current->eclass);
+  ts->t8_element_new (1, &current->element);
+  ts->t8_element_copy (leaf, current->element);
+  memset (current->leaf_corners, 0, sizeof (current->leaf_corners));
+  num_corners = ts->t8_element_num_corners (leaf);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    current->leaf_corners[icorner] = 1 << icorner;
+  }
+  current->num_shared = num_corners;
+  known[std::make_pair (current->gtreeid, ts->t8_element_get_linear_id (leaf, level))] = first_entry;
+  queue.push_back (first_entry);
+
+  while (!queue.empty ()) {
+    icurrent = queue.back ();
+    queue.pop_back ();
+    current = (t8_forest_vertex_neighbor_t *) sc_array_index (neighbors, icurrent);
+    if (!t8_cmesh_treeid_is_local_tree (cmesh, current->lctreeid)) {
+      /* We can only compute face neighbors in local trees of the cmesh */
+      continue;
+    }
+    ts = t8_forest_get_eclass_scheme (forest, current->eclass);
+    for (iface = 0; iface < ts->t8_element_num_faces (current->element); iface++) {
+      /* Pushing to neighbors may have moved the array */
+      current = (t8_forest_vertex_neighbor_t *) sc_array_index (neighbors, icurrent);
+      /* Only faces with vertices of the leaf lead to new neighbors */
+      num_face_corners = t8_eclass_num_vertices[ts->t8_element_face_shape (current->element, iface)];
+      for (icorner = 0, has_shared = 0; icorner < num_face_corners && !has_shared; icorner++) {
+        has_shared = current->leaf_corners[ts->t8_element_get_face_corner (current->element, iface, icorner)] != 0;
+      }
+      if (!has_shared) {
+        continue;
+      }
+      /* Compute the class of the neighbor tree */
+      neigh_class = current->eclass;
+      if (ts->t8_element_is_root_boundary (current->element, iface)) {
+        lcneigh_treeid = t8_cmesh_get_face_neighbor (cmesh, current->lctreeid,
+                                                     ts->t8_element_tree_face (current->element, iface), NULL, NULL);
+        if (lcneigh_treeid < 0) {
+          continue;
+        }
+        neigh_class = t8_cmesh_treeid_is_ghost (cmesh, lcneigh_treeid)
+                        ? t8_cmesh_get_ghost_class (cmesh, t8_cmesh_ltreeid_to_ghostid (cmesh, lcneigh_treeid))
+                        : t8_cmesh_get_tree_class (cmesh, lcneigh_treeid);
+      }
+      neigh_ts = t8_forest_get_eclass_scheme (forest, neigh_class);
+      neigh_ts->t8_element_new (1, &neigh);
+      gneigh_treeid = t8_forest_element_face_neighbor_cmesh (forest, current->lctreeid, current->element, neigh,
+                                                             neigh_ts, iface, &neigh_face);
+      lcneigh_treeid = gneigh_treeid >= 0 ? t8_cmesh_get_local_id (cmesh, gneigh_treeid) : -1;
+      if (lcneigh_treeid < 0) {
+        /* There is no neighbor */
+        neigh_ts->t8_element_destroy (1, &neigh);
+        continue;
+      }
+      t8_forest_element_face_corner_map (forest, current, ts, iface, neigh_class, neigh_ts, neigh, neigh_face,
+                                         &face_vertices, neigh_corners);
+
+      /* Look up the neighbor or add it with no shared vertices */
+      auto found = known.find (std::make_pair (gneigh_treeid, neigh_ts->t8_element_get_linear_id (neigh, level)));
+      if (found != known.end ()) {
+        ineigh = found->second;
+        neigh_ts->t8_element_destroy (1, &neigh);
+      }
+      else {
+        ineigh = neighbors->elem_count;
+        candidate = (t8_forest_vertex_neighbor_t *) sc_array_push (neighbors);
+        candidate->lctreeid = lcneigh_treeid;
+        candidate->gtreeid = gneigh_treeid;
+        candidate->eclass = neigh_class;
+        candidate->element = neigh;
+        candidate->num_shared = 0;
+        memset (candidate->leaf_corners, 0, sizeof (candidate->leaf_corners));
+        known[std::make_pair (gneigh_treeid, neigh_ts->t8_element_get_linear_id (neigh, level))] = ineigh;
+      }
+      current = (t8_forest_vertex_neighbor_t *) sc_array_index (neighbors, icurrent);
+      candidate = (t8_forest_vertex_neighbor_t *) sc_array_index (neighbors, ineigh);
+
+      /* Pass the leaf vertices on to the corners of the neighbor */
+      grown = 0;
+      for (icorner = 0; icorner < num_face_corners; icorner++) {
+        const int corner = ts->t8_element_get_face_corner (current->element, iface, icorner);
+        const int neigh_corner = neigh_corners[corner];
+        if ((candidate->leaf_corners[neigh_corner] | current->leaf_corners[corner])
+            != candidate->leaf_corners[neigh_corner]) {
+          candidate->leaf_corners[neigh_corner] |= current->leaf_corners[corner];
+          grown = 1;
+        }
+      }
+      if (grown) {
+        candidate->num_shared
+          = t8_forest_vertex_neighbor_num_shared (candidate, neigh_ts->t8_element_num_corners (candidate->element));
+        if (candidate->num_shared >= min_touch) {
+          /* Process the neighbor (again) with its new shared vertices */
+          queue.push_back (ineigh);
+        }
+      }
     }
-    /* We now transform the face element to the other tree. */
-    sign = t8_eclass_face_orientation[eclass][tree_face] == t8_eclass_face_orientation[neigh_eclass][tree_neigh_face];
-    boundary_scheme->t8_element_transform_face (face_element, face_element, ttf[tree_face] / F, sign, is_smaller);
-    /* And now we extrude the face to the new neighbor element */
-    neighbor_scheme = forest->scheme_cxx->eclass_schemes[neigh_eclass];
-    *neigh_face = neighbor_scheme->t8_element_extrude_face (face_element, boundary_scheme, neigh, tree_neigh_face);
-    /* Free the face_element */
-    boundary_scheme->t8_element_destroy (1, &face_element);
+  }
+  sc_array_reset (&face_vertices);
 
-    return global_neigh_id;
+  /* Keep the leaf and the neighbors that touch it as required */
+  for (icurrent = first_entry + 1, inew = first_entry + 1; icurrent < neighbors->elem_count; icurrent++) {
+    candidate = (t8_forest_vertex_neighbor_t *) sc_array_index (neighbors, icurrent);
+    if (candidate->num_shared < min_touch) {
+      t8_forest_get_eclass_scheme (forest, candidate->eclass)->t8_element_destroy (1, &candidate->element);
+      continue;
+    }
+    if (inew != icurrent) {
+      memcpy (sc_array_index (neighbors, inew), candidate, sizeof (t8_forest_vertex_neighbor_t));
+    }
+    inew++;
   }
+  sc_array_resize (neighbors, inew);
 }
 
 t8_gloidx_t
@@ -1692,6 +2135,206 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
   return neighbor_tree;
 }
 
+int
+t8_forest_leaf_face_orientation (t8_forest_t forest, t8_locidx_t ltreeid, t8_eclass_scheme_c *ts,
+                                 const t8_element_t *elem, int face)
+{
+  int orientation = 0;
+  int tree_face;
+  t8_locidx_t cmesh_ltreeid;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (ts->t8_element_is_root_boundary (elem, face)) {
+    tree_face = ts->t8_element_tree_face (elem, face);
+    cmesh_ltreeid = t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid);
+    /* If there is no neighbor tree, the orientation remains 0 */
+    t8_cmesh_get_face_neighbor (t8_forest_get_cmesh (forest), cmesh_ltreeid, tree_face, NULL, &orientation);
+  }
+  return orientation;
+}
+
+/* A leaf that was found by t8_forest_leaf_face_neighbors_in_array */
+typedef struct
+{
+  const t8_element_t *leaf; /* The leaf */
+  t8_locidx_t index;        /* The local or ghost index of the leaf */
+  int face;                 /* The face of the leaf at the connection */
+} t8_forest_face_leaf_t;
+
+/* Callback for t8_forest_iterate_faces that collects all leaves at the face.
+ * The found leaves are appended to the sc_array of t8_forest_face_leaf_t in user_data,
+ * their index is the index in the tree's leaf array. */
+static int
+t8_forest_leaf_face_neighbors_collect (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *element, int face,
+                                       void *user_data, t8_locidx_t tree_leaf_index)
+{
+  t8_forest_face_leaf_t *found;
+
+  if (tree_leaf_index >= 0) {
+    found = (t8_forest_face_leaf_t *) sc_array_push ((sc_array_t *) user_data);
+    found->leaf = element;
+    found->index = tree_leaf_index;
+    found->face = face;
+  }
+  return 1;
+}
+
+/* Search a leaf array of a local or ghost tree for the leaves that overlap a face neighbor
+ * of the same level as the original leaf and touch its face \a dual_face.
+ * These are either one leaf that is an ancestor of (or equal to) \a neighbor or
+ * descendants of \a neighbor. The descendants occupy the SFC index range [first_id, last_id]
+ * and are found with two binary searches.
+ * \a ltreeid is a local tree id or num_local_trees + a ghost tree id, \a index_offset is added to
+ * the indices of the found leaves.
+ * The found leaves are appended to \a found. Returns true if the leaf is an ancestor of \a neighbor. */
+static int
+t8_forest_leaf_face_neighbors_in_array (t8_forest_t forest, t8_locidx_t ltreeid, t8_element_array_t *leaf_array,
+                                        const t8_element_t *neighbor, int dual_face, t8_linearidx_t first_id,
+                                        t8_linearidx_t last_id, t8_locidx_t index_offset, sc_array_t *found)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t *nca;
+  const t8_element_t *candidate;
+  t8_forest_face_leaf_t *found_leaf;
+  t8_element_array_t descendants;
+  t8_locidx_t index_lower, index_upper, start;
+  size_t ifound, first_found;
+  int is_ancestor, face, is_local_tree;
+
+  if (t8_element_array_get_count (leaf_array) == 0) {
+    return 0;
+  }
+  ts = t8_element_array_get_scheme (leaf_array);
+  is_local_tree = ltreeid < t8_forest_get_num_local_trees (forest);
+  index_lower = is_local_tree ? t8_forest_tree_bin_search_lower (forest, ltreeid, first_id)
+                              : t8_forest_bin_search_lower (leaf_array, first_id, forest->maxlevel);
+  start = index_lower + 1;
+  if (index_lower >= 0) {
+    /* Check whether the leaf before the face neighbor contains the face neighbor */
+    candidate = t8_element_array_index_locidx (leaf_array, index_lower);
+    ts->t8_element_new (1, &nca);
+    ts->t8_element_nca (candidate, neighbor, nca);
+    is_ancestor = ts->t8_element_equal (nca, candidate);
+    if (is_ancestor) {
+      /* The leaf is the face neighbor or a coarser element. Compute its face at the connection
+       * by going up from the face neighbor to the leaf. */
+      face = dual_face;
+      ts->t8_element_copy (neighbor, nca);
+      while (ts->t8_element_level (nca) > ts->t8_element_level (candidate)) {
+        face = ts->t8_element_face_parent_face (nca, face);
+        T8_ASSERT (face >= 0);
+        ts->t8_element_parent (nca, nca);
+      }
+      found_leaf = (t8_forest_face_leaf_t *) sc_array_push (found);
+      found_leaf->leaf = candidate;
+      found_leaf->index = index_lower + index_offset;
+      found_leaf->face = face;
+    }
+    ts->t8_element_destroy (1, &nca);
+    if (is_ancestor) {
+      return 1;
+    }
+    if (ts->t8_element_get_linear_id (candidate, forest->maxlevel) == first_id) {
+      /* The leaf is the first descendant of the face neighbor */
+      start = index_lower;
+    }
+  }
+  /* Find the leaves that are descendants of the face neighbor */
+  index_upper = is_local_tree ? t8_forest_tree_bin_search_lower (forest, ltreeid, last_id)
+                              : t8_forest_bin_search_lower (leaf_array, last_id, forest->maxlevel);
+  if (start <= index_upper) {
+    /* Collect the descendants at the face with a top-down iteration */
+    first_found = found->elem_count;
+    t8_element_array_init_view (&descendants, leaf_array, start, index_upper - start + 1);
+    t8_forest_iterate_faces (forest, ltreeid, neighbor, dual_face, &descendants, found, start,
+                             t8_forest_leaf_face_neighbors_collect);
+    for (ifound = first_found; ifound < found->elem_count; ifound++) {
+      ((t8_forest_face_leaf_t *) sc_array_index (found, ifound))->index += index_offset;
+    }
+  }
+  return 0;
+}
+
+/* Compute the leaf face neighbors of a leaf in a possibly unbalanced forest.
+ * We compute the same level face neighbor and search the leaf arrays of the local and the
+ * ghost neighbor tree for the leaves that overlap it. */
+static void
+t8_forest_leaf_face_neighbors_unbalanced (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *leaf,
+                                          t8_element_t **pneighbor_leaves[], int face, int *dual_faces[],
+                                          int *num_neighbors, t8_locidx_t **pelement_indices,
+                                          t8_eclass_scheme_c **pneigh_scheme, t8_gloidx_t *gneigh_tree)
+{
+  t8_eclass_t neigh_class;
+  t8_eclass_scheme_c *neigh_scheme;
+  t8_element_t *neighbor, *last_desc;
+  t8_gloidx_t gneigh_treeid;
+  t8_locidx_t lneigh_treeid, lghost_treeid;
+  t8_linearidx_t first_id, last_id;
+  t8_forest_face_leaf_t *found_leaf;
+  sc_array_t found;
+  int dual_face, is_ancestor, ineigh;
+
+  neigh_class = t8_forest_element_neighbor_eclass (forest, ltreeid, leaf, face);
+  neigh_scheme = *pneigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+  /* Compute the face neighbor of the same level as leaf */
+  neigh_scheme->t8_element_new (1, &neighbor);
+  gneigh_treeid = t8_forest_element_face_neighbor (forest, ltreeid, leaf, neighbor, neigh_scheme, face, &dual_face);
+  if (gneigh_tree) {
+    *gneigh_tree = gneigh_treeid;
+  }
+  *num_neighbors = 0;
+  *pneighbor_leaves = NULL;
+  *dual_faces = NULL;
+  *pelement_indices = NULL;
+  if (gneigh_treeid < 0) {
+    /* There exists no face neighbor across this face */
+    neigh_scheme->t8_element_destroy (1, &neighbor);
+    return;
+  }
+  /* Compute the SFC index range of the face neighbor */
+  first_id = neigh_scheme->t8_element_get_linear_id (neighbor, forest->maxlevel);
+  neigh_scheme->t8_element_new (1, &last_desc);
+  neigh_scheme->t8_element_last_descendant (neighbor, last_desc, forest->maxlevel);
+  last_id = neigh_scheme->t8_element_get_linear_id (last_desc, forest->maxlevel);
+  neigh_scheme->t8_element_destroy (1, &last_desc);
+
+  sc_array_init (&found, sizeof (t8_forest_face_leaf_t));
+  is_ancestor = 0;
+  lneigh_treeid = t8_forest_get_local_id (forest, gneigh_treeid);
+  if (lneigh_treeid >= 0) {
+    is_ancestor = t8_forest_leaf_face_neighbors_in_array (
+      forest, lneigh_treeid, t8_forest_get_tree_element_array (forest, lneigh_treeid), neighbor, dual_face, first_id,
+      last_id, t8_forest_get_tree_element_offset (forest, lneigh_treeid), &found);
+  }
+  if (!is_ancestor && forest->ghosts != NULL) {
+    lghost_treeid = t8_forest_ghost_get_ghost_treeid (forest, gneigh_treeid);
+    if (lghost_treeid >= 0) {
+      t8_forest_leaf_face_neighbors_in_array (
+        forest, t8_forest_get_num_local_trees (forest) + lghost_treeid,
+        t8_forest_ghost_get_tree_elements (forest, lghost_treeid), neighbor, dual_face, first_id, last_id,
+        t8_forest_get_local_num_elements (forest) + t8_forest_ghost_get_tree_element_offset (forest, lghost_treeid),
+        &found);
+    }
+  }
+  neigh_scheme->t8_element_destroy (1, &neighbor);
+
+  /* Copy the found leaves to the output arrays */
+  *num_neighbors = found.elem_count;
+  if (*num_neighbors > 0) {
+    *pneighbor_leaves = T8_ALLOC (t8_element_t *, *num_neighbors);
+    *dual_faces = T8_ALLOC (int, *num_neighbors);
+    *pelement_indices = T8_ALLOC (t8_locidx_t, *num_neighbors);
+    neigh_scheme->t8_element_new (*num_neighbors, *pneighbor_leaves);
+    for (ineigh = 0; ineigh < *num_neighbors; ineigh++) {
+      found_leaf = (t8_forest_face_leaf_t *) sc_array_index_int (&found, ineigh);
+      neigh_scheme->t8_element_copy (found_leaf->leaf, (*pneighbor_leaves)[ineigh]);
+      (*dual_faces)[ineigh] = found_leaf->face;
+      (*pelement_indices)[ineigh] = found_leaf->index;
+    }
+  }
+  sc_array_reset (&found);
+}
+
 void
 t8_forest_leaf_face_neighbors_ext (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *leaf,
                                    t8_element_t **pneighbor_leaves[], int face, int *dual_faces[], int *num_neighbors,
@@ -1712,8 +2355,6 @@ t8_forest_leaf_face_neighbors_ext (t8_forest_t forest, t8_locidx_t ltreeid, cons
   /* TODO: implement is_leaf check to apply to leaf */
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (!forest_is_balanced || t8_forest_is_balanced (forest));
-  SC_CHECK_ABORT (forest_is_balanced, "leaf face neighbors is not implemented "
-                                      "for unbalanced forests.\n"); /* TODO: write version for unbalanced forests */
   SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL,
                   "Ghost structure is needed for t8_forest_leaf_face_neighbors "
                   "but was not found in forest.\n");
@@ -1820,10 +2461,9 @@ t8_forest_leaf_face_neighbors_ext (t8_forest_t forest, t8_locidx_t ltreeid, cons
       }
       else {
         /* the elements are local elements */
-        element_array = t8_forest_get_tree_element_array (forest, lneigh_treeid);
-        /* Find the index in element_array of the leaf ancestor of the first neighbor.
+        /* Find the index in the tree of the leaf ancestor of the first neighbor.
          * This is either the neighbor itself or its parent, or its grandparent */
-        element_index = t8_forest_bin_search_lower (element_array, neigh_id, forest->maxlevel);
+        element_index = t8_forest_tree_bin_search_lower (forest, lneigh_treeid, neigh_id);
         /* Get the element */
         ancestor = t8_forest_get_tree_element (t8_forest_get_tree (forest, lneigh_treeid), element_index);
         /* Add the element offset of this tree to the index */
@@ -1883,9 +2523,8 @@ t8_forest_leaf_face_neighbors_ext (t8_forest_t forest, t8_locidx_t ltreeid, cons
        * This is either the local leaf array of the local tree or the corresponding leaf array in the ghost structure */
       if (owners[ineigh] == forest->mpirank) {
         /* The neighbor is a local leaf */
-        element_array = t8_forest_get_tree_element_array (forest, lneigh_treeid);
-        /* Find the index of the neighbor in the array */
-        element_indices[ineigh] = t8_forest_bin_search_lower (element_array, neigh_id, forest->maxlevel);
+        /* Find the index of the neighbor in the tree */
+        element_indices[ineigh] = t8_forest_tree_bin_search_lower (forest, lneigh_treeid, neigh_id);
         T8_ASSERT (element_indices[ineigh] >= 0);
         /* We have to add the tree's element offset to the index found to get the actual local element id */
         element_indices[ineigh] += t8_forest_get_tree_element_offset (forest, lneigh_treeid);
@@ -1922,8 +2561,10 @@ t8_forest_leaf_face_neighbors_ext (t8_forest_t forest, t8_locidx_t ltreeid, cons
     T8_FREE (owners);
   }
   else {
-    /* TODO: implement unbalanced version */
-    SC_ABORT_NOT_REACHED ();
+    /* In an unbalanced forest, the neighbor leaves can have any level. We search them
+     * in the SFC index range of the same level face neighbor. */
+    t8_forest_leaf_face_neighbors_unbalanced (forest, ltreeid, leaf, pneighbor_leaves, face, dual_faces, num_neighbors,
+                                              pelement_indices, pneigh_scheme, gneigh_tree);
   }
 }
 
@@ -2272,6 +2913,100 @@ t8_forest_element_find_owner (t8_forest_t forest, t8_gloidx_t gtreeid, t8_elemen
                                            (forest->mpisize - 1) / 2, 0);
 }
 
+/* An element of a batched owner search, identified by its tree and the linear id
+ * of its first descendant at the maximum level. */
+typedef struct
+{
+  t8_gloidx_t gtreeid;
+  t8_linearidx_t desc_id;
+  size_t index;
+} t8_forest_owner_key_t;
+
+static int
+t8_forest_owner_key_compare (const void *a, const void *b)
+{
+  const t8_forest_owner_key_t *ka = (const t8_forest_owner_key_t *) a;
+  const t8_forest_owner_key_t *kb = (const t8_forest_owner_key_t *) b;
+
+  if (ka->gtreeid != kb->gtreeid) {
+    return ka->gtreeid < kb->gtreeid ? -1 : 1;
+  }
+  if (ka->desc_id != kb->desc_id) {
+    return ka->desc_id < kb->desc_id ? -1 : 1;
+  }
+  return ka->index < kb->index ? -1 : ka->index > kb->index;
+}
+
+void
+t8_forest_element_find_owners (t8_forest_t forest, size_t num_elements, const t8_gloidx_t *gtreeids,
+                               const t8_element_t *const *elements, const t8_eclass_t *eclasses, int *owners)
+{
+  t8_forest_owner_key_t *keys;
+  t8_element_t *first_desc[T8_ECLASS_COUNT] = { NULL };
+  t8_eclass_scheme_c *ts;
+  t8_gloidx_t next_first_tree;
+  size_t ielement;
+  int eclass, owner, next_owner;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (num_elements == 0) {
+    return;
+  }
+  if (forest->mpisize == 1) {
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      owners[ielement] = 0;
+    }
+    return;
+  }
+  T8_ASSERT (forest->tree_offsets != NULL);
+  T8_ASSERT (forest->global_first_desc != NULL);
+
+  /* Compute the maxlevel linear ids of the first descendants of all elements and sort them */
+  keys = T8_ALLOC (t8_forest_owner_key_t, num_elements);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    T8_ASSERT (0 <= gtreeids[ielement] && gtreeids[ielement] < t8_forest_get_num_global_trees (forest));
+    ts = t8_forest_get_eclass_scheme (forest, eclasses[ielement]);
+    if (first_desc[eclasses[ielement]] == NULL) {
+      ts->t8_element_new (1, first_desc + eclasses[ielement]);
+    }
+    ts->t8_element_first_descendant (elements[ielement], first_desc[eclasses[ielement]], forest->maxlevel);
+    keys[ielement].gtreeid = gtreeids[ielement];
+    keys[ielement].desc_id = ts->t8_element_get_linear_id (first_desc[eclasses[ielement]], forest->maxlevel);
+    keys[ielement].index = ielement;
+  }
+  qsort (keys, num_elements, sizeof (t8_forest_owner_key_t), t8_forest_owner_key_compare);
+
+  /* The owner of an element is the last nonempty process whose first tree and first descendant
+   * are not greater than the element's tree and first descendant. Since the elements are sorted,
+   * we find all owners in one sweep over the processes. */
+  const t8_gloidx_t *first_trees = t8_shmem_array_get_gloidx_array (forest->tree_offsets);
+  const t8_linearidx_t *first_descs = (const t8_linearidx_t *) t8_shmem_array_get_array (forest->global_first_desc);
+  const t8_gloidx_t *element_offsets = t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  owner = t8_offset_next_nonempty_rank (-1, forest->mpisize, element_offsets);
+  next_owner = t8_offset_next_nonempty_rank (owner, forest->mpisize, element_offsets);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    while (next_owner < forest->mpisize) {
+      next_first_tree = t8_offset_first (next_owner, first_trees);
+      if (next_first_tree > keys[ielement].gtreeid
+          || (next_first_tree == keys[ielement].gtreeid && first_descs[next_owner] > keys[ielement].desc_id)) {
+        break;
+      }
+      owner = next_owner;
+      next_owner = t8_offset_next_nonempty_rank (owner, forest->mpisize, element_offsets);
+    }
+    T8_ASSERT (t8_forest_element_check_owner (forest, (t8_element_t *) elements[keys[ielement].index],
+                                              keys[ielement].gtreeid, eclasses[keys[ielement].index], owner, 0));
+    owners[keys[ielement].index] = owner;
+  }
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    if (first_desc[eclass] != NULL) {
+      t8_forest_get_eclass_scheme (forest, (t8_eclass_t) eclass)->t8_element_destroy (1, first_desc + eclass);
+    }
+  }
+  T8_FREE (keys);
+}
+
 /* This is a deprecated version of the element_find_owner algorithm which
  * searches for the owners of the coarse tree first */
 int
@@ -2653,20 +3388,27 @@ t8_forest_element_has_leaf_desc (t8_forest_t forest, t8_gloidx_t gtreeid, const
    * then the number returned is negative */
   ltreeid = t8_forest_get_local_id (forest, gtreeid);
   if (ltreeid >= 0) {
-    /* The tree is a local tree */
-    /* Get the elements */
-    elements = t8_forest_get_tree_element_array (forest, ltreeid);
+    /* The tree is a local tree, we search its linear ids and levels */
+    const int8_t *levels;
+    const t8_linearidx_t *linear_ids = t8_forest_tree_get_linear_ids (forest, ltreeid, &levels);
 
-    index = t8_forest_bin_search_lower (elements, last_desc_id, forest->maxlevel);
+    index = t8_forest_tree_bin_search_lower (forest, ltreeid, last_desc_id);
     if (index >= 0) {
       /* There exists an element in the array with id <= last_desc_id,
        * If also elem_id < id, then we found a true decsendant of element */
-      elem_found = t8_element_array_index_locidx (elements, index);
-      elem_id = ts->t8_element_get_linear_id (elem_found, forest->maxlevel);
-      level_found = ts->t8_element_level (elem_found);
+      if (linear_ids != NULL) {
+        elem_id = linear_ids[index];
+        level_found = levels[index];
+      }
+      else {
+        elem_found = t8_forest_get_tree_element (t8_forest_get_tree (forest, ltreeid), index);
+        elem_id = ts->t8_element_get_linear_id (elem_found, forest->maxlevel);
+        level_found = ts->t8_element_level (elem_found);
+      }
       if (ts->t8_element_get_linear_id (element, forest->maxlevel) <= elem_id && level < level_found) {
         /* The element is a true descendant */
-        T8_ASSERT (ts->t8_element_level (elem_found) > ts->t8_element_level (element));
+        T8_ASSERT (ts->t8_element_level (t8_forest_get_tree_element (t8_forest_get_tree (forest, ltreeid), index))
+                   > ts->t8_element_level (element));
         /* clean-up */
         ts->t8_element_destroy (1, &last_desc);
         return 1;
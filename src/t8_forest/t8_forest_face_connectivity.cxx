@@ -0,0 +1,182 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest/t8_forest_face_connectivity.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_element_cxx.hxx>
+
+T8_EXTERN_C_BEGIN ();
+
+void
+t8_forest_build_face_connectivity (t8_forest_t forest, int forest_is_balanced)
+{
+  t8_forest_face_connectivity_t *conn;
+  t8_locidx_t num_local_trees, itree, ielem, num_tree_elements;
+  t8_locidx_t element_index, num_face_slots, slot;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t **neighbor_leaves;
+  const t8_element_t *leaf;
+  t8_locidx_t *element_indices;
+  int *dual_faces;
+  int num_faces, iface, num_neighbors;
+  int leaf_level, neigh_level;
+  sc_array_t neighbor_ids, neighbor_dual_faces;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->face_connectivity != NULL) {
+    /* The table was already built */
+    return;
+  }
+  SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL,
+                  "Ghost structure is needed for t8_forest_build_face_connectivity "
+                  "but was not found in forest.\n");
+
+  conn = T8_ALLOC_ZERO (t8_forest_face_connectivity_t, 1);
+  conn->num_elements = t8_forest_get_local_num_elements (forest);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+
+  /* Count the face slots of all leaves */
+  conn->element_offsets = T8_ALLOC (t8_locidx_t, conn->num_elements + 1);
+  conn->element_offsets[0] = 0;
+  for (itree = 0, element_index = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++, element_index++) {
+      leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      conn->element_offsets[element_index + 1] = conn->element_offsets[element_index] + ts->t8_element_num_faces (leaf);
+    }
+  }
+  num_face_slots = conn->element_offsets[conn->num_elements];
+  conn->face_offsets = T8_ALLOC (t8_locidx_t, num_face_slots + 1);
+  conn->orientations = T8_ALLOC (int8_t, num_face_slots);
+  conn->hanging = T8_ALLOC (int8_t, num_face_slots);
+  conn->face_offsets[0] = 0;
+
+  /* Compute the neighbors of all faces. Since we do not know the number of neighbors
+   * in advance, we collect them in growing arrays. */
+  sc_array_init (&neighbor_ids, sizeof (t8_locidx_t));
+  sc_array_init (&neighbor_dual_faces, sizeof (int));
+  for (itree = 0, slot = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++) {
+      leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      leaf_level = ts->t8_element_level (leaf);
+      num_faces = ts->t8_element_num_faces (leaf);
+      for (iface = 0; iface < num_faces; iface++, slot++) {
+        t8_forest_leaf_face_neighbors (forest, itree, leaf, &neighbor_leaves, iface, &dual_faces, &num_neighbors,
+                                       &element_indices, &neigh_scheme, forest_is_balanced);
+        conn->face_offsets[slot + 1] = conn->face_offsets[slot] + num_neighbors;
+        conn->orientations[slot] = t8_forest_leaf_face_orientation (forest, itree, ts, leaf, iface);
+        conn->hanging[slot] = T8_FACE_CONNECTIVITY_CONFORMING;
+        if (num_neighbors > 0) {
+          memcpy (sc_array_push_count (&neighbor_ids, num_neighbors), element_indices,
+                  num_neighbors * sizeof (t8_locidx_t));
+          memcpy (sc_array_push_count (&neighbor_dual_faces, num_neighbors), dual_faces, num_neighbors * sizeof (int));
+          /* The neighbors are either all coarser, all of the same level, or all finer */
+          neigh_level = neigh_scheme->t8_element_level (neighbor_leaves[0]);
+          if (neigh_level < leaf_level) {
+            conn->hanging[slot] = T8_FACE_CONNECTIVITY_COARSER;
+          }
+          else if (neigh_level > leaf_level) {
+            conn->hanging[slot] = T8_FACE_CONNECTIVITY_FINER;
+          }
+          neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leaves);
+          T8_FREE (neighbor_leaves);
+          T8_FREE (element_indices);
+          T8_FREE (dual_faces);
+        }
+      }
+    }
+  }
+  T8_ASSERT (slot == num_face_slots);
+  T8_ASSERT ((size_t) conn->face_offsets[num_face_slots] == neighbor_ids.elem_count);
+
+  /* Copy the neighbors to arrays of exact size */
+  conn->neighbor_ids = T8_ALLOC (t8_locidx_t, neighbor_ids.elem_count);
+  conn->dual_faces = T8_ALLOC (int, neighbor_dual_faces.elem_count);
+  if (neighbor_ids.elem_count > 0) {
+    memcpy (conn->neighbor_ids, neighbor_ids.array, neighbor_ids.elem_count * sizeof (t8_locidx_t));
+    memcpy (conn->dual_faces, neighbor_dual_faces.array, neighbor_dual_faces.elem_count * sizeof (int));
+  }
+  sc_array_reset (&neighbor_ids);
+  sc_array_reset (&neighbor_dual_faces);
+
+  forest->face_connectivity = conn;
+}
+
+int
+t8_forest_has_face_connectivity (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  return forest->face_connectivity != NULL;
+}
+
+void
+t8_forest_face_connectivity_get (const t8_forest_t forest, t8_locidx_t lelement_id, int face, int *num_neighbors,
+                                 const t8_locidx_t **neighbor_ids, const int **dual_faces, int *orientation,
+                                 int *hanging)
+{
+  const t8_forest_face_connectivity_t *conn;
+  t8_locidx_t slot;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->face_connectivity != NULL);
+  conn = forest->face_connectivity;
+  T8_ASSERT (0 <= lelement_id && lelement_id < conn->num_elements);
+  T8_ASSERT (0 <= face && face < conn->element_offsets[lelement_id + 1] - conn->element_offsets[lelement_id]);
+
+  slot = conn->element_offsets[lelement_id] + face;
+  *num_neighbors = conn->face_offsets[slot + 1] - conn->face_offsets[slot];
+  *neighbor_ids = conn->neighbor_ids + conn->face_offsets[slot];
+  *dual_faces = conn->dual_faces + conn->face_offsets[slot];
+  if (orientation != NULL) {
+    *orientation = conn->orientations[slot];
+  }
+  if (hanging != NULL) {
+    *hanging = conn->hanging[slot];
+  }
+}
+
+void
+t8_forest_face_connectivity_reset (t8_forest_t forest)
+{
+  t8_forest_face_connectivity_t *conn;
+
+  T8_ASSERT (forest != NULL);
+  conn = forest->face_connectivity;
+  if (conn == NULL) {
+    return;
+  }
+  T8_FREE (conn->element_offsets);
+  T8_FREE (conn->face_offsets);
+  T8_FREE (conn->neighbor_ids);
+  T8_FREE (conn->dual_faces);
+  T8_FREE (conn->orientations);
+  T8_FREE (conn->hanging);
+  T8_FREE (conn);
+  forest->face_connectivity = NULL;
+}
+
+T8_EXTERN_C_END ();
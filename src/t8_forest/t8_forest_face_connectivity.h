@@ -0,0 +1,94 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_face_connectivity.h
+ * Precomputed leaf face neighbor table of a committed forest.
+ * The face neighbors of all local leaves are computed once with \ref t8_forest_leaf_face_neighbors
+ * and stored in flat arrays in compressed sparse row format. Afterwards, the neighbors of
+ * a leaf face can be queried in constant time without allocating memory.
+ */
+
+#ifndef T8_FOREST_FACE_CONNECTIVITY_H
+#define T8_FOREST_FACE_CONNECTIVITY_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_general.h>
+
+/** The face of a leaf is conforming, the neighbor leaf has the same level. */
+#define T8_FACE_CONNECTIVITY_CONFORMING 0
+/** The face of a leaf is hanging, the neighbor leaf is coarser. */
+#define T8_FACE_CONNECTIVITY_COARSER 1
+/** The face of a leaf is split, the neighbor leaves are finer. */
+#define T8_FACE_CONNECTIVITY_FINER 2
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the face neighbors of all local leaves of a forest and store them in the forest.
+ * If the table was already built, this function does nothing.
+ * The table is valid as long as the forest exists and is freed together with the forest.
+ * If the ghost layer of the forest is replaced, for example by \ref t8_forest_ghost_create,
+ * the table is rebuilt for the new ghost indices.
+ * \param [in,out] forest   A committed forest. If the forest is distributed, it must have a ghost layer.
+ * \param [in] forest_is_balanced  True if \a forest is known to be balanced.
+ *                          See \ref t8_forest_leaf_face_neighbors.
+ * \note The neighbor indices follow the convention of \ref t8_forest_leaf_face_neighbors,
+ *       local leaves have indices 0 to num_local_elements - 1 and ghosts have indices
+ *       num_local_elements + ghost index.
+ */
+void
+t8_forest_build_face_connectivity (t8_forest_t forest, int forest_is_balanced);
+
+/** Query whether the face connectivity table of a forest was built.
+ * \param [in] forest   A committed forest.
+ * \return              True if \ref t8_forest_build_face_connectivity was called for \a forest.
+ */
+int
+t8_forest_has_face_connectivity (const t8_forest_t forest);
+
+/** Return the face neighbors of a local leaf from the face connectivity table.
+ * \param [in] forest         A committed forest with a face connectivity table.
+ * \param [in] lelement_id    The local index of a leaf.
+ * \param [in] face           A face of the leaf.
+ * \param [out] num_neighbors On output the number of face neighbor leaves, 0 at a domain boundary.
+ * \param [out] neighbor_ids  On output a pointer to \a num_neighbors indices of the neighbor leaves.
+ *                            Must not be modified or freed.
+ * \param [out] dual_faces    On output a pointer to \a num_neighbors faces of the neighbor leaves
+ *                            that are connected to \a face. Must not be modified or freed.
+ * \param [out] orientation   If not NULL, on output the orientation of the connection of the two trees
+ *                            across \a face (see \ref t8_cmesh_get_face_neighbor), 0 within a tree.
+ * \param [out] hanging       If not NULL, on output \ref T8_FACE_CONNECTIVITY_CONFORMING,
+ *                            \ref T8_FACE_CONNECTIVITY_COARSER or \ref T8_FACE_CONNECTIVITY_FINER.
+ */
+void
+t8_forest_face_connectivity_get (const t8_forest_t forest, t8_locidx_t lelement_id, int face, int *num_neighbors,
+                                 const t8_locidx_t **neighbor_ids, const int **dual_faces, int *orientation,
+                                 int *hanging);
+
+/** Free the face connectivity table of a forest, if it exists.
+ * \param [in,out] forest   A committed forest.
+ */
+void
+t8_forest_face_connectivity_reset (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_FACE_CONNECTIVITY_H */
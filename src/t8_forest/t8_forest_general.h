@@ -38,7 +38,7 @@ typedef struct t8_forest *t8_forest_t;
 typedef struct t8_tree *t8_tree_t;
 
 /** This type controls, which neighbors count as ghost elements.
- * Currently, we support face-neighbors. Vertex and edge neighbors will eventually be added. */
+ * In 2D, edges are faces and thus \ref T8_GHOST_EDGES is equivalent to \ref T8_GHOST_FACES. */
 typedef enum {
   T8_GHOST_NONE = 0, /**< Do not create ghost layer. */
   T8_GHOST_FACES,    /**< Consider all face (codimension 1) neighbors. */
@@ -299,6 +299,8 @@ t8_forest_get_user_function (const t8_forest_t forest);
 /** Set a source forest to be partitioned during commit.
  * The partitioning is done according to the SFC and each rank is assigned
  * the same (maybe +1) number of elements.
+ * If element costs were recorded on \a set_from (\see t8_forest_cost_add_range),
+ * each rank is instead assigned elements of the same (maybe +1 element) total cost.
  * \param [in, out] forest  The forest.
  * \param [in]      set_from A second forest that should be partitioned.
  *                          We take ownership. This can be prevented by
@@ -350,8 +352,13 @@ t8_forest_set_balance (t8_forest_t forest, const t8_forest_t set_from, int no_re
  * \param [in]      forest    The forest.
  * \param [in]      do_ghost  If non-zero a ghost layer will be created.
  * \param [in]      ghost_type Controls which neighbors count as ghost elements,
- *                             currently only T8_GHOST_FACES is supported. This value
+ *                             see \ref t8_ghost_type_t. This value
  *                             is ignored if \a do_ghost = 0.
+ * \note For \ref T8_GHOST_EDGES and \ref T8_GHOST_VERTICES the edge and vertex neighbors
+ *       are found topologically, by walking from face neighbor to face neighbor across the
+ *       elements and, between trees, through the face connections of the cmesh. Thus neighbors
+ *       across periodic boundaries are found as well. For a partitioned cmesh, neighbors in trees
+ *       that are not local trees of the cmesh are not found.
  */
 void
 t8_forest_set_ghost (t8_forest_t forest, int do_ghost, t8_ghost_type_t ghost_type);
@@ -367,8 +374,64 @@ t8_forest_set_ghost (t8_forest_t forest, int do_ghost, t8_ghost_type_t ghost_typ
 void
 t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost, t8_ghost_type_t ghost_type, int ghost_version);
 
-/* TODO: use assertions and document that the forest_set (..., from) and
- *       set_load are mutually exclusive. */
+/** Set the number of layers of the ghost layer.
+ * The first layer consists of the neighbors given by the ghost type, see \ref t8_forest_set_ghost.
+ * Each further layer consists of the face neighbors of the previous layer that are not
+ * in a previous layer. All layers are exchanged with one message per neighbor process.
+ * On default the ghost width is 1. This setting is ignored if no ghost layer is created.
+ * \param [in,out] forest      The forest.
+ * \param [in]     ghost_width The number of ghost layers, at least 1.
+ * \see t8_forest_get_ghost_width
+ */
+void
+t8_forest_set_ghost_width (t8_forest_t forest, int ghost_width);
+
+/** Derive the ghost layer of a forest from the ghost layer of the forest it is created from.
+ * If the forest is only adapted or copied from a forest with a face ghost layer,
+ * the remote elements are computed only for the leaves that changed and each process
+ * sends only the ghost trees that changed for the receiver.
+ * In all other cases, for example if the forest is also partitioned, or for ghost layers
+ * of width larger than one, the ghost layer is created from scratch.
+ * On default this setting is disabled.
+ * \param [in,out] forest      The forest.
+ * \param [in]     incremental If non-zero, derive the ghost layer if possible.
+ * \note The forest that \a forest is created from is kept until the ghost layer is created.
+ */
+void
+t8_forest_set_ghost_incremental (t8_forest_t forest, int incremental);
+
+/** Cache the linear ids and levels of the local elements when the forest is committed.
+ * The cache speeds up the binary searches in the local trees, for example in
+ * \ref t8_forest_leaf_face_neighbors and in the balance check, at the cost of
+ * 9 bytes of memory per local element. It is freed together with the elements of the forest.
+ * On default this setting is disabled.
+ * \param [in,out] forest      The forest.
+ * \param [in]     do_cache    If non-zero, the linear ids are cached.
+ */
+void
+t8_forest_set_linear_id_cache (t8_forest_t forest, int do_cache);
+
+/** Return the number of layers of the ghost layer of a forest.
+ * \param [in]     forest      The forest.
+ * \return         The ghost width set with \ref t8_forest_set_ghost_width.
+ */
+int
+t8_forest_get_ghost_width (const t8_forest_t forest);
+
+/** Load the leaves of a forest from a checkpoint file on committing.
+ * The file must have been written with \ref t8_forest_save.
+ * The forest gets the same leaves as the saved forest. If it is loaded on the same
+ * number of processes, it also gets the same partition. Otherwise, the leaves are
+ * distributed uniformly and each process reads only its own contiguous range of leaves.
+ * \param [in,out] forest     The forest.
+ * \param [in]     filename   The name of the checkpoint file.
+ * \note The coarse mesh and the scheme must be set with \ref t8_forest_set_cmesh and
+ *       \ref t8_forest_set_scheme and must be the same as those of the saved forest.
+ *       If the coarse mesh is partitioned and its partition does not match the loaded
+ *       forest, it is repartitioned on commit.
+ * \note This setting cannot be combined with setting a source forest, such as
+ *       \ref t8_forest_set_copy or \ref t8_forest_set_adapt.
+ */
 void
 t8_forest_set_load (t8_forest_t forest, const char *filename);
 
@@ -512,7 +575,10 @@ t8_forest_get_coarse_tree (t8_forest_t forest, t8_locidx_t ltreeid);
  *                        otherwise.
  * \note If there are no face neighbors, then *neighbor_leaves = NULL, num_neighbors = 0,
  * and *pelement_indices = NULL on output.
- * \note Currently \a forest must be balanced.
+ * \note If \a forest_is_balanced is false, the neighbor leaves may have any level. They are
+ * ordered by the SFC within the local leaves, followed by the ghost leaves in SFC order.
+ * In this case the ghost layer must be created with a ghost algorithm for unbalanced forests,
+ * which is the default of \ref t8_forest_set_ghost.
  * \note \a forest must be committed before calling this function.
  */
 void
@@ -26,10 +26,13 @@
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_iterate.h>
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_face_connectivity.h>
 #include <t8_cmesh/t8_cmesh_trees.h>
 #include <t8_element_cxx.hxx>
+#include <t8_vec.h>
 #include <t8_data/t8_containers.h>
 #include <sc_statistics.h>
+#include <sc_notify.h>
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -172,8 +175,7 @@ t8_forest_ghost_init (t8_forest_ghost_t *pghost, t8_ghost_type_t ghost_type)
 {
   t8_forest_ghost_t ghost;
 
-  /* We currently only support face-neighbor ghosts */
-  T8_ASSERT (ghost_type == T8_GHOST_FACES);
+  T8_ASSERT (ghost_type == T8_GHOST_FACES || ghost_type == T8_GHOST_EDGES || ghost_type == T8_GHOST_VERTICES);
 
   /* Allocate memory for ghost */
   ghost = *pghost = T8_ALLOC_ZERO (t8_forest_ghost_struct_t, 1);
@@ -821,15 +823,659 @@ t8_forest_ghost_fill_remote (t8_forest_t forest, t8_forest_ghost_t ghost, int gh
   }
 }
 
+/* Check whether a point lies in the convex hull of up to 8 points.
+ * All points have 3 coordinates. If the hull is not planar, we only find the points
+ * on its boundary, which suffices since the shared vertices are vertices of an element
+ * that touches the leaf at its boundary. */
+static int
+t8_ghost_point_in_convex_hull (const double *point, const double *hull, int num_hull)
+{
+  const double eps = 1e-12;
+  double edge_a[3], edge_b[3], to_point[3], normal[3], cross[3];
+  int ia, ib, ic, inside, iedge;
+
+  if (num_hull == 1) {
+    return t8_vec_dist (point, hull) < eps;
+  }
+  if (num_hull == 2) {
+    /* The point must be on the segment */
+    t8_vec_axpyz (hull, hull + 3, edge_a, -1);
+    t8_vec_axpyz (hull, point, to_point, -1);
+    t8_vec_cross (edge_a, to_point, cross);
+    return t8_vec_norm (cross) < eps && t8_vec_dot (edge_a, to_point) >= -eps
+           && t8_vec_dot (edge_a, to_point) <= t8_vec_dot (edge_a, edge_a) + eps;
+  }
+  /* The hull is a planar polygon. We check all triangles spanned by three of its points. */
+  for (ia = 0; ia < num_hull; ia++) {
+    for (ib = ia + 1; ib < num_hull; ib++) {
+      for (ic = ib + 1; ic < num_hull; ic++) {
+        const double *tri[3] = { hull + 3 * ia, hull + 3 * ib, hull + 3 * ic };
+        t8_vec_axpyz (tri[0], tri[1], edge_a, -1);
+        t8_vec_axpyz (tri[0], tri[2], edge_b, -1);
+        t8_vec_cross (edge_a, edge_b, normal);
+        if (t8_vec_norm (normal) < eps) {
+          /* The three points are collinear */
+          continue;
+        }
+        t8_vec_axpyz (tri[0], point, to_point, -1);
+        if (fabs (t8_vec_dot (normal, to_point)) > eps) {
+          /* The point is not in the plane of the triangle */
+          continue;
+        }
+        inside = 1;
+        for (iedge = 0; iedge < 3 && inside; iedge++) {
+          t8_vec_axpyz (tri[iedge], tri[(iedge + 1) % 3], edge_a, -1);
+          t8_vec_axpyz (tri[iedge], point, to_point, -1);
+          t8_vec_cross (edge_a, to_point, cross);
+          inside = t8_vec_dot (cross, normal) >= -eps;
+        }
+        if (inside) {
+          return 1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/* Add all owners of leaves that are descendants of (or ancestors of) element and that have at least
+ * min_touch vertices in the convex hull of the reference coordinates hull to owners.
+ * lower and upper are known bounds for the owners of element. */
+static void
+t8_ghost_owners_touching (t8_forest_t forest, t8_gloidx_t gtreeid, t8_eclass_t eclass, t8_eclass_scheme_c *ts,
+                          const t8_element_t *element, const double *hull, int num_hull, int min_touch, int lower,
+                          int upper, sc_array_t *owners)
+{
+  t8_element_t **children;
+  double vertex_coords[3];
+  int num_children, ichild, ivertex, num_touch;
+
+  t8_forest_element_owners_bounds (forest, gtreeid, element, eclass, &lower, &upper);
+  if (lower >= upper) {
+    /* The element is owned by a single process */
+    *(int *) sc_array_push (owners) = lower;
+    return;
+  }
+  /* Recurse into the children that touch the hull */
+  num_children = ts->t8_element_num_children (element);
+  children = T8_ALLOC (t8_element_t *, num_children);
+  ts->t8_element_new (num_children, children);
+  ts->t8_element_children (element, num_children, children);
+  for (ichild = 0; ichild < num_children; ichild++) {
+    num_touch = 0;
+    for (ivertex = 0; ivertex < ts->t8_element_num_corners (children[ichild]); ivertex++) {
+      ts->t8_element_vertex_reference_coords (children[ichild], ivertex, vertex_coords);
+      num_touch += t8_ghost_point_in_convex_hull (vertex_coords, hull, num_hull);
+    }
+    if (num_touch >= min_touch) {
+      t8_ghost_owners_touching (forest, gtreeid, eclass, ts, children[ichild], hull, num_hull, min_touch, lower, upper,
+                                owners);
+    }
+  }
+  ts->t8_element_destroy (num_children, children);
+  T8_FREE (children);
+}
+
+/* Fill the remote ghosts of a ghost structure for edge or vertex ghosts.
+ * For each leaf we compute the owners of all leaves at its faces with
+ * t8_forest_element_owners_at_neigh_face. Additionally, we compute the same level elements
+ * that share an edge (or a vertex) with the leaf and the owners of all leaves in them that
+ * touch the shared vertices.
+ * We only need the owners, thus we refine the neighbors only until their owner bounds
+ * give a unique owner.
+ * The shared vertices are determined topologically through the face connections of the cmesh,
+ * thus edge and vertex neighbors across periodic boundaries are found as well.
+ * \note If the cmesh is partitioned, only neighbors that are reachable through local trees
+ * of the cmesh are found.
+ */
+static void
+t8_forest_ghost_fill_remote_corners (t8_forest_t forest, t8_forest_ghost_t ghost)
+{
+  t8_locidx_t num_local_trees, itree, ielem, num_tree_elems;
+  t8_eclass_scheme_c *ts, *neigh_ts;
+  t8_forest_vertex_neighbor_t *neighbor;
+  const t8_element_t *elem;
+  sc_array_t owners, face_owners, neighbors;
+  double hull[3 * T8_ECLASS_MAX_CORNERS];
+  size_t iowner, ineigh;
+  int iface, num_faces, owner, last_owner, min_touch, icorner, num_hull;
+
+  T8_ASSERT (ghost->ghost_type == T8_GHOST_EDGES || ghost->ghost_type == T8_GHOST_VERTICES);
+  /* Edge neighbors share at least 2 vertices, vertex neighbors at least 1 */
+  min_touch = ghost->ghost_type == T8_GHOST_EDGES ? 2 : 1;
+  sc_array_init (&owners, sizeof (int));
+  sc_array_init (&face_owners, sizeof (int));
+  sc_array_init (&neighbors, sizeof (t8_forest_vertex_neighbor_t));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elems = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elems; ielem++) {
+      elem = t8_forest_get_element_in_tree (forest, itree, ielem);
+      /* The owners at the faces */
+      num_faces = ts->t8_element_num_faces (elem);
+      for (iface = 0; iface < num_faces; iface++) {
+        sc_array_truncate (&face_owners);
+        t8_forest_element_owners_at_neigh_face (forest, itree, elem, iface, &face_owners);
+        if (face_owners.elem_count > 0) {
+          memcpy (sc_array_push_count (&owners, face_owners.elem_count), face_owners.array,
+                  face_owners.elem_count * sizeof (int));
+        }
+      }
+      /* The owners at the edges or vertices */
+      t8_forest_element_vertex_neighbors (forest, itree, elem, min_touch, &neighbors);
+      for (ineigh = 0; ineigh < neighbors.elem_count; ineigh++) {
+        neighbor = (t8_forest_vertex_neighbor_t *) sc_array_index (&neighbors, ineigh);
+        neigh_ts = t8_forest_get_eclass_scheme (forest, neighbor->eclass);
+        if (ineigh > 0) {
+          /* The reference coordinates of the shared vertices in the tree of the neighbor */
+          num_hull = 0;
+          memset (hull, 0, sizeof (hull));
+          for (icorner = 0; icorner < neigh_ts->t8_element_num_corners (neighbor->element); icorner++) {
+            if (neighbor->leaf_corners[icorner] != 0) {
+              neigh_ts->t8_element_vertex_reference_coords (neighbor->element, icorner, hull + 3 * num_hull++);
+            }
+          }
+          T8_ASSERT (num_hull == neighbor->num_shared);
+          t8_ghost_owners_touching (forest, neighbor->gtreeid, neighbor->eclass, neigh_ts, neighbor->element, hull,
+                                    num_hull, min_touch, 0, forest->mpisize - 1, &owners);
+        }
+        neigh_ts->t8_element_destroy (1, &neighbor->element);
+      }
+      sc_array_truncate (&neighbors);
+      /* Add the element as remote element to all owners */
+      sc_array_sort (&owners, sc_int_compare);
+      last_owner = -1;
+      for (iowner = 0; iowner < owners.elem_count; iowner++) {
+        owner = *(int *) sc_array_index (&owners, iowner);
+        T8_ASSERT (0 <= owner && owner < forest->mpisize);
+        if (owner != forest->mpirank && owner != last_owner) {
+          t8_ghost_add_remote (forest, ghost, owner, itree, elem, ielem);
+        }
+        last_owner = owner;
+      }
+      sc_array_truncate (&owners);
+    }
+  }
+  sc_array_reset (&owners);
+  sc_array_reset (&face_owners);
+  sc_array_reset (&neighbors);
+
+  if (forest->profile != NULL) {
+    /* If profiling is enabled, we count the number of remote processes. */
+    forest->profile->ghosts_remotes = ghost->remote_processes->elem_count;
+  }
+}
+
+/* The edge and vertex neighbor relation computed in t8_forest_ghost_fill_remote_corners
+ * may not be symmetric, for example if the cmesh is partitioned.
+ * Since each process receives ghosts only from its remote processes, we add every
+ * process that sends to this process as a remote process without remote elements.
+ * We find these processes with sc_notify, thus each process only communicates with
+ * the processes it sends to and receives from.
+ * This function is collective. Processes without local elements pass NULL as ghost. */
+static void
+t8_forest_ghost_symmetrize_remotes (t8_forest_t forest, t8_forest_ghost_t ghost)
+{
+  t8_ghost_remote_t remote_entry_lookup, *remote_entry;
+  sc_array_t receivers;
+  int *senders, num_senders, isender, mpiret;
+  size_t index;
+
+  sc_array_init (&receivers, sizeof (int));
+  if (ghost != NULL && ghost->remote_processes->elem_count > 0) {
+    sc_array_copy (&receivers, ghost->remote_processes);
+    sc_array_sort (&receivers, sc_int_compare);
+  }
+  senders = T8_ALLOC (int, forest->mpisize);
+  mpiret = sc_notify ((int *) receivers.array, receivers.elem_count, senders, &num_senders, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (isender = 0; isender < num_senders; isender++) {
+    if (sc_array_bsearch (&receivers, senders + isender, sc_int_compare) < 0) {
+      /* We receive from this process, but do not send to it. Add an empty remote entry.
+       * A process without local elements is never a remote process of another process. */
+      T8_ASSERT (ghost != NULL);
+      remote_entry_lookup.remote_rank = senders[isender];
+      remote_entry = (t8_ghost_remote_t *) sc_hash_array_insert_unique (ghost->remote_ghosts,
+                                                                        (void *) &remote_entry_lookup, &index);
+      T8_ASSERT (remote_entry != NULL);
+      remote_entry->remote_rank = senders[isender];
+      remote_entry->num_elements = 0;
+      sc_array_init (&remote_entry->remote_trees, sizeof (t8_ghost_remote_tree_t));
+      *(int *) sc_array_push (ghost->remote_processes) = senders[isender];
+    }
+  }
+  sc_array_reset (&receivers);
+  T8_FREE (senders);
+}
+
+/* For a process, the ghost layer of each local element and ghost element, used while
+ * growing a ghost layer of width larger than one. */
+typedef struct
+{
+  int rank;   /* The rank of the process */
+  int *layer; /* For each local element and ghost element the layer in which it is a ghost of rank,
+                 0 if it is not a ghost of rank. */
+} t8_ghost_layer_rank_t;
+
+/* Return the layer entry of a process in layer_ranks. If it does not exist, it is added. */
+static t8_ghost_layer_rank_t *
+t8_forest_ghost_layer_rank (sc_array_t *layer_ranks, int rank, t8_locidx_t num_elements_and_ghosts)
+{
+  t8_ghost_layer_rank_t *entry;
+  size_t irank;
+
+  for (irank = 0; irank < layer_ranks->elem_count; irank++) {
+    entry = (t8_ghost_layer_rank_t *) sc_array_index (layer_ranks, irank);
+    if (entry->rank == rank) {
+      return entry;
+    }
+  }
+  entry = (t8_ghost_layer_rank_t *) sc_array_push (layer_ranks);
+  entry->rank = rank;
+  entry->layer = T8_ALLOC_ZERO (int, num_elements_and_ghosts);
+  return entry;
+}
+
+/* Tell each remote process of the face ghost layer which of its ghost elements are in the
+ * ghost layer number width of which other processes.
+ * For each remote element that is a ghost of another process in layer width, we send its position in the
+ * list of remote elements of the receiver and the rank of the other process.
+ * Since the receiver got the remote elements in this order, it knows the local ghost index. */
+static void
+t8_forest_ghost_layer_exchange (t8_forest_t forest, sc_array_t *layer_ranks, int width)
+{
+  t8_forest_ghost_t ghost = forest->ghosts;
+  const t8_locidx_t num_elements_and_ghosts
+    = t8_forest_get_local_num_elements (forest) + t8_forest_get_num_ghosts (forest);
+  const int num_remotes = ghost->remote_processes->elem_count;
+  t8_ghost_layer_rank_t *entry;
+  t8_ghost_remote_t *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  sc_MPI_Request *requests;
+  sc_MPI_Status status;
+  sc_array_t *send_buffers, *send_buffer;
+  t8_locidx_t element_offset, lelement, position, first_ghost, ghost_index;
+  size_t itree, ielem, irank;
+  int iremote, remote_rank, recv_count, ientry, mpiret;
+  int *recv_buffer;
+
+  send_buffers = T8_ALLOC (sc_array_t, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, num_remotes);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank = *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_entry = t8_forest_ghost_get_remote (forest, remote_rank);
+    send_buffer = send_buffers + iremote;
+    sc_array_init (send_buffer, sizeof (int));
+    position = 0;
+    for (itree = 0; itree < remote_entry->remote_trees.elem_count; itree++) {
+      remote_tree = (t8_ghost_remote_tree_t *) sc_array_index (&remote_entry->remote_trees, itree);
+      element_offset
+        = t8_forest_get_tree_element_offset (forest, t8_forest_get_local_id (forest, remote_tree->global_id));
+      for (ielem = 0; ielem < remote_tree->element_indices.elem_count; ielem++, position++) {
+        lelement = element_offset + *(t8_locidx_t *) sc_array_index (&remote_tree->element_indices, ielem);
+        for (irank = 0; irank < layer_ranks->elem_count; irank++) {
+          entry = (t8_ghost_layer_rank_t *) sc_array_index (layer_ranks, irank);
+          if (entry->rank != remote_rank && entry->layer[lelement] == width) {
+            *(int *) sc_array_push (send_buffer) = position;
+            *(int *) sc_array_push (send_buffer) = entry->rank;
+          }
+        }
+      }
+    }
+    mpiret = sc_MPI_Isend (send_buffer->array, send_buffer->elem_count, sc_MPI_INT, remote_rank, T8_MPI_GHOST_LAYERS,
+                           forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Receive the layer information for our ghost elements */
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank = *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    mpiret = sc_MPI_Probe (remote_rank, T8_MPI_GHOST_LAYERS, forest->mpicomm, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_INT, &recv_count);
+    SC_CHECK_MPI (mpiret);
+    recv_buffer = T8_ALLOC (int, recv_count);
+    mpiret = sc_MPI_Recv (recv_buffer, recv_count, sc_MPI_INT, remote_rank, T8_MPI_GHOST_LAYERS, forest->mpicomm,
+                          sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    first_ghost = t8_forest_get_local_num_elements (forest) + t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    for (ientry = 0; ientry < recv_count; ientry += 2) {
+      if (recv_buffer[ientry + 1] == forest->mpirank) {
+        /* We already own all elements at distance zero */
+        continue;
+      }
+      ghost_index = first_ghost + recv_buffer[ientry];
+      T8_ASSERT (ghost_index < num_elements_and_ghosts);
+      entry = t8_forest_ghost_layer_rank (layer_ranks, recv_buffer[ientry + 1], num_elements_and_ghosts);
+      entry->layer[ghost_index] = width;
+    }
+    T8_FREE (recv_buffer);
+  }
+
+  mpiret = sc_MPI_Waitall (num_remotes, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_reset (send_buffers + iremote);
+  }
+  T8_FREE (send_buffers);
+  T8_FREE (requests);
+}
+
+/* Grow the ghost layer of a forest to forest->ghost_width layers.
+ * On input, the forest has a ghost layer of width one. A local element is in layer k + 1
+ * of a process if it is not in a previous layer of this process and has a face neighbor in layer k.
+ * The face neighbors are taken from the face connectivity table. In each step, the processes exchange
+ * with their face ghost neighbors which ghost elements are in layer k of which processes.
+ * On output, the remote elements of the ghost layer are replaced by the elements of all
+ * layers. The ghost elements are not communicated yet. */
+static void
+t8_forest_ghost_grow_layers (t8_forest_t forest)
+{
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t num_elements_and_ghosts = num_local_elements + t8_forest_get_num_ghosts (forest);
+  t8_forest_ghost_t ghost = forest->ghosts;
+  t8_ghost_type_t ghost_type = ghost->ghost_type;
+  t8_ghost_layer_rank_t *entry;
+  t8_ghost_remote_t *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  const t8_locidx_t *neighbor_ids;
+  const int *dual_faces;
+  sc_array_t layer_ranks;
+  t8_locidx_t num_local_trees, itree, ielem, num_tree_elements, lelement, element_offset;
+  size_t iremote, iremote_tree, iremote_elem, irank;
+  int width, iface, num_faces, num_neighbors, ineigh, is_next;
+
+  T8_ASSERT (forest->ghost_width > 1);
+  t8_forest_build_face_connectivity (forest, 0);
+  sc_array_init (&layer_ranks, sizeof (t8_ghost_layer_rank_t));
+
+  /* The first layer are the remote elements of the face ghost layer */
+  for (iremote = 0; iremote < ghost->remote_processes->elem_count; iremote++) {
+    remote_entry = t8_forest_ghost_get_remote (forest, *(int *) sc_array_index (ghost->remote_processes, iremote));
+    entry = t8_forest_ghost_layer_rank (&layer_ranks, remote_entry->remote_rank, num_elements_and_ghosts);
+    for (iremote_tree = 0; iremote_tree < remote_entry->remote_trees.elem_count; iremote_tree++) {
+      remote_tree = (t8_ghost_remote_tree_t *) sc_array_index (&remote_entry->remote_trees, iremote_tree);
+      element_offset
+        = t8_forest_get_tree_element_offset (forest, t8_forest_get_local_id (forest, remote_tree->global_id));
+      for (iremote_elem = 0; iremote_elem < remote_tree->element_indices.elem_count; iremote_elem++) {
+        entry->layer[element_offset + *(t8_locidx_t *) sc_array_index (&remote_tree->element_indices, iremote_elem)]
+          = 1;
+      }
+    }
+  }
+
+  for (width = 1; width < forest->ghost_width; width++) {
+    t8_forest_ghost_layer_exchange (forest, &layer_ranks, width);
+    /* Compute the next layer */
+    for (lelement = 0; lelement < num_local_elements; lelement++) {
+      for (irank = 0; irank < layer_ranks.elem_count; irank++) {
+        entry = (t8_ghost_layer_rank_t *) sc_array_index (&layer_ranks, irank);
+        if (entry->layer[lelement] != 0) {
+          continue;
+        }
+        num_faces = forest->face_connectivity->element_offsets[lelement + 1]
+                    - forest->face_connectivity->element_offsets[lelement];
+        is_next = 0;
+        for (iface = 0; iface < num_faces && !is_next; iface++) {
+          t8_forest_face_connectivity_get (forest, lelement, iface, &num_neighbors, &neighbor_ids, &dual_faces, NULL,
+                                           NULL);
+          for (ineigh = 0; ineigh < num_neighbors && !is_next; ineigh++) {
+            is_next = entry->layer[neighbor_ids[ineigh]] == width;
+          }
+        }
+        if (is_next) {
+          entry->layer[lelement] = width + 1;
+        }
+      }
+    }
+  }
+  /* The table refers to the ghost elements of the face ghost layer, which we replace now */
+  t8_forest_face_connectivity_reset (forest);
+
+  /* Replace the remote elements of the ghost layer with the elements of all layers */
+  t8_forest_ghost_unref (&forest->ghosts);
+  t8_forest_ghost_init (&forest->ghosts, ghost_type);
+  ghost = forest->ghosts;
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0, lelement = 0; itree < num_local_trees; itree++) {
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++, lelement++) {
+      for (irank = 0; irank < layer_ranks.elem_count; irank++) {
+        entry = (t8_ghost_layer_rank_t *) sc_array_index (&layer_ranks, irank);
+        if (entry->layer[lelement] != 0) {
+          t8_ghost_add_remote (forest, ghost, entry->rank, itree, t8_forest_get_element_in_tree (forest, itree, ielem),
+                               ielem);
+        }
+      }
+    }
+  }
+  T8_ASSERT (lelement == num_local_elements);
+
+  for (irank = 0; irank < layer_ranks.elem_count; irank++) {
+    T8_FREE (((t8_ghost_layer_rank_t *) sc_array_index (&layer_ranks, irank))->layer);
+  }
+  sc_array_reset (&layer_ranks);
+}
+
+/* In a ghost message, this element count marks a tree whose remote elements did not change
+ * since the ghost layer of the forest that the ghost layer is derived from. */
+#define T8_GHOST_TREE_UNCHANGED ((size_t) -1)
+
+/* Compare two pairs (local element index, remote rank) */
+static int
+t8_ghost_compare_old_remotes (const void *pair_a, const void *pair_b)
+{
+  const t8_locidx_t *a = (const t8_locidx_t *) pair_a;
+  const t8_locidx_t *b = (const t8_locidx_t *) pair_b;
+
+  if (a[0] != b[0]) {
+    return a[0] < b[0] ? -1 : 1;
+  }
+  return a[1] < b[1] ? -1 : a[1] > b[1];
+}
+
+/* Fill the remote ghosts of a ghost structure from the ghost structure of the forest
+ * that forest was adapted or copied from.
+ * Since adapting does not change the partition of the space-filling curve, a leaf that
+ * already is a leaf of forest_from is remote to the same processes as before.
+ * Only for the new leaves we compute the owners at their faces.
+ * As in t8_forest_ghost_fill_remote, we add the remote elements in linear order. */
+static void
+t8_forest_ghost_fill_remote_incremental (t8_forest_t forest, t8_forest_ghost_t ghost, t8_forest_t forest_from)
+{
+  t8_forest_ghost_t ghost_from = forest_from->ghosts;
+  t8_ghost_remote_t *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *elem, *elem_from;
+  sc_array_t old_remotes, owners;
+  t8_locidx_t num_local_trees, itree, ielem, ielem_from, num_tree_elems, num_tree_elems_from;
+  t8_locidx_t offset_from, *old_remote;
+  size_t iremote, iremote_tree, iremote_elem, iold, iowner;
+  t8_linearidx_t id, id_from = 0;
+  int iface, num_faces, owner, maxlevel, level, level_from = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  T8_ASSERT (forest->first_local_tree == forest_from->first_local_tree);
+  T8_ASSERT (t8_forest_get_num_local_trees (forest) == t8_forest_get_num_local_trees (forest_from));
+
+  /* Collect pairs (local element index, remote rank) of the remote elements of forest_from */
+  sc_array_init (&old_remotes, 2 * sizeof (t8_locidx_t));
+  if (ghost_from != NULL) {
+    for (iremote = 0; iremote < ghost_from->remote_ghosts->a.elem_count; iremote++) {
+      remote_entry = (t8_ghost_remote_t *) sc_array_index (&ghost_from->remote_ghosts->a, iremote);
+      for (iremote_tree = 0; iremote_tree < remote_entry->remote_trees.elem_count; iremote_tree++) {
+        remote_tree = (t8_ghost_remote_tree_t *) sc_array_index (&remote_entry->remote_trees, iremote_tree);
+        offset_from = t8_forest_get_tree_element_offset (forest_from,
+                                                         t8_forest_get_local_id (forest_from, remote_tree->global_id));
+        for (iremote_elem = 0; iremote_elem < remote_tree->element_indices.elem_count; iremote_elem++) {
+          old_remote = (t8_locidx_t *) sc_array_push (&old_remotes);
+          old_remote[0] = offset_from + *(t8_locidx_t *) sc_array_index (&remote_tree->element_indices, iremote_elem);
+          old_remote[1] = remote_entry->remote_rank;
+        }
+      }
+    }
+  }
+  /* Sort by element index and rank */
+  sc_array_sort (&old_remotes, t8_ghost_compare_old_remotes);
+
+  sc_array_init (&owners, sizeof (int));
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  iold = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    maxlevel = ts->t8_element_maxlevel ();
+    num_tree_elems = t8_forest_get_tree_num_elements (forest, itree);
+    num_tree_elems_from = t8_forest_get_tree_num_elements (forest_from, itree);
+    offset_from = t8_forest_get_tree_element_offset (forest_from, itree);
+    for (ielem = 0, ielem_from = 0; ielem < num_tree_elems; ielem++) {
+      elem = t8_forest_get_element_in_tree (forest, itree, ielem);
+      /* Find the first leaf of forest_from that is not smaller than elem */
+      level = ts->t8_element_level (elem);
+      id = ts->t8_element_get_linear_id (elem, maxlevel);
+      for (; ielem_from < num_tree_elems_from; ielem_from++) {
+        elem_from = t8_forest_get_element_in_tree (forest_from, itree, ielem_from);
+        level_from = ts->t8_element_level (elem_from);
+        id_from = ts->t8_element_get_linear_id (elem_from, maxlevel);
+        if (id_from > id || (id_from == id && level_from >= level)) {
+          break;
+        }
+      }
+      if (ielem_from < num_tree_elems_from && id_from == id && level_from == level) {
+        /* The leaf did not change, it is remote to the same processes as before */
+        while (iold < old_remotes.elem_count
+               && ((t8_locidx_t *) sc_array_index (&old_remotes, iold))[0] < offset_from + ielem_from) {
+          iold++;
+        }
+        for (; iold < old_remotes.elem_count
+               && ((t8_locidx_t *) sc_array_index (&old_remotes, iold))[0] == offset_from + ielem_from;
+             iold++) {
+          owner = ((t8_locidx_t *) sc_array_index (&old_remotes, iold))[1];
+          t8_ghost_add_remote (forest, ghost, owner, itree, elem, ielem);
+        }
+        continue;
+      }
+      /* The leaf is new, we compute the owners at its faces */
+      num_faces = ts->t8_element_num_faces (elem);
+      for (iface = 0; iface < num_faces; iface++) {
+        sc_array_truncate (&owners);
+        t8_forest_element_owners_at_neigh_face (forest, itree, elem, iface, &owners);
+        for (iowner = 0; iowner < owners.elem_count; iowner++) {
+          owner = *(int *) sc_array_index (&owners, iowner);
+          T8_ASSERT (0 <= owner && owner < forest->mpisize);
+          if (owner != forest->mpirank) {
+            t8_ghost_add_remote (forest, ghost, owner, itree, elem, ielem);
+          }
+        }
+      }
+    }
+  }
+  sc_array_reset (&owners);
+  sc_array_reset (&old_remotes);
+
+  if (forest->profile != NULL) {
+    /* If profiling is enabled, we count the number of remote processes. */
+    forest->profile->ghosts_remotes = ghost->remote_processes->elem_count;
+  }
+}
+
+/* Return true if the remote elements of a tree for a remote process are the same as
+ * in ghost_from. In this case, the remote process already has these elements as ghosts. */
+static int
+t8_forest_ghost_remote_tree_unchanged (t8_forest_t forest, t8_forest_ghost_t ghost_from, int remote_rank,
+                                       t8_ghost_remote_tree_t *remote_tree)
+{
+  t8_ghost_remote_t remote_search, *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree_from = NULL;
+  t8_eclass_scheme_c *ts;
+  size_t index, itree, element_count, ielem;
+
+  if (ghost_from == NULL) {
+    return 0;
+  }
+  remote_search.remote_rank = remote_rank;
+  if (!sc_hash_array_lookup (ghost_from->remote_ghosts, &remote_search, &index)) {
+    return 0;
+  }
+  remote_entry = (t8_ghost_remote_t *) sc_array_index (&ghost_from->remote_ghosts->a, index);
+  for (itree = 0; itree < remote_entry->remote_trees.elem_count && remote_tree_from == NULL; itree++) {
+    remote_tree_from = (t8_ghost_remote_tree_t *) sc_array_index (&remote_entry->remote_trees, itree);
+    if (remote_tree_from->global_id != remote_tree->global_id) {
+      remote_tree_from = NULL;
+    }
+  }
+  element_count = t8_element_array_get_count (&remote_tree->elements);
+  if (remote_tree_from == NULL || t8_element_array_get_count (&remote_tree_from->elements) != element_count) {
+    return 0;
+  }
+  ts = t8_forest_get_eclass_scheme (forest, remote_tree->eclass);
+  for (ielem = 0; ielem < element_count; ielem++) {
+    if (!ts->t8_element_equal (t8_element_array_index_locidx (&remote_tree->elements, ielem),
+                               t8_element_array_index_locidx (&remote_tree_from->elements, ielem))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Find the ghost elements of a tree that were received from a remote process in ghost_from.
+ * On output, elements points to the ghost elements of the tree and first and count
+ * are the range of the elements of the remote process in it. */
+static void
+t8_forest_ghost_tree_elements_from (t8_forest_ghost_t ghost_from, int remote_rank, t8_gloidx_t gtreeid,
+                                    t8_element_array_t **elements, size_t *first, size_t *count)
+{
+  t8_ghost_gtree_hash_t tree_search, **ptree_found;
+  t8_ghost_process_hash_t proc_search, **pproc_found;
+  t8_ghost_tree_t *ghost_tree;
+  t8_locidx_t rank_begin, rank_end, tree_begin, tree_end;
+  size_t irank;
+  int found;
+
+  T8_ASSERT (ghost_from != NULL);
+  tree_search.global_id = gtreeid;
+  found = sc_hash_lookup (ghost_from->global_tree_to_ghost_tree, &tree_search, (void ***) &ptree_found);
+  SC_CHECK_ABORT (found, "Ghost tree of an unchanged remote tree not found.\n");
+  ghost_tree = (t8_ghost_tree_t *) sc_array_index (ghost_from->ghost_trees, (*ptree_found)->index);
+
+  /* The ghost elements of the remote process are those with indices in [rank_begin, rank_end) */
+  proc_search.mpirank = remote_rank;
+  found = sc_hash_lookup (ghost_from->process_offsets, &proc_search, (void ***) &pproc_found);
+  SC_CHECK_ABORT (found, "Remote process of an unchanged remote tree not found.\n");
+  rank_begin = (*pproc_found)->ghost_offset;
+  rank_end = ghost_from->num_ghosts_elements;
+  /* The remote processes are sorted, the next one begins where remote_rank ends */
+  for (irank = 0; irank + 1 < ghost_from->remote_processes->elem_count; irank++) {
+    if (*(int *) sc_array_index (ghost_from->remote_processes, irank) == remote_rank) {
+      proc_search.mpirank = *(int *) sc_array_index (ghost_from->remote_processes, irank + 1);
+      found = sc_hash_lookup (ghost_from->process_offsets, &proc_search, (void ***) &pproc_found);
+      T8_ASSERT (found);
+      rank_end = (*pproc_found)->ghost_offset;
+      break;
+    }
+  }
+  tree_begin = ghost_tree->element_offset;
+  tree_end = tree_begin + t8_element_array_get_count (&ghost_tree->elements);
+
+  *elements = &ghost_tree->elements;
+  *first = SC_MAX (rank_begin, tree_begin) - tree_begin;
+  *count = SC_MAX (0, SC_MIN (rank_end, tree_end) - SC_MAX (rank_begin, tree_begin));
+}
+
 /* Begin sending the ghost elements from the remote ranks
  * using non-blocking communication.
  * Afterwards,
  *  t8_forest_ghost_send_end
  * must be called to end the communication.
+ * If ghost_from is not NULL, the elements of remote trees that did not change since ghost_from
+ * are not sent, see t8_forest_ghost_remote_tree_unchanged.
  * Returns an array of mpi_send_info_t, one for each remote rank.
  */
 static t8_ghost_mpi_send_info_t *
-t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_Request **requests)
+t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, t8_forest_ghost_t ghost_from,
+                            sc_MPI_Request **requests)
 {
   int proc_index, remote_rank;
   int num_remotes;
@@ -839,7 +1485,9 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_
   t8_ghost_remote_tree_t *remote_tree = NULL;
   t8_ghost_mpi_send_info_t *send_info, *current_send_info;
   char *current_buffer;
-  size_t bytes_written, element_bytes, element_count, element_size;
+  size_t bytes_written, element_bytes, element_count, element_size, tree_count;
+  sc_array_t unchanged;
+  int *tree_unchanged;
 #ifdef T8_ENABLE_DEBUG
   size_t acc_el_count = 0;
 #endif
@@ -849,6 +1497,7 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_
   num_remotes = ghost->remote_processes->elem_count;
   send_info = T8_ALLOC (t8_ghost_mpi_send_info_t, num_remotes);
   *requests = T8_ALLOC (sc_MPI_Request, num_remotes);
+  sc_array_init (&unchanged, sizeof (int));
 
   /* Loop over all remote processes */
   for (proc_index = 0; proc_index < (int) ghost->remote_processes->elem_count; proc_index++) {
@@ -872,6 +1521,7 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_
     /* TODO: Use remote_entry to count the number of bytes while inserting
      *        the remote ghosts. */
     remote_trees = &remote_entry->remote_trees;
+    sc_array_truncate (&unchanged);
     for (remote_index = 0; remote_index < remote_trees->elem_count; remote_index++) {
       /* Get the next remote tree. */
       remote_tree = (t8_ghost_remote_tree_t *) sc_array_index (remote_trees, remote_index);
@@ -883,9 +1533,12 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_
       current_send_info->num_bytes += sizeof (t8_eclass_t);
       /* add padding before the elements */
       current_send_info->num_bytes += T8_ADD_PADDING (current_send_info->num_bytes);
-      /* The byte count of the elements */
+      /* The byte count of the elements. If the remote process already has the elements
+       * of this tree, we do not send them again. */
+      tree_unchanged = (int *) sc_array_push (&unchanged);
+      *tree_unchanged = t8_forest_ghost_remote_tree_unchanged (forest, ghost_from, remote_rank, remote_tree);
       element_size = t8_element_array_get_size (&remote_tree->elements);
-      element_count = t8_element_array_get_count (&remote_tree->elements);
+      element_count = *tree_unchanged ? 0 : t8_element_array_get_count (&remote_tree->elements);
       element_bytes = element_size * element_count;
       /* We will store the number of elements */
       current_send_info->num_bytes += sizeof (size_t);
@@ -924,12 +1577,13 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_
       bytes_written += T8_ADD_PADDING (bytes_written);
       /* Store the number of elements in the buffer */
       element_count = t8_element_array_get_count (&remote_tree->elements);
-      memcpy (current_buffer + bytes_written, &element_count, sizeof (size_t));
+      tree_count = *(int *) sc_array_index (&unchanged, remote_index) ? T8_GHOST_TREE_UNCHANGED : element_count;
+      memcpy (current_buffer + bytes_written, &tree_count, sizeof (size_t));
       bytes_written += sizeof (size_t);
       bytes_written += T8_ADD_PADDING (bytes_written);
       /* The byte count of the elements */
       element_size = t8_element_array_get_size (&remote_tree->elements);
-      element_bytes = element_size * element_count;
+      element_bytes = tree_count == T8_GHOST_TREE_UNCHANGED ? 0 : element_size * element_count;
       /* Copy the elements into the send buffer */
       memcpy (current_buffer + bytes_written, t8_element_array_get_data (&remote_tree->elements), element_bytes);
       bytes_written += element_bytes;
@@ -949,6 +1603,7 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost, sc_MPI_
                            forest->mpicomm, *requests + proc_index);
     SC_CHECK_MPI (mpiret);
   } /* end process loop */
+  sc_array_reset (&unchanged);
   return send_info;
 }
 
@@ -1009,16 +1664,23 @@ t8_forest_ghost_receive_message (int recv_rank, sc_MPI_Comm comm, sc_MPI_Status
  *
  * pad is paddind, see T8_ADD_PADDING
  *
+ * If num_elems is T8_GHOST_TREE_UNCHANGED, the message does not contain the elements of this tree
+ * and we copy them from ghost_from, the ghost structure that the sender compared against.
+ *
  * current_element_offset is updated in each step to store the element offset
  * of the next ghost tree to be inserted.
  * When called with the first message, current_element_offset must be set to 0.
  */
 /* Currently we expect that the messages arrive in order of the sender's rank. */
 static void
-t8_forest_ghost_parse_received_message (t8_forest_t forest, t8_forest_ghost_t ghost,
+t8_forest_ghost_parse_received_message (t8_forest_t forest, t8_forest_ghost_t ghost, t8_forest_ghost_t ghost_from,
                                         t8_locidx_t *current_element_offset, int recv_rank, char *recv_buffer,
                                         int recv_bytes)
 {
+  t8_element_array_t *elements_from;
+  const char *elements_read;
+  size_t first_from;
+  int tree_unchanged;
   size_t bytes_read, first_tree_index = 0, first_element_index = 0;
   t8_locidx_t num_trees, itree;
   t8_gloidx_t global_id;
@@ -1059,6 +1721,11 @@ t8_forest_ghost_parse_received_message (t8_forest_t forest, t8_forest_ghost_t gh
     bytes_read += T8_ADD_PADDING (bytes_read);
     /* read the number of elements sent */
     num_elements = *(size_t *) (recv_buffer + bytes_read);
+    tree_unchanged = num_elements == T8_GHOST_TREE_UNCHANGED;
+    if (tree_unchanged) {
+      /* We already received the elements of this tree when creating ghost_from */
+      t8_forest_ghost_tree_elements_from (ghost_from, recv_rank, global_id, &elements_from, &first_from, &num_elements);
+    }
 
     /* Add to the counter of ghost elements. */
     ghost->num_ghosts_elements += num_elements;
@@ -1117,10 +1784,17 @@ t8_forest_ghost_parse_received_message (t8_forest_t forest, t8_forest_ghost_t gh
       first_element_index = old_elem_count;
     }
     /* Insert the new elements */
-    memcpy (element_insert, recv_buffer + bytes_read, num_elements * ts->t8_element_size ());
-
-    bytes_read += num_elements * ts->t8_element_size ();
-    bytes_read += T8_ADD_PADDING (bytes_read);
+    if (tree_unchanged) {
+      elements_read = (const char *) t8_element_array_get_data (elements_from) + first_from * ts->t8_element_size ();
+    }
+    else {
+      elements_read = recv_buffer + bytes_read;
+      bytes_read += num_elements * ts->t8_element_size ();
+      bytes_read += T8_ADD_PADDING (bytes_read);
+    }
+    if (num_elements > 0) {
+      memcpy (element_insert, elements_read, num_elements * ts->t8_element_size ());
+    }
     *current_element_offset += num_elements;
   }
   T8_ASSERT (bytes_read == (size_t) recv_bytes);
@@ -1172,9 +1846,10 @@ t8_recv_list_entry_equal (const void *v1, const void *v2, const void *u)
 
 /* Probe for all incoming messages from the remote ranks and receive them.
  * We receive the message in the order in which they arrive. To achieve this,
- * we have to use polling. */
+ * we have to use polling.
+ * ghost_from is the ghost structure that the senders compared their remote trees against, or NULL. */
 static void
-t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
+t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost, t8_forest_ghost_t ghost_from)
 {
   int num_remotes;
   int proc_pos;
@@ -1316,8 +1991,8 @@ t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
           /* For all ranks that we haven't parsed yet, but can be parsed in order */
           for (parse_it = last_rank_parsed + 1; parse_it < num_remotes && received_flag[parse_it] == 1; parse_it++) {
             recv_rank = *(int *) sc_array_index_int (ghost->remote_processes, parse_it);
-            t8_forest_ghost_parse_received_message (forest, ghost, &current_element_offset, recv_rank, buffer[parse_it],
-                                                    recv_bytes[parse_it]);
+            t8_forest_ghost_parse_received_message (forest, ghost, ghost_from, &current_element_offset, recv_rank,
+                                                    buffer[parse_it], recv_bytes[parse_it]);
             last_rank_parsed++;
           }
 
@@ -1352,8 +2027,8 @@ t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
     /* For all ranks that we haven't parsed yet, but can be parsed in order */
     for (parse_it = last_rank_parsed + 1; parse_it < num_remotes && received_flag[parse_it] == 1; parse_it++) {
       recv_rank = *(int *) sc_array_index_int (ghost->remote_processes, parse_it);
-      t8_forest_ghost_parse_received_message (forest, ghost, &current_element_offset, recv_rank, buffer[parse_it],
-                                              recv_bytes[parse_it]);
+      t8_forest_ghost_parse_received_message (forest, ghost, ghost_from, &current_element_offset, recv_rank,
+                                              buffer[parse_it], recv_bytes[parse_it]);
       last_rank_parsed++;
     }
 #endif
@@ -1390,11 +2065,11 @@ t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
 void
 t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
 {
-  t8_forest_ghost_t ghost = NULL;
+  t8_forest_ghost_t ghost = NULL, ghost_from = NULL;
   t8_ghost_mpi_send_info_t *send_info;
   sc_MPI_Request *requests;
   int create_tree_array = 0, create_gfirst_desc_array = 0;
-  int create_element_array = 0;
+  int create_element_array = 0, had_face_connectivity = 0;
 
   T8_ASSERT (t8_forest_is_committed (forest));
 
@@ -1440,14 +2115,29 @@ t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
                  "Ghost layer is not constructed.\n");
       return;
     }
-    /* Currently we only support face ghosts */
-    T8_ASSERT (forest->ghost_type == T8_GHOST_FACES);
-
+    /* The face connectivity table refers to the ghosts by their index and must be
+     * rebuilt for the new ghost layer */
+    had_face_connectivity = t8_forest_has_face_connectivity (forest);
+    t8_forest_face_connectivity_reset (forest);
+    if (forest->ghosts != NULL) {
+      /* Replace an existing ghost layer */
+      t8_forest_ghost_unref (&forest->ghosts);
+    }
     /* Initialize the ghost structure */
     t8_forest_ghost_init (&forest->ghosts, forest->ghost_type);
     ghost = forest->ghosts;
 
-    if (unbalanced_version == -1) {
+    if (forest->ghost_from != NULL) {
+      /* Derive the remote elements from the ghost layer of the previous forest */
+      t8_forest_ghost_fill_remote_incremental (forest, ghost, forest->ghost_from);
+      ghost_from = forest->ghost_from->ghosts;
+    }
+    else if (forest->ghost_type == T8_GHOST_EDGES || forest->ghost_type == T8_GHOST_VERTICES) {
+      /* Construct the remote elements at the faces, edges and vertices */
+      t8_forest_ghost_fill_remote_corners (forest, ghost);
+      t8_forest_ghost_symmetrize_remotes (forest, ghost);
+    }
+    else if (unbalanced_version == -1) {
       t8_forest_ghost_fill_remote_v3 (forest);
     }
     else {
@@ -1456,13 +2146,35 @@ t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
     }
 
     /* Start sending the remote elements */
-    send_info = t8_forest_ghost_send_start (forest, ghost, &requests);
+    send_info = t8_forest_ghost_send_start (forest, ghost, ghost_from, &requests);
 
     /* Receive the ghost elements from the remote processes */
-    t8_forest_ghost_receive (forest, ghost);
+    t8_forest_ghost_receive (forest, ghost, ghost_from);
 
     /* End sending the remote elements */
     t8_forest_ghost_send_end (forest, ghost, send_info, requests);
+
+    if (forest->ghost_width > 1) {
+      /* Grow the ghost layer and exchange the elements of all layers at once */
+      t8_forest_ghost_grow_layers (forest);
+      ghost = forest->ghosts;
+      t8_forest_ghost_symmetrize_remotes (forest, ghost);
+      send_info = t8_forest_ghost_send_start (forest, ghost, NULL, &requests);
+      t8_forest_ghost_receive (forest, ghost, NULL);
+      t8_forest_ghost_send_end (forest, ghost, send_info, requests);
+    }
+    if (had_face_connectivity) {
+      t8_forest_build_face_connectivity (forest, 0);
+    }
+  }
+  else {
+    /* Take part in the collective communication of the processes with elements */
+    if (forest->ghost_type == T8_GHOST_EDGES || forest->ghost_type == T8_GHOST_VERTICES) {
+      t8_forest_ghost_symmetrize_remotes (forest, NULL);
+    }
+    if (forest->ghost_width > 1) {
+      t8_forest_ghost_symmetrize_remotes (forest, NULL);
+    }
   }
 
   if (create_element_array) {
@@ -1588,6 +2300,36 @@ t8_forest_ghost_remote_first_elem (t8_forest_t forest, int remote)
   return proc_entry->ghost_offset;
 }
 
+void
+t8_forest_ghost_remote_element_indices (t8_forest_t forest, int remote, sc_array_t *element_indices)
+{
+  t8_ghost_remote_t lookup_rank, *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  t8_locidx_t tree_offset;
+  size_t index, itree, ielement;
+  int ret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->ghosts != NULL);
+  T8_ASSERT (element_indices->elem_size == sizeof (t8_locidx_t));
+
+  lookup_rank.remote_rank = remote;
+  ret = sc_hash_array_lookup (forest->ghosts->remote_ghosts, &lookup_rank, &index);
+  if (!ret) {
+    /* We do not send any elements to this rank */
+    return;
+  }
+  remote_entry = (t8_ghost_remote_t *) sc_array_index (&forest->ghosts->remote_ghosts->a, index);
+  for (itree = 0; itree < remote_entry->remote_trees.elem_count; itree++) {
+    remote_tree = (t8_ghost_remote_tree_t *) sc_array_index (&remote_entry->remote_trees, itree);
+    tree_offset = t8_forest_get_tree_element_offset (forest, t8_forest_get_local_id (forest, remote_tree->global_id));
+    for (ielement = 0; ielement < remote_tree->element_indices.elem_count; ielement++) {
+      *(t8_locidx_t *) sc_array_push (element_indices)
+        = tree_offset + *(t8_locidx_t *) sc_array_index (&remote_tree->element_indices, ielement);
+    }
+  }
+}
+
 /* Fill the send buffer for a ghost data exchange for on remote rank.
  * returns the number of bytes in the buffer. */
 static size_t
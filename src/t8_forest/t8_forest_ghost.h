@@ -133,6 +133,16 @@ t8_forest_ghost_remote_first_tree (t8_forest_t forest, int remote);
 t8_locidx_t
 t8_forest_ghost_remote_first_elem (t8_forest_t forest, int remote);
 
+/** Return the local indices of the local elements that are ghost elements of a remote rank.
+ * \param [in] forest   A forest with constructed ghost layer.
+ * \param [in] remote   A rank.
+ * \param [in,out] element_indices An array of \ref t8_locidx_t. On output the local indices of the
+ *                      elements that are sent to \a remote are appended in ascending order.
+ *                      Nothing is appended if \a remote is not a remote rank of \a forest.
+ */
+void
+t8_forest_ghost_remote_element_indices (t8_forest_t forest, int remote, sc_array_t *element_indices);
+
 /** Increase the reference count of a ghost structure.
  * \param [in,out]  ghost     On input, this ghost structure must exist with
  *                            positive reference count.
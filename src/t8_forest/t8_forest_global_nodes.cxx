@@ -0,0 +1,550 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest/t8_forest_global_nodes.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_element_cxx.hxx>
+
+T8_EXTERN_C_BEGIN ();
+
+/* The integer coordinates of a node are its reference coordinates times this length.
+ * The reference coordinates of element vertices are integer coordinates divided by the root
+ * length of the scheme, which is at most 2^30 for all default schemes. Thus, the integer
+ * coordinates are exact. */
+#define T8_GLOBAL_NODE_ROOT_LEN ((int64_t) 1 << 30)
+
+/* A node is identified by a tree and its integer coordinates in that tree.
+ * A node on a tree boundary has a representation in each tree that touches it,
+ * we use the smallest one as its key. The representations in the other trees are
+ * found by passing the vertices through the face connections of the cmesh,
+ * see t8_forest_element_vertex_neighbors. */
+typedef struct
+{
+  t8_gloidx_t gtreeid; /* The global id of the tree. */
+  int64_t coords[3];   /* The integer coordinates in the tree, padded with zeros. */
+} t8_global_node_key_t;
+
+/* Set the key of the corner of an element in the tree gtreeid. */
+static void
+t8_global_node_set_key (t8_eclass_scheme_c *ts, t8_gloidx_t gtreeid, const t8_element_t *element, int corner,
+                        t8_global_node_key_t *key)
+{
+  double ref_coords[3] = { 0, 0, 0 };
+  int idim;
+
+  ts->t8_element_vertex_reference_coords (element, corner, ref_coords);
+  key->gtreeid = gtreeid;
+  for (idim = 0; idim < 3; idim++) {
+    key->coords[idim] = (int64_t) (ref_coords[idim] * T8_GLOBAL_NODE_ROOT_LEN);
+    T8_ASSERT (key->coords[idim] == ref_coords[idim] * T8_GLOBAL_NODE_ROOT_LEN);
+  }
+}
+
+/* The hash function for the node keys. We hash the bytes of the key. */
+static unsigned
+t8_global_node_hash (const void *node_key, const void *data)
+{
+  const unsigned char *bytes = (const unsigned char *) node_key;
+  unsigned hash = 2166136261u;
+  size_t ibyte;
+
+  for (ibyte = 0; ibyte < sizeof (t8_global_node_key_t); ibyte++) {
+    hash = (hash ^ bytes[ibyte]) * 16777619u;
+  }
+  return hash;
+}
+
+/* Compare two node keys lexicographically. */
+static int
+t8_global_node_compare (const t8_global_node_key_t *key_a, const t8_global_node_key_t *key_b)
+{
+  int idim;
+
+  if (key_a->gtreeid != key_b->gtreeid) {
+    return key_a->gtreeid < key_b->gtreeid ? -1 : 1;
+  }
+  for (idim = 0; idim < 3; idim++) {
+    if (key_a->coords[idim] != key_b->coords[idim]) {
+      return key_a->coords[idim] < key_b->coords[idim] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+/* The equal function for the node keys. */
+static int
+t8_global_node_equal (const void *node_key_a, const void *node_key_b, const void *data)
+{
+  return !t8_global_node_compare ((const t8_global_node_key_t *) node_key_a, (const t8_global_node_key_t *) node_key_b);
+}
+
+/* Return true if a vertex with the given integer coordinates may lie on the boundary of its tree.
+ * The faces of the reference elements lie in the planes x_i = 0, x_i = 1 and, for
+ * the simplicial classes, x_i = x_j. We may return true for interior vertices. */
+static int
+t8_global_node_maybe_on_tree_boundary (t8_eclass_t eclass, const int64_t *coords)
+{
+  const int dim = t8_eclass_to_dimension[eclass];
+  int idim, jdim;
+
+  for (idim = 0; idim < dim; idim++) {
+    if (coords[idim] == 0 || coords[idim] == T8_GLOBAL_NODE_ROOT_LEN) {
+      return 1;
+    }
+  }
+  if (eclass == T8_ECLASS_VERTEX || eclass == T8_ECLASS_LINE || eclass == T8_ECLASS_QUAD || eclass == T8_ECLASS_HEX) {
+    return 0;
+  }
+  for (idim = 0; idim < dim; idim++) {
+    for (jdim = idim + 1; jdim < dim; jdim++) {
+      if (coords[idim] == coords[jdim]) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/* Compute the keys of the corners of a leaf.
+ * For corners that may lie on the tree boundary, we find the representations of the
+ * corner in the neighboring trees and use the smallest one. */
+static void
+t8_forest_global_nodes_leaf_keys (t8_forest_t forest, t8_locidx_t ltreeid, t8_eclass_scheme_c *ts,
+                                  const t8_element_t *leaf, sc_array_t *neighbors, t8_global_node_key_t *keys)
+{
+  const t8_eclass_t eclass = t8_forest_get_tree_class (forest, ltreeid);
+  const int num_corners = ts->t8_element_num_corners (leaf);
+  t8_forest_vertex_neighbor_t *neighbor;
+  t8_eclass_scheme_c *neigh_ts;
+  t8_global_node_key_t candidate;
+  size_t ineigh;
+  int icorner, ishared, maybe_on_boundary = 0;
+
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    t8_global_node_set_key (ts, t8_forest_global_tree_id (forest, ltreeid), leaf, icorner, keys + icorner);
+    maybe_on_boundary = maybe_on_boundary || t8_global_node_maybe_on_tree_boundary (eclass, keys[icorner].coords);
+  }
+  if (!maybe_on_boundary) {
+    return;
+  }
+
+  T8_ASSERT (neighbors->elem_count == 0);
+  t8_forest_element_vertex_neighbors (forest, ltreeid, leaf, 1, neighbors);
+  for (ineigh = 0; ineigh < neighbors->elem_count; ineigh++) {
+    neighbor = (t8_forest_vertex_neighbor_t *) sc_array_index (neighbors, ineigh);
+    neigh_ts = t8_forest_get_eclass_scheme (forest, neighbor->eclass);
+    for (ishared = 0; ishared < neigh_ts->t8_element_num_corners (neighbor->element); ishared++) {
+      if (neighbor->leaf_corners[ishared] == 0) {
+        continue;
+      }
+      t8_global_node_set_key (neigh_ts, neighbor->gtreeid, neighbor->element, ishared, &candidate);
+      /* The vertex may be more than one corner of the leaf */
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        if ((neighbor->leaf_corners[ishared] & (1 << icorner))
+            && t8_global_node_compare (&candidate, keys + icorner) < 0) {
+          keys[icorner] = candidate;
+        }
+      }
+    }
+    neigh_ts->t8_element_destroy (1, &neighbor->element);
+  }
+  sc_array_truncate (neighbors);
+}
+
+/* Number the corners of the local leaves in the order in which we first encounter them.
+ * Coincident corners, also of leaves in different trees, get the same number.
+ * Allocates the corner offsets of the leaves and the node numbers of the corners and
+ * returns the hash array of the node keys, in which the position of a key is its number. */
+static sc_hash_array_t *
+t8_forest_global_nodes_number_local (t8_forest_t forest, t8_locidx_t **element_offsets, t8_locidx_t **element_nodes)
+{
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  sc_hash_array_t *node_hash;
+  sc_array_t neighbors;
+  t8_global_node_key_t keys[T8_ECLASS_MAX_CORNERS], *new_key;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *leaf;
+  t8_locidx_t itree, ielem, num_tree_elements, element_index;
+  t8_locidx_t *offsets, *corner_nodes;
+  size_t position;
+  int icorner, num_corners;
+
+  /* Count the corners of all leaves */
+  offsets = T8_ALLOC (t8_locidx_t, num_elements + 1);
+  offsets[0] = 0;
+  for (itree = 0, element_index = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++, element_index++) {
+      leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      offsets[element_index + 1] = offsets[element_index] + ts->t8_element_num_corners (leaf);
+    }
+  }
+  corner_nodes = T8_ALLOC (t8_locidx_t, offsets[num_elements]);
+
+  /* Number the nodes locally in the order in which we first encounter them */
+  node_hash = sc_hash_array_new (sizeof (t8_global_node_key_t), t8_global_node_hash, t8_global_node_equal, NULL);
+  sc_array_init (&neighbors, sizeof (t8_forest_vertex_neighbor_t));
+  for (itree = 0, element_index = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++, element_index++) {
+      leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      t8_forest_global_nodes_leaf_keys (forest, itree, ts, leaf, &neighbors, keys);
+      num_corners = ts->t8_element_num_corners (leaf);
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        new_key = (t8_global_node_key_t *) sc_hash_array_insert_unique (node_hash, keys + icorner, &position);
+        if (new_key != NULL) {
+          *new_key = keys[icorner];
+        }
+        corner_nodes[offsets[element_index] + icorner] = position;
+      }
+    }
+  }
+  sc_array_reset (&neighbors);
+  *element_offsets = offsets;
+  *element_nodes = corner_nodes;
+  return node_hash;
+}
+
+/* Send the keys of the nodes of our remote elements to each remote rank.
+ * On the receiving side, the owner of each node is the smallest rank of all processes with
+ * a leaf at that node. Since the ghost layer contains all leaves that touch a local leaf in a
+ * vertex, every process with a leaf at a node receives the key from all other such processes.
+ * We store the local indices of the sent nodes and the received keys for the second exchange. */
+static void
+t8_forest_global_nodes_exchange_keys (t8_forest_t forest, t8_forest_global_nodes_t *nodes, sc_hash_array_t *node_hash,
+                                      int num_remotes, const int *remotes, sc_array_t *sent_nodes,
+                                      sc_array_t *recv_keys)
+{
+  sc_array_t *send_keys, element_indices;
+  sc_MPI_Request *requests;
+  sc_MPI_Status status;
+  t8_locidx_t *last_sent, lelement, lnode, inode;
+  size_t ielement, ikey, position;
+  int iremote, recv_bytes, mpiret;
+
+  send_keys = T8_ALLOC (sc_array_t, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, num_remotes);
+  /* For each node the last remote that we added it to, to avoid sending a node twice */
+  last_sent = T8_ALLOC (t8_locidx_t, nodes->num_local_nodes);
+  for (lnode = 0; lnode < nodes->num_local_nodes; lnode++) {
+    last_sent[lnode] = -1;
+  }
+  sc_array_init (&element_indices, sizeof (t8_locidx_t));
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_init (sent_nodes + iremote, sizeof (t8_locidx_t));
+    sc_array_init (send_keys + iremote, sizeof (t8_global_node_key_t));
+    t8_forest_ghost_remote_element_indices (forest, remotes[iremote], &element_indices);
+    for (ielement = 0; ielement < element_indices.elem_count; ielement++) {
+      lelement = *(t8_locidx_t *) sc_array_index (&element_indices, ielement);
+      for (inode = nodes->element_offsets[lelement]; inode < nodes->element_offsets[lelement + 1]; inode++) {
+        lnode = nodes->element_nodes[inode];
+        if (last_sent[lnode] != iremote) {
+          last_sent[lnode] = iremote;
+          *(t8_locidx_t *) sc_array_push (sent_nodes + iremote) = lnode;
+          memcpy (sc_array_push (send_keys + iremote), sc_array_index (&node_hash->a, lnode),
+                  sizeof (t8_global_node_key_t));
+        }
+      }
+    }
+    sc_array_truncate (&element_indices);
+    mpiret = sc_MPI_Isend (send_keys[iremote].array, send_keys[iremote].elem_count * sizeof (t8_global_node_key_t),
+                           sc_MPI_BYTE, remotes[iremote], T8_MPI_GLOBAL_NODES, forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Receive the keys of the remote processes and compute the owners of our nodes */
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    mpiret = sc_MPI_Probe (remotes[iremote], T8_MPI_GLOBAL_NODES, forest->mpicomm, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &recv_bytes);
+    SC_CHECK_MPI (mpiret);
+    T8_ASSERT (recv_bytes % sizeof (t8_global_node_key_t) == 0);
+    sc_array_init_count (recv_keys + iremote, sizeof (t8_global_node_key_t),
+                         recv_bytes / sizeof (t8_global_node_key_t));
+    mpiret = sc_MPI_Recv (recv_keys[iremote].array, recv_bytes, sc_MPI_BYTE, remotes[iremote], T8_MPI_GLOBAL_NODES,
+                          forest->mpicomm, sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    for (ikey = 0; ikey < recv_keys[iremote].elem_count; ikey++) {
+      if (sc_hash_array_lookup (node_hash, sc_array_index (recv_keys + iremote, ikey), &position)) {
+        nodes->node_owners[position] = SC_MIN (nodes->node_owners[position], remotes[iremote]);
+      }
+    }
+  }
+
+  mpiret = sc_MPI_Waitall (num_remotes, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_reset (send_keys + iremote);
+  }
+  sc_array_reset (&element_indices);
+  T8_FREE (send_keys);
+  T8_FREE (requests);
+  T8_FREE (last_sent);
+}
+
+/* Send the global ids of the owned nodes to the processes that sent us their keys.
+ * For each received key that we own, we send its position in the received list together with its id. */
+static void
+t8_forest_global_nodes_exchange_ids (t8_forest_t forest, t8_forest_global_nodes_t *nodes, sc_hash_array_t *node_hash,
+                                     int num_remotes, const int *remotes, sc_array_t *sent_nodes,
+                                     sc_array_t *recv_keys)
+{
+  sc_array_t *send_ids;
+  sc_MPI_Request *requests;
+  sc_MPI_Status status;
+  t8_gloidx_t *recv_buffer;
+  t8_locidx_t lnode;
+  size_t ikey, position;
+  int iremote, recv_count, ientry, mpiret;
+
+  send_ids = T8_ALLOC (sc_array_t, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, num_remotes);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_init (send_ids + iremote, sizeof (t8_gloidx_t));
+    for (ikey = 0; ikey < recv_keys[iremote].elem_count; ikey++) {
+      if (sc_hash_array_lookup (node_hash, sc_array_index (recv_keys + iremote, ikey), &position)
+          && nodes->node_owners[position] == forest->mpirank) {
+        *(t8_gloidx_t *) sc_array_push (send_ids + iremote) = ikey;
+        *(t8_gloidx_t *) sc_array_push (send_ids + iremote) = nodes->global_ids[position];
+      }
+    }
+    mpiret = sc_MPI_Isend (send_ids[iremote].array, send_ids[iremote].elem_count, T8_MPI_GLOIDX, remotes[iremote],
+                           T8_MPI_GLOBAL_NODES, forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Receive the global ids of the nodes that are owned by the remote processes */
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    mpiret = sc_MPI_Probe (remotes[iremote], T8_MPI_GLOBAL_NODES, forest->mpicomm, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, T8_MPI_GLOIDX, &recv_count);
+    SC_CHECK_MPI (mpiret);
+    recv_buffer = T8_ALLOC (t8_gloidx_t, recv_count);
+    mpiret = sc_MPI_Recv (recv_buffer, recv_count, T8_MPI_GLOIDX, remotes[iremote], T8_MPI_GLOBAL_NODES,
+                          forest->mpicomm, sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    for (ientry = 0; ientry < recv_count; ientry += 2) {
+      T8_ASSERT (0 <= recv_buffer[ientry] && (size_t) recv_buffer[ientry] < sent_nodes[iremote].elem_count);
+      lnode = *(t8_locidx_t *) sc_array_index (sent_nodes + iremote, recv_buffer[ientry]);
+      T8_ASSERT (nodes->node_owners[lnode] == remotes[iremote]);
+      nodes->global_ids[lnode] = recv_buffer[ientry + 1];
+    }
+    T8_FREE (recv_buffer);
+  }
+
+  mpiret = sc_MPI_Waitall (num_remotes, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_reset (send_ids + iremote);
+  }
+  T8_FREE (send_ids);
+  T8_FREE (requests);
+}
+
+void
+t8_forest_build_global_nodes (t8_forest_t forest)
+{
+  t8_forest_global_nodes_t *nodes;
+  sc_hash_array_t *node_hash;
+  sc_array_t *sent_nodes, *recv_keys;
+  t8_locidx_t lnode, num_unresolved;
+  t8_gloidx_t num_owned, first_owned;
+  const int *remotes = NULL;
+  int num_remotes = 0, iremote, mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->global_nodes != NULL) {
+    /* The numbering was already built */
+    return;
+  }
+  SC_CHECK_ABORT (forest->mpisize == 1 || forest->local_num_elements == 0
+                    || (forest->ghosts != NULL && forest->ghosts->ghost_type == T8_GHOST_VERTICES),
+                  "Vertex ghost layer is needed for t8_forest_build_global_nodes "
+                  "but was not found in forest.\n");
+
+  nodes = T8_ALLOC_ZERO (t8_forest_global_nodes_t, 1);
+  nodes->num_elements = t8_forest_get_local_num_elements (forest);
+  node_hash = t8_forest_global_nodes_number_local (forest, &nodes->element_offsets, &nodes->element_nodes);
+  nodes->num_local_nodes = node_hash->a.elem_count;
+  nodes->node_owners = T8_ALLOC (int, nodes->num_local_nodes);
+  nodes->global_ids = T8_ALLOC (t8_gloidx_t, nodes->num_local_nodes);
+  for (lnode = 0; lnode < nodes->num_local_nodes; lnode++) {
+    nodes->node_owners[lnode] = forest->mpirank;
+    nodes->global_ids[lnode] = -1;
+  }
+
+  /* Compute the owners of the nodes */
+  if (forest->mpisize > 1 && nodes->num_elements > 0) {
+    remotes = t8_forest_ghost_get_remotes (forest, &num_remotes);
+  }
+  sent_nodes = T8_ALLOC (sc_array_t, num_remotes);
+  recv_keys = T8_ALLOC (sc_array_t, num_remotes);
+  t8_forest_global_nodes_exchange_keys (forest, nodes, node_hash, num_remotes, remotes, sent_nodes, recv_keys);
+
+  /* Number the owned nodes consecutively */
+  for (lnode = 0; lnode < nodes->num_local_nodes; lnode++) {
+    nodes->num_owned_nodes += nodes->node_owners[lnode] == forest->mpirank;
+  }
+  num_owned = nodes->num_owned_nodes;
+  mpiret = sc_MPI_Scan (&num_owned, &first_owned, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  nodes->first_owned_node = first_owned - num_owned;
+  mpiret = sc_MPI_Allreduce (&num_owned, &nodes->global_num_nodes, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (lnode = 0, num_owned = 0; lnode < nodes->num_local_nodes; lnode++) {
+    if (nodes->node_owners[lnode] == forest->mpirank) {
+      nodes->global_ids[lnode] = nodes->first_owned_node + num_owned++;
+    }
+  }
+
+  /* Receive the ids of the nodes owned by other processes */
+  t8_forest_global_nodes_exchange_ids (forest, nodes, node_hash, num_remotes, remotes, sent_nodes, recv_keys);
+  /* A node has no id if the process that we consider its owner does not know it under the
+   * same key, for example since the trees around it could not be found in a partitioned cmesh */
+  for (lnode = 0, num_unresolved = 0; lnode < nodes->num_local_nodes; lnode++) {
+    num_unresolved += nodes->global_ids[lnode] < 0;
+    T8_ASSERT (nodes->global_ids[lnode] < nodes->global_num_nodes);
+  }
+  SC_CHECK_ABORTF (num_unresolved == 0, "t8_forest_build_global_nodes could not resolve the global ids of %li nodes.\n",
+                   (long) num_unresolved);
+
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_reset (sent_nodes + iremote);
+    sc_array_reset (recv_keys + iremote);
+  }
+  T8_FREE (sent_nodes);
+  T8_FREE (recv_keys);
+  sc_hash_array_destroy (node_hash);
+  forest->global_nodes = nodes;
+}
+
+t8_locidx_t
+t8_forest_number_local_nodes (const t8_forest_t forest, t8_locidx_t **element_offsets, t8_locidx_t **element_nodes)
+{
+  sc_hash_array_t *node_hash;
+  t8_locidx_t num_local_nodes;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (element_offsets != NULL && element_nodes != NULL);
+
+  node_hash = t8_forest_global_nodes_number_local (forest, element_offsets, element_nodes);
+  num_local_nodes = node_hash->a.elem_count;
+  sc_hash_array_destroy (node_hash);
+  return num_local_nodes;
+}
+
+int
+t8_forest_has_global_nodes (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  return forest->global_nodes != NULL;
+}
+
+t8_locidx_t
+t8_forest_get_num_local_nodes (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  return forest->global_nodes->num_local_nodes;
+}
+
+t8_locidx_t
+t8_forest_get_num_owned_nodes (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  return forest->global_nodes->num_owned_nodes;
+}
+
+t8_gloidx_t
+t8_forest_get_global_num_nodes (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  return forest->global_nodes->global_num_nodes;
+}
+
+t8_gloidx_t
+t8_forest_get_first_owned_node (const t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  return forest->global_nodes->first_owned_node;
+}
+
+const t8_locidx_t *
+t8_forest_global_nodes_get_element (const t8_forest_t forest, t8_locidx_t lelement_id, int *num_nodes)
+{
+  const t8_forest_global_nodes_t *nodes;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  nodes = forest->global_nodes;
+  T8_ASSERT (0 <= lelement_id && lelement_id < nodes->num_elements);
+
+  *num_nodes = nodes->element_offsets[lelement_id + 1] - nodes->element_offsets[lelement_id];
+  return nodes->element_nodes + nodes->element_offsets[lelement_id];
+}
+
+t8_gloidx_t
+t8_forest_global_nodes_get_global_id (const t8_forest_t forest, t8_locidx_t lnode_id)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  T8_ASSERT (0 <= lnode_id && lnode_id < forest->global_nodes->num_local_nodes);
+  return forest->global_nodes->global_ids[lnode_id];
+}
+
+int
+t8_forest_global_nodes_get_owner (const t8_forest_t forest, t8_locidx_t lnode_id)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->global_nodes != NULL);
+  T8_ASSERT (0 <= lnode_id && lnode_id < forest->global_nodes->num_local_nodes);
+  return forest->global_nodes->node_owners[lnode_id];
+}
+
+void
+t8_forest_global_nodes_reset (t8_forest_t forest)
+{
+  t8_forest_global_nodes_t *nodes;
+
+  T8_ASSERT (forest != NULL);
+  nodes = forest->global_nodes;
+  if (nodes == NULL) {
+    return;
+  }
+  T8_FREE (nodes->element_offsets);
+  T8_FREE (nodes->element_nodes);
+  T8_FREE (nodes->node_owners);
+  T8_FREE (nodes->global_ids);
+  T8_FREE (nodes);
+  forest->global_nodes = NULL;
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,145 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_global_nodes.h
+ * Parallel global numbering of the vertices of the leaves of a forest.
+ * Each vertex (node) that is shared by several leaves, possibly on different processes,
+ * gets one global id. Every node is owned by exactly one process, the smallest rank
+ * among the processes that have a leaf touching the node. The owned nodes of a process
+ * are numbered consecutively, such that the ids of rank p come before those of rank p + 1.
+ * This is the numbering needed to assemble continuous finite element systems with
+ * distributed linear algebra packages.
+ */
+
+#ifndef T8_FOREST_GLOBAL_NODES_H
+#define T8_FOREST_GLOBAL_NODES_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the global numbering of the vertices of all local leaves of a forest and store it in the forest.
+ * If the numbering was already built, this function does nothing.
+ * The numbering is valid as long as the forest exists and is freed together with the forest.
+ * This function is collective over the communicator of \a forest.
+ * \param [in,out] forest   A committed forest. If the forest is distributed, it must have a ghost layer
+ *                          of type \ref T8_GHOST_VERTICES, see \ref t8_forest_set_ghost_ext.
+ * \note A vertex is identified by a tree and its integer coordinates in that tree. The representations
+ *       of a vertex in other trees, also across periodic boundaries, are found through the face
+ *       connections of the cmesh. For a partitioned cmesh, the trees around a vertex must be reachable
+ *       through local trees of the cmesh. Otherwise, a vertex may be numbered twice, or its id may not
+ *       be resolved, in which case the function aborts.
+ * \note Hanging vertices of non-conforming leaves are numbered as separate nodes.
+ */
+void
+t8_forest_build_global_nodes (t8_forest_t forest);
+
+/** Number the vertices of the local leaves of a forest on this process only.
+ * Coincident vertices of local leaves, also of leaves in different trees, get the same local index.
+ * The nodes are numbered in the order in which they first appear as a corner of a local leaf.
+ * In contrast to \ref t8_forest_build_global_nodes, this function needs neither a ghost layer
+ * nor communication and does not store the numbering in the forest.
+ * \param [in] forest           A committed forest.
+ * \param [out] element_offsets On output an array of length num_local_elements + 1, allocated with
+ *                              T8_ALLOC. The corners of leaf i have the entries element_offsets[i] to
+ *                              element_offsets[i + 1] - 1 of \a element_nodes.
+ * \param [out] element_nodes   On output an array allocated with T8_ALLOC with the local node index
+ *                              of each corner of each leaf, ordered as the corners of the leaf.
+ * \return                      The number of local nodes.
+ * \note The same restrictions as for \ref t8_forest_build_global_nodes apply to the identification
+ *       of vertices of different trees and to hanging vertices.
+ */
+t8_locidx_t
+t8_forest_number_local_nodes (const t8_forest_t forest, t8_locidx_t **element_offsets, t8_locidx_t **element_nodes);
+
+/** Query whether the global node numbering of a forest was built.
+ * \param [in] forest   A committed forest.
+ * \return              True if \ref t8_forest_build_global_nodes was called for \a forest.
+ */
+int
+t8_forest_has_global_nodes (const t8_forest_t forest);
+
+/** Return the number of nodes at the corners of the local leaves of a forest.
+ * \param [in] forest   A committed forest with a global node numbering.
+ * \return              The number of local nodes, including those owned by other processes.
+ */
+t8_locidx_t
+t8_forest_get_num_local_nodes (const t8_forest_t forest);
+
+/** Return the number of nodes owned by this process.
+ * \param [in] forest   A committed forest with a global node numbering.
+ * \return              The number of owned nodes.
+ */
+t8_locidx_t
+t8_forest_get_num_owned_nodes (const t8_forest_t forest);
+
+/** Return the number of nodes on all processes.
+ * \param [in] forest   A committed forest with a global node numbering.
+ * \return              The global number of nodes.
+ */
+t8_gloidx_t
+t8_forest_get_global_num_nodes (const t8_forest_t forest);
+
+/** Return the global id of the first node owned by this process.
+ * The owned nodes have the global ids first to first + num_owned_nodes - 1.
+ * \param [in] forest   A committed forest with a global node numbering.
+ * \return              The global id of the first owned node.
+ */
+t8_gloidx_t
+t8_forest_get_first_owned_node (const t8_forest_t forest);
+
+/** Return the local node indices of the corners of a local leaf.
+ * \param [in] forest       A committed forest with a global node numbering.
+ * \param [in] lelement_id  The local index of a leaf.
+ * \param [out] num_nodes   On output the number of corners of the leaf.
+ * \return                  A pointer to \a num_nodes local node indices, ordered as the corners
+ *                          of the leaf. Must not be modified or freed.
+ */
+const t8_locidx_t *
+t8_forest_global_nodes_get_element (const t8_forest_t forest, t8_locidx_t lelement_id, int *num_nodes);
+
+/** Return the global id of a local node.
+ * \param [in] forest   A committed forest with a global node numbering.
+ * \param [in] lnode_id A local node index.
+ * \return              The global id of \a lnode_id.
+ */
+t8_gloidx_t
+t8_forest_global_nodes_get_global_id (const t8_forest_t forest, t8_locidx_t lnode_id);
+
+/** Return the rank of the process that owns a local node.
+ * \param [in] forest   A committed forest with a global node numbering.
+ * \param [in] lnode_id A local node index.
+ * \return              The rank of the owner of \a lnode_id.
+ */
+int
+t8_forest_global_nodes_get_owner (const t8_forest_t forest, t8_locidx_t lnode_id);
+
+/** Free the global node numbering of a forest, if it exists.
+ * \param [in,out] forest   A committed forest.
+ */
+void
+t8_forest_global_nodes_reset (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_GLOBAL_NODES_H */
@@ -32,9 +32,40 @@
 #include <t8_vtk.h>
 T8_EXTERN_C_BEGIN ();
 
-/* TODO: implement */
-void
-t8_forest_save (t8_forest_t forest);
+/** Save the leaves of a forest and optional per element data to a binary checkpoint file.
+ * All processes write to the same file with collective MPI I/O, each at the offset
+ * of its first local element. The file contains the partition of the forest, the number
+ * of elements of each tree, whether elements were removed from the forest and the level
+ * and linear id of each leaf. The leaves are stored
+ * difference encoded in blocks, which can be decoded independently, such that each process
+ * reads only the blocks that contain its leaves when loading.
+ * The forest can be restored with \ref t8_forest_set_load and the data with
+ * \ref t8_forest_load_element_data.
+ * The coarse mesh is not stored in the checkpoint. It can be saved with \ref t8_cmesh_save.
+ * This function is collective and must be called on each process.
+ * \param [in]      forest              A committed forest.
+ * \param [in]      filename            The name of the checkpoint file. An existing file is overwritten.
+ * \param [in]      element_data        If not NULL, an array with one entry per local element,
+ *                                      whose entries are written to the file.
+ * \return  True if successful, false if not.
+ * \note Without MPI I/O, checkpoints can only be written on a single process.
+ */
+int
+t8_forest_save (t8_forest_t forest, const char *filename, const sc_array_t *element_data);
+
+/** Read per element data from a checkpoint file written with \ref t8_forest_save.
+ * The forest must have the same leaves as the saved forest, for example because it was
+ * loaded from the same file with \ref t8_forest_set_load. Its partition may differ.
+ * This function is collective and must be called on each process.
+ * \param [in]      forest              A committed forest.
+ * \param [in]      filename            The name of the checkpoint file.
+ * \param [in,out]  element_data        An array whose element size equals the size of the saved data.
+ *                                      On output it has one entry per local element.
+ * \return  True if successful, false if not, in particular if the file does not store data
+ *          of this size for a forest with the same number of elements.
+ */
+int
+t8_forest_load_element_data (t8_forest_t forest, const char *filename, sc_array_t *element_data);
 
 /** Write the forest in a parallel vtu format. Extended version.
  * See \ref t8_forest_write_vtk for the standard version of this function.
@@ -23,7 +23,21 @@
 #include <t8_forest/t8_forest_iterate.h>
 #include <t8_forest/t8_forest_types.h>
 #include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_cmesh/t8_cmesh_locate.h>
 #include <t8_element_cxx.hxx>
+#include <vector>
+#ifdef T8_ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+/* OpenMP pragmas are only active if t8code is configured with OpenMP */
+#ifdef T8_ENABLE_OPENMP
+#define T8_FOREST_SEARCH_OMP(x) _Pragma (#x)
+#else
+#define T8_FOREST_SEARCH_OMP(x)
+#endif
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -89,7 +103,8 @@ t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid, const t8_eleme
   t8_element_array_t face_child_leaves;
 
   T8_ASSERT (t8_forest_is_committed (forest));
-  T8_ASSERT (0 <= ltreeid && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest) + t8_forest_get_num_ghost_trees (forest));
 
   elem_count = t8_element_array_get_count (leaf_elements);
   if (elem_count == 0) {
@@ -178,8 +193,9 @@ t8_forest_search_recursion (t8_forest_t forest, const t8_locidx_t ltreeid, t8_el
   /* Assertions to check for necessary requirements */
   /* The forest must be committed */
   T8_ASSERT (t8_forest_is_committed (forest));
-  /* The tree must be local */
-  T8_ASSERT (0 <= ltreeid && ltreeid < t8_forest_get_num_local_trees (forest));
+  /* The tree must be local or a ghost tree */
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest) + t8_forest_get_num_ghost_trees (forest));
   /* If we have queries, we also must have a query function */
   T8_ASSERT ((queries == NULL) == (query_fn == NULL));
 
@@ -285,16 +301,20 @@ t8_forest_search_recursion (t8_forest_t forest, const t8_locidx_t ltreeid, t8_el
   }
 }
 
-/* Perform a top-down search in one tree of the forest */
+/* Perform a top-down search in one tree of the forest.
+ * ltreeid may also be a ghost tree id, num_local_trees + lghost_tree */
 static void
 t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid, t8_forest_search_query_fn search_fn,
                        t8_forest_search_query_fn query_fn, sc_array_t *queries, sc_array_t *active_queries)
 {
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
 
   /* Get the element class, scheme and leaf elements of this tree */
-  const t8_eclass_t eclass = t8_forest_get_eclass (forest, ltreeid);
+  const t8_eclass_t eclass = t8_forest_get_tree_class (forest, ltreeid);
   const t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
-  t8_element_array_t *leaf_elements = t8_forest_tree_get_leaves (forest, ltreeid);
+  t8_element_array_t *leaf_elements = ltreeid < num_local_trees
+                                        ? t8_forest_tree_get_leaves (forest, ltreeid)
+                                        : t8_forest_ghost_get_tree_elements (forest, ltreeid - num_local_trees);
 
   /* assert for empty tree */
   T8_ASSERT (t8_element_array_get_count (leaf_elements) >= 0);
@@ -339,6 +359,922 @@ t8_forest_search (t8_forest_t forest, t8_forest_search_query_fn search_fn, t8_fo
   }
 }
 
+void
+t8_forest_search_point_candidates (t8_forest_t forest, const double point[3], const double tolerance,
+                                   t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
+                                   sc_array_t *queries)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  /* Find the coarse trees whose bounding box contains the point */
+  sc_array_t candidate_trees;
+  sc_array_init (&candidate_trees, sizeof (t8_locidx_t));
+  t8_cmesh_locate_candidate_trees (t8_forest_get_cmesh (forest), point, tolerance, &candidate_trees);
+  if (candidate_trees.elem_count == 0) {
+    sc_array_reset (&candidate_trees);
+    return;
+  }
+
+  sc_array_t *active_queries = NULL;
+  if (queries != NULL) {
+    const size_t num_queries = queries->elem_count;
+    active_queries = sc_array_new_count (sizeof (size_t), num_queries);
+    for (size_t iquery = 0; iquery < num_queries; ++iquery) {
+      *(size_t *) sc_array_index (active_queries, iquery) = iquery;
+    }
+  }
+
+  /* Search those candidate trees that are local in the forest */
+  for (size_t icandidate = 0; icandidate < candidate_trees.elem_count; ++icandidate) {
+    const t8_locidx_t lctreeid = *(t8_locidx_t *) sc_array_index (&candidate_trees, icandidate);
+    const t8_locidx_t ltreeid = t8_forest_cmesh_ltreeid_to_ltreeid (forest, lctreeid);
+    if (ltreeid >= 0 && t8_forest_get_tree_num_elements (forest, ltreeid) > 0) {
+      t8_forest_search_tree (forest, ltreeid, search_fn, query_fn, queries, active_queries);
+    }
+  }
+
+  if (active_queries != NULL) {
+    sc_array_destroy (active_queries);
+  }
+  sc_array_reset (&candidate_trees);
+}
+
+void
+t8_forest_search_ghosts (t8_forest_t forest, t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
+                         sc_array_t *queries)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  /* If we have queries build a list of all active queries,
+   * thus all queries in the array */
+  sc_array_t *active_queries = NULL;
+  if (queries != NULL) {
+    const size_t num_queries = queries->elem_count;
+    active_queries = sc_array_new_count (sizeof (size_t), num_queries);
+    for (size_t iquery = 0; iquery < num_queries; ++iquery) {
+      *(size_t *) sc_array_index (active_queries, iquery) = iquery;
+    }
+  }
+
+  /* The ghost trees are identified by num_local_trees + lghost_tree */
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  const t8_locidx_t num_ghost_trees = t8_forest_get_num_ghost_trees (forest);
+  for (t8_locidx_t ighost_tree = 0; ighost_tree < num_ghost_trees; ighost_tree++) {
+    t8_forest_search_tree (forest, num_local_trees + ighost_tree, search_fn, query_fn, queries, active_queries);
+  }
+
+  if (active_queries != NULL) {
+    sc_array_destroy (active_queries);
+  }
+}
+
+/* Allocate elements in t8_forest_search_threaded.
+ * The element schemes may allocate from a memory pool that is not thread-safe,
+ * thus we serialize these calls. */
+static void
+t8_forest_search_threaded_element_new (const t8_eclass_scheme_c *ts, const int length, t8_element_t **elems)
+{
+  T8_FOREST_SEARCH_OMP (omp critical (t8_forest_search_elements))
+  ts->t8_element_new (length, elems);
+}
+
+static void
+t8_forest_search_threaded_element_destroy (const t8_eclass_scheme_c *ts, const int length, t8_element_t **elems)
+{
+  T8_FOREST_SEARCH_OMP (omp critical (t8_forest_search_elements))
+  ts->t8_element_destroy (length, elems);
+}
+
+/* The recursion of t8_forest_search_threaded.
+ * This is the same recursion as t8_forest_search_recursion, but the children
+ * of element are searched as new tasks as long as depth < task_depth.
+ * Since the recursion runs concurrently, the active queries are stored in std::vector
+ * and not allocated with the (not thread-safe) libsc allocation functions. */
+static void
+t8_forest_search_threaded_recursion (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_t *element,
+                                     const t8_eclass_scheme_c *ts, t8_element_array_t *leaf_elements,
+                                     const t8_locidx_t tree_lindex_of_first_leaf, t8_forest_search_query_fn search_fn,
+                                     t8_forest_search_query_fn query_fn, sc_array_t *queries,
+                                     const std::vector<size_t> *active_queries, const int depth, const int task_depth)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT ((queries == NULL) == (query_fn == NULL));
+
+  const size_t elem_count = t8_element_array_get_count (leaf_elements);
+  if (elem_count == 0) {
+    /* There are no leaves left, so we have nothing to do */
+    return;
+  }
+  const size_t num_active = queries == NULL ? 0 : active_queries->size ();
+  if (queries != NULL && num_active == 0) {
+    /* There are no queries left. We stop the recursion */
+    return;
+  }
+
+  int is_leaf = 0;
+  if (elem_count == 1) {
+    /* There is only one leaf left, we check whether it is the same as element */
+    const t8_element_t *leaf = t8_element_array_index_locidx (leaf_elements, 0);
+
+    SC_CHECK_ABORT (ts->t8_element_level (element) <= ts->t8_element_level (leaf),
+                    "Search: element level greater than leaf level\n");
+    if (ts->t8_element_level (element) == ts->t8_element_level (leaf)) {
+      T8_ASSERT (ts->t8_element_equal (element, leaf));
+      is_leaf = 1;
+    }
+  }
+  /* The callbacks take a non-const element */
+  t8_element_t *search_element = (t8_element_t *) element;
+  if (!search_fn (forest, ltreeid, search_element, is_leaf, leaf_elements, tree_lindex_of_first_leaf, NULL, NULL,
+                  NULL, 0)) {
+    /* The function returned false. We abort the recursion */
+    return;
+  }
+
+  /* Check the queries and store the ones that match element for its children */
+  std::vector<size_t> new_active_queries;
+  if (num_active > 0) {
+    std::vector<int> active_queries_matches (num_active);
+    sc_array_t active_queries_view;
+    sc_array_init_data (&active_queries_view, (void *) active_queries->data (), sizeof (size_t), num_active);
+    query_fn (forest, ltreeid, search_element, is_leaf, leaf_elements, tree_lindex_of_first_leaf, queries,
+              &active_queries_view, active_queries_matches.data (), num_active);
+    if (is_leaf) {
+      return;
+    }
+    for (size_t iactive = 0; iactive < num_active; iactive++) {
+      if (active_queries_matches[iactive]) {
+        new_active_queries.push_back ((*active_queries)[iactive]);
+      }
+    }
+    if (new_active_queries.empty ()) {
+      /* No queries returned true for this element. We abort the recursion */
+      return;
+    }
+  }
+  if (is_leaf) {
+    return;
+  }
+
+  /* Enter the recursion */
+  const int num_children = ts->t8_element_num_children (element);
+  std::vector<t8_element_t *> children (num_children);
+  std::vector<size_t> split_offsets (num_children + 1);
+  t8_forest_search_threaded_element_new (ts, num_children, children.data ());
+  ts->t8_element_children (element, num_children, children.data ());
+  t8_forest_split_array (element, leaf_elements, split_offsets.data ());
+  const std::vector<size_t> *child_active_queries = &new_active_queries;
+  for (int ichild = 0; ichild < num_children; ichild++) {
+    const size_t indexa = split_offsets[ichild];     /* first leaf of this child */
+    const size_t indexb = split_offsets[ichild + 1]; /* first leaf of next child */
+    if (indexa < indexb) {
+      const t8_element_t *child = children[ichild];
+      /* Spawn a new task for the child if we are not deeper than task_depth.
+       * The children and active queries stay alive until the taskwait below. */
+      T8_FOREST_SEARCH_OMP (omp task if (depth < task_depth) firstprivate (child, indexa, indexb))
+      {
+        t8_element_array_t child_leaves;
+        t8_element_array_init_view (&child_leaves, leaf_elements, indexa, indexb - indexa);
+        t8_forest_search_threaded_recursion (forest, ltreeid, child, ts, &child_leaves,
+                                             indexa + tree_lindex_of_first_leaf, search_fn, query_fn, queries,
+                                             child_active_queries, depth + 1, task_depth);
+      }
+    }
+  }
+  T8_FOREST_SEARCH_OMP (omp taskwait)
+  t8_forest_search_threaded_element_destroy (ts, num_children, children.data ());
+}
+
+void
+t8_forest_search_threaded (t8_forest_t forest, t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
+                           sc_array_t *queries, int num_threads, int task_depth)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT ((queries == NULL) == (query_fn == NULL));
+  T8_ASSERT (task_depth >= 0);
+
+  /* If we have queries build a list of all active queries, thus all queries in the array */
+  std::vector<size_t> active_queries;
+  if (queries != NULL) {
+    active_queries.resize (queries->elem_count);
+    for (size_t iquery = 0; iquery < queries->elem_count; ++iquery) {
+      active_queries[iquery] = iquery;
+    }
+  }
+#ifdef T8_ENABLE_OPENMP
+  if (num_threads <= 0) {
+    num_threads = omp_get_max_threads ();
+  }
+#else
+  num_threads = 1;
+#endif
+
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  /* One thread creates a task for each tree, the other threads steal these tasks
+   * and the subtree tasks created by them. */
+  T8_FOREST_SEARCH_OMP (omp parallel num_threads (num_threads))
+  T8_FOREST_SEARCH_OMP (omp single)
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    T8_FOREST_SEARCH_OMP (omp task firstprivate (itree))
+    {
+      const t8_eclass_t eclass = t8_forest_get_eclass (forest, itree);
+      const t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+      t8_element_array_t *leaf_elements = t8_forest_tree_get_leaves (forest, itree);
+      const size_t num_leaves = t8_element_array_get_count (leaf_elements);
+      if (num_leaves > 0) {
+        /* Start the search at the nearest common ancestor of the tree's leaves */
+        const t8_element_t *first_el = t8_element_array_index_locidx (leaf_elements, 0);
+        const t8_element_t *last_el = t8_element_array_index_locidx (leaf_elements, num_leaves - 1);
+        t8_element_t *nca;
+        t8_forest_search_threaded_element_new (ts, 1, &nca);
+        ts->t8_element_nca (first_el, last_el, nca);
+        t8_forest_search_threaded_recursion (forest, itree, nca, ts, leaf_elements, 0, search_fn, query_fn, queries,
+                                             &active_queries, 0, task_depth);
+        t8_forest_search_threaded_element_destroy (ts, 1, &nca);
+      }
+    }
+  }
+}
+
+/* Scratch memory of t8_forest_search_batched.
+ * All buffers are allocated once per search and reused for every element,
+ * such that the recursion itself does not allocate memory. */
+typedef struct
+{
+  size_t *active;       /* Stack of active query indices. The active queries of an element are stored
+                         * contiguously behind the active queries of its parent. */
+  size_t active_alloc;  /* The number of entries allocated in active. */
+  int *matches;         /* The query matches of the current element, one entry for each query. */
+  t8_element_t **children[T8_ECLASS_COUNT]; /* For each eclass and level L the children of an element of level L. */
+  size_t *split_offsets[T8_ECLASS_COUNT];   /* For each eclass and each level the offsets of the children's leaves. */
+  int max_children[T8_ECLASS_COUNT];        /* For each eclass the maximum number of children of an element. */
+  int num_levels[T8_ECLASS_COUNT];          /* For each eclass the number of levels for which we store children. */
+} t8_forest_search_batch_t;
+
+/* Make sure that the active query stack has room for at least num_entries entries */
+static void
+t8_forest_search_batch_reserve (t8_forest_search_batch_t *batch, const size_t num_entries)
+{
+  if (num_entries > batch->active_alloc) {
+    batch->active_alloc = SC_MAX (2 * batch->active_alloc, num_entries);
+    batch->active = T8_REALLOC (batch->active, size_t, batch->active_alloc);
+  }
+}
+
+/* Allocate the children and split offset buffers for an eclass, if not done yet */
+static void
+t8_forest_search_batch_prepare_eclass (t8_forest_search_batch_t *batch, const t8_eclass_t eclass,
+                                       const t8_eclass_scheme_c *ts)
+{
+  if (batch->children[eclass] != NULL) {
+    return;
+  }
+  /* The root element has the maximum number of children (10 for pyramids, whose children may be tets) */
+  t8_element_t *root;
+  ts->t8_element_new (1, &root);
+  ts->t8_element_root (root);
+  const int max_children = ts->t8_element_num_children (root);
+  ts->t8_element_destroy (1, &root);
+
+  const int num_levels = ts->t8_element_maxlevel () + 1;
+  batch->max_children[eclass] = max_children;
+  batch->num_levels[eclass] = num_levels;
+  batch->children[eclass] = T8_ALLOC (t8_element_t *, num_levels * max_children);
+  ts->t8_element_new (num_levels * max_children, batch->children[eclass]);
+  batch->split_offsets[eclass] = T8_ALLOC (size_t, num_levels * (max_children + 1));
+}
+
+/* The recursion of t8_forest_search_batched.
+ * This is the same recursion as t8_forest_search_recursion, but the active
+ * queries of element are the num_active entries of batch->active starting at active_first
+ * and the children of element are stored in the per level buffers of batch. */
+static void
+t8_forest_search_batch_recursion (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_eclass_t eclass,
+                                  const t8_element_t *element, const t8_eclass_scheme_c *ts,
+                                  t8_element_array_t *leaf_elements, const t8_locidx_t tree_lindex_of_first_leaf,
+                                  t8_forest_search_query_fn search_fn, t8_forest_search_batch_query_fn query_fn,
+                                  sc_array_t *queries, t8_forest_search_batch_t *batch, const size_t active_first,
+                                  const size_t num_active)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT ((queries == NULL) == (query_fn == NULL));
+
+  const size_t elem_count = t8_element_array_get_count (leaf_elements);
+  if (elem_count == 0) {
+    /* There are no leaves left, so we have nothing to do */
+    return;
+  }
+  if (queries != NULL && num_active == 0) {
+    /* There are no queries left. We stop the recursion */
+    return;
+  }
+
+  int is_leaf = 0;
+  if (elem_count == 1) {
+    /* There is only one leaf left, we check whether it is the same as element */
+    const t8_element_t *leaf = t8_element_array_index_locidx (leaf_elements, 0);
+
+    SC_CHECK_ABORT (ts->t8_element_level (element) <= ts->t8_element_level (leaf),
+                    "Search: element level greater than leaf level\n");
+    if (ts->t8_element_level (element) == ts->t8_element_level (leaf)) {
+      T8_ASSERT (ts->t8_element_equal (element, leaf));
+      is_leaf = 1;
+    }
+  }
+  if (!search_fn (forest, ltreeid, element, is_leaf, leaf_elements, tree_lindex_of_first_leaf, NULL, NULL, NULL, 0)) {
+    /* The function returned false. We abort the recursion */
+    return;
+  }
+
+  /* The active queries of the children are stored directly behind our active queries */
+  const size_t new_active_first = active_first + num_active;
+  size_t new_num_active = 0;
+  if (num_active > 0) {
+    query_fn (forest, ltreeid, element, is_leaf, leaf_elements, tree_lindex_of_first_leaf, queries,
+              batch->active + active_first, batch->matches, num_active);
+    if (is_leaf) {
+      return;
+    }
+    t8_forest_search_batch_reserve (batch, new_active_first + num_active);
+    for (size_t iactive = 0; iactive < num_active; iactive++) {
+      if (batch->matches[iactive]) {
+        batch->active[new_active_first + new_num_active] = batch->active[active_first + iactive];
+        new_num_active++;
+      }
+    }
+    if (new_num_active == 0) {
+      /* No queries returned true for this element. We abort the recursion */
+      return;
+    }
+  }
+  if (is_leaf) {
+    return;
+  }
+
+  /* Enter the recursion. The children are stored in the buffer of element's level,
+   * deeper levels of the recursion use different buffers. */
+  const int level = ts->t8_element_level (element);
+  const int num_children = ts->t8_element_num_children (element);
+  const int max_children = batch->max_children[eclass];
+  T8_ASSERT (level < batch->num_levels[eclass]);
+  T8_ASSERT (num_children <= max_children);
+  t8_element_t **children = batch->children[eclass] + level * max_children;
+  size_t *split_offsets = batch->split_offsets[eclass] + level * (max_children + 1);
+  ts->t8_element_children (element, num_children, children);
+  t8_forest_split_array (element, leaf_elements, split_offsets);
+  for (int ichild = 0; ichild < num_children; ichild++) {
+    const size_t indexa = split_offsets[ichild];     /* first leaf of this child */
+    const size_t indexb = split_offsets[ichild + 1]; /* first leaf of next child */
+    if (indexa < indexb) {
+      t8_element_array_t child_leaves;
+      t8_element_array_init_view (&child_leaves, leaf_elements, indexa, indexb - indexa);
+      t8_forest_search_batch_recursion (forest, ltreeid, eclass, children[ichild], ts, &child_leaves,
+                                        indexa + tree_lindex_of_first_leaf, search_fn, query_fn, queries, batch,
+                                        new_active_first, new_num_active);
+    }
+  }
+}
+
+/* A query index together with its tree and sort key */
+typedef struct
+{
+  t8_locidx_t ltreeid;
+  t8_linearidx_t key;
+  size_t index;
+} t8_forest_search_tree_key_index_t;
+
+static int
+t8_forest_search_tree_key_index_compare (const void *a, const void *b)
+{
+  const t8_forest_search_tree_key_index_t *ka = (const t8_forest_search_tree_key_index_t *) a;
+  const t8_forest_search_tree_key_index_t *kb = (const t8_forest_search_tree_key_index_t *) b;
+
+  if (ka->ltreeid != kb->ltreeid) {
+    return ka->ltreeid < kb->ltreeid ? -1 : 1;
+  }
+  if (ka->key != kb->key) {
+    return ka->key < kb->key ? -1 : 1;
+  }
+  /* Keep the input order for queries with equal keys */
+  return ka->index < kb->index ? -1 : ka->index > kb->index;
+}
+
+/* The search of t8_forest_search_batched and t8_forest_search_batched_trees.
+ * If tree_fn is NULL, each tree is searched with all queries. Otherwise, each tree is
+ * only searched with the queries for which tree_fn returns this tree. */
+static void
+t8_forest_search_batched_ext (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                              t8_forest_search_batch_query_fn query_fn, sc_array_t *queries,
+                              t8_forest_search_query_key_fn key_fn, t8_forest_search_query_tree_fn tree_fn)
+{
+  t8_forest_search_batch_t batch;
+  t8_forest_search_tree_key_index_t *keys = NULL;
+  size_t num_queries = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT ((queries == NULL) == (query_fn == NULL));
+  T8_ASSERT (queries != NULL || tree_fn == NULL);
+
+  memset (&batch, 0, sizeof (t8_forest_search_batch_t));
+  if (queries != NULL) {
+    num_queries = queries->elem_count;
+    batch.matches = T8_ALLOC (int, num_queries);
+    t8_forest_search_batch_reserve (&batch, 2 * num_queries);
+    /* Sort the queries by their trees and keys */
+    keys = T8_ALLOC (t8_forest_search_tree_key_index_t, SC_MAX (num_queries, 1));
+    for (size_t iquery = 0; iquery < num_queries; ++iquery) {
+      const void *query = sc_array_index (queries, iquery);
+      keys[iquery].ltreeid = tree_fn != NULL ? tree_fn (forest, query) : 0;
+      keys[iquery].key = key_fn != NULL ? key_fn (forest, query) : 0;
+      keys[iquery].index = iquery;
+    }
+    if (key_fn != NULL || tree_fn != NULL) {
+      qsort (keys, num_queries, sizeof (t8_forest_search_tree_key_index_t),
+             t8_forest_search_tree_key_index_compare);
+    }
+  }
+
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  t8_element_t *nca[T8_ECLASS_COUNT] = { NULL };
+  size_t first_query = 0;
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    /* Find the queries of this tree. Since the keys are sorted by tree, they are
+     * the entries starting at first_query. */
+    size_t num_tree_queries = num_queries;
+    if (tree_fn != NULL) {
+      while (first_query < num_queries && keys[first_query].ltreeid < itree) {
+        first_query++;
+      }
+      num_tree_queries = 0;
+      while (first_query + num_tree_queries < num_queries && keys[first_query + num_tree_queries].ltreeid == itree) {
+        num_tree_queries++;
+      }
+      if (num_tree_queries == 0) {
+        /* No query is searched in this tree */
+        continue;
+      }
+    }
+    const t8_eclass_t eclass = t8_forest_get_eclass (forest, itree);
+    const t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+    t8_element_array_t *leaf_elements = t8_forest_tree_get_leaves (forest, itree);
+    const size_t num_leaves = t8_element_array_get_count (leaf_elements);
+    if (num_leaves == 0) {
+      continue;
+    }
+    /* The active queries of the tree are the first entries of the active stack.
+     * The recursion stores the active queries of the children behind them. */
+    for (size_t iquery = 0; iquery < num_tree_queries; ++iquery) {
+      batch.active[iquery] = keys[first_query + iquery].index;
+    }
+    t8_forest_search_batch_prepare_eclass (&batch, eclass, ts);
+    if (nca[eclass] == NULL) {
+      ts->t8_element_new (1, &nca[eclass]);
+    }
+    /* Start the search at the nearest common ancestor of the tree's leaves */
+    const t8_element_t *first_el = t8_element_array_index_locidx (leaf_elements, 0);
+    const t8_element_t *last_el = t8_element_array_index_locidx (leaf_elements, num_leaves - 1);
+    ts->t8_element_nca (first_el, last_el, nca[eclass]);
+    t8_forest_search_batch_recursion (forest, itree, eclass, nca[eclass], ts, leaf_elements, 0, search_fn, query_fn,
+                                      queries, &batch, 0, num_tree_queries);
+  }
+
+  /* clean-up */
+  for (int ieclass = T8_ECLASS_ZERO; ieclass < T8_ECLASS_COUNT; ieclass++) {
+    if (batch.children[ieclass] != NULL) {
+      const t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, (t8_eclass_t) ieclass);
+      ts->t8_element_destroy (batch.num_levels[ieclass] * batch.max_children[ieclass], batch.children[ieclass]);
+      T8_FREE (batch.children[ieclass]);
+      T8_FREE (batch.split_offsets[ieclass]);
+      ts->t8_element_destroy (1, &nca[ieclass]);
+    }
+  }
+  T8_FREE (keys);
+  T8_FREE (batch.active);
+  T8_FREE (batch.matches);
+}
+
+void
+t8_forest_search_batched (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                          t8_forest_search_batch_query_fn query_fn, sc_array_t *queries,
+                          t8_forest_search_query_key_fn key_fn)
+{
+  t8_forest_search_batched_ext (forest, search_fn, query_fn, queries, key_fn, NULL);
+}
+
+void
+t8_forest_search_batched_trees (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                                t8_forest_search_batch_query_fn query_fn, sc_array_t *queries,
+                                t8_forest_search_query_key_fn key_fn, t8_forest_search_query_tree_fn tree_fn)
+{
+  T8_ASSERT (queries != NULL && tree_fn != NULL);
+  t8_forest_search_batched_ext (forest, search_fn, query_fn, queries, key_fn, tree_fn);
+}
+
+t8_linearidx_t
+t8_forest_search_morton_key (const double coords[3], const double lower[3], const double upper[3])
+{
+  const int bits = 21;
+  const t8_linearidx_t max_coord = ((t8_linearidx_t) 1 << bits) - 1;
+  t8_linearidx_t key = 0;
+
+  for (int idim = 0; idim < 3; idim++) {
+    /* Scale the coordinate to [0, max_coord] */
+    const double extent = upper[idim] - lower[idim];
+    double scaled = extent > 0 ? (coords[idim] - lower[idim]) / extent : 0;
+    scaled = SC_MIN (SC_MAX (scaled, 0), 1);
+    const t8_linearidx_t icoord = (t8_linearidx_t) (scaled * max_coord);
+    /* Interleave the bits of the coordinate into the key */
+    for (int ibit = 0; ibit < bits; ibit++) {
+      key |= ((icoord >> ibit) & 1) << (3 * ibit + idim);
+    }
+  }
+  return key;
+}
+
+/* The state of t8_forest_iterate_interior_faces in one local tree */
+typedef struct
+{
+  t8_forest_t forest;
+  t8_locidx_t ltreeid;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t tree_offset;      /* The local index of the tree's first leaf */
+  int tree_is_complete;         /* True if all leaves of the tree are local */
+  t8_linearidx_t first_desc_id; /* The linear id of the first local descendant at the maximum level */
+  t8_linearidx_t last_desc_id;  /* The linear id of the last local descendant at the maximum level */
+  t8_element_t *desc;           /* Scratch element for the descendants */
+  const t8_forest_face_side_t *coarse_side; /* The coarse side of a hanging face while its finer leaves are visited */
+  t8_forest_iterate_interior_face_fn face_fn;
+  void *user_data;
+} t8_forest_iterate_interior_t;
+
+/* Return true if all descendants of element are covered by the local leaves of the tree */
+static int
+t8_forest_iterate_interior_is_local (const t8_forest_iterate_interior_t *iter, const t8_element_t *element)
+{
+  const t8_eclass_scheme_c *ts = iter->ts;
+  const int maxlevel = ts->t8_element_maxlevel ();
+
+  if (iter->tree_is_complete) {
+    return 1;
+  }
+  ts->t8_element_first_descendant (element, iter->desc, maxlevel);
+  if (ts->t8_element_get_linear_id (iter->desc, maxlevel) < iter->first_desc_id) {
+    return 0;
+  }
+  ts->t8_element_last_descendant (element, iter->desc, maxlevel);
+  return ts->t8_element_get_linear_id (iter->desc, maxlevel) <= iter->last_desc_id;
+}
+
+static void
+t8_forest_iterate_interior_set_side (const t8_forest_iterate_interior_t *iter, t8_forest_face_side_t *side,
+                                     const t8_element_t *leaf, const t8_locidx_t tree_leaf_index, const int face)
+{
+  side->ltreeid = iter->ltreeid;
+  side->element = leaf;
+  side->ts = iter->ts;
+  side->element_index = iter->tree_offset + tree_leaf_index;
+  side->face = face;
+  side->is_ghost = 0;
+}
+
+/* Face callback of t8_forest_iterate_faces that passes each finer leaf at a hanging face
+ * together with the coarse leaf to the face callback */
+static int
+t8_forest_iterate_interior_hanging (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *element, int face,
+                                    void *user_data, t8_locidx_t tree_leaf_index)
+{
+  const t8_forest_iterate_interior_t *iter = (const t8_forest_iterate_interior_t *) user_data;
+  t8_forest_face_side_t sides[2];
+
+  if (tree_leaf_index >= 0) {
+    t8_forest_iterate_interior_set_side (iter, &sides[0], element, tree_leaf_index, face);
+    sides[1] = *iter->coarse_side;
+    iter->face_fn (forest, sides, 0, 1, iter->user_data);
+  }
+  return 1;
+}
+
+/* Visit all leaf faces between the elements elements[0] and elements[1] of the same level,
+ * which are face neighbors across faces[0] and faces[1] in the same tree.
+ * leaves[i] are the local leaves of elements[i] and first_leaf[i] is the tree index of the first of them. */
+static void
+t8_forest_iterate_interior_face_recursion (t8_forest_iterate_interior_t *iter, const t8_element_t *elements[2],
+                                           const int faces[2], t8_element_array_t *leaves[2],
+                                           const t8_locidx_t first_leaf[2])
+{
+  const t8_eclass_scheme_c *ts = iter->ts;
+  int is_leaf[2];
+
+  for (int iside = 0; iside < 2; iside++) {
+    T8_ASSERT (t8_element_array_get_count (leaves[iside]) > 0);
+    is_leaf[iside] = t8_element_array_get_count (leaves[iside]) == 1
+                     && ts->t8_element_level (t8_element_array_index_locidx (leaves[iside], 0))
+                          == ts->t8_element_level (elements[iside]);
+  }
+  if (is_leaf[0] && is_leaf[1]) {
+    /* A conforming face. The leaf with the smaller index is the first side. */
+    t8_forest_face_side_t sides[2];
+    const int first = first_leaf[0] < first_leaf[1] ? 0 : 1;
+    t8_forest_iterate_interior_set_side (iter, &sides[0], t8_element_array_index_locidx (leaves[first], 0),
+                                         first_leaf[first], faces[first]);
+    t8_forest_iterate_interior_set_side (iter, &sides[1], t8_element_array_index_locidx (leaves[1 - first], 0),
+                                         first_leaf[1 - first], faces[1 - first]);
+    iter->face_fn (iter->forest, sides, 0, 0, iter->user_data);
+    return;
+  }
+  if (is_leaf[0] || is_leaf[1]) {
+    /* A hanging face. We visit the finer leaves at the face of the other element. */
+    const int coarse = is_leaf[0] ? 0 : 1;
+    t8_forest_face_side_t coarse_side;
+    t8_forest_iterate_interior_set_side (iter, &coarse_side, t8_element_array_index_locidx (leaves[coarse], 0),
+                                         first_leaf[coarse], faces[coarse]);
+    iter->coarse_side = &coarse_side;
+    t8_forest_iterate_faces (iter->forest, iter->ltreeid, elements[1 - coarse], faces[1 - coarse], leaves[1 - coarse],
+                             iter, first_leaf[1 - coarse], t8_forest_iterate_interior_hanging);
+    iter->coarse_side = NULL;
+    return;
+  }
+
+  /* Both elements are refined. We pair each face child of the first element with its
+   * face neighbor, which is a child of the second element. */
+  const int num_face_children = ts->t8_element_num_face_children (elements[0], faces[0]);
+  t8_element_t **face_children = T8_ALLOC (t8_element_t *, num_face_children);
+  t8_element_t *neigh;
+  size_t *split_offsets[2];
+  ts->t8_element_new (num_face_children, face_children);
+  ts->t8_element_new (1, &neigh);
+  ts->t8_element_children_at_face (elements[0], faces[0], face_children, num_face_children, NULL);
+  for (int iside = 0; iside < 2; iside++) {
+    split_offsets[iside] = T8_ALLOC (size_t, ts->t8_element_num_children (elements[iside]) + 1);
+    t8_forest_split_array (elements[iside], leaves[iside], split_offsets[iside]);
+  }
+  for (int ichild = 0; ichild < num_face_children; ichild++) {
+    const t8_element_t *child_elements[2];
+    t8_element_array_t child_leaves[2];
+    t8_element_array_t *child_leaves_ptr[2] = { &child_leaves[0], &child_leaves[1] };
+    t8_locidx_t child_first_leaf[2];
+    int child_faces[2], child_ids[2];
+
+    child_elements[0] = face_children[ichild];
+    child_elements[1] = neigh;
+    child_faces[0] = ts->t8_element_face_child_face (elements[0], faces[0], ichild);
+    const int inside
+      = ts->t8_element_face_neighbor_inside (face_children[ichild], neigh, child_faces[0], child_faces + 1);
+    T8_ASSERT (inside);
+    (void) inside;
+    child_ids[0] = ts->t8_element_child_id (face_children[ichild]);
+    child_ids[1] = ts->t8_element_child_id (neigh);
+    for (int iside = 0; iside < 2; iside++) {
+      const size_t indexa = split_offsets[iside][child_ids[iside]];
+      const size_t indexb = split_offsets[iside][child_ids[iside] + 1];
+      T8_ASSERT (indexa < indexb);
+      t8_element_array_init_view (&child_leaves[iside], leaves[iside], indexa, indexb - indexa);
+      child_first_leaf[iside] = first_leaf[iside] + indexa;
+    }
+    t8_forest_iterate_interior_face_recursion (iter, child_elements, child_faces, child_leaves_ptr, child_first_leaf);
+  }
+  ts->t8_element_destroy (num_face_children, face_children);
+  ts->t8_element_destroy (1, &neigh);
+  T8_FREE (face_children);
+  T8_FREE (split_offsets[0]);
+  T8_FREE (split_offsets[1]);
+}
+
+/* Visit the faces between the leaves of element. For each pair of children of element that
+ * share a face, the faces between their leaves are visited if both children are covered by local leaves. */
+static void
+t8_forest_iterate_interior_volume_recursion (t8_forest_iterate_interior_t *iter, const t8_element_t *element,
+                                             t8_element_array_t *leaves, const t8_locidx_t first_leaf)
+{
+  const t8_eclass_scheme_c *ts = iter->ts;
+  const size_t num_leaves = t8_element_array_get_count (leaves);
+
+  if (num_leaves == 0
+      || (num_leaves == 1
+          && ts->t8_element_level (t8_element_array_index_locidx (leaves, 0)) == ts->t8_element_level (element))) {
+    /* There are no faces between leaves in element */
+    return;
+  }
+
+  const int num_children = ts->t8_element_num_children (element);
+  t8_element_t **children = T8_ALLOC (t8_element_t *, num_children);
+  t8_element_array_t *child_leaves = T8_ALLOC (t8_element_array_t, num_children);
+  size_t *split_offsets = T8_ALLOC (size_t, num_children + 1);
+  t8_element_t *neigh, *parent;
+  ts->t8_element_new (num_children, children);
+  ts->t8_element_new (1, &neigh);
+  ts->t8_element_new (1, &parent);
+  ts->t8_element_children (element, num_children, children);
+  t8_forest_split_array (element, leaves, split_offsets);
+  for (int ichild = 0; ichild < num_children; ichild++) {
+    t8_element_array_init_view (&child_leaves[ichild], leaves, split_offsets[ichild],
+                                split_offsets[ichild + 1] - split_offsets[ichild]);
+    t8_forest_iterate_interior_volume_recursion (iter, children[ichild], &child_leaves[ichild],
+                                                 first_leaf + split_offsets[ichild]);
+  }
+
+  /* Visit the faces between the children */
+  for (int ichild = 0; ichild < num_children; ichild++) {
+    if (split_offsets[ichild] == split_offsets[ichild + 1]
+        || !t8_forest_iterate_interior_is_local (iter, children[ichild])) {
+      continue;
+    }
+    const int num_faces = ts->t8_element_num_faces (children[ichild]);
+    for (int iface = 0; iface < num_faces; iface++) {
+      int neigh_face;
+      if (!ts->t8_element_face_neighbor_inside (children[ichild], neigh, iface, &neigh_face)) {
+        continue;
+      }
+      ts->t8_element_parent (neigh, parent);
+      const int neigh_child = ts->t8_element_child_id (neigh);
+      /* Visit each pair of siblings from the child with the smaller id */
+      if (!ts->t8_element_equal (parent, element) || neigh_child < ichild
+          || split_offsets[neigh_child] == split_offsets[neigh_child + 1]
+          || !t8_forest_iterate_interior_is_local (iter, children[neigh_child])) {
+        continue;
+      }
+      const t8_element_t *pair_elements[2] = { children[ichild], children[neigh_child] };
+      const int pair_faces[2] = { iface, neigh_face };
+      t8_element_array_t *pair_leaves[2] = { &child_leaves[ichild], &child_leaves[neigh_child] };
+      const t8_locidx_t pair_first_leaf[2]
+        = { first_leaf + (t8_locidx_t) split_offsets[ichild], first_leaf + (t8_locidx_t) split_offsets[neigh_child] };
+      t8_forest_iterate_interior_face_recursion (iter, pair_elements, pair_faces, pair_leaves, pair_first_leaf);
+    }
+  }
+
+  ts->t8_element_destroy (num_children, children);
+  ts->t8_element_destroy (1, &neigh);
+  ts->t8_element_destroy (1, &parent);
+  T8_FREE (children);
+  T8_FREE (child_leaves);
+  T8_FREE (split_offsets);
+}
+
+/* Return true if the face of a leaf was visited by the recursion of t8_forest_iterate_interior_faces.
+ * This is the case if the face is inside the tree and the two children of the nearest common ancestor
+ * of leaf and its face neighbor, which contain leaf and the neighbor, are covered by local leaves. */
+static int
+t8_forest_iterate_interior_visited (const t8_forest_iterate_interior_t *iter, const t8_element_t *leaf, const int face,
+                                    t8_element_t *scratch[3])
+{
+  const t8_eclass_scheme_c *ts = iter->ts;
+  t8_element_t *neigh = scratch[0];
+  t8_element_t *nca = scratch[1];
+  t8_element_t *ancestor = scratch[2];
+  int neigh_face;
+
+  if (ts->t8_element_is_root_boundary (leaf, face)
+      || !ts->t8_element_face_neighbor_inside (leaf, neigh, face, &neigh_face)) {
+    return 0;
+  }
+  if (iter->tree_is_complete) {
+    return 1;
+  }
+  ts->t8_element_nca (leaf, neigh, nca);
+  const int child_level = ts->t8_element_level (nca) + 1;
+  ts->t8_element_copy (leaf, ancestor);
+  while (ts->t8_element_level (ancestor) > child_level) {
+    ts->t8_element_parent (ancestor, ancestor);
+  }
+  if (!t8_forest_iterate_interior_is_local (iter, ancestor)) {
+    return 0;
+  }
+  ts->t8_element_copy (neigh, ancestor);
+  while (ts->t8_element_level (ancestor) > child_level) {
+    ts->t8_element_parent (ancestor, ancestor);
+  }
+  return t8_forest_iterate_interior_is_local (iter, ancestor);
+}
+
+void
+t8_forest_iterate_interior_faces (t8_forest_t forest, int forest_is_balanced,
+                                  t8_forest_iterate_interior_face_fn face_fn, void *user_data)
+{
+  t8_locidx_t num_local_trees, num_local_elements, itree, ielem, num_tree_elements;
+  t8_locidx_t element_index, neigh_index, lneigh_treeid, lghost_neigh_treeid;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t **neighbor_leaves, *scratch[3];
+  const t8_element_t *leaf;
+  t8_locidx_t *element_indices;
+  t8_gloidx_t gneigh_treeid;
+  t8_forest_face_side_t sides[2], *leaf_side, *neigh_side;
+  t8_forest_iterate_interior_t iter;
+  int *dual_faces;
+  int num_faces, iface, num_neighbors, ineigh;
+  int level, neigh_level, orientation;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL,
+                  "Ghost structure is needed for t8_forest_iterate_interior_faces "
+                  "but was not found in forest.\n");
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  iter.forest = forest;
+  iter.face_fn = face_fn;
+  iter.user_data = user_data;
+  iter.coarse_side = NULL;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    if (num_tree_elements == 0) {
+      continue;
+    }
+    t8_element_array_t *leaves = t8_forest_tree_get_leaves (forest, itree);
+    const t8_element_t *first_leaf = t8_element_array_index_locidx (leaves, 0);
+    const t8_element_t *last_leaf = t8_element_array_index_locidx (leaves, num_tree_elements - 1);
+    const int maxlevel = ts->t8_element_maxlevel ();
+    t8_element_t *root;
+
+    /* Find the range of the local leaves in the tree */
+    iter.ltreeid = itree;
+    iter.ts = ts;
+    iter.tree_offset = t8_forest_get_tree_element_offset (forest, itree);
+    ts->t8_element_new (1, &iter.desc);
+    ts->t8_element_new (1, &root);
+    ts->t8_element_new (3, scratch);
+    ts->t8_element_first_descendant (first_leaf, iter.desc, maxlevel);
+    iter.first_desc_id = ts->t8_element_get_linear_id (iter.desc, maxlevel);
+    ts->t8_element_last_descendant (last_leaf, iter.desc, maxlevel);
+    iter.last_desc_id = ts->t8_element_get_linear_id (iter.desc, maxlevel);
+    ts->t8_element_root (root);
+    ts->t8_element_first_descendant (root, iter.desc, maxlevel);
+    iter.tree_is_complete = ts->t8_element_get_linear_id (iter.desc, maxlevel) == iter.first_desc_id;
+    ts->t8_element_last_descendant (root, iter.desc, maxlevel);
+    iter.tree_is_complete
+      = iter.tree_is_complete && ts->t8_element_get_linear_id (iter.desc, maxlevel) == iter.last_desc_id;
+
+    /* Visit the faces between local leaves of this tree top-down, starting at
+     * the nearest common ancestor of the local leaves */
+    ts->t8_element_nca (first_leaf, last_leaf, root);
+    t8_forest_iterate_interior_volume_recursion (&iter, root, leaves, 0);
+
+    /* Visit the remaining faces, which are at the tree boundary or at the boundary of the local leaves.
+     * Their neighbors are searched leaf by leaf. */
+    for (ielem = 0; ielem < num_tree_elements; ielem++) {
+      leaf = t8_element_array_index_locidx (leaves, ielem);
+      element_index = iter.tree_offset + ielem;
+      level = ts->t8_element_level (leaf);
+      num_faces = ts->t8_element_num_faces (leaf);
+      for (iface = 0; iface < num_faces; iface++) {
+        if (t8_forest_iterate_interior_visited (&iter, leaf, iface, scratch)) {
+          continue;
+        }
+        t8_forest_leaf_face_neighbors_ext (forest, itree, leaf, &neighbor_leaves, iface, &dual_faces, &num_neighbors,
+                                           &element_indices, &neigh_scheme, forest_is_balanced, &gneigh_treeid);
+        if (num_neighbors == 0) {
+          /* This is a boundary face */
+          continue;
+        }
+        orientation = t8_forest_leaf_face_orientation (forest, itree, ts, leaf, iface);
+        lneigh_treeid = t8_forest_get_local_id (forest, gneigh_treeid);
+        lghost_neigh_treeid = -1;
+        for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+          neigh_index = element_indices[ineigh];
+          neigh_level = neigh_scheme->t8_element_level (neighbor_leaves[ineigh]);
+          if (neigh_index < num_local_elements) {
+            /* A face between two local leaves is visited from the finer leaf or,
+             * if both have the same level, from the leaf with the smaller index. */
+            if (neigh_level > level
+                || (neigh_level == level
+                    && (neigh_index < element_index || (neigh_index == element_index && dual_faces[ineigh] < iface)))) {
+              continue;
+            }
+          }
+          else if (lghost_neigh_treeid < 0) {
+            lghost_neigh_treeid = num_local_trees + t8_forest_ghost_get_ghost_treeid (forest, gneigh_treeid);
+          }
+          /* The finer leaf is the first side */
+          leaf_side = neigh_level > level ? &sides[1] : &sides[0];
+          neigh_side = neigh_level > level ? &sides[0] : &sides[1];
+          leaf_side->ltreeid = itree;
+          leaf_side->element = leaf;
+          leaf_side->ts = ts;
+          leaf_side->element_index = element_index;
+          leaf_side->face = iface;
+          leaf_side->is_ghost = 0;
+          neigh_side->is_ghost = neigh_index >= num_local_elements;
+          neigh_side->ltreeid = neigh_side->is_ghost ? lghost_neigh_treeid : lneigh_treeid;
+          neigh_side->element = neighbor_leaves[ineigh];
+          neigh_side->ts = neigh_scheme;
+          neigh_side->element_index = neigh_index;
+          neigh_side->face = dual_faces[ineigh];
+          face_fn (forest, sides, orientation, neigh_level != level, user_data);
+        }
+        neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leaves);
+        T8_FREE (neighbor_leaves);
+        T8_FREE (element_indices);
+        T8_FREE (dual_faces);
+      }
+    }
+    ts->t8_element_destroy (1, &iter.desc);
+    ts->t8_element_destroy (1, &root);
+    ts->t8_element_destroy (3, scratch);
+  }
+}
+
 void
 t8_forest_iterate_replace (t8_forest_t forest_new, t8_forest_t forest_old, t8_forest_replace_t replace_fn)
 {
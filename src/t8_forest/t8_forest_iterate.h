@@ -59,6 +59,73 @@ typedef int (*t8_forest_search_query_fn) (t8_forest_t forest, const t8_locidx_t
                                           const t8_locidx_t tree_leaf_index, void *query, sc_array_t *query_indices,
                                           int *query_matches, const size_t num_active_queries);
 
+/*
+ * Query callback of \ref t8_forest_search_batched.
+ * In contrast to \ref t8_forest_search_query_fn the active queries are passed
+ * as a contiguous array of query indices, sorted by the key of the queries.
+ * \param[in] forest              the forest
+ * \param[in] ltreeid             the local tree id of the current tree
+ * \param[in] element             the element for which the queries are executed
+ * \param[in] is_leaf             true if and only if \a element is a leaf element
+ * \param[in] leaf_elements       the leaf elements in \a forest that are descendants of \a element (or the element
+ *                                itself if \a is_leaf is true)
+ * \param[in] tree_leaf_index     the local index of the first leaf in \a leaf_elements
+ * \param[in] queries             the queries array that was passed to \ref t8_forest_search_batched
+ * \param[in] query_indices       the indices into \a queries of the \a num_active_queries active queries
+ * \param[out] query_matches      on output, true at the i-th index if and only if \a element matches the
+ *                                query with index \a query_indices[i]
+ * \param[in] num_active_queries  the number of active queries
+ */
+typedef void (*t8_forest_search_batch_query_fn) (t8_forest_t forest, const t8_locidx_t ltreeid,
+                                                 const t8_element_t *element, const int is_leaf,
+                                                 const t8_element_array_t *leaf_elements,
+                                                 const t8_locidx_t tree_leaf_index, sc_array_t *queries,
+                                                 const size_t *query_indices, int *query_matches,
+                                                 const size_t num_active_queries);
+
+/*
+ * Compute a sort key for a query of \ref t8_forest_search_batched.
+ * Queries with close keys should be likely to match the same elements,
+ * for example the Morton index of a point query, see \ref t8_forest_search_morton_key.
+ * \param[in] forest              the forest
+ * \param[in] query               a pointer to the query
+ * \return                        the sort key of \a query
+ */
+typedef t8_linearidx_t (*t8_forest_search_query_key_fn) (t8_forest_t forest, const void *query);
+
+/*
+ * Select the tree of a query of \ref t8_forest_search_batched_trees.
+ * \param[in] forest              the forest
+ * \param[in] query               a pointer to the query
+ * \return                        the local tree id of the tree in which \a query is searched,
+ *                                or -1 if the query is not searched at all
+ */
+typedef t8_locidx_t (*t8_forest_search_query_tree_fn) (t8_forest_t forest, const void *query);
+
+/** One side of a face in \ref t8_forest_iterate_interior_faces. */
+typedef struct
+{
+  t8_locidx_t ltreeid;         /**< The local tree id, or num_local_trees + lghost_tree for ghosts. */
+  const t8_element_t *element; /**< The leaf element on this side. */
+  t8_eclass_scheme_c *ts;      /**< The eclass scheme of \a element. */
+  t8_locidx_t element_index;   /**< The local index of the leaf, or num_local_elements + ghost index for ghosts. */
+  int face;                    /**< The face of \a element at the connection. */
+  int is_ghost;                /**< True if \a element is a ghost. */
+} t8_forest_face_side_t;
+
+/*
+ * Callback for \ref t8_forest_iterate_interior_faces.
+ * \param[in] forest              the forest
+ * \param[in] sides               the two sides of the face. If the face is hanging,
+ *                                sides[0] is the finer and sides[1] the coarser side.
+ * \param[in] orientation         the orientation of the tree connection across the face,
+ *                                0 if both sides are in the same tree
+ * \param[in] is_hanging          true if the leaves have different levels
+ * \param[in] user_data           the user data passed to \ref t8_forest_iterate_interior_faces
+ */
+typedef void (*t8_forest_iterate_interior_face_fn) (t8_forest_t forest, const t8_forest_face_side_t sides[2],
+                                                    int orientation, int is_hanging, void *user_data);
+
 T8_EXTERN_C_BEGIN ();
 
 /* TODO: Document */
@@ -73,6 +140,7 @@ t8_forest_split_array (const t8_element_t *element, t8_element_array_t *leaf_ele
  * - (index + 1) */
 /* Top-down iteration and callback is called on each intermediate level.
  * If it returns false, the current element is not traversed further */
+/* ltreeid may also be a ghost tree id, num_local_trees + lghost_tree. */
 void
 t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *element, int face,
                          t8_element_array_t *leaf_elements, void *user_data, t8_locidx_t tree_lindex_of_first_leaf,
@@ -88,6 +156,125 @@ void
 t8_forest_search (t8_forest_t forest, t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
                   sc_array_t *queries);
 
+/** Perform a top-down search of those local trees of the forest that may contain a point.
+ * This is the same search as \ref t8_forest_search, but only the trees whose
+ * bounding box contains \a point are searched. The candidate trees are found with
+ * \ref t8_cmesh_locate_candidate_trees, which caches a bucket grid of the tree
+ * bounding boxes on the cmesh. Use this for point location in forests with many trees.
+ * \param[in] forest     the forest
+ * \param[in] point      the coordinates of the point
+ * \param[in] tolerance  the tree bounding boxes are enlarged by \a tolerance in each direction
+ * \param[in] search_fn  the search callback, see \ref t8_forest_search
+ * \param[in] query_fn   the query callback, see \ref t8_forest_search
+ * \param[in] queries    an array of queries
+ */
+void
+t8_forest_search_point_candidates (t8_forest_t forest, const double point[3], const double tolerance,
+                                   t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
+                                   sc_array_t *queries);
+
+/** Perform a top-down search of the ghost elements of the forest.
+ * This is the same search as \ref t8_forest_search, but over each ghost tree's
+ * element array instead of the local trees.
+ * The callbacks are called with the same arguments as in \ref t8_forest_search, except that
+ * \a ltreeid is num_local_trees + lghost_tree for the ghost tree lghost_tree and
+ * \a tree_leaf_index is the index of the leaf in \ref t8_forest_ghost_get_tree_elements.
+ * The local ghost index of a leaf is thus
+ * t8_forest_ghost_get_tree_element_offset (forest, lghost_tree) + \a tree_leaf_index.
+ * \param[in] forest     the forest. If it has no ghost layer, nothing is done.
+ * \param[in] search_fn  the search callback, see \ref t8_forest_search
+ * \param[in] query_fn   the query callback, see \ref t8_forest_search
+ * \param[in] queries    an array of queries
+ */
+void
+t8_forest_search_ghosts (t8_forest_t forest, t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
+                         sc_array_t *queries);
+
+/** Perform a top-down search of the forest for many queries at once.
+ * This is equivalent to \ref t8_forest_search, but optimized for large numbers of queries.
+ * The queries are sorted by \a key_fn such that queries that match the same
+ * elements are processed together, and all memory needed for the active queries,
+ * children and leaf splitting is allocated once per search instead of once per element.
+ * \param[in] forest     the forest
+ * \param[in] search_fn  the search callback, called on each element before the queries
+ * \param[in] query_fn   the query callback, called with the active queries of each element
+ * \param[in] queries    an array of queries
+ * \param[in] key_fn     if not NULL, the queries are processed in the order of their keys.
+ *                       If NULL, they are processed in the order of \a queries.
+ */
+void
+t8_forest_search_batched (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                          t8_forest_search_batch_query_fn query_fn, sc_array_t *queries,
+                          t8_forest_search_query_key_fn key_fn);
+
+/** Perform a top-down search of the forest for many queries, each restricted to one tree.
+ * This is the same search as \ref t8_forest_search_batched, but each tree is only searched
+ * with the queries for which \a tree_fn returns this tree, and trees without queries are skipped.
+ * To search a point in several candidate trees, add one query per candidate tree.
+ * \param[in] forest     the forest
+ * \param[in] search_fn  the search callback, called on each element before the queries
+ * \param[in] query_fn   the query callback, called with the active queries of each element
+ * \param[in] queries    an array of queries
+ * \param[in] key_fn     if not NULL, the queries of a tree are processed in the order of their keys.
+ *                       If NULL, they are processed in the order of \a queries.
+ * \param[in] tree_fn    returns the local tree in which a query is searched
+ */
+void
+t8_forest_search_batched_trees (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                                t8_forest_search_batch_query_fn query_fn, sc_array_t *queries,
+                                t8_forest_search_query_key_fn key_fn, t8_forest_search_query_tree_fn tree_fn);
+
+/** Perform a top-down search of the forest with multiple threads.
+ * This is equivalent to \ref t8_forest_search, but the local trees and the subtrees
+ * of the search are processed in parallel as tasks.
+ * The order in which elements are visited is unspecified, only the parent of an element
+ * is guaranteed to be visited before the element itself.
+ * \param[in] forest      the forest
+ * \param[in] search_fn   the search callback, see \ref t8_forest_search
+ * \param[in] query_fn    the query callback, see \ref t8_forest_search
+ * \param[in] queries     an array of queries
+ * \param[in] num_threads the number of threads to use. If <= 0, the default number of threads is used.
+ * \param[in] task_depth  subtrees up to this depth below the root of each tree's search
+ *                        are spawned as separate tasks, deeper subtrees are searched by the
+ *                        thread that reached them. 0 creates one task per tree.
+ * \note \a search_fn and \a query_fn are called concurrently and must be thread-safe.
+ * \note If t8code is not configured with OpenMP, the search is performed serially.
+ */
+void
+t8_forest_search_threaded (t8_forest_t forest, t8_forest_search_query_fn search_fn, t8_forest_search_query_fn query_fn,
+                           sc_array_t *queries, int num_threads, int task_depth);
+
+/** Compute the Morton index of a point inside a bounding box.
+ * This can be used as a sort key for point queries in \ref t8_forest_search_batched.
+ * \param[in] coords     the coordinates of the point
+ * \param[in] lower      the lower corner of the bounding box
+ * \param[in] upper      the upper corner of the bounding box
+ * \return               the Morton index of \a coords with 21 bits per coordinate.
+ *                       Points outside the bounding box are clamped to its boundary.
+ */
+t8_linearidx_t
+t8_forest_search_morton_key (const double coords[3], const double lower[3], const double upper[3]);
+
+/** Iterate over all interior faces of the local leaves of a forest.
+ * Each face between a local leaf and a local or ghost leaf is passed exactly once to \a face_fn,
+ * together with both sides.
+ * The faces between local leaves of the same tree are found in a top-down traversal of the tree,
+ * which pairs neighboring subtrees and needs no neighbor search. Only the faces at tree boundaries
+ * and at the boundary of the local partition are found by searching the leaf face neighbors.
+ * A hanging face is passed once for each finer leaf at it, paired with the coarser leaf.
+ * Faces at the domain boundary are not visited.
+ * Faces between a local leaf and a ghost are visited on both processes that own one of the leaves.
+ * \param[in] forest     A committed forest. If it is distributed, it must have a ghost layer.
+ * \param[in] forest_is_balanced True if \a forest is known to be balanced,
+ *                       see \ref t8_forest_leaf_face_neighbors.
+ * \param[in] face_fn    The callback that is called for each face.
+ * \param[in] user_data  Passed to \a face_fn.
+ * \note The element pointers of the sides are only valid during the call of \a face_fn.
+ */
+void
+t8_forest_iterate_interior_faces (t8_forest_t forest, int forest_is_balanced,
+                                  t8_forest_iterate_interior_face_fn face_fn, void *user_data);
+
 /** Given two forest where the elements in one forest are either direct children or
  * parents of the elements in the other forest
  * compare the two forests and for each refined element or coarsened
@@ -0,0 +1,579 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest/t8_forest_locate.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_geometrical.h>
+#include <t8_cmesh/t8_cmesh_locate.h>
+#include <t8_geometry/t8_geometry.h>
+#include <t8_element_cxx.hxx>
+#include <sc_notify.h>
+#include <unordered_map>
+#include <utility>
+
+T8_EXTERN_C_BEGIN ();
+
+/* The relative margin by which the bounding box of leaves with non-linear geometry is enlarged */
+#define T8_FOREST_LOCATE_CURVED_MARGIN 0.05
+
+/* A point that is sent to a candidate process */
+typedef struct
+{
+  double coords[3];    /* The coordinates of the point */
+  t8_gloidx_t gtreeid; /* The candidate tree of the point, or -1 if the receiver finds the candidate trees */
+} t8_forest_locate_point_t;
+
+/* A point that is searched for in one local tree on this process */
+typedef struct
+{
+  double coords[3];     /* The coordinates of the point */
+  double tolerance;     /* The tolerance for the point inside check */
+  t8_linearidx_t key;   /* The Morton index of the point, used to sort the queries */
+  t8_locidx_t ltreeid;  /* The local tree in which the point is searched */
+  int recv_index;       /* The index of the received point that this query belongs to */
+  t8_gloidx_t element;  /* The global index of the leaf containing the point, or -1 */
+} t8_forest_locate_query_t;
+
+static t8_linearidx_t
+t8_forest_locate_query_key (t8_forest_t forest, const void *query)
+{
+  return ((const t8_forest_locate_query_t *) query)->key;
+}
+
+static t8_locidx_t
+t8_forest_locate_query_tree (t8_forest_t forest, const void *query)
+{
+  return ((const t8_forest_locate_query_t *) query)->ltreeid;
+}
+
+static int
+t8_forest_locate_search_fn (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_t *element,
+                            const int is_leaf, const t8_element_array_t *leaf_elements,
+                            const t8_locidx_t tree_leaf_index, void *queries, sc_array_t *query_indices,
+                            int *query_matches, const size_t num_active_queries)
+{
+  /* The queries decide whether to continue the search */
+  return 1;
+}
+
+static void
+t8_forest_locate_query_fn (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_t *element,
+                           const int is_leaf, const t8_element_array_t *leaf_elements,
+                           const t8_locidx_t tree_leaf_index, sc_array_t *queries, const size_t *query_indices,
+                           int *query_matches, const size_t num_active_queries)
+{
+  for (size_t iquery = 0; iquery < num_active_queries; ++iquery) {
+    t8_forest_locate_query_t *query = (t8_forest_locate_query_t *) sc_array_index (queries, query_indices[iquery]);
+    T8_ASSERT (query->ltreeid == ltreeid);
+    t8_forest_element_points_inside (forest, ltreeid, element, query->coords, 1, query_matches + iquery,
+                                     query->tolerance);
+    if (is_leaf && query_matches[iquery]) {
+      /* If the point lies on the boundary of multiple leaves, we keep the one with the smallest index */
+      const t8_gloidx_t element_index = t8_forest_get_first_local_element_id (forest)
+                                        + t8_forest_get_tree_element_offset (forest, ltreeid) + tree_leaf_index;
+      if (query->element < 0 || element_index < query->element) {
+        query->element = element_index;
+      }
+    }
+  }
+}
+
+/* Compute the ranks that own elements of a global tree.
+ * All ranks in [*first_owner, *last_owner] own parts of the tree or are empty. */
+static void
+t8_forest_locate_tree_owners (t8_forest_t forest, const t8_gloidx_t gtreeid, int *first_owner, int *last_owner)
+{
+  t8_cmesh_t cmesh = t8_forest_get_cmesh (forest);
+  const t8_eclass_t eclass = t8_cmesh_get_tree_class (cmesh, t8_cmesh_get_local_id (cmesh, gtreeid));
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+  t8_element_t *root;
+
+  ts->t8_element_new (1, &root);
+  ts->t8_element_root (root);
+  *first_owner = 0;
+  *last_owner = forest->mpisize - 1;
+  t8_forest_element_owners_bounds (forest, gtreeid, root, eclass, first_owner, last_owner);
+  ts->t8_element_destroy (1, &root);
+}
+
+/* Enlarge the box [lower, upper] such that it contains the box [add_lower, add_upper].
+ * Empty boxes have lower > upper. */
+static void
+t8_forest_locate_box_union (double *lower, double *upper, const double *add_lower, const double *add_upper)
+{
+  if (add_lower[0] > add_upper[0]) {
+    return;
+  }
+  const int is_empty = lower[0] > upper[0];
+  for (int idim = 0; idim < 3; ++idim) {
+    lower[idim] = is_empty ? add_lower[idim] : SC_MIN (lower[idim], add_lower[idim]);
+    upper[idim] = is_empty ? add_upper[idim] : SC_MAX (upper[idim], add_upper[idim]);
+  }
+}
+
+/* Return true if a local tree consists of all descendants of its root, i.e. it is not shared with other processes */
+static int
+t8_forest_locate_tree_is_complete (t8_forest_t forest, const t8_locidx_t ltreeid)
+{
+  const t8_eclass_t eclass = t8_forest_get_tree_class (forest, ltreeid);
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+  t8_element_array_t *leaves = t8_forest_tree_get_leaves (forest, ltreeid);
+  const size_t num_leaves = t8_element_array_get_count (leaves);
+  t8_element_t *root, *desc;
+  int is_complete;
+
+  ts->t8_element_new (1, &root);
+  ts->t8_element_new (1, &desc);
+  ts->t8_element_root (root);
+  ts->t8_element_first_descendant (root, desc, ts->t8_element_maxlevel ());
+  is_complete = ts->t8_element_compare (desc, t8_element_array_index_locidx (leaves, 0)) == 0;
+  if (is_complete) {
+    ts->t8_element_last_descendant (root, desc, ts->t8_element_maxlevel ());
+    const t8_element_t *last_leaf = t8_element_array_index_locidx (leaves, num_leaves - 1);
+    t8_element_t *last_desc;
+    ts->t8_element_new (1, &last_desc);
+    ts->t8_element_last_descendant (last_leaf, last_desc, ts->t8_element_maxlevel ());
+    is_complete = ts->t8_element_equal (desc, last_desc);
+    ts->t8_element_destroy (1, &last_desc);
+  }
+  ts->t8_element_destroy (1, &root);
+  ts->t8_element_destroy (1, &desc);
+  return is_complete;
+}
+
+/* Compute the bounding box of the local leaves. Trees that are not shared with other processes
+ * contribute their cmesh tree bounding box. The at most two trees that are shared contribute the
+ * box of the vertices of their local leaves, enlarged for non-linear geometries.
+ * An empty process gets an empty box (lower > upper). */
+static void
+t8_forest_locate_local_bounds (t8_forest_t forest, double *lower, double *upper)
+{
+  t8_cmesh_t cmesh = t8_forest_get_cmesh (forest);
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  double coords[3];
+
+  for (int idim = 0; idim < 3; ++idim) {
+    lower[idim] = 1;
+    upper[idim] = 0;
+  }
+  for (t8_locidx_t itree = 0; itree < num_local_trees; ++itree) {
+    t8_element_array_t *leaves = t8_forest_tree_get_leaves (forest, itree);
+    const t8_locidx_t num_leaves = t8_element_array_get_count (leaves);
+    if (num_leaves == 0) {
+      continue;
+    }
+    const t8_locidx_t lctreeid = t8_forest_ltreeid_to_cmesh_ltreeid (forest, itree);
+    double tree_lower[3], tree_upper[3];
+    if ((itree > 0 && itree < num_local_trees - 1) || t8_forest_locate_tree_is_complete (forest, itree)) {
+      /* Only the first and the last local tree can be shared */
+      t8_cmesh_get_tree_bounding_box (cmesh, lctreeid, tree_lower, tree_upper);
+      t8_forest_locate_box_union (lower, upper, tree_lower, tree_upper);
+      continue;
+    }
+    const t8_eclass_t eclass = t8_forest_get_tree_class (forest, itree);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+    for (int idim = 0; idim < 3; ++idim) {
+      tree_lower[idim] = 1;
+      tree_upper[idim] = 0;
+    }
+    for (t8_locidx_t ileaf = 0; ileaf < num_leaves; ++ileaf) {
+      const t8_element_t *leaf = t8_element_array_index_locidx (leaves, ileaf);
+      const int num_corners = ts->t8_element_num_corners (leaf);
+      for (int icorner = 0; icorner < num_corners; ++icorner) {
+        t8_forest_element_coordinate (forest, itree, leaf, icorner, coords);
+        t8_forest_locate_box_union (tree_lower, tree_upper, coords, coords);
+      }
+    }
+    /* The vertices bound the leaves of a linear geometry. Other geometries may leave the box. */
+    const t8_geometry_type_t geom_type = t8_geometry_get_type (cmesh, t8_forest_global_tree_id (forest, itree));
+    if (geom_type != T8_GEOMETRY_TYPE_LINEAR && geom_type != T8_GEOMETRY_TYPE_LINEAR_AXIS_ALIGNED) {
+      double diameter = 0;
+      for (int idim = 0; idim < 3; ++idim) {
+        diameter = SC_MAX (diameter, tree_upper[idim] - tree_lower[idim]);
+      }
+      for (int idim = 0; idim < 3; ++idim) {
+        tree_lower[idim] -= T8_FOREST_LOCATE_CURVED_MARGIN * diameter;
+        tree_upper[idim] += T8_FOREST_LOCATE_CURVED_MARGIN * diameter;
+      }
+    }
+    t8_forest_locate_box_union (lower, upper, tree_lower, tree_upper);
+  }
+}
+
+/* A binary tree over the process bounding boxes. Node 1 is the root, node i has the children
+ * 2i and 2i + 1, and the leaf num_leaves + p holds the box of process p.
+ * Each inner node holds the union of the boxes of its children, such that the processes
+ * whose box contains a point are found without testing every process. */
+typedef struct
+{
+  int num_leaves; /* A power of two that is at least the number of processes */
+  double *bounds; /* 6 entries (lower and upper corner) per node */
+} t8_forest_locate_rank_tree_t;
+
+static void
+t8_forest_locate_rank_tree_init (t8_forest_t forest, t8_forest_locate_rank_tree_t *rank_tree)
+{
+  const int mpisize = forest->mpisize;
+  double local_bounds[6];
+  int mpiret, inode;
+
+  rank_tree->num_leaves = 1;
+  while (rank_tree->num_leaves < mpisize) {
+    rank_tree->num_leaves *= 2;
+  }
+  rank_tree->bounds = T8_ALLOC (double, 12 * rank_tree->num_leaves);
+  t8_forest_locate_local_bounds (forest, local_bounds, local_bounds + 3);
+  mpiret = sc_MPI_Allgather (local_bounds, 6, sc_MPI_DOUBLE, rank_tree->bounds + 6 * rank_tree->num_leaves, 6,
+                             sc_MPI_DOUBLE, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (inode = rank_tree->num_leaves + mpisize; inode < 2 * rank_tree->num_leaves; ++inode) {
+    /* Unused leaves get an empty box */
+    for (int idim = 0; idim < 3; ++idim) {
+      rank_tree->bounds[6 * inode + idim] = 1;
+      rank_tree->bounds[6 * inode + 3 + idim] = 0;
+    }
+  }
+  for (inode = rank_tree->num_leaves - 1; inode > 0; --inode) {
+    double *lower = rank_tree->bounds + 6 * inode;
+    const double *left = rank_tree->bounds + 12 * inode;
+    const double *right = left + 6;
+    memcpy (lower, left, 6 * sizeof (double));
+    t8_forest_locate_box_union (lower, lower + 3, right, right + 3);
+  }
+}
+
+/* Append to found_ranks each process in [first_rank, last_rank] whose box
+ * contains the point up to the tolerance. inode is a node of the rank tree that covers
+ * the processes [node_first, node_last]. */
+static void
+t8_forest_locate_rank_tree_query (const t8_forest_locate_rank_tree_t *rank_tree, const int inode,
+                                  const int node_first, const int node_last, const int first_rank,
+                                  const int last_rank, const double *point, const double tolerance,
+                                  sc_array_t *found_ranks)
+{
+  if (node_last < first_rank || last_rank < node_first) {
+    return;
+  }
+  const double *lower = rank_tree->bounds + 6 * inode;
+  const double *upper = lower + 3;
+  for (int idim = 0; idim < 3; ++idim) {
+    if (point[idim] < lower[idim] - tolerance || upper[idim] + tolerance < point[idim]) {
+      /* The point is outside of the box (or the box is empty) */
+      return;
+    }
+  }
+  if (inode >= rank_tree->num_leaves) {
+    *(int *) sc_array_push (found_ranks) = inode - rank_tree->num_leaves;
+    return;
+  }
+  const int node_mid = (node_first + node_last) / 2;
+  t8_forest_locate_rank_tree_query (rank_tree, 2 * inode, node_first, node_mid, first_rank, last_rank, point,
+                                    tolerance, found_ranks);
+  t8_forest_locate_rank_tree_query (rank_tree, 2 * inode + 1, node_mid + 1, node_last, first_rank, last_rank, point,
+                                    tolerance, found_ranks);
+}
+
+/* Find the processes in [first_rank, last_rank] whose box contains the point and append them to found_ranks */
+static void
+t8_forest_locate_find_ranks (const t8_forest_locate_rank_tree_t *rank_tree, const int first_rank,
+                             const int last_rank, const double *point, const double tolerance,
+                             sc_array_t *found_ranks)
+{
+  t8_forest_locate_rank_tree_query (rank_tree, 1, 0, rank_tree->num_leaves - 1, first_rank, last_rank, point,
+                                    tolerance, found_ranks);
+}
+
+/* Add a point and its candidate tree to the points that we send to a process.
+ * The processes we send to are collected in receivers when their first point is added. */
+static void
+t8_forest_locate_add_point (sc_array_t *send_points, sc_array_t *send_indices, sc_array_t *receivers,
+                            const int rank, const double *point, const t8_gloidx_t gtreeid, const t8_locidx_t ipoint)
+{
+  if (send_points[rank].elem_count == 0) {
+    *(int *) sc_array_push (receivers) = rank;
+  }
+  t8_forest_locate_point_t *send_point = (t8_forest_locate_point_t *) sc_array_push (send_points + rank);
+  memcpy (send_point->coords, point, 3 * sizeof (double));
+  send_point->gtreeid = gtreeid;
+  *(t8_locidx_t *) sc_array_push (send_indices + rank) = ipoint;
+}
+
+/* Add one query for a received point and a local tree */
+static void
+t8_forest_locate_add_query (sc_array_t *queries, const t8_forest_locate_point_t *point, const t8_locidx_t ltreeid,
+                            const int recv_index, const double tolerance)
+{
+  t8_forest_locate_query_t *query = (t8_forest_locate_query_t *) sc_array_push (queries);
+  memcpy (query->coords, point->coords, 3 * sizeof (double));
+  query->tolerance = tolerance;
+  query->key = 0;
+  query->ltreeid = ltreeid;
+  query->recv_index = recv_index;
+  query->element = -1;
+}
+
+void
+t8_forest_locate_points (t8_forest_t forest, const double *points, t8_locidx_t num_points, double tolerance,
+                         int *out_rank, t8_gloidx_t *out_tree, t8_gloidx_t *out_element)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_points == 0 || points != NULL);
+  T8_ASSERT (tolerance >= 0);
+
+  t8_cmesh_t cmesh = t8_forest_get_cmesh (forest);
+  const int mpisize = forest->mpisize;
+  const int cmesh_is_partitioned = t8_cmesh_is_partitioned (cmesh);
+  t8_forest_locate_rank_tree_t rank_tree;
+  sc_array_t found_ranks;
+  t8_locidx_t ipoint;
+  int mpiret;
+
+  /* For each process the points that we send to it and their indices in points */
+  sc_array_t *send_points = T8_ALLOC (sc_array_t, mpisize);
+  sc_array_t *send_indices = T8_ALLOC (sc_array_t, mpisize);
+  for (int iproc = 0; iproc < mpisize; ++iproc) {
+    sc_array_init (send_points + iproc, sizeof (t8_forest_locate_point_t));
+    sc_array_init (send_indices + iproc, sizeof (t8_locidx_t));
+  }
+  sc_array_t receivers;
+  sc_array_init (&receivers, sizeof (int));
+  sc_array_init (&found_ranks, sizeof (int));
+  t8_forest_locate_rank_tree_init (forest, &rank_tree);
+
+  /* Find the candidate processes of each point */
+  if (!cmesh_is_partitioned) {
+    /* The cmesh is replicated. We find the candidate trees of each point and compute the owners
+     * of these trees from the forest's partition. Among the owners, we only send the point
+     * to the processes whose local leaves' bounding box contains it, together with the tree. */
+    std::unordered_map<t8_gloidx_t, std::pair<int, int>> tree_owners;
+    sc_array_t candidate_trees;
+    sc_array_init (&candidate_trees, sizeof (t8_locidx_t));
+    for (ipoint = 0; ipoint < num_points; ++ipoint) {
+      const double *point = points + 3 * ipoint;
+      sc_array_truncate (&candidate_trees);
+      t8_cmesh_locate_candidate_trees (cmesh, point, tolerance, &candidate_trees);
+      for (size_t itree = 0; itree < candidate_trees.elem_count; ++itree) {
+        const t8_locidx_t lctreeid = *(t8_locidx_t *) sc_array_index (&candidate_trees, itree);
+        const t8_gloidx_t gtreeid = t8_cmesh_get_global_id (cmesh, lctreeid);
+        auto owners = tree_owners.find (gtreeid);
+        if (owners == tree_owners.end ()) {
+          /* Compute the owners of this tree once */
+          int first_owner, last_owner;
+          t8_forest_locate_tree_owners (forest, gtreeid, &first_owner, &last_owner);
+          owners = tree_owners.emplace (gtreeid, std::make_pair (first_owner, last_owner)).first;
+        }
+        sc_array_truncate (&found_ranks);
+        t8_forest_locate_find_ranks (&rank_tree, owners->second.first, owners->second.second, point, tolerance,
+                                     &found_ranks);
+        for (size_t irank = 0; irank < found_ranks.elem_count; ++irank) {
+          t8_forest_locate_add_point (send_points, send_indices, &receivers,
+                                      *(int *) sc_array_index (&found_ranks, irank), point, gtreeid, ipoint);
+        }
+      }
+    }
+    sc_array_reset (&candidate_trees);
+  }
+  else {
+    /* The cmesh is partitioned and we do not know the bounding boxes of all trees.
+     * Instead, we send each point to the processes whose local leaves' bounding box contains it,
+     * and the receiver finds the candidate trees among its local trees. */
+    for (ipoint = 0; ipoint < num_points; ++ipoint) {
+      const double *point = points + 3 * ipoint;
+      sc_array_truncate (&found_ranks);
+      t8_forest_locate_find_ranks (&rank_tree, 0, mpisize - 1, point, tolerance, &found_ranks);
+      for (size_t irank = 0; irank < found_ranks.elem_count; ++irank) {
+        t8_forest_locate_add_point (send_points, send_indices, &receivers,
+                                    *(int *) sc_array_index (&found_ranks, irank), point, -1, ipoint);
+      }
+    }
+  }
+  T8_FREE (rank_tree.bounds);
+  sc_array_reset (&found_ranks);
+
+  /* Find the processes that send points to us. Each process only communicates with its
+   * candidate processes, there is no collective exchange of counts. */
+  const int num_receivers = receivers.elem_count;
+  sc_array_sort (&receivers, sc_int_compare);
+  int *senders = T8_ALLOC (int, mpisize);
+  int num_senders;
+  mpiret = sc_notify ((int *) receivers.array, num_receivers, senders, &num_senders, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* Send the points */
+  sc_MPI_Request *requests = T8_ALLOC (sc_MPI_Request, SC_MAX (num_receivers + num_senders, 1));
+  for (int ireceiver = 0; ireceiver < num_receivers; ++ireceiver) {
+    const int iproc = *(int *) sc_array_index_int (&receivers, ireceiver);
+    mpiret = sc_MPI_Isend (send_points[iproc].array, send_points[iproc].elem_count * sizeof (t8_forest_locate_point_t),
+                           sc_MPI_BYTE, iproc, T8_MPI_LOCATE_POINTS, forest->mpicomm, requests + ireceiver);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Receive the points of each sender. We do not know their number and probe for it. */
+  int *recv_offsets = T8_ALLOC (int, num_senders + 1);
+  sc_array_t recv_points;
+  sc_array_init (&recv_points, sizeof (t8_forest_locate_point_t));
+  recv_offsets[0] = 0;
+  for (int isender = 0; isender < num_senders; ++isender) {
+    sc_MPI_Status status;
+    int recv_bytes;
+    mpiret = sc_MPI_Probe (senders[isender], T8_MPI_LOCATE_POINTS, forest->mpicomm, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &recv_bytes);
+    SC_CHECK_MPI (mpiret);
+    T8_ASSERT (recv_bytes % sizeof (t8_forest_locate_point_t) == 0);
+    recv_offsets[isender + 1] = recv_offsets[isender] + recv_bytes / sizeof (t8_forest_locate_point_t);
+    sc_array_resize (&recv_points, recv_offsets[isender + 1]);
+    mpiret = sc_MPI_Recv (sc_array_index_int (&recv_points, recv_offsets[isender]), recv_bytes, sc_MPI_BYTE,
+                          senders[isender], T8_MPI_LOCATE_POINTS, forest->mpicomm, sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  const int num_recv_total = recv_offsets[num_senders];
+  mpiret = sc_MPI_Waitall (num_receivers, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* Build one query for each received point and each of its candidate trees on this process */
+  sc_array_t queries;
+  sc_array_t local_candidates;
+  sc_array_init (&queries, sizeof (t8_forest_locate_query_t));
+  sc_array_init (&local_candidates, sizeof (t8_locidx_t));
+  for (int irecv = 0; irecv < num_recv_total; ++irecv) {
+    const t8_forest_locate_point_t *point = (const t8_forest_locate_point_t *) sc_array_index_int (&recv_points, irecv);
+    if (point->gtreeid >= 0) {
+      const t8_locidx_t ltreeid = t8_forest_get_local_id (forest, point->gtreeid);
+      if (ltreeid >= 0) {
+        t8_forest_locate_add_query (&queries, point, ltreeid, irecv, tolerance);
+      }
+    }
+    else {
+      sc_array_truncate (&local_candidates);
+      t8_cmesh_locate_candidate_trees (cmesh, point->coords, tolerance, &local_candidates);
+      for (size_t itree = 0; itree < local_candidates.elem_count; ++itree) {
+        const t8_locidx_t ltreeid
+          = t8_forest_cmesh_ltreeid_to_ltreeid (forest, *(t8_locidx_t *) sc_array_index (&local_candidates, itree));
+        if (ltreeid >= 0) {
+          t8_forest_locate_add_query (&queries, point, ltreeid, irecv, tolerance);
+        }
+      }
+    }
+  }
+  sc_array_reset (&local_candidates);
+
+  /* Search the queries in their trees. Within a tree, the points are sorted along a Morton
+   * curve over their bounding box, such that nearby points are processed together. */
+  const size_t num_queries = queries.elem_count;
+  double lower[3] = { 0, 0, 0 }, upper[3] = { 0, 0, 0 };
+  for (size_t iquery = 0; iquery < num_queries; ++iquery) {
+    const t8_forest_locate_query_t *query = (const t8_forest_locate_query_t *) sc_array_index (&queries, iquery);
+    for (int idim = 0; idim < 3; ++idim) {
+      lower[idim] = iquery == 0 ? query->coords[idim] : SC_MIN (lower[idim], query->coords[idim]);
+      upper[idim] = iquery == 0 ? query->coords[idim] : SC_MAX (upper[idim], query->coords[idim]);
+    }
+  }
+  for (size_t iquery = 0; iquery < num_queries; ++iquery) {
+    t8_forest_locate_query_t *query = (t8_forest_locate_query_t *) sc_array_index (&queries, iquery);
+    query->key = t8_forest_search_morton_key (query->coords, lower, upper);
+  }
+  if (num_queries > 0) {
+    t8_forest_search_batched_trees (forest, t8_forest_locate_search_fn, t8_forest_locate_query_fn, &queries,
+                                    t8_forest_locate_query_key, t8_forest_locate_query_tree);
+  }
+
+  /* Combine the results of the candidate trees of each received point,
+   * two entries (tree and element) per point */
+  t8_gloidx_t *send_results = T8_ALLOC (t8_gloidx_t, 2 * SC_MAX (num_recv_total, 1));
+  for (int irecv = 0; irecv < num_recv_total; ++irecv) {
+    send_results[2 * irecv] = -1;
+    send_results[2 * irecv + 1] = -1;
+  }
+  for (size_t iquery = 0; iquery < num_queries; ++iquery) {
+    const t8_forest_locate_query_t *query = (const t8_forest_locate_query_t *) sc_array_index (&queries, iquery);
+    t8_gloidx_t *result = send_results + 2 * query->recv_index;
+    if (query->element >= 0 && (result[1] < 0 || query->element < result[1])) {
+      result[0] = t8_forest_global_tree_id (forest, query->ltreeid);
+      result[1] = query->element;
+    }
+  }
+  sc_array_reset (&queries);
+  sc_array_reset (&recv_points);
+
+  /* Send the results back */
+  int *result_offsets = T8_ALLOC (int, num_receivers + 1);
+  result_offsets[0] = 0;
+  for (int ireceiver = 0; ireceiver < num_receivers; ++ireceiver) {
+    const int iproc = *(int *) sc_array_index_int (&receivers, ireceiver);
+    result_offsets[ireceiver + 1] = result_offsets[ireceiver] + send_points[iproc].elem_count;
+  }
+  t8_gloidx_t *recv_results = T8_ALLOC (t8_gloidx_t, 2 * SC_MAX (result_offsets[num_receivers], 1));
+  for (int ireceiver = 0; ireceiver < num_receivers; ++ireceiver) {
+    const int iproc = *(int *) sc_array_index_int (&receivers, ireceiver);
+    mpiret = sc_MPI_Irecv (recv_results + 2 * result_offsets[ireceiver], 2 * send_points[iproc].elem_count,
+                           T8_MPI_GLOIDX, iproc, T8_MPI_LOCATE_POINTS, forest->mpicomm, requests + ireceiver);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (int isender = 0; isender < num_senders; ++isender) {
+    const int num_results = recv_offsets[isender + 1] - recv_offsets[isender];
+    mpiret = sc_MPI_Isend (send_results + 2 * recv_offsets[isender], 2 * num_results, T8_MPI_GLOIDX,
+                           senders[isender], T8_MPI_LOCATE_POINTS, forest->mpicomm,
+                           requests + num_receivers + isender);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = sc_MPI_Waitall (num_receivers + num_senders, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* Combine the results of all candidate processes */
+  for (ipoint = 0; ipoint < num_points; ++ipoint) {
+    out_rank[ipoint] = -1;
+    out_tree[ipoint] = -1;
+    out_element[ipoint] = -1;
+  }
+  for (int ireceiver = 0; ireceiver < num_receivers; ++ireceiver) {
+    const int iproc = *(int *) sc_array_index_int (&receivers, ireceiver);
+    for (size_t isend = 0; isend < send_indices[iproc].elem_count; ++isend) {
+      ipoint = *(t8_locidx_t *) sc_array_index (send_indices + iproc, isend);
+      const t8_gloidx_t *result = recv_results + 2 * (result_offsets[ireceiver] + isend);
+      if (result[1] >= 0 && (out_element[ipoint] < 0 || result[1] < out_element[ipoint])) {
+        out_rank[ipoint] = iproc;
+        out_tree[ipoint] = result[0];
+        out_element[ipoint] = result[1];
+      }
+    }
+  }
+
+  /* clean-up */
+  for (int iproc = 0; iproc < mpisize; ++iproc) {
+    sc_array_reset (send_points + iproc);
+    sc_array_reset (send_indices + iproc);
+  }
+  sc_array_reset (&receivers);
+  T8_FREE (send_points);
+  T8_FREE (send_indices);
+  T8_FREE (senders);
+  T8_FREE (recv_offsets);
+  T8_FREE (result_offsets);
+  T8_FREE (send_results);
+  T8_FREE (recv_results);
+  T8_FREE (requests);
+}
+
+T8_EXTERN_C_END ();
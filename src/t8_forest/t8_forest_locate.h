@@ -0,0 +1,68 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_locate.h
+ * Distributed point location in a forest.
+ */
+
+#ifndef T8_FOREST_LOCATE_H
+#define T8_FOREST_LOCATE_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_general.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Find the owner process and leaf element of arbitrary points.
+ * Each process passes its own set of points, which need not lie in the local
+ * partition. Each process computes the bounding box of its local leaves and the boxes of all
+ * processes are gathered into a binary tree over the ranks.
+ * For each point the candidate coarse trees are looked up in the bucket grid
+ * of the cmesh (see \ref t8_cmesh_locate_candidate_trees) and the processes that own
+ * elements of these trees are computed from the forest's partition. The point is sent
+ * together with the candidate tree to those owners whose box contains it, and the receiver
+ * only searches this tree (see \ref t8_forest_search_batched_trees).
+ * If the cmesh is partitioned, the point is sent to all processes whose box contains it,
+ * and the receiver finds the candidate trees among its local trees.
+ * The processes that receive points from a process are found with a sparse notification
+ * (sc_notify), the results are sent back directly.
+ * \param [in]  forest       A committed forest.
+ * \param [in]  points       The coordinates of the points, 3 entries per point.
+ * \param [in]  num_points   The number of points on this process.
+ * \param [in]  tolerance    The tolerance for the point inside check, see \ref t8_forest_element_points_inside.
+ * \param [out] out_rank     Array of length \a num_points. On output the rank of the process that owns
+ *                           the leaf element containing each point, or -1 if the point is not in the forest.
+ * \param [out] out_tree     Array of length \a num_points. On output the global tree id of the leaf
+ *                           element containing each point, or -1 if the point is not in the forest.
+ * \param [out] out_element  Array of length \a num_points. On output the global index of the leaf
+ *                           element containing each point, or -1 if the point is not in the forest.
+ * \note If a point lies on the boundary of multiple leaf elements, the element with the
+ *       smallest global index is returned.
+ * \note This function is MPI collective.
+ */
+void
+t8_forest_locate_points (t8_forest_t forest, const double *points, t8_locidx_t num_points, double tolerance,
+                         int *out_rank, t8_gloidx_t *out_tree, t8_gloidx_t *out_element);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_LOCATE_H */
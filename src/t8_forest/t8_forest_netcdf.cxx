@@ -94,6 +94,19 @@ typedef struct
   const char *convention;
   int netcdf_var_storage_mode;
   int netcdf_mpi_access;
+  /* Chunk sizes, filters and MPI-IO hints of the variables */
+  size_t chunk_elements;
+  size_t chunk_nodes;
+  int deflate_level;
+  int shuffle;
+  int cb_nodes;
+  int cb_buffer_size;
+  /* The time dimension and the current time step if the user variables are time dependent */
+  int time_dependent;
+  int time_dimid;
+  int var_time_id;
+  size_t time_step;
+  double time;
   /* Stores the old NetCDF-FillMode if it gets changed */
   int old_fill_mode;
 
@@ -158,6 +171,171 @@ t8_forest_init_ugrid_namespace_context (t8_forest_netcdf_ugrid_namespace_t *name
   }
 }
 
+/* Initialize the storage and access properties of a context from the given options */
+static void
+t8_forest_netcdf_init_context_options (t8_forest_netcdf_context_t *context, const t8_forest_netcdf_options_t *options)
+{
+  context->nMesh_elem_dimid = -1;
+  context->nMesh_node_dimid = -1;
+  context->time_dimid = -1;
+  context->time_step = 0;
+  context->time = options->time;
+  context->time_dependent = options->time_dependent;
+  context->chunk_elements = options->chunk_elements;
+  context->chunk_nodes = options->chunk_nodes;
+  context->deflate_level = SC_MAX (0, SC_MIN (options->deflate_level, 9));
+  context->shuffle = options->shuffle;
+  context->cb_nodes = options->cb_nodes;
+  context->cb_buffer_size = options->cb_buffer_size;
+
+#if T8_WITH_NETCDF
+  /* Check the given 'netcdf_storage_mode' */
+  if (options->storage_mode != NC_CONTIGUOUS && options->storage_mode != NC_CHUNKED) {
+    t8_global_productionf ("Illegal input parameter for the storage-mode (NC_CONTIGUOUS or NC_CHUNKED) was "
+                           "given.\nTherefore, NC_CONTIGUOUS will be used as the default value.\n");
+    context->netcdf_var_storage_mode = NC_CONTIGUOUS;
+  }
+  else {
+    context->netcdf_var_storage_mode = options->storage_mode;
+  }
+#endif
+#if T8_WITH_NETCDF_PAR
+  /* Check the given 'netcdf_mpi_access' */
+  if (options->mpi_access != NC_INDEPENDENT && options->mpi_access != NC_COLLECTIVE) {
+    t8_global_productionf ("Illegal input parameter for the variable-mpi-access (NC_INDEPENDENT or NC_COLLECTIVE) was "
+                           "given.\nTherefore, NC_INDEPENDENT will be used as the default value.\n");
+    context->netcdf_mpi_access = NC_INDEPENDENT;
+  }
+  else {
+    context->netcdf_mpi_access = options->mpi_access;
+  }
+#endif
+}
+
+/* Create the filename of the netCDF-file */
+static void
+t8_forest_netcdf_file_name (char *file_name, const char *file_prefix, sc_MPI_Comm comm)
+{
+  /* Create the NetCDF-Filename */
+  snprintf (file_name, BUFSIZ, "%s.nc", file_prefix);
+
+#if !T8_WITH_NETCDF_PAR
+  /* In case of a parallel configuration without parallel netCDF routines */
+  int retval;
+  int mpirank, mpisize;
+  /* Size of the communicator */
+  retval = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (retval);
+  /* Get the rank of the process */
+  retval = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (retval);
+
+  /** \note This prevents the single file to be overwritten if more processes are involved,
+   * in a configuration which does not feature parallel netCDF routines!
+   * Otherwise, if several processes try to write in the same file,
+   * the result will be an HDF-5 error. Now, each process will create its own
+   * file. Each of these files will be as big as if all processes would have written into the same file,
+   * but in each file is only the process-local data defined.
+   * (-> storage requirement is the #ranks-fold storage requirement of a serial or parallel netCDF run)
+   *
+   * \note Therefore, it is advisable to either run the whole program with only one MPI rank or
+   * make use of a parallel netCDF/HDF-5 configuration
+   */
+  if (mpisize > 1) {
+    /* Create the NetCDF-Filename for each process */
+    snprintf (file_name, BUFSIZ, "%s_rank_%d.nc", file_prefix, mpirank);
+    t8_global_productionf (
+      "Note: The program is executed in parallel, but the netCDF Usage is serial.\nThis is not advisable, you may want "
+      "to either execute the program with only one MPI rank or use a parallel netCDF/HDF-5 configuration\n");
+  }
+#endif
+}
+
+#if T8_WITH_NETCDF_PAR
+/* Create the MPI-IO hints for the collective buffering of the context. The caller has to free them. */
+static MPI_Info
+t8_forest_netcdf_new_info (t8_forest_netcdf_context_t *context)
+{
+  MPI_Info info;
+  char value[BUFSIZ];
+
+  MPI_Info_create (&info);
+  if (context->cb_nodes > 0) {
+    /* Let only cb_nodes processes access the file in the collective writes */
+    snprintf (value, BUFSIZ, "%i", context->cb_nodes);
+    MPI_Info_set (info, "cb_nodes", value);
+    MPI_Info_set (info, "romio_cb_write", "enable");
+  }
+  if (context->cb_buffer_size > 0) {
+    snprintf (value, BUFSIZ, "%i", context->cb_buffer_size);
+    MPI_Info_set (info, "cb_buffer_size", value);
+  }
+  return info;
+}
+#endif
+
+/* Define the storage, the filters and the parallel access of a variable with the given dimensions */
+static void
+t8_forest_netcdf_def_var_storage (t8_forest_netcdf_context_t *context, int varid, int ndims, const int *dimids)
+{
+#if T8_WITH_NETCDF
+  size_t chunksizes[2];
+  int storage_mode = context->netcdf_var_storage_mode;
+  const int use_filters = context->deflate_level > 0 || context->shuffle;
+  int use_chunksizes = 0;
+  int has_time = 0;
+  int retval;
+
+  T8_ASSERT (ndims <= 2);
+  for (int idim = 0; idim < ndims; idim++) {
+    size_t chunksize = 0;
+    if ((retval = nc_inq_dimlen (context->ncid, dimids[idim], &chunksizes[idim]))) {
+      ERR (retval);
+    }
+    if (dimids[idim] == context->time_dimid) {
+      /* One time step per chunk, appending a time step does not touch the chunks of the previous steps */
+      chunksizes[idim] = 1;
+      has_time = 1;
+    }
+    else if (dimids[idim] == context->nMesh_elem_dimid) {
+      chunksize = context->chunk_elements;
+    }
+    else if (dimids[idim] == context->nMesh_node_dimid) {
+      chunksize = context->chunk_nodes;
+    }
+    if (chunksize > 0) {
+      /* A chunk must not be larger than the dimension */
+      chunksizes[idim] = SC_MAX (1, SC_MIN (chunksize, chunksizes[idim]));
+      use_chunksizes = 1;
+    }
+  }
+  /* Variables with an unlimited dimension or with filters cannot be stored contiguously */
+  if (has_time || use_filters) {
+    storage_mode = NC_CHUNKED;
+  }
+  /* Define whether a contiguous or chunked storage is used for the variable */
+  if ((retval = nc_def_var_chunking (context->ncid, varid, storage_mode,
+                                     storage_mode == NC_CHUNKED && use_chunksizes ? chunksizes : NULL))) {
+    ERR (retval);
+  }
+  /* Define the shuffle and the deflate filter */
+  if (use_filters) {
+    if ((retval = nc_def_var_deflate (context->ncid, varid, context->shuffle, context->deflate_level > 0,
+                                      context->deflate_level))) {
+      ERR (retval);
+    }
+  }
+  /* Define whether an independent or collective variable access is used.
+   * Parallel writes to filtered variables and extending an unlimited dimension must be collective. */
+#if T8_WITH_NETCDF_PAR
+  if ((retval = nc_var_par_access (context->ncid, varid,
+                                   has_time || use_filters ? NC_COLLECTIVE : context->netcdf_mpi_access))) {
+    ERR (retval);
+  }
+#endif
+#endif
+}
+
 /* Define NetCDF-dimensions */
 static void
 t8_forest_write_netcdf_dimensions (t8_forest_netcdf_context_t *context,
@@ -184,6 +362,13 @@ t8_forest_write_netcdf_dimensions (t8_forest_netcdf_context_t *context,
   context->dimids[0] = context->nMesh_elem_dimid;
   context->dimids[1] = context->nMaxMesh_elem_nodes_dimid;
 
+  /* Define dimension: time steps of the user variables */
+  if (context->time_dependent) {
+    if ((retval = nc_def_dim (context->ncid, "time", NC_UNLIMITED, &context->time_dimid))) {
+      ERR (retval);
+    }
+  }
+
   t8_debugf ("First NetCDF-dimensions were defined.\n");
 #endif
 }
@@ -251,17 +436,8 @@ t8_forest_write_netcdf_variables (t8_forest_netcdf_context_t *context,
                             &context->nMesh_elem_dimid, &context->var_elem_types_id))) {
     ERR (retval);
   }
-  /* Define whether a contiguous or chunked storage is used for the variable */
-  if ((retval
-       = nc_def_var_chunking (context->ncid, context->var_elem_types_id, context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval = nc_var_par_access (context->ncid, context->var_elem_types_id, context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Define the storage, the filters and whether an independent or collective variable access is used */
+  t8_forest_netcdf_def_var_storage (context, context->var_elem_types_id, 1, &context->nMesh_elem_dimid);
   /* Define cf_role attribute */
   if ((retval
        = nc_put_att_text (context->ncid, context->var_elem_types_id, "cf_role",
@@ -292,17 +468,8 @@ t8_forest_write_netcdf_variables (t8_forest_netcdf_context_t *context,
                             &context->nMesh_elem_dimid, &context->var_elem_tree_id))) {
     ERR (retval);
   }
-  /* Define whether a contiguous or chunked storage is used for the variable */
-  if ((retval
-       = nc_def_var_chunking (context->ncid, context->var_elem_tree_id, context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval = nc_var_par_access (context->ncid, context->var_elem_tree_id, context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Define the storage, the filters and whether an independent or collective variable access is used */
+  t8_forest_netcdf_def_var_storage (context, context->var_elem_tree_id, 1, &context->nMesh_elem_dimid);
   /* Define cf_role attribute */
   if ((retval = nc_put_att_text (context->ncid, context->var_elem_tree_id, "cf_role",
                                  strlen (namespace_context->att_elem_tree_id), namespace_context->att_elem_tree_id))) {
@@ -332,17 +499,8 @@ t8_forest_write_netcdf_variables (t8_forest_netcdf_context_t *context,
                             &context->var_elem_nodes_id))) {
     ERR (retval);
   }
-  /* Define whether a contiguous or chunked storage is used for the variable */
-  if ((retval
-       = nc_def_var_chunking (context->ncid, context->var_elem_nodes_id, context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval = nc_var_par_access (context->ncid, context->var_elem_nodes_id, context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Define the storage, the filters and whether an independent or collective variable access is used */
+  t8_forest_netcdf_def_var_storage (context, context->var_elem_nodes_id, 2, context->dimids);
   /* Define cf_role attribute */
   if ((retval = nc_put_att_text (context->ncid, context->var_elem_nodes_id, "cf_role",
                                  strlen (namespace_context->att_elem_node_connectivity),
@@ -485,16 +643,8 @@ t8_forest_write_netcdf_coordinate_variables (t8_forest_netcdf_context_t *context
                             &context->var_node_x_id))) {
     ERR (retval);
   }
-  /* Define whether contiguous or chunked storage is used for the variable */
-  if ((retval = nc_def_var_chunking (context->ncid, context->var_node_x_id, context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval = nc_var_par_access (context->ncid, context->var_node_x_id, context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Define the storage, the filters and whether an independent or collective variable access is used */
+  t8_forest_netcdf_def_var_storage (context, context->var_node_x_id, 1, &context->nMesh_node_dimid);
   /* Define standard_name attribute. */
   const char *standard_node_x = "Longitude";
   if ((retval = nc_put_att_text (context->ncid, context->var_node_x_id, "standard_name", strlen (standard_node_x),
@@ -521,16 +671,8 @@ t8_forest_write_netcdf_coordinate_variables (t8_forest_netcdf_context_t *context
                             &context->var_node_y_id))) {
     ERR (retval);
   }
-  /* Define whether contiguous or chunked storage is used for the variable */
-  if ((retval = nc_def_var_chunking (context->ncid, context->var_node_y_id, context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval = nc_var_par_access (context->ncid, context->var_node_y_id, context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Define the storage, the filters and whether an independent or collective variable access is used */
+  t8_forest_netcdf_def_var_storage (context, context->var_node_y_id, 1, &context->nMesh_node_dimid);
   /* Define standard_name attribute. */
   const char *standard_node_y = "Latitude";
   if ((retval = nc_put_att_text (context->ncid, context->var_node_y_id, "standard_name", strlen (standard_node_y),
@@ -557,16 +699,8 @@ t8_forest_write_netcdf_coordinate_variables (t8_forest_netcdf_context_t *context
                             &context->var_node_z_id))) {
     ERR (retval);
   }
-  /* Define whether contiguous or chunked storage is used for the variable */
-  if ((retval = nc_def_var_chunking (context->ncid, context->var_node_z_id, context->netcdf_var_storage_mode, NULL))) {
-    ERR (retval);
-  }
-  /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-  if ((retval = nc_var_par_access (context->ncid, context->var_node_z_id, context->netcdf_mpi_access))) {
-    ERR (retval);
-  }
-#endif
+  /* Define the storage, the filters and whether an independent or collective variable access is used */
+  t8_forest_netcdf_def_var_storage (context, context->var_node_z_id, 1, &context->nMesh_node_dimid);
   /* Define standard_name attribute. */
   const char *standard_node_z = "Height";
   if ((retval = nc_put_att_text (context->ncid, context->var_node_z_id, "standard_name", strlen (standard_node_z),
@@ -605,45 +739,49 @@ t8_forest_write_user_netcdf_vars (t8_forest_netcdf_context_t *context,
     retval = sc_MPI_Comm_rank (comm, &mpirank);
     SC_CHECK_MPI (retval);
 
+    /* Time dependent variables have the dimensions (time, elements) */
+    const int user_ndims = context->time_dependent ? 2 : 1;
+    const int user_dimids[2] = { context->time_dependent ? context->time_dimid : context->nMesh_elem_dimid,
+                                 context->nMesh_elem_dimid };
+
+    /* Define the variable which holds the time of each time step */
+    if (context->time_dependent) {
+      if ((retval = nc_def_var (context->ncid, "time", NC_DOUBLE, 1, &context->time_dimid, &context->var_time_id))) {
+        ERR (retval);
+      }
+      t8_forest_netcdf_def_var_storage (context, context->var_time_id, 1, &context->time_dimid);
+      const char *long_time = "Time of the time step";
+      if ((retval
+           = nc_put_att_text (context->ncid, context->var_time_id, "long_name", strlen (long_time), long_time))) {
+        ERR (retval);
+      }
+    }
+
     /* Iterate over the amount of user-defined variables */
     for (i = 0; i < num_extern_netcdf_vars; i++) {
+      nc_type var_type = NC_DOUBLE;
       /* Check the variable data type */
       switch (ext_variables[i]->datatype) {
       case T8_NETCDF_INT:
         /* A netCDF 32bit integer variable will be declared */
-        if ((retval = nc_def_var (context->ncid, ext_variables[i]->variable_name, NC_INT, 1, &context->nMesh_elem_dimid,
-                                  &(ext_variables[i]->var_user_dimid)))) {
-          ERR (retval);
-        }
+        var_type = NC_INT;
         break;
       case T8_NETCDF_INT64:
         /* A netCDF 64bit integer variable will be declared */
-        if ((retval = nc_def_var (context->ncid, ext_variables[i]->variable_name, NC_INT64, 1,
-                                  &context->nMesh_elem_dimid, &(ext_variables[i]->var_user_dimid)))) {
-          ERR (retval);
-        }
+        var_type = NC_INT64;
         break;
       case T8_NETCDF_DOUBLE:
         /* A netCDF Double-Variable will be declared */
-        if ((retval = nc_def_var (context->ncid, ext_variables[i]->variable_name, NC_DOUBLE, 1,
-                                  &context->nMesh_elem_dimid, &(ext_variables[i]->var_user_dimid)))) {
-          ERR (retval);
-          break;
-        }
-
-        /* Define whether contiguous or chunked storage is used for the variable */
-        if ((retval = nc_def_var_chunking (context->ncid, ext_variables[i]->var_user_dimid,
-                                           context->netcdf_var_storage_mode, NULL))) {
-          ERR (retval);
-        }
-        /* Define whether an independent or collective variable access is used */
-#if T8_WITH_NETCDF_PAR
-        if ((retval
-             = nc_var_par_access (context->ncid, ext_variables[i]->var_user_dimid, context->netcdf_mpi_access))) {
-          ERR (retval);
-        }
-#endif
+        var_type = NC_DOUBLE;
+        break;
+      }
+      if ((retval = nc_def_var (context->ncid, ext_variables[i]->variable_name, var_type, user_ndims, user_dimids,
+                                &(ext_variables[i]->var_user_dimid)))) {
+        ERR (retval);
       }
+      /* Define the storage, the filters and whether an independent or collective variable access is used */
+      t8_forest_netcdf_def_var_storage (context, ext_variables[i]->var_user_dimid, user_ndims, user_dimids);
+
       /* Attach the user-defined 'long_name' attribute to the variable */
       if ((retval
            = nc_put_att_text (context->ncid, (ext_variables[i]->var_user_dimid), "long_name",
@@ -809,6 +947,7 @@ t8_forest_write_netcdf_coordinate_data (t8_forest_t forest, t8_forest_netcdf_con
 
 /* Function that writes user-defined data to user-defined variables, if some were passed */
 /* It is only possible to write exactly one value per element per variable */
+/* If the variables are time dependent, the data is written as the time step context->time_step */
 static void
 t8_forest_write_user_netcdf_data (t8_forest_t forest, t8_forest_netcdf_context_t *context, int num_extern_netcdf_vars,
                                   t8_netcdf_variable_t *ext_variables[], sc_MPI_Comm comm)
@@ -816,40 +955,61 @@ t8_forest_write_user_netcdf_data (t8_forest_t forest, t8_forest_netcdf_context_t
 #if T8_WITH_NETCDF
   if (num_extern_netcdf_vars > 0 && ext_variables != NULL) {
     int retval;
-    size_t start_ptr;
-    size_t count_ptr;
+    size_t start_ptr[2];
+    size_t count_ptr[2];
     int i;
 
     /* Counters which imply the position in the NetCDF-variable where the data will be written, */
-    start_ptr = (size_t) t8_forest_get_first_local_element_id (forest);
-    count_ptr = (size_t) t8_forest_get_local_num_elements (forest);
-    ;
+    /* the element dimension is the last dimension of the variables */
+    const int ielem_dim = context->time_dependent ? 1 : 0;
+    start_ptr[ielem_dim] = (size_t) t8_forest_get_first_local_element_id (forest);
+    count_ptr[ielem_dim] = (size_t) t8_forest_get_local_num_elements (forest);
+
+    if (context->time_dependent) {
+      /* Write the time of the time step */
+      start_ptr[0] = context->time_step;
+#if T8_WITH_NETCDF_PAR
+      /* The write is collective but only the first rank writes a value */
+      int mpirank;
+      retval = sc_MPI_Comm_rank (comm, &mpirank);
+      SC_CHECK_MPI (retval);
+      count_ptr[0] = mpirank == 0 ? 1 : 0;
+#else
+      /* Each process writes its own file */
+      count_ptr[0] = 1;
+#endif
+      if ((retval = nc_put_vara_double (context->ncid, context->var_time_id, start_ptr, count_ptr, &context->time))) {
+        ERR (retval);
+      }
+      /* Each process writes its elements of the time step */
+      count_ptr[0] = 1;
+    }
 
     /* Iterate over the amount of user-defined variables */
     for (i = 0; i < num_extern_netcdf_vars; i++) {
 
       /* Check if exactly one value per element is given */
-      T8_ASSERT (count_ptr == ext_variables[i]->var_user_data->elem_count);
+      T8_ASSERT (count_ptr[ielem_dim] == ext_variables[i]->var_user_data->elem_count);
 
       /* Check the variable data type */
       switch (ext_variables[i]->datatype) {
       case T8_NETCDF_INT:
         /* NetCDF 32bit integer data will be written */
-        if ((retval = nc_put_vara_int (context->ncid, ext_variables[i]->var_user_dimid, &start_ptr, &count_ptr,
+        if ((retval = nc_put_vara_int (context->ncid, ext_variables[i]->var_user_dimid, start_ptr, count_ptr,
                                        (t8_nc_int32_t *) sc_array_index (ext_variables[i]->var_user_data, 0)))) {
           ERR (retval);
         }
         break;
       case T8_NETCDF_INT64:
         /* NetCDF 64bit integer data will be written */
-        if ((retval = nc_put_vara_long (context->ncid, ext_variables[i]->var_user_dimid, &start_ptr, &count_ptr,
+        if ((retval = nc_put_vara_long (context->ncid, ext_variables[i]->var_user_dimid, start_ptr, count_ptr,
                                         (t8_nc_int64_t *) sc_array_index (ext_variables[i]->var_user_data, 0)))) {
           ERR (retval);
         }
         break;
       case T8_NETCDF_DOUBLE:
         /* NetCDF double data will be written */
-        if ((retval = nc_put_vara_double (context->ncid, ext_variables[i]->var_user_dimid, &start_ptr, &count_ptr,
+        if ((retval = nc_put_vara_double (context->ncid, ext_variables[i]->var_user_dimid, start_ptr, count_ptr,
                                           (double *) sc_array_index (ext_variables[i]->var_user_data, 0)))) {
           ERR (retval);
         }
@@ -883,10 +1043,12 @@ t8_forest_write_netcdf_file (t8_forest_t forest, t8_forest_netcdf_context_t *con
   /* Create a parallel NetCDF-File (NetCDF-4/HDF5 file) */
   /* NC_MPIIO seems to be redundant since NetCDF version 4.6.2 */
 #if T8_WITH_NETCDF_PAR
-  if ((retval = nc_create_par (context->filename, NC_CLOBBER | NC_NETCDF4 | NC_MPIIO, comm, sc_MPI_INFO_NULL,
-                               &context->ncid))) {
+  /* Pass the hints for the collective buffering to MPI-IO */
+  MPI_Info info = t8_forest_netcdf_new_info (context);
+  if ((retval = nc_create_par (context->filename, NC_CLOBBER | NC_NETCDF4 | NC_MPIIO, comm, info, &context->ncid))) {
     ERR (retval);
   }
+  MPI_Info_free (&info);
   t8_debugf ("A parallel netCDf-file has been created.\n");
 #elif T8_WITH_NETCDF
   if ((retval = nc_create (context->filename, NC_CLOBBER | NC_NETCDF4, &context->ncid))) {
@@ -973,51 +1135,37 @@ t8_forest_write_netcdf_file (t8_forest_t forest, t8_forest_netcdf_context_t *con
 #endif
 }
 
-/* Function that gets called if a forest should be written in NetCDF-Format. This function is somehow an extended version which allows the user to decide if contiguous or chunked storage should used and whether the MPI ranks write independently or collectively. */
 void
-t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix, const char *file_title, int dim,
+t8_forest_netcdf_options_init (t8_forest_netcdf_options_t *options)
+{
+  T8_ASSERT (options != NULL);
+  options->storage_mode = NC_CONTIGUOUS;
+  options->chunk_elements = 0;
+  options->chunk_nodes = 0;
+  options->deflate_level = 0;
+  options->shuffle = 0;
+  options->mpi_access = NC_INDEPENDENT;
+  options->cb_nodes = 0;
+  options->cb_buffer_size = 0;
+  options->time_dependent = 0;
+  options->time = 0;
+}
+
+/* Function that gets called if a forest should be written in NetCDF-Format with given storage and access options. */
+void
+t8_forest_write_netcdf_opt (t8_forest_t forest, const char *file_prefix, const char *file_title, int dim,
                             int num_extern_netcdf_vars, t8_netcdf_variable_t *ext_variables[], sc_MPI_Comm comm,
-                            int netcdf_var_storage_mode, int netcdf_mpi_access)
+                            const t8_forest_netcdf_options_t *options)
 {
   t8_forest_netcdf_context_t context;
   /* Check whether pointers are not NULL */
   T8_ASSERT (file_title != NULL);
   T8_ASSERT (file_prefix != NULL);
+  T8_ASSERT (options != NULL);
   char file_name[BUFSIZ];
 
   /* Create the NetCDF-Filename */
-  snprintf (file_name, BUFSIZ, "%s.nc", file_prefix);
-
-#if !T8_WITH_NETCDF_PAR
-  /* In case of a parallel configuration without parallel netCDF routines */
-  int retval;
-  int mpirank, mpisize;
-  /* Size of the communicator */
-  retval = sc_MPI_Comm_size (comm, &mpisize);
-  SC_CHECK_MPI (retval);
-  /* Get the rank of the process */
-  retval = sc_MPI_Comm_rank (comm, &mpirank);
-  SC_CHECK_MPI (retval);
-
-  /** \note This prevents the single file to be overwritten if more processes are involved,
-   * in a configuration which does not feature parallel netCDF routines!
-   * Otherwise, if several processes try to write in the same file,
-   * the result will be an HDF-5 error. Now, each process will create its own
-   * file. Each of these files will be as big as if all processes would have written into the same file,
-   * but in each file is only the process-local data defined.
-   * (-> storage requirement is the #ranks-fold storage requirement of a serial or parallel netCDF run)
-   *
-   * \note Therefore, it is advisable to either run the whole program with only one MPI rank or
-   * make use of a parallel netCDF/HDF-5 configuration
-   */
-  if (mpisize > 1) {
-    /* Create the NetCDF-Filename for each process */
-    snprintf (file_name, BUFSIZ, "%s_rank_%d.nc", file_prefix, mpirank);
-    t8_global_productionf (
-      "Note: The program is executed in parallel, but the netCDF Usage is serial.\nThis is not advisable, you may want "
-      "to either execute the program with only one MPI rank or use a parallel netCDF/HDF-5 configuration\n");
-  }
-#endif
+  t8_forest_netcdf_file_name (file_name, file_prefix, comm);
 
   /* Initialize first variables for netCDF purposes. */
   /* Therefore, create a 'context' and initialize it with given properties */
@@ -1029,29 +1177,7 @@ t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix, const c
   context.fillvalue64 = -1;
   context.start_index = 0;
   context.convention = "UGRID v1.0";
-
-#if T8_WITH_NETCDF
-  /* Check the given 'netcdf_storage_mode' */
-  if (netcdf_var_storage_mode != NC_CONTIGUOUS && netcdf_var_storage_mode != NC_CHUNKED) {
-    t8_global_productionf ("Illegal input parameter for the storage-mode (NC_CONTIGUOUS or NC_CHUNKED) was "
-                           "given.\nTherefore, NC_CONTIGUOUS will be used as the default value.\n");
-    context.netcdf_var_storage_mode = NC_CONTIGUOUS;
-  }
-  else {
-    context.netcdf_var_storage_mode = netcdf_var_storage_mode;
-  }
-#endif
-#if T8_WITH_NETCDF_PAR
-  /* Check the given 'netcdf_mpi_access' */
-  if (netcdf_mpi_access != NC_INDEPENDENT && netcdf_mpi_access != NC_COLLECTIVE) {
-    t8_global_productionf ("Illegal input parameter for the variable-mpi-access (NC_INDEPENDENT or NC_COLLECTIVE) was "
-                           "given.\nTherefore, NC_INDEPENDENT will be used as the default value.\n");
-    context.netcdf_mpi_access = NC_INDEPENDENT;
-  }
-  else {
-    context.netcdf_mpi_access = netcdf_mpi_access;
-  }
-#endif
+  t8_forest_netcdf_init_context_options (&context, options);
 
   /* Create and initialize the 'namespace_context' which holds the names of the variables, they vary depending on the given dimension */
   t8_forest_netcdf_ugrid_namespace_t namespace_context;
@@ -1067,6 +1193,150 @@ t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix, const c
   }
 }
 
+/* Function that gets called if a forest should be written in NetCDF-Format. This function is somehow an extended version which allows the user to decide if contiguous or chunked storage should used and whether the MPI ranks write independently or collectively. */
+void
+t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix, const char *file_title, int dim,
+                            int num_extern_netcdf_vars, t8_netcdf_variable_t *ext_variables[], sc_MPI_Comm comm,
+                            int netcdf_var_storage_mode, int netcdf_mpi_access)
+{
+  t8_forest_netcdf_options_t options;
+
+  t8_forest_netcdf_options_init (&options);
+  options.storage_mode = netcdf_var_storage_mode;
+  options.mpi_access = netcdf_mpi_access;
+  t8_forest_write_netcdf_opt (forest, file_prefix, file_title, dim, num_extern_netcdf_vars, ext_variables, comm,
+                              &options);
+}
+
+#if T8_WITH_NETCDF
+/* Count the global number of mesh nodes that t8_forest_write_netcdf_opt writes for a forest */
+static t8_gloidx_t
+t8_forest_netcdf_global_num_nodes (t8_forest_t forest, sc_MPI_Comm comm)
+{
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  t8_gloidx_t num_local_nodes = 0;
+  t8_gloidx_t num_nodes;
+  int mpiret;
+
+  for (t8_locidx_t ltree_id = 0; ltree_id < num_local_trees; ltree_id++) {
+    const t8_locidx_t num_local_tree_elem = t8_forest_get_tree_num_elements (forest, ltree_id);
+    t8_eclass_scheme_c *scheme = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, ltree_id));
+    for (t8_locidx_t local_elem_id = 0; local_elem_id < num_local_tree_elem; local_elem_id++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest, ltree_id, local_elem_id);
+      num_local_nodes += t8_element_shape_num_vertices (scheme->t8_element_shape (element));
+    }
+  }
+  mpiret = sc_MPI_Allreduce (&num_local_nodes, &num_nodes, 1, T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  return num_nodes;
+}
+#endif
+
+/* Function that appends a time step of the user-defined variables to an existing time dependent NetCDF-File */
+void
+t8_forest_write_netcdf_time_step (t8_forest_t forest, const char *file_prefix, int dim, double time,
+                                  int num_extern_netcdf_vars, t8_netcdf_variable_t *ext_variables[],
+                                  sc_MPI_Comm comm, const t8_forest_netcdf_options_t *options)
+{
+  t8_forest_netcdf_context_t context;
+  t8_forest_netcdf_options_t default_options;
+  char file_name[BUFSIZ];
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (file_prefix != NULL);
+  if (options == NULL) {
+    t8_forest_netcdf_options_init (&default_options);
+    options = &default_options;
+  }
+
+  /* Open the file that was written by t8_forest_write_netcdf_opt */
+  t8_forest_netcdf_file_name (file_name, file_prefix, comm);
+  context.filename = file_name;
+  context.dim = dim;
+  t8_forest_netcdf_init_context_options (&context, options);
+  context.time_dependent = 1;
+  context.time = time;
+
+  if (dim < 2 || dim > 3) {
+    t8_global_errorf ("Only writing 2D and 3D netCDF forest data is supported.\n");
+    return;
+  }
+#if T8_WITH_NETCDF
+  t8_forest_netcdf_ugrid_namespace_t namespace_context;
+  size_t num_file_elements;
+  size_t num_file_nodes;
+  int retval;
+
+  t8_forest_init_ugrid_namespace_context (&namespace_context, dim);
+#if T8_WITH_NETCDF_PAR
+  MPI_Info info = t8_forest_netcdf_new_info (&context);
+  if ((retval = nc_open_par (context.filename, NC_WRITE | NC_MPIIO, comm, info, &context.ncid))) {
+    ERR (retval);
+  }
+  MPI_Info_free (&info);
+#else
+  if ((retval = nc_open (context.filename, NC_WRITE, &context.ncid))) {
+    ERR (retval);
+  }
+#endif
+
+  /* The mesh variables are reused, therefore the forest must have as many elements and nodes as the written mesh */
+  if ((retval = nc_inq_dimid (context.ncid, namespace_context.dim_nMesh_elem, &context.nMesh_elem_dimid))) {
+    ERR (retval);
+  }
+  if ((retval = nc_inq_dimlen (context.ncid, context.nMesh_elem_dimid, &num_file_elements))) {
+    ERR (retval);
+  }
+  if ((retval = nc_inq_dimid (context.ncid, namespace_context.dim_nMesh_node, &context.nMesh_node_dimid))) {
+    ERR (retval);
+  }
+  if ((retval = nc_inq_dimlen (context.ncid, context.nMesh_node_dimid, &num_file_nodes))) {
+    ERR (retval);
+  }
+  SC_CHECK_ABORT ((t8_gloidx_t) num_file_elements == t8_forest_get_global_num_elements (forest)
+                    && (t8_gloidx_t) num_file_nodes == t8_forest_netcdf_global_num_nodes (forest, comm),
+                  "The forest does not match the mesh of the netCDF file.");
+
+  /* The new time step is appended after the existing time steps */
+  if ((retval = nc_inq_dimid (context.ncid, "time", &context.time_dimid))) {
+    ERR (retval);
+  }
+  if ((retval = nc_inq_dimlen (context.ncid, context.time_dimid, &context.time_step))) {
+    ERR (retval);
+  }
+  if ((retval = nc_inq_varid (context.ncid, "time", &context.var_time_id))) {
+    ERR (retval);
+  }
+#if T8_WITH_NETCDF_PAR
+  /* Extending the unlimited time dimension has to be collective */
+  if ((retval = nc_var_par_access (context.ncid, context.var_time_id, NC_COLLECTIVE))) {
+    ERR (retval);
+  }
+#endif
+  for (int ivar = 0; ivar < num_extern_netcdf_vars; ivar++) {
+    if ((retval = nc_inq_varid (context.ncid, ext_variables[ivar]->variable_name,
+                                &ext_variables[ivar]->var_user_dimid))) {
+      ERR (retval);
+    }
+#if T8_WITH_NETCDF_PAR
+    if ((retval = nc_var_par_access (context.ncid, ext_variables[ivar]->var_user_dimid, NC_COLLECTIVE))) {
+      ERR (retval);
+    }
+#endif
+  }
+
+  /* Write the user-defined variable data of the time step */
+  t8_forest_write_user_netcdf_data (forest, &context, num_extern_netcdf_vars, ext_variables, comm);
+
+  if ((retval = nc_close (context.ncid))) {
+    ERR (retval);
+  }
+  t8_debugf ("Time step %zu has been appended to the NetCDF-File.\n", context.time_step);
+#else
+  t8_global_errorf ("This version of t8code is not compiled with netcdf support.\n");
+#endif
+}
+
 /* Function which writes out the forest in the netCDF format, this function calls the extended method with given default values (e.g. NC_CONTIGUOUS and NC_INDEPENDENT) for storage and MPI access for variables */
 void
 t8_forest_write_netcdf (t8_forest_t forest, const char *file_prefix, const char *file_title, int dim,
@@ -437,6 +437,76 @@ t8_forest_partition_compute_new_offset (t8_forest_t forest)
   t8_shmem_array_end_writing (forest->element_offsets);
 }
 
+/* Calculate the new element_offset for forest from the element costs
+ * recorded on forest->set_from.
+ * Process p is assigned all elements whose cost prefix (the sum of the costs
+ * of all elements before it) lies in [p * W / P, (p + 1) * W / P), where W is the
+ * global sum of all costs and P the number of processes.
+ * Each process counts for each p how many of its local elements belong to processes < p,
+ * the sum over all processes of these counts is the new offset of p. */
+static void
+t8_forest_partition_compute_new_offset_weighted (t8_forest_t forest)
+{
+  t8_forest_t forest_from = forest->set_from;
+  sc_MPI_Comm comm = forest->mpicomm;
+  const double *costs = forest_from->element_costs;
+  const t8_locidx_t num_local_elements = forest_from->local_num_elements;
+  double local_cost = 0, global_cost, prefix_cost;
+  int mpiret;
+
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (forest->element_offsets == NULL);
+
+  /* If this process did not record any costs, all its elements have cost 0 */
+  if (costs != NULL) {
+    for (t8_locidx_t ielement = 0; ielement < num_local_elements; ielement++) {
+      local_cost += costs[ielement];
+    }
+  }
+  mpiret = sc_MPI_Allreduce (&local_cost, &global_cost, 1, sc_MPI_DOUBLE, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (global_cost <= 0) {
+    /* No cost was recorded, fall back to the partition without weights */
+    t8_forest_partition_compute_new_offset (forest);
+    return;
+  }
+  /* The cost of all elements on the processes before this one */
+  mpiret = sc_MPI_Scan (&local_cost, &prefix_cost, 1, sc_MPI_DOUBLE, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  prefix_cost -= local_cost;
+
+  t8_gloidx_t *local_counts = T8_ALLOC_ZERO (t8_gloidx_t, forest->mpisize + 1);
+  t8_gloidx_t *new_offsets = T8_ALLOC (t8_gloidx_t, forest->mpisize + 1);
+  t8_locidx_t ielement = 0;
+  for (int iproc = 1; iproc < forest->mpisize; iproc++) {
+    const double proc_first_cost = iproc * global_cost / forest->mpisize;
+    while (ielement < num_local_elements && prefix_cost < proc_first_cost) {
+      prefix_cost += costs != NULL ? costs[ielement] : 0;
+      ielement++;
+    }
+    local_counts[iproc] = ielement;
+  }
+  local_counts[forest->mpisize] = num_local_elements;
+  mpiret = sc_MPI_Allreduce (local_counts, new_offsets, forest->mpisize + 1, T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  T8_ASSERT (new_offsets[0] == 0);
+  T8_ASSERT (new_offsets[forest->mpisize] == forest_from->global_num_elements);
+
+  /* Set the shmem array type to comm */
+  t8_shmem_init (comm);
+  t8_shmem_set_type (comm, T8_SHMEM_BEST_TYPE);
+  /* Initialize the shmem array and copy the new offsets */
+  t8_shmem_array_init (&forest->element_offsets, sizeof (t8_gloidx_t), forest->mpisize + 1, comm);
+  if (t8_shmem_array_start_writing (forest->element_offsets)) {
+    t8_gloidx_t *element_offsets = t8_shmem_array_get_gloidx_array_for_writing (forest->element_offsets);
+    memcpy (element_offsets, new_offsets, (forest->mpisize + 1) * sizeof (t8_gloidx_t));
+  }
+  t8_shmem_array_end_writing (forest->element_offsets);
+
+  T8_FREE (local_counts);
+  T8_FREE (new_offsets);
+}
+
 /* Find the owner of a given element.
  */
 static int
@@ -1149,7 +1219,8 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data, const sc_arr
 }
 
 /* Populate a forest with the partitioned elements of forest->set_from.
- * Currently the elements are distributed evenly (each element has the same weight).
+ * If forest->set_from has recorded element costs, they are used as weights.
+ * Otherwise the elements are distributed evenly (each element has the same weight).
  */
 void
 t8_forest_partition (t8_forest_t forest)
@@ -1181,8 +1252,19 @@ t8_forest_partition (t8_forest_t forest)
   }
   /* TODO: if offsets already exist on forest_from, check it for consistency */
 
-  /* We now calculate the new element offsets */
-  t8_forest_partition_compute_new_offset (forest);
+  /* We now calculate the new element offsets.
+   * Costs are recorded per process, so we need to check whether any process recorded any. */
+  int local_has_costs = forest_from->element_costs != NULL;
+  int has_costs;
+  int mpiret = sc_MPI_Allreduce (&local_has_costs, &has_costs, 1, sc_MPI_INT, sc_MPI_LOR, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (has_costs) {
+    /* Use the measured element costs as weights */
+    t8_forest_partition_compute_new_offset_weighted (forest);
+  }
+  else {
+    t8_forest_partition_compute_new_offset (forest);
+  }
   t8_forest_partition_given (forest, 0, NULL, NULL);
 
   T8_ASSERT ((size_t) t8_forest_get_num_local_trees (forest_from) == forest_from->trees->elem_count);
@@ -68,6 +68,11 @@ t8_forest_compute_desc (t8_forest_t forest);
 void
 t8_forest_populate (t8_forest_t forest);
 
+/* Create the elements on this process from the checkpoint file set with
+ * t8_forest_set_load. */
+void
+t8_forest_load_leaves (t8_forest_t forest);
+
 /** Return the eclass scheme of a given element class associated to a forest.
  * This function does not check whether the given forest is committed, use with
  * caution and only if you are sure that the eclass_scheme was set.
@@ -177,6 +182,40 @@ t8_forest_get_tree_element (t8_tree_t tree, t8_locidx_t elem_in_tree);
 t8_element_array_t *
 t8_forest_get_tree_element_array (t8_forest_t forest, t8_locidx_t ltreeid);
 
+/** Compute and store the linear ids at the forest's maxlevel and the levels of the local elements.
+ * This is called in \ref t8_forest_commit if \ref t8_forest_set_linear_id_cache is enabled.
+ * The cache is freed together with the trees of the forest.
+ * \param [in,out] forest  A committed forest without cached linear ids.
+ */
+void
+t8_forest_build_tree_keys (t8_forest_t forest);
+
+/** Return the cached linear ids at the forest's maxlevel of the elements of a local tree.
+ * This function does not modify the forest and can be called from multiple threads.
+ * \param [in] forest      A committed forest.
+ * \param [in] ltreeid     The local id of a local tree.
+ * \param [out] levels     If not NULL, on output a pointer to the levels of the elements,
+ *                         or NULL if the linear ids are not cached.
+ * \return                 The linear ids of the elements in the tree, in ascending order,
+ *                         or NULL if the linear ids are not cached. Must not be modified or freed.
+ * \see t8_forest_set_linear_id_cache
+ */
+const t8_linearidx_t *
+t8_forest_tree_get_linear_ids (const t8_forest_t forest, t8_locidx_t ltreeid, const int8_t **levels);
+
+/** Search for a linear element id (at forest->maxlevel) in the elements of a local tree.
+ * If the element does not exist, return the largest index i such that the element at
+ * position i has a smaller id than the given one. If no such i exists, return -1.
+ * If the linear ids of the forest are cached, the cache is searched without branches in the loop,
+ * otherwise the elements are decoded.
+ * \param [in] forest      A committed forest.
+ * \param [in] ltreeid     The local id of a local tree.
+ * \param [in] element_id  A linear id at the forest's maxlevel.
+ * \return                 The index of the element in the tree, or -1.
+ */
+t8_locidx_t
+t8_forest_tree_bin_search_lower (const t8_forest_t forest, t8_locidx_t ltreeid, t8_linearidx_t element_id);
+
 /** Find the owner process of a given element, deprecated version.
  * Use t8_forest_element_find_owner instead.
  * \param [in]     forest  The forest.
@@ -244,6 +283,24 @@ int
 t8_forest_element_find_owner_ext (t8_forest_t forest, t8_gloidx_t gtreeid, t8_element_t *element, t8_eclass_t eclass,
                                   int lower_bound, int upper_bound, int guess, int element_is_desc);
 
+/** Find the owner processes of many elements at once.
+ * Instead of a binary search for each element, the elements are sorted by their
+ * first descendants and the owners are found in one sweep over the partition.
+ * \param [in]    forest       The forest.
+ * \param [in]    num_elements The number of elements.
+ * \param [in]    gtreeids     For each element the global id of its tree.
+ * \param [in]    elements     The elements to look for.
+ * \param [in]    eclasses     For each element the element class of its tree.
+ * \param [out]   owners       An array of \a num_elements ints. On output the owner
+ *                             process of each element, in the order of \a elements.
+ * \note The same conditions as for \ref t8_forest_element_find_owner apply to each element.
+ * \note \a forest must be committed before calling this function.
+ * \see t8_forest_element_find_owner
+ */
+void
+t8_forest_element_find_owners (t8_forest_t forest, size_t num_elements, const t8_gloidx_t *gtreeids,
+                               const t8_element_t *const *elements, const t8_eclass_t *eclasses, int *owners);
+
 /** Perform a constant runtime check if a given rank is owner of a given element.
  * If the element is owned by more than one rank, then this check is only true
  * for the smallest.
@@ -381,6 +438,74 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
                                        t8_element_t *neighs[], t8_eclass_scheme_c *neigh_scheme, int face,
                                        int num_neighs, int dual_faces[]);
 
+/** Construct the face neighbor of an element in a tree that is given by its cmesh local id.
+ * This is the same as \ref t8_forest_element_face_neighbor, but the tree does not
+ * need to be a local tree of the forest.
+ * \param [in]     forest  The forest.
+ * \param [in]     lctreeid The cmesh local id of the tree in which \a elem is.
+ *                         Must be a local tree of the cmesh.
+ * \param [in]     elem    The element.
+ * \param [in,out] neigh   An allocated element of the scheme \a neigh_scheme.
+ *                         On output the face neighbor of \a elem across \a face.
+ * \param [in]     neigh_scheme The eclass scheme of the neighbor tree.
+ * \param [in]     face    A face of \a elem.
+ * \param [out]    neigh_face The face of \a neigh at the connection.
+ * \return                 The global id of the neighbor tree, -1 if there is no neighbor.
+ */
+t8_gloidx_t
+t8_forest_element_face_neighbor_cmesh (t8_forest_t forest, t8_locidx_t lctreeid, const t8_element_t *elem,
+                                       t8_element_t *neigh, t8_eclass_scheme_c *neigh_scheme, int face,
+                                       int *neigh_face);
+
+/** An element of the same level as a leaf that shares vertices with the leaf.
+ * \see t8_forest_element_vertex_neighbors */
+typedef struct
+{
+  t8_locidx_t lctreeid;  /**< The cmesh local id of the tree of the element. */
+  t8_gloidx_t gtreeid;   /**< The global id of the tree of the element. */
+  t8_eclass_t eclass;    /**< The element class of the tree. */
+  t8_element_t *element; /**< The element. */
+  int num_shared;        /**< The number of corners of the element that are vertices of the leaf. */
+  int leaf_corners[T8_ECLASS_MAX_CORNERS]; /**< For each corner of the element the bit mask of the corners
+                                                of the leaf that are this vertex, 0 if it is not a vertex
+                                                of the leaf. More than one bit is set if the leaf touches
+                                                itself, for example across a periodic boundary. */
+} t8_forest_vertex_neighbor_t;
+
+/** Compute the elements of the same level as a leaf that share at least \a min_touch vertices
+ * with the leaf, also across tree boundaries and periodic boundaries.
+ * Shared vertices are determined topologically: within a tree by the reference coordinates of
+ * the element vertices and across trees through the face connections of the cmesh.
+ * \param [in]     forest    The forest.
+ * \param [in]     ltreeid   The local id of the tree of \a leaf.
+ * \param [in]     leaf      A local leaf.
+ * \param [in]     min_touch The minimum number of shared vertices, 1 for vertex neighbors,
+ *                           2 for edge neighbors.
+ * \param [in,out] neighbors An array of \ref t8_forest_vertex_neighbor_t. On output, the neighbors
+ *                           are appended. The first appended entry is a copy of \a leaf, each of its
+ *                           corners is shared with the corresponding leaf corner. The elements must be
+ *                           destroyed by the caller.
+ * \note For a partitioned cmesh, neighbors that are only reachable through trees that are not
+ *       local trees of the cmesh are not found.
+ */
+void
+t8_forest_element_vertex_neighbors (t8_forest_t forest, t8_locidx_t ltreeid, const t8_element_t *leaf, int min_touch,
+                                    sc_array_t *neighbors);
+
+/** Compute the orientation of the tree connection across a face of an element.
+ * \param [in]     forest  The forest.
+ * \param [in]     ltreeid The local tree id of the tree in which \a elem is.
+ * \param [in]     ts      The eclass scheme of \a elem.
+ * \param [in]     elem    An element in the tree \a ltreeid.
+ * \param [in]     face    A face of \a elem.
+ * \return                 The orientation of the face connection of the tree across
+ *                         \a face, see \ref t8_cmesh_get_face_neighbor.
+ *                         0 if \a face is not at the tree boundary or there is no neighbor tree.
+ */
+int
+t8_forest_leaf_face_orientation (t8_forest_t forest, t8_locidx_t ltreeid, t8_eclass_scheme_c *ts,
+                                 const t8_element_t *elem, int face);
+
 /** Iterate over all leaves of a forest and for each face compute the face neighbor
  * leaves with \ref t8_forest_leaf_face_neighbors and print their local element ids.
  * This function is meant for debugging only.
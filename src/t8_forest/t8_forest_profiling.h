@@ -132,6 +132,84 @@ t8_forest_profile_get_ghost_time (t8_forest_t forest, t8_locidx_t *ghosts_sent);
  */
 double
 t8_forest_profile_get_ghostexchange_waittime (t8_forest_t forest);
+
+/** Add a measured cost (for example a compute time in seconds) to a range
+ * of local elements. The cost is distributed evenly among the elements.
+ * The accumulated costs are used as partition weights when a new forest is
+ * partitioned from \a forest, see \ref t8_forest_set_partition.
+ * \param [in,out] forest         The forest.
+ * \param [in]     first_lelement The local index of the first element of the range.
+ * \param [in]     num_elements   The number of elements in the range.
+ * \param [in]     cost           The cost of all elements of the range together. Must be >= 0.
+ * \a forest must be committed before calling this function.
+ */
+void
+t8_forest_cost_add_range (t8_forest_t forest, t8_locidx_t first_lelement, t8_locidx_t num_elements, double cost);
+
+/** Add a measured cost to a single local element.
+ * \param [in,out] forest         The forest.
+ * \param [in]     ltreeid        A local tree id.
+ * \param [in]     leid_in_tree   The index of the element within the tree.
+ * \param [in]     cost           The cost of the element. Must be >= 0.
+ * \a forest must be committed before calling this function.
+ * \see t8_forest_cost_add_range
+ */
+void
+t8_forest_cost_add_element (t8_forest_t forest, t8_locidx_t ltreeid, t8_locidx_t leid_in_tree, double cost);
+
+/** Add a measured cost to a local tree. The cost is distributed evenly
+ * among the elements of the tree.
+ * \param [in,out] forest         The forest.
+ * \param [in]     ltreeid        A local tree id.
+ * \param [in]     cost           The cost of all elements of the tree together. Must be >= 0.
+ * \a forest must be committed before calling this function.
+ * \see t8_forest_cost_add_range
+ */
+void
+t8_forest_cost_add_tree (t8_forest_t forest, t8_locidx_t ltreeid, double cost);
+
+/** Set all recorded element costs of a forest back to zero.
+ * \param [in,out] forest         The forest.
+ * \a forest must be committed before calling this function.
+ */
+void
+t8_forest_cost_reset (t8_forest_t forest);
+
+/** Return the array of recorded element costs of a forest.
+ * \param [in]     forest         The forest.
+ * \return                        An array of length \ref t8_forest_get_local_num_elements
+ *                                storing the accumulated cost of each local element, or NULL
+ *                                if no cost was recorded.
+ * \a forest must be committed before calling this function.
+ */
+const double *
+t8_forest_cost_get_array (t8_forest_t forest);
+
+/** Compute the global imbalance of the recorded element costs.
+ * The imbalance is the maximum cost of a process divided by the average cost per process.
+ * A perfectly balanced forest has imbalance 1.
+ * \param [in,out] forest         The forest. The result is stored in the forest.
+ * \return                        The imbalance ratio. 1 if no process recorded any cost.
+ * \a forest must be committed before calling this function.
+ * \note This function is MPI collective.
+ */
+double
+t8_forest_compute_cost_imbalance (t8_forest_t forest);
+
+/** Decide whether the measured costs of a forest are imbalanced enough that
+ * a repartition is worthwhile.
+ * \param [in,out] forest         The forest.
+ * \param [in]     threshold      The admissible imbalance ratio, for example 1.1
+ *                                to allow the most expensive process to be 10%
+ *                                above average. Must be >= 1.
+ * \return                        True if and only if the imbalance as computed by
+ *                                \ref t8_forest_compute_cost_imbalance exceeds \a threshold.
+ *                                The return value is the same on all processes.
+ * \a forest must be committed before calling this function.
+ * \note This function is MPI collective.
+ */
+int
+t8_forest_should_repartition (t8_forest_t forest, double threshold);
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_PROFILING_H */
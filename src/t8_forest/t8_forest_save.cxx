@@ -0,0 +1,708 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this file we save a forest to a single binary checkpoint file and load it again.
+ * The file consists of the following sections:
+ *  - The header t8_forest_checkpoint_header_t.
+ *  - The partition: The global index of the first element of each process, mpisize + 1 entries.
+ *  - The tree offsets: The global index of the first element of each tree, num_trees + 1 entries.
+ *  - The blocks: For each block of block_size leaves the position of its first leaf in the leaf stream
+ *    and the tree of its first leaf, num_blocks + 1 entries.
+ *  - The leaf stream: The compressed level and linear id of all leaves in SFC order, padded to 8 bytes.
+ *  - If data_size > 0, data_size bytes of element data per element.
+ * All fixed size numbers are stored in the byte order of the writing machine.
+ * Each process writes and reads a contiguous range of the element sections with collective MPI I/O.
+ * A process writes the tree offsets of the trees whose first element it owns and reads the tree offsets
+ * of the trees between its first and last block, such that no process handles the offsets of all trees.
+ *
+ * In the leaf stream, each leaf is stored as a sequence of unsigned variable length integers
+ * with 7 bits per byte. A leaf with the same level as the previous leaf in the same tree is
+ * stored as (d - 1) << 1, where d > 0 is the difference of the linear ids on this level.
+ * All other leaves are stored as (level << 1) | 1, followed by the linear id.
+ * The first leaf of each block, of each tree and of each writing process is stored in the second way,
+ * such that the leaf stream can be decoded starting at the beginning of any block.
+ * In uniform regions of the forest a leaf needs only one byte. */
+
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_io.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_cmesh.h>
+#include <t8_element_cxx.hxx>
+#include <algorithm>
+
+T8_EXTERN_C_BEGIN ();
+
+/** The magic string at the beginning of a forest checkpoint file. */
+#define T8_FOREST_CHECKPOINT_MAGIC "t8forst"
+
+/** Increment this constant each time the file format changes. */
+#define T8_FOREST_CHECKPOINT_FORMAT 3
+
+/** The number of leaves in a block of the leaf stream. */
+#define T8_FOREST_CHECKPOINT_BLOCK_SIZE 1024
+
+/** The maximum number of bytes of one leaf in the leaf stream. */
+#define T8_FOREST_CHECKPOINT_MAX_LEAF_BYTES 12
+
+/** The largest number of bytes that we read or write with a count of MPI_BYTE. */
+#define T8_FOREST_CHECKPOINT_CHUNK_SIZE ((size_t) 1 << 30)
+
+/* The header of a forest checkpoint file. */
+typedef struct
+{
+  char magic[8];               /* T8_FOREST_CHECKPOINT_MAGIC */
+  int64_t format;              /* T8_FOREST_CHECKPOINT_FORMAT */
+  int64_t mpisize;             /* The number of processes that wrote the file. */
+  int64_t dimension;           /* The dimension of the forest. */
+  int64_t global_num_trees;    /* The number of trees. */
+  int64_t global_num_elements; /* The number of elements. */
+  int64_t data_size;           /* The number of bytes of data per element, 0 if no data was written. */
+  int64_t block_size;          /* The number of leaves in a block of the leaf stream. */
+  int64_t leaf_stream_size;    /* The number of bytes of the leaf stream. */
+  int64_t incomplete_trees;    /* True if elements were removed from the forest. */
+} t8_forest_checkpoint_header_t;
+
+/* An entry of the block section of a checkpoint file. */
+typedef struct
+{
+  int64_t leaf_offset; /* The position of the first leaf of the block in the leaf stream. */
+  int64_t tree;        /* The global id of the tree of the first leaf of the block. */
+} t8_forest_checkpoint_block_t;
+
+/* The positions of the sections in a checkpoint file. */
+typedef struct
+{
+  int64_t partition;
+  int64_t tree_offsets;
+  int64_t blocks;
+  int64_t leaves;
+  int64_t data;
+} t8_forest_checkpoint_sections_t;
+
+/* An open checkpoint file. Without MPI I/O, we can only use files on a single process. */
+typedef struct
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_File file;
+#else
+  FILE *file;
+#endif
+} t8_forest_checkpoint_file_t;
+
+/* The number of blocks of the leaf stream */
+static int64_t
+t8_forest_checkpoint_num_blocks (const t8_forest_checkpoint_header_t *header)
+{
+  return (header->global_num_elements + header->block_size - 1) / header->block_size;
+}
+
+static void
+t8_forest_checkpoint_sections (const t8_forest_checkpoint_header_t *header, t8_forest_checkpoint_sections_t *sections)
+{
+  sections->partition = sizeof (t8_forest_checkpoint_header_t);
+  sections->tree_offsets = sections->partition + (header->mpisize + 1) * sizeof (int64_t);
+  sections->blocks = sections->tree_offsets + (header->global_num_trees + 1) * sizeof (int64_t);
+  sections->leaves
+    = sections->blocks + (t8_forest_checkpoint_num_blocks (header) + 1) * sizeof (t8_forest_checkpoint_block_t);
+  sections->data = sections->leaves + header->leaf_stream_size + (-header->leaf_stream_size & 7);
+}
+
+/* Write an unsigned integer with 7 bits per byte, lowest bits first.
+ * The highest bit of a byte is set if more bytes follow. Returns the position after the integer. */
+static uint8_t *
+t8_forest_checkpoint_put_varint (uint8_t *pos, uint64_t value)
+{
+  while (value >= 0x80) {
+    *pos++ = (uint8_t) (value | 0x80);
+    value >>= 7;
+  }
+  *pos++ = (uint8_t) value;
+  return pos;
+}
+
+/* Read an unsigned integer written with t8_forest_checkpoint_put_varint.
+ * Returns the position after the integer, or NULL if the integer exceeds end. */
+static const uint8_t *
+t8_forest_checkpoint_get_varint (const uint8_t *pos, const uint8_t *end, uint64_t *value)
+{
+  int shift;
+
+  *value = 0;
+  for (shift = 0; pos < end && shift < 64; shift += 7) {
+    *value |= (uint64_t) (*pos & 0x7f) << shift;
+    if (!(*pos++ & 0x80)) {
+      return pos;
+    }
+  }
+  return NULL;
+}
+
+/* Open a checkpoint file on all processes of comm. Returns true on success. */
+static int
+t8_forest_checkpoint_open (sc_MPI_Comm comm, const char *filename, int write, t8_forest_checkpoint_file_t *fp)
+{
+#ifdef T8_ENABLE_MPIIO
+  int mpiret;
+
+  if (write) {
+    mpiret = MPI_File_open (comm, filename, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &fp->file);
+    if (mpiret == MPI_SUCCESS) {
+      /* Remove the contents of an existing file */
+      mpiret = MPI_File_set_size (fp->file, 0);
+    }
+  }
+  else {
+    mpiret = MPI_File_open (comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fp->file);
+  }
+  return mpiret == MPI_SUCCESS;
+#else
+  int mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (mpisize == 1, "Forest checkpoints on more than one process require MPI I/O.");
+  fp->file = fopen (filename, write ? "wb" : "rb");
+  return fp->file != NULL;
+#endif
+}
+
+#ifdef T8_ENABLE_MPIIO
+/* Create a datatype of num_bytes contiguous bytes, such that the count of an MPI I/O call fits into an int.
+ * Up to T8_FOREST_CHECKPOINT_CHUNK_SIZE bytes are transferred as MPI_BYTE, more bytes as one struct of
+ * whole chunks followed by the remaining bytes. Returns true if the datatype must be freed. */
+static int
+t8_forest_checkpoint_bytes_type (size_t num_bytes, MPI_Datatype *datatype, int *count)
+{
+  MPI_Datatype chunk_type, types[2];
+  MPI_Aint displacements[2];
+  int blocklengths[2];
+
+  if (num_bytes <= T8_FOREST_CHECKPOINT_CHUNK_SIZE) {
+    *datatype = MPI_BYTE;
+    *count = (int) num_bytes;
+    return 0;
+  }
+  MPI_Type_contiguous ((int) T8_FOREST_CHECKPOINT_CHUNK_SIZE, MPI_BYTE, &chunk_type);
+  blocklengths[0] = (int) (num_bytes / T8_FOREST_CHECKPOINT_CHUNK_SIZE);
+  blocklengths[1] = (int) (num_bytes % T8_FOREST_CHECKPOINT_CHUNK_SIZE);
+  displacements[0] = 0;
+  displacements[1] = (MPI_Aint) (num_bytes - blocklengths[1]);
+  types[0] = chunk_type;
+  types[1] = MPI_BYTE;
+  MPI_Type_create_struct (2, blocklengths, displacements, types, datatype);
+  MPI_Type_commit (datatype);
+  MPI_Type_free (&chunk_type);
+  *count = 1;
+  return 1;
+}
+#endif
+
+/* Write num_bytes bytes at a position of the file. This function is collective,
+ * processes that do not write anything must call it with num_bytes = 0. Returns true on success. */
+static int
+t8_forest_checkpoint_write_at (t8_forest_checkpoint_file_t *fp, int64_t offset, const void *buffer, size_t num_bytes)
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_Datatype datatype;
+  int count, free_type, ret;
+
+  free_type = t8_forest_checkpoint_bytes_type (num_bytes, &datatype, &count);
+  ret = MPI_File_write_at_all (fp->file, offset, buffer, count, datatype, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+  if (free_type) {
+    MPI_Type_free (&datatype);
+  }
+  return ret;
+#else
+  if (num_bytes == 0) {
+    return 1;
+  }
+  return fseek (fp->file, offset, SEEK_SET) == 0 && fwrite (buffer, 1, num_bytes, fp->file) == num_bytes;
+#endif
+}
+
+/* Read num_bytes bytes at a position of the file. This function is collective. Returns true on success. */
+static int
+t8_forest_checkpoint_read_at (t8_forest_checkpoint_file_t *fp, int64_t offset, void *buffer, size_t num_bytes)
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_Datatype datatype;
+  MPI_Status status;
+  int count, count_read, free_type, ret;
+
+  free_type = t8_forest_checkpoint_bytes_type (num_bytes, &datatype, &count);
+  ret = MPI_File_read_at_all (fp->file, offset, buffer, count, datatype, &status) == MPI_SUCCESS;
+  if (ret) {
+    MPI_Get_count (&status, datatype, &count_read);
+    ret = count_read == count;
+  }
+  if (free_type) {
+    MPI_Type_free (&datatype);
+  }
+  return ret;
+#else
+  if (num_bytes == 0) {
+    return 1;
+  }
+  return fseek (fp->file, offset, SEEK_SET) == 0 && fread (buffer, 1, num_bytes, fp->file) == num_bytes;
+#endif
+}
+
+static void
+t8_forest_checkpoint_close (t8_forest_checkpoint_file_t *fp)
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_File_close (&fp->file);
+#else
+  fclose (fp->file);
+#endif
+}
+
+/* Read and check the header of a checkpoint file. Returns true if the file is a valid checkpoint. */
+static int
+t8_forest_checkpoint_read_header (t8_forest_checkpoint_file_t *fp, t8_forest_checkpoint_header_t *header)
+{
+  if (!t8_forest_checkpoint_read_at (fp, 0, header, sizeof (t8_forest_checkpoint_header_t))) {
+    return 0;
+  }
+  return !strncmp (header->magic, T8_FOREST_CHECKPOINT_MAGIC, sizeof (header->magic))
+         && header->format == T8_FOREST_CHECKPOINT_FORMAT;
+}
+
+int
+t8_forest_save (t8_forest_t forest, const char *filename, const sc_array_t *element_data)
+{
+  t8_forest_checkpoint_header_t header;
+  t8_forest_checkpoint_sections_t sections;
+  t8_forest_checkpoint_file_t fp;
+  t8_forest_checkpoint_block_t *blocks, last_block;
+  t8_gloidx_t *tree_offsets, first_element, end_element, itree_global, element_id;
+  t8_gloidx_t last_nonempty_tree, prev_nonempty_tree, first_offset_tree, end_offset_tree;
+  t8_locidx_t num_local_trees, itree, ielem, num_tree_elements;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  uint8_t *leaf_stream, *pos;
+  int64_t first_block, num_local_blocks, stream_size, stream_offset, iblock;
+  uint64_t linear_id, prev_linear_id;
+  size_t data_size;
+  int ret, is_root, mpiret, level, prev_level;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (element_data == NULL || element_data->elem_count == (size_t) forest->local_num_elements);
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+  end_element = first_element + forest->local_num_elements;
+  data_size = element_data != NULL ? element_data->elem_size : 0;
+
+  /* A process writes the global index of the first element of the trees after the last nonempty tree
+   * of the previous processes up to its own last nonempty tree. Trees without elements start at the first
+   * element of the next tree. The last process also writes the offsets of the empty trees at the end. */
+  last_nonempty_tree = -1;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    if (t8_forest_get_tree_num_elements (forest, itree) > 0) {
+      last_nonempty_tree = t8_forest_global_tree_id (forest, itree);
+    }
+  }
+  mpiret = sc_MPI_Exscan (&last_nonempty_tree, &prev_nonempty_tree, 1, T8_MPI_GLOIDX, sc_MPI_MAX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* The result of the exclusive scan is undefined on the first process */
+    prev_nonempty_tree = -1;
+  }
+  first_offset_tree = prev_nonempty_tree + 1;
+  end_offset_tree = forest->mpirank == forest->mpisize - 1 ? forest->global_num_trees + 1
+                                                           : SC_MAX (last_nonempty_tree + 1, first_offset_tree);
+  tree_offsets = T8_ALLOC (t8_gloidx_t, SC_MAX (end_offset_tree - first_offset_tree, 1));
+  for (itree_global = first_offset_tree; itree_global < end_offset_tree; itree_global++) {
+    if (forest->first_local_tree <= itree_global && itree_global < forest->first_local_tree + num_local_trees) {
+      itree = itree_global - forest->first_local_tree;
+      element_id = first_element + t8_forest_get_tree_element_offset (forest, itree);
+    }
+    else {
+      element_id = itree_global < forest->first_local_tree ? first_element : end_element;
+    }
+    tree_offsets[itree_global - first_offset_tree] = element_id;
+  }
+
+  /* Encode the leaves and remember the position and the tree of each block that starts on this process */
+  first_block = (first_element + T8_FOREST_CHECKPOINT_BLOCK_SIZE - 1) / T8_FOREST_CHECKPOINT_BLOCK_SIZE;
+  num_local_blocks = (end_element + T8_FOREST_CHECKPOINT_BLOCK_SIZE - 1) / T8_FOREST_CHECKPOINT_BLOCK_SIZE;
+  num_local_blocks -= first_block;
+  blocks = T8_ALLOC (t8_forest_checkpoint_block_t, SC_MAX (num_local_blocks, 1));
+  leaf_stream = T8_ALLOC (uint8_t, forest->local_num_elements * T8_FOREST_CHECKPOINT_MAX_LEAF_BYTES);
+  pos = leaf_stream;
+  prev_linear_id = 0;
+  for (itree = 0, element_id = first_element; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    prev_level = -1;
+    for (ielem = 0; ielem < num_tree_elements; ielem++, element_id++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      level = ts->t8_element_level (element);
+      linear_id = ts->t8_element_get_linear_id (element, level);
+      if (element_id % T8_FOREST_CHECKPOINT_BLOCK_SIZE == 0) {
+        /* A new block starts */
+        iblock = element_id / T8_FOREST_CHECKPOINT_BLOCK_SIZE - first_block;
+        blocks[iblock].leaf_offset = pos - leaf_stream;
+        blocks[iblock].tree = t8_forest_global_tree_id (forest, itree);
+        prev_level = -1;
+      }
+      if (level == prev_level) {
+        T8_ASSERT (linear_id > prev_linear_id);
+        pos = t8_forest_checkpoint_put_varint (pos, (linear_id - prev_linear_id - 1) << 1);
+      }
+      else {
+        pos = t8_forest_checkpoint_put_varint (pos, ((uint64_t) level << 1) | 1);
+        pos = t8_forest_checkpoint_put_varint (pos, linear_id);
+      }
+      prev_level = level;
+      prev_linear_id = linear_id;
+    }
+  }
+  /* Compute the position of the encoded leaves of this process in the leaf stream */
+  stream_size = pos - leaf_stream;
+  mpiret = sc_MPI_Scan (&stream_size, &stream_offset, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  stream_offset -= stream_size;
+  for (iblock = 0; iblock < num_local_blocks; iblock++) {
+    blocks[iblock].leaf_offset += stream_offset;
+  }
+
+  memset (&header, 0, sizeof (t8_forest_checkpoint_header_t));
+  strncpy (header.magic, T8_FOREST_CHECKPOINT_MAGIC, sizeof (header.magic));
+  header.format = T8_FOREST_CHECKPOINT_FORMAT;
+  header.mpisize = forest->mpisize;
+  header.dimension = forest->dimension;
+  header.global_num_trees = forest->global_num_trees;
+  header.global_num_elements = forest->global_num_elements;
+  header.data_size = data_size;
+  header.block_size = T8_FOREST_CHECKPOINT_BLOCK_SIZE;
+  header.incomplete_trees = forest->incomplete_trees;
+  mpiret = sc_MPI_Allreduce (&stream_size, &header.leaf_stream_size, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  t8_forest_checkpoint_sections (&header, &sections);
+  /* The last entry of the blocks marks the end of the leaf stream */
+  last_block.leaf_offset = header.leaf_stream_size;
+  last_block.tree = header.global_num_trees;
+
+  ret = t8_forest_checkpoint_open (forest->mpicomm, filename, 1, &fp);
+  if (ret) {
+    /* The first process writes the header, the partition and the end of the blocks.
+     * We do not use && here, since all processes must take part in each write. */
+    is_root = forest->mpirank == 0;
+    ret &= t8_forest_checkpoint_write_at (&fp, 0, &header, is_root ? sizeof (t8_forest_checkpoint_header_t) : 0);
+    ret &= t8_forest_checkpoint_write_at (&fp, sections.partition,
+                                          t8_shmem_array_get_gloidx_array (forest->element_offsets),
+                                          is_root ? (forest->mpisize + 1) * sizeof (int64_t) : 0);
+    ret &= t8_forest_checkpoint_write_at (
+      &fp, sections.blocks + t8_forest_checkpoint_num_blocks (&header) * sizeof (t8_forest_checkpoint_block_t),
+      &last_block, is_root ? sizeof (t8_forest_checkpoint_block_t) : 0);
+    /* Each process writes its tree offsets, its blocks and its part of the leaf stream */
+    ret &= t8_forest_checkpoint_write_at (&fp, sections.tree_offsets + first_offset_tree * sizeof (int64_t),
+                                          tree_offsets, (end_offset_tree - first_offset_tree) * sizeof (int64_t));
+    ret &= t8_forest_checkpoint_write_at (&fp, sections.blocks + first_block * sizeof (t8_forest_checkpoint_block_t),
+                                          blocks, num_local_blocks * sizeof (t8_forest_checkpoint_block_t));
+    ret &= t8_forest_checkpoint_write_at (&fp, sections.leaves + stream_offset, leaf_stream, stream_size);
+    if (data_size > 0) {
+      ret &= t8_forest_checkpoint_write_at (&fp, sections.data + first_element * data_size, element_data->array,
+                                            forest->local_num_elements * data_size);
+    }
+    t8_forest_checkpoint_close (&fp);
+  }
+  if (!ret) {
+    t8_errorf ("Error when writing forest checkpoint %s.\n", filename);
+  }
+  T8_FREE (tree_offsets);
+  T8_FREE (blocks);
+  T8_FREE (leaf_stream);
+  return ret;
+}
+
+/* Return the index of the tree that contains the element with global index element_id,
+ * given the offsets of num_trees consecutive trees and the end of the last of these trees.
+ * Empty trees are skipped, since the tree offsets of an empty tree and the following tree are equal. */
+static t8_gloidx_t
+t8_forest_checkpoint_find_tree (const t8_gloidx_t *tree_offsets, t8_gloidx_t num_trees, t8_gloidx_t element_id)
+{
+  return std::upper_bound (tree_offsets, tree_offsets + num_trees + 1, element_id) - tree_offsets - 1;
+}
+
+/* The global index of the first element of a process in a uniform partition of the elements,
+ * as computed by t8_forest_partition_compute_new_offset. */
+static t8_gloidx_t
+t8_forest_checkpoint_uniform_offset (t8_gloidx_t global_num_elements, int iproc, int mpisize)
+{
+  if (iproc == mpisize) {
+    return global_num_elements;
+  }
+  return (((double) iproc * (long double) global_num_elements) / (double) mpisize);
+}
+
+/* Repartition the cmesh of a forest such that it matches the element partition of the loaded forest.
+ * As in t8_forest_partition_create_tree_offsets, the offset of a process is -t - 1 if its
+ * first tree t is shared with the previous process, and an empty process stores the first
+ * non-shared tree of the next nonempty process.
+ * \param [in] tree_offset  The offset of this process, or the global number of trees if it is empty. */
+static void
+t8_forest_checkpoint_partition_cmesh (t8_forest_t forest, t8_gloidx_t tree_offset)
+{
+  t8_cmesh_t cmesh_partition;
+  t8_shmem_array_t offsets;
+  t8_gloidx_t next_first_tree;
+  int iproc;
+
+  t8_debugf ("Partitioning cmesh according to loaded forest\n");
+  t8_shmem_init (forest->mpicomm);
+  t8_shmem_set_type (forest->mpicomm, T8_SHMEM_BEST_TYPE);
+  offsets = t8_cmesh_alloc_offsets (forest->mpisize, forest->mpicomm);
+  t8_shmem_array_allgather (&tree_offset, 1, T8_MPI_GLOIDX, offsets, 1, T8_MPI_GLOIDX);
+  if (t8_shmem_array_start_writing (offsets)) {
+    t8_gloidx_t *offset_array = t8_shmem_array_get_gloidx_array_for_writing (offsets);
+    next_first_tree = forest->global_num_trees;
+    offset_array[forest->mpisize] = forest->global_num_trees;
+    for (iproc = forest->mpisize - 1; iproc >= 0; iproc--) {
+      if (offset_array[iproc] == forest->global_num_trees) {
+        /* This process is empty */
+        offset_array[iproc] = next_first_tree;
+      }
+      else {
+        next_first_tree = offset_array[iproc] < 0 ? -offset_array[iproc] : offset_array[iproc];
+      }
+    }
+  }
+  t8_shmem_array_end_writing (offsets);
+
+  t8_cmesh_init (&cmesh_partition);
+  t8_cmesh_set_derive (cmesh_partition, forest->cmesh);
+  t8_cmesh_set_partition_offsets (cmesh_partition, offsets);
+  t8_cmesh_set_profiling (cmesh_partition, forest->profile != NULL);
+  t8_cmesh_commit (cmesh_partition, forest->mpicomm);
+  forest->cmesh = cmesh_partition;
+}
+
+void
+t8_forest_load_leaves (t8_forest_t forest)
+{
+  t8_forest_checkpoint_header_t header;
+  t8_forest_checkpoint_sections_t sections;
+  t8_forest_checkpoint_file_t fp;
+  t8_forest_checkpoint_block_t block_range[2];
+  t8_gloidx_t element_range[2], *tree_offsets, first_element, end_element, tree_begin, tree_end, jt, first_ctree;
+  t8_gloidx_t first_offset_tree, num_offset_trees, tree_offset;
+  t8_locidx_t num_local_elements, num_local_trees, ielem, count_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_t *element;
+  t8_tree_t tree;
+  uint64_t *linear_ids, prev_linear_id, code;
+  int8_t *levels;
+  uint8_t *leaf_stream;
+  const uint8_t *pos;
+  int64_t first_block, end_block, stream_size;
+  t8_gloidx_t element_id;
+  int ret, mpiret, cmesh_matches, all_cmesh_match, prev_level, is_empty;
+
+  T8_ASSERT (forest->set_load_filename != NULL);
+  T8_ASSERT (forest->cmesh != NULL && forest->scheme_cxx != NULL);
+
+  ret = t8_forest_checkpoint_open (forest->mpicomm, forest->set_load_filename, 0, &fp);
+  SC_CHECK_ABORTF (ret, "Could not open forest checkpoint %s.\n", forest->set_load_filename);
+  ret = t8_forest_checkpoint_read_header (&fp, &header);
+  SC_CHECK_ABORTF (ret, "File %s is not a forest checkpoint of this version.\n", forest->set_load_filename);
+  SC_CHECK_ABORTF (header.global_num_trees == t8_cmesh_get_num_trees (forest->cmesh)
+                     && header.dimension == forest->dimension,
+                   "Forest checkpoint %s does not match the coarse mesh.\n", forest->set_load_filename);
+  t8_forest_checkpoint_sections (&header, &sections);
+
+  /* Read the element range of this process, if the number of processes did not change */
+  if (header.mpisize == forest->mpisize) {
+    ret = t8_forest_checkpoint_read_at (&fp, sections.partition + forest->mpirank * sizeof (int64_t), element_range,
+                                        2 * sizeof (int64_t));
+  }
+  else {
+    /* Distribute the elements uniformly */
+    t8_debugf ("Loading forest checkpoint written with %lli processes\n", (long long) header.mpisize);
+    element_range[0]
+      = t8_forest_checkpoint_uniform_offset (header.global_num_elements, forest->mpirank, forest->mpisize);
+    element_range[1]
+      = t8_forest_checkpoint_uniform_offset (header.global_num_elements, forest->mpirank + 1, forest->mpisize);
+  }
+  first_element = element_range[0];
+  end_element = element_range[1];
+  ret &= 0 <= first_element && first_element <= end_element && end_element <= header.global_num_elements;
+  SC_CHECK_ABORTF (ret, "Error when reading forest checkpoint %s.\n", forest->set_load_filename);
+  num_local_elements = end_element - first_element;
+  is_empty = num_local_elements == 0;
+
+  /* We read the leaf stream from the beginning of the block that contains the first local element
+   * to the end of the block that contains the last local element. The trees of these blocks
+   * contain the local trees, so we only read their offsets. */
+  first_block = first_element / header.block_size;
+  end_block = !is_empty ? (end_element + header.block_size - 1) / header.block_size : first_block;
+  memset (block_range, 0, sizeof (block_range));
+  ret &= t8_forest_checkpoint_read_at (&fp, sections.blocks + first_block * sizeof (t8_forest_checkpoint_block_t),
+                                       block_range, is_empty ? 0 : sizeof (t8_forest_checkpoint_block_t));
+  ret &= t8_forest_checkpoint_read_at (&fp, sections.blocks + end_block * sizeof (t8_forest_checkpoint_block_t),
+                                       block_range + 1, is_empty ? 0 : sizeof (t8_forest_checkpoint_block_t));
+  ret &= block_range[0].leaf_offset <= block_range[1].leaf_offset
+         && block_range[1].leaf_offset <= header.leaf_stream_size && 0 <= block_range[0].tree
+         && block_range[0].tree <= block_range[1].tree && block_range[1].tree <= header.global_num_trees;
+  stream_size = ret ? block_range[1].leaf_offset - block_range[0].leaf_offset : 0;
+  first_offset_tree = ret ? block_range[0].tree : 0;
+  num_offset_trees = ret && !is_empty ? SC_MIN (block_range[1].tree + 1, header.global_num_trees) - first_offset_tree
+                                      : 0;
+  tree_offsets = T8_ALLOC (t8_gloidx_t, num_offset_trees + 1);
+  ret &= t8_forest_checkpoint_read_at (&fp, sections.tree_offsets + first_offset_tree * sizeof (int64_t),
+                                       tree_offsets, is_empty ? 0 : (num_offset_trees + 1) * sizeof (int64_t));
+  leaf_stream = T8_ALLOC (uint8_t, stream_size);
+  ret &= t8_forest_checkpoint_read_at (&fp, sections.leaves + block_range[0].leaf_offset, leaf_stream, stream_size);
+  t8_forest_checkpoint_close (&fp);
+  SC_CHECK_ABORTF (ret, "Error when reading forest checkpoint %s.\n", forest->set_load_filename);
+
+  /* Decode the leaves and keep the local ones */
+  linear_ids = T8_ALLOC (uint64_t, num_local_elements);
+  levels = T8_ALLOC (int8_t, num_local_elements);
+  pos = leaf_stream;
+  prev_level = -1;
+  prev_linear_id = 0;
+  for (element_id = first_block * header.block_size; element_id < end_element; element_id++) {
+    pos = t8_forest_checkpoint_get_varint (pos, leaf_stream + stream_size, &code);
+    if (pos != NULL && (code & 1)) {
+      prev_level = (int) (code >> 1);
+      pos = t8_forest_checkpoint_get_varint (pos, leaf_stream + stream_size, &prev_linear_id);
+    }
+    else if (pos != NULL) {
+      prev_linear_id += (code >> 1) + 1;
+    }
+    SC_CHECK_ABORTF (pos != NULL && 0 <= prev_level && prev_level <= forest->maxlevel,
+                     "Corrupt leaf stream in forest checkpoint %s.\n", forest->set_load_filename);
+    if (element_id >= first_element) {
+      levels[element_id - first_element] = prev_level;
+      linear_ids[element_id - first_element] = prev_linear_id;
+    }
+  }
+  T8_FREE (leaf_stream);
+
+  forest->global_num_trees = header.global_num_trees;
+  forest->incomplete_trees = header.incomplete_trees != 0;
+
+  if (is_empty) {
+    /* This process is empty */
+    forest->first_local_tree = 0;
+    forest->last_local_tree = -1;
+    tree_offset = header.global_num_trees;
+  }
+  else {
+    /* The local trees are the trees that contain the first and the last local element and all trees between */
+    forest->first_local_tree
+      = first_offset_tree + t8_forest_checkpoint_find_tree (tree_offsets, num_offset_trees, first_element);
+    forest->last_local_tree
+      = first_offset_tree + t8_forest_checkpoint_find_tree (tree_offsets, num_offset_trees, end_element - 1);
+    SC_CHECK_ABORTF (first_offset_tree <= forest->first_local_tree
+                       && forest->last_local_tree < first_offset_tree + num_offset_trees,
+                     "Corrupt tree offsets in forest checkpoint %s.\n", forest->set_load_filename);
+    tree_offset = tree_offsets[forest->first_local_tree - first_offset_tree] < first_element
+                    ? -forest->first_local_tree - 1
+                    : forest->first_local_tree;
+  }
+
+  /* If the cmesh is partitioned and does not contain the local trees on all processes, we repartition it */
+  first_ctree = t8_cmesh_get_first_treeid (forest->cmesh);
+  cmesh_matches = is_empty
+                  || (forest->first_local_tree >= first_ctree
+                      && forest->last_local_tree < first_ctree + t8_cmesh_get_num_local_trees (forest->cmesh));
+  mpiret = sc_MPI_Allreduce (&cmesh_matches, &all_cmesh_match, 1, sc_MPI_INT, sc_MPI_LAND, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (!all_cmesh_match) {
+    SC_CHECK_ABORT (t8_cmesh_is_partitioned (forest->cmesh),
+                    "cmesh partition does not match the loaded forest partition");
+    t8_forest_checkpoint_partition_cmesh (forest, tree_offset);
+    first_ctree = t8_cmesh_get_first_treeid (forest->cmesh);
+  }
+
+  if (is_empty) {
+    forest->trees = sc_array_new (sizeof (t8_tree_struct_t));
+  }
+  else {
+    num_local_trees = forest->last_local_tree - forest->first_local_tree + 1;
+    forest->trees = sc_array_new_count (sizeof (t8_tree_struct_t), num_local_trees);
+    for (jt = forest->first_local_tree, count_elements = 0; jt <= forest->last_local_tree; jt++) {
+      tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, jt - forest->first_local_tree);
+      tree->eclass = t8_cmesh_get_tree_class (forest->cmesh, jt - first_ctree);
+      tree->elements_offset = count_elements;
+      ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+      tree_begin = SC_MAX (tree_offsets[jt - first_offset_tree], first_element);
+      tree_end = SC_MIN (tree_offsets[jt - first_offset_tree + 1], end_element);
+      t8_element_array_init_size (&tree->elements, ts, tree_end - tree_begin);
+      for (ielem = 0; ielem < tree_end - tree_begin; ielem++, count_elements++) {
+        T8_ASSERT (0 <= levels[count_elements] && levels[count_elements] <= forest->maxlevel);
+        element = t8_element_array_index_locidx (&tree->elements, ielem);
+        ts->t8_element_set_linear_id (element, levels[count_elements], linear_ids[count_elements]);
+      }
+    }
+    T8_ASSERT (count_elements == num_local_elements);
+  }
+  forest->local_num_elements = num_local_elements;
+  forest->global_num_elements = header.global_num_elements;
+
+  T8_FREE (tree_offsets);
+  T8_FREE (linear_ids);
+  T8_FREE (levels);
+}
+
+int
+t8_forest_load_element_data (t8_forest_t forest, const char *filename, sc_array_t *element_data)
+{
+  t8_forest_checkpoint_header_t header;
+  t8_forest_checkpoint_sections_t sections;
+  t8_forest_checkpoint_file_t fp;
+  int ret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (element_data != NULL);
+
+  if (!t8_forest_checkpoint_open (forest->mpicomm, filename, 0, &fp)) {
+    t8_errorf ("Could not open forest checkpoint %s.\n", filename);
+    return 0;
+  }
+  ret = t8_forest_checkpoint_read_header (&fp, &header);
+  if (ret && (header.global_num_elements != forest->global_num_elements
+              || header.data_size != (int64_t) element_data->elem_size)) {
+    /* The checkpoint does not match the forest or has no data of this size */
+    ret = 0;
+  }
+  if (ret) {
+    t8_forest_checkpoint_sections (&header, &sections);
+    sc_array_resize (element_data, forest->local_num_elements);
+    ret = t8_forest_checkpoint_read_at (
+      &fp, sections.data + t8_forest_get_first_local_element_id (forest) * header.data_size, element_data->array,
+      forest->local_num_elements * header.data_size);
+  }
+  t8_forest_checkpoint_close (&fp);
+  if (!ret) {
+    t8_errorf ("Could not read element data from forest checkpoint %s.\n", filename);
+  }
+  return ret;
+}
+
+T8_EXTERN_C_END ();
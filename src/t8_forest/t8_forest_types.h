@@ -36,8 +36,11 @@
 #include <t8_forest/t8_forest_adapt.h>
 #include <t8_forest/t8_forest_general.h>
 
-typedef struct t8_profile t8_profile_t;            /* Defined below */
-typedef struct t8_forest_ghost *t8_forest_ghost_t; /* Defined below */
+typedef struct t8_profile t8_profile_t;                                   /* Defined below */
+typedef struct t8_forest_face_connectivity t8_forest_face_connectivity_t; /* Defined below */
+typedef struct t8_forest_global_nodes t8_forest_global_nodes_t;           /* Defined below */
+typedef struct t8_forest_tree_keys t8_forest_tree_keys_t;                 /* Defined below */
+typedef struct t8_forest_ghost *t8_forest_ghost_t;                        /* Defined below */
 
 /** If a forest is to be derived from another forest, there are different
  * possibilities how the original forest is modified.
@@ -69,8 +72,9 @@ typedef struct t8_forest
 {
   t8_refcount_t rc; /**< Reference counter. */
 
-  int set_level;          /**< Level to use in new construction. */
-  int set_for_coarsening; /**< Change partition to allow
+  int set_level;           /**< Level to use in new construction. */
+  char *set_load_filename; /**< Checkpoint file to load in new construction. */
+  int set_for_coarsening;  /**< Change partition to allow
                                                      for one round of coarsening */
 
   sc_MPI_Comm mpicomm; /**< MPI communicator to use. */
@@ -101,6 +105,12 @@ typedef struct t8_forest
   t8_ghost_type_t ghost_type;     /**< If a ghost layer will be created, the type of neighbors that count as ghost. */
   int ghost_algorithm;            /**< Controls the algorithm used for ghost. 1 = balanced only. 2 = also unbalanced
                                              3 = top-down search and unbalanced. */
+  int ghost_width;                /**< The number of ghost layers. \see t8_forest_set_ghost_width. */
+  int ghost_incremental;          /**< If true, derive the ghost layer from the one of set_from if possible.
+                                             \see t8_forest_set_ghost_incremental. */
+  t8_forest_t ghost_from;         /**< During commit, the forest whose ghost layer the ghost layer is derived from. */
+  int cache_linear_ids;           /**< If true, the linear ids of the elements are cached on commit.
+                                             \see t8_forest_set_linear_id_cache. */
   void *user_data;                /**< Pointer for arbitrary user data. \see t8_forest_set_user_data. */
   void (*user_function) ();       /**< Pointer for arbitrary user function. \see t8_forest_set_user_function. */
   void *t8code_data;              /**< Pointer for arbitrary data that is used internally. */
@@ -134,8 +144,16 @@ typedef struct t8_forest
   t8_locidx_t local_num_elements;  /**< Number of elements on this processor. */
   t8_gloidx_t global_num_elements; /**< Number of elements on all processors. */
   t8_profile_t *profile;           /**< If not NULL, runtimes and statistics about forest_commit are stored here. */
+  double *element_costs;           /**< If not NULL, the measured cost of each local element. Used as weights
+                                             when partitioning from this forest. \see t8_forest_cost_add_range */
   sc_statinfo_t stats[T8_PROFILE_NUM_STATS];
   int stats_computed;
+  t8_forest_face_connectivity_t *face_connectivity; /**< If not NULL, the precomputed leaf face neighbors.
+                                                          \see t8_forest_build_face_connectivity */
+  t8_forest_global_nodes_t *global_nodes;           /**< If not NULL, the global numbering of the element vertices.
+                                                          \see t8_forest_build_global_nodes */
+  t8_forest_tree_keys_t *tree_keys;                 /**< If not NULL, for each local tree the cached linear ids of
+                                                          its elements. \see t8_forest_tree_get_linear_ids */
 } t8_forest_struct_t;
 
 /** The t8 tree datatype */
@@ -151,6 +169,52 @@ typedef struct t8_tree
                                                   (locals only) */
 } t8_tree_struct_t;
 
+/** The face neighbors of all local leaves of a forest in compressed sparse row format.
+ * The faces of the leaves are numbered consecutively, the faces of leaf i are
+ * element_offsets[i] to element_offsets[i + 1] - 1.
+ * The neighbors of face slot j are neighbor_ids[face_offsets[j]] to neighbor_ids[face_offsets[j + 1] - 1].
+ * \see t8_forest_build_face_connectivity
+ */
+typedef struct t8_forest_face_connectivity
+{
+  t8_locidx_t num_elements;     /**< The number of local leaves. */
+  t8_locidx_t *element_offsets; /**< For each leaf its first face slot, num_elements + 1 entries. */
+  t8_locidx_t *face_offsets;    /**< For each face slot its first neighbor, num face slots + 1 entries. */
+  t8_locidx_t *neighbor_ids;    /**< The local or ghost indices of the neighbor leaves. */
+  int *dual_faces;              /**< For each neighbor leaf its face at the connection. */
+  int8_t *orientations;         /**< For each face slot the orientation of the tree connection. */
+  int8_t *hanging;              /**< For each face slot one of T8_FACE_CONNECTIVITY_CONFORMING/COARSER/FINER. */
+} t8_forest_face_connectivity_struct_t;
+
+/** The global numbering of the vertices (nodes) of the local leaves of a forest.
+ * The nodes at the corners of leaf i are element_nodes[element_offsets[i]] to
+ * element_nodes[element_offsets[i + 1] - 1], given as local node indices.
+ * \see t8_forest_build_global_nodes
+ */
+typedef struct t8_forest_global_nodes
+{
+  t8_locidx_t num_elements;     /**< The number of local leaves. */
+  t8_locidx_t *element_offsets; /**< For each leaf the position of its first node, num_elements + 1 entries. */
+  t8_locidx_t *element_nodes;   /**< For each leaf corner its local node index. */
+  t8_locidx_t num_local_nodes;  /**< The number of nodes at the corners of the local leaves. */
+  t8_locidx_t num_owned_nodes;  /**< The number of nodes owned by this process. */
+  t8_gloidx_t global_num_nodes; /**< The number of nodes on all processes. */
+  t8_gloidx_t first_owned_node; /**< The global id of the first node owned by this process. */
+  int *node_owners;             /**< For each local node the rank of its owner process. */
+  t8_gloidx_t *global_ids;      /**< For each local node its global id. */
+} t8_forest_global_nodes_struct_t;
+
+/** The linear ids at the forest's maxlevel and the levels of the elements of a local tree.
+ * They are computed when the forest is committed and speed up binary searches in the tree,
+ * since the elements do not need to be decoded.
+ * \see t8_forest_tree_get_linear_ids
+ */
+typedef struct t8_forest_tree_keys
+{
+  t8_linearidx_t *linear_ids; /**< If not NULL, for each element its linear id at the forest's maxlevel. */
+  int8_t *levels;             /**< For each element its level. */
+} t8_forest_tree_keys_struct_t;
+
 /** This struct is used to profile forest algorithms.
  * The forest struct stores a pointer to a profile struct, and if
  * it is nonzero, various runtimes and data measurements are stored here.
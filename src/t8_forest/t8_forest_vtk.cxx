@@ -59,12 +59,24 @@
 #include <t8_forest/t8_forest_general.h>
 #include <t8_forest/t8_forest_io.h>
 #include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_global_nodes.h>
+#include <t8_cmesh/t8_cmesh_locate.h>
+#include <string>
+#include <vector>
+#ifdef SC_ENABLE_PTHREAD
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
-/* TODO: Currently we only use ASCII mode and no data compression.
- *       We also do not use sc_io to buffer our output stream. */
+/* The .vtu files are written in ASCII mode by default. With t8_forest_vtk_write_file_ext
+ * the data arrays can also be written base64 encoded, zlib compressed or raw appended.
+ * For t8_forest_vtk_write_file_async the write functions below do not write to a file
+ * but record the xml and the data arrays in a snapshot, which is written on an i/o thread. */
 
 /* There are different cell data to write, e.g. connectivity, type, vertices, ...
  * The structure is always the same:
@@ -81,6 +93,274 @@ T8_EXTERN_C_BEGIN ();
  * appropriately. */
 typedef enum { T8_VTK_KERNEL_INIT, T8_VTK_KERNEL_EXECUTE, T8_VTK_KERNEL_CLEANUP } T8_VTK_KERNEL_MODUS;
 
+/* The points of the local leaves with coincident corners written only once.
+ * For each corner of each local leaf, in vtk corner order, we store the index of
+ * its point and whether the corner is the first appearance of the point. */
+typedef struct
+{
+  t8_locidx_t num_points;      /* The number of points of the local leaves. */
+  t8_locidx_t *corner_offsets; /* For each local leaf the index of its first corner. */
+  t8_locidx_t *point_ids;      /* For each corner the index of its point. */
+  int8_t *is_first;            /* For each corner true if the point was not written for a previous corner. */
+} t8_forest_vtk_shared_points_t;
+
+/* The target of the values of one data array.
+ * In ascii mode the values are printed to vtufile.
+ * In binary mode vtufile is NULL and the values are appended to the array values,
+ * whose element size is the size of the VTK data type of the data array. */
+typedef struct
+{
+  FILE *vtufile;                               /* The file in ascii mode, NULL otherwise. */
+  sc_array_t *values;                          /* The values in binary mode. */
+  int is_float;                                /* True if the VTK data type of the values is floating point. */
+  const t8_forest_vtk_shared_points_t *shared; /* The shared points if we deduplicate points, NULL otherwise. */
+  t8_locidx_t num_leaves;                      /* The number of leaves of the current cell, see t8_forest_vtk_cell_t. */
+} t8_forest_vtk_stream_t;
+
+/* Write an integer value to a stream.
+ * In ascii mode the value is printed with the printf format \a format, which must
+ * expect a long long argument. In binary mode the value is converted to the VTK data type.
+ * Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_put_int (t8_forest_vtk_stream_t *stream, const char *format, const long long value)
+{
+  if (stream->vtufile != NULL) {
+    return fprintf (stream->vtufile, format, value) > 0;
+  }
+  T8_ASSERT (!stream->is_float);
+  switch (stream->values->elem_size) {
+  case 1:
+    *(int8_t *) sc_array_push (stream->values) = (int8_t) value;
+    break;
+  case 2:
+    *(int16_t *) sc_array_push (stream->values) = (int16_t) value;
+    break;
+  case 4:
+    *(int32_t *) sc_array_push (stream->values) = (int32_t) value;
+    break;
+  case 8:
+    *(int64_t *) sc_array_push (stream->values) = (int64_t) value;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  return 1;
+}
+
+/* Write a floating point value to a stream.
+ * In ascii mode the value is printed with the printf format \a format, which must
+ * expect a double argument. In binary mode the value is converted to the VTK data type.
+ * Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_put_float (t8_forest_vtk_stream_t *stream, const char *format, const double value)
+{
+  if (stream->vtufile != NULL) {
+    return fprintf (stream->vtufile, format, value) > 0;
+  }
+  T8_ASSERT (stream->is_float);
+  if (stream->values->elem_size == sizeof (float)) {
+    *(float *) sc_array_push (stream->values) = (float) value;
+  }
+  else {
+    T8_ASSERT (stream->values->elem_size == sizeof (double));
+    *(double *) sc_array_push (stream->values) = value;
+  }
+  return 1;
+}
+
+/* An xml text or a data array of a .vtu file, recorded to be written later. */
+typedef struct
+{
+  char *text;             /* The xml text, NULL if this item is a data array. */
+  char *type;             /* The VTK data type of the data array. */
+  char *name;             /* The name of the data array. */
+  char *component_string; /* Additional attributes of the data array. */
+  sc_array_t *values;     /* The values of the data array. */
+} t8_forest_vtk_snapshot_item_t;
+
+/* The complete contents of the .vtu file of one process.
+ * A snapshot does not reference the forest or the user data, thus the forest may be
+ * modified or destroyed before the snapshot is written. */
+typedef struct
+{
+  char vtufilename[BUFSIZ]; /* The name of the file to write. */
+  t8_vtk_format_t format;   /* The encoding of the data arrays, not T8_VTK_ASCII. */
+  t8_locidx_t num_points;   /* The number of points of the piece. */
+  t8_locidx_t num_cells;    /* The number of cells of the piece. */
+  sc_array_t items;         /* The xml texts and data arrays in file order. */
+} t8_forest_vtk_snapshot_t;
+
+/* A cell of the output if the elements are filtered.
+ * Either a leaf, or the ancestor on the maximum output level of a complete family of
+ * local leaves of a tree that are written as one coarse cell. */
+typedef struct
+{
+  t8_locidx_t ltree_id;      /* The local tree id, for ghosts the ghost tree id plus the number of local trees. */
+  t8_locidx_t element_index; /* The index of the first leaf of the cell in its tree. */
+  t8_locidx_t num_leaves;    /* The number of leaves of the cell. */
+  t8_element_t *element;     /* The element of the cell. */
+  int is_ancestor;           /* True if element was allocated for this cell, false if it is the leaf. */
+  t8_eclass_scheme_c *ts;    /* The scheme of the tree. */
+} t8_forest_vtk_cell_t;
+
+/* The data arrays that depend only on the forest and not on user data, for example the
+ * point coordinates and the connectivity, kept for the next output of the same forest.
+ * Since a committed forest does not change, the arrays are valid as long as we hold a
+ * reference to the forest, which also prevents a new forest from getting the same address. */
+typedef struct
+{
+  t8_forest_t forest;                   /* The forest of the arrays, NULL if the cache is empty. */
+  sc_array_t arrays;                    /* The cached data arrays as t8_forest_vtk_snapshot_item_t. */
+  int has_shared;                       /* True if shared holds the shared points of forest. */
+  t8_forest_vtk_shared_points_t shared; /* The shared points of forest. */
+} t8_forest_vtk_geometry_cache_t;
+
+/* The target of the write functions below.
+ * Either we write directly to an open file, or we record the output in a snapshot. */
+typedef struct
+{
+  t8_vtk_file_t *file;                         /* The open file, NULL if we record a snapshot. */
+  t8_forest_vtk_snapshot_t *snapshot;          /* The snapshot, NULL if we write to the file. */
+  const t8_forest_vtk_shared_points_t *shared; /* The shared points if we deduplicate points, NULL otherwise. */
+  t8_forest_vtk_geometry_cache_t *cache;       /* The cache for binary output to a file, NULL if not used. */
+  sc_array_t *cells;                           /* The t8_forest_vtk_cell_t to write if we filter, NULL otherwise. */
+} t8_forest_vtk_output_t;
+
+static char *
+t8_forest_vtk_strdup (const char *string)
+{
+  char *copy = T8_ALLOC (char, strlen (string) + 1);
+
+  strcpy (copy, string);
+  return copy;
+}
+
+static void
+t8_forest_vtk_snapshot_init (t8_forest_vtk_snapshot_t *snapshot)
+{
+  snapshot->vtufilename[0] = '\0';
+  snapshot->format = T8_VTK_BINARY;
+  snapshot->num_points = snapshot->num_cells = 0;
+  sc_array_init (&snapshot->items, sizeof (t8_forest_vtk_snapshot_item_t));
+}
+
+/* Add a data array to an array of snapshot items. The items take ownership of \a values. */
+static void
+t8_forest_vtk_items_add_array (sc_array_t *items, const char *type, const char *name, const char *component_string,
+                               sc_array_t *values)
+{
+  t8_forest_vtk_snapshot_item_t *item = (t8_forest_vtk_snapshot_item_t *) sc_array_push (items);
+
+  item->text = NULL;
+  item->type = t8_forest_vtk_strdup (type);
+  item->name = t8_forest_vtk_strdup (name);
+  item->component_string = t8_forest_vtk_strdup (component_string);
+  item->values = values;
+}
+
+/* Free an array of snapshot items. */
+static void
+t8_forest_vtk_items_reset (sc_array_t *items)
+{
+  for (size_t iitem = 0; iitem < items->elem_count; iitem++) {
+    t8_forest_vtk_snapshot_item_t *item = (t8_forest_vtk_snapshot_item_t *) sc_array_index (items, iitem);
+    if (item->text != NULL) {
+      T8_FREE (item->text);
+    }
+    else {
+      T8_FREE (item->type);
+      T8_FREE (item->name);
+      T8_FREE (item->component_string);
+      sc_array_destroy (item->values);
+    }
+  }
+  sc_array_reset (items);
+}
+
+/* Free all items of a snapshot. */
+static void
+t8_forest_vtk_snapshot_reset (t8_forest_vtk_snapshot_t *snapshot)
+{
+  t8_forest_vtk_items_reset (&snapshot->items);
+}
+
+/* Return the data array with a given name of an array of snapshot items, or NULL if there is none. */
+static const t8_forest_vtk_snapshot_item_t *
+t8_forest_vtk_items_find_array (sc_array_t *items, const char *name)
+{
+  for (size_t iitem = 0; iitem < items->elem_count; iitem++) {
+    const t8_forest_vtk_snapshot_item_t *item = (t8_forest_vtk_snapshot_item_t *) sc_array_index (items, iitem);
+    if (item->text == NULL && !strcmp (item->name, name)) {
+      return item;
+    }
+  }
+  return NULL;
+}
+
+/* Write the recorded contents of a snapshot to its file.
+ * This function does not access the forest and does not communicate.
+ * Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_snapshot_write (t8_forest_vtk_snapshot_t *snapshot)
+{
+  t8_vtk_file_t file;
+
+  if (t8_vtk_file_open (&file, snapshot->vtufilename, snapshot->format, snapshot->num_points, snapshot->num_cells)) {
+    t8_errorf ("Error when opening file %s\n", snapshot->vtufilename);
+    return 0;
+  }
+  for (size_t iitem = 0; iitem < snapshot->items.elem_count; iitem++) {
+    t8_forest_vtk_snapshot_item_t *item
+      = (t8_forest_vtk_snapshot_item_t *) sc_array_index (&snapshot->items, iitem);
+    int failed;
+    if (item->text != NULL) {
+      failed = fputs (item->text, file.vtufile) < 0;
+    }
+    else {
+      failed = t8_vtk_write_binary_data_array (&file, item->type, item->name, item->component_string,
+                                               item->values->array, item->values->elem_count * item->values->elem_size);
+    }
+    if (failed) {
+      t8_errorf ("Error when writing file %s\n", snapshot->vtufilename);
+      fclose (file.vtufile);
+      sc_array_reset (&file.appended_data);
+      return 0;
+    }
+  }
+  if (t8_vtk_file_close (&file)) {
+    t8_errorf ("Error when closing file %s\n", snapshot->vtufilename);
+    return 0;
+  }
+  return 1;
+}
+
+/* Write xml text to an output, with the same arguments as printf.
+ * Returns a positive value on success and a non-positive value otherwise. */
+static int
+t8_forest_vtk_output_printf (t8_forest_vtk_output_t *output, const char *format, ...)
+{
+  va_list args;
+  int retval;
+
+  va_start (args, format);
+  if (output->snapshot == NULL) {
+    retval = vfprintf (output->file->vtufile, format, args);
+  }
+  else {
+    char text[BUFSIZ];
+    retval = vsnprintf (text, BUFSIZ, format, args);
+    if (retval > 0 && retval < BUFSIZ) {
+      t8_forest_vtk_snapshot_item_t *item = (t8_forest_vtk_snapshot_item_t *) sc_array_push (&output->snapshot->items);
+      item->text = t8_forest_vtk_strdup (text);
+    }
+    else {
+      retval = -1;
+    }
+  }
+  va_end (args);
+  return retval;
+}
+
 /** Callback function prototype for writing cell data.
  * The function is executed for each element.
  * The callback can run in three different modi:
@@ -97,7 +377,7 @@ typedef enum { T8_VTK_KERNEL_INIT, T8_VTK_KERNEL_EXECUTE, T8_VTK_KERNEL_CLEANUP
  * \param [in] is_ghost Non-zero if the current element is a ghost element.
  *                      In this cas \a tree is NULL.
  *                      All ghost element will be traversed after all elements are
- * \param [in,out] vtufile The open file stream to which we write the forest.
+ * \param [in,out] stream  The stream to which we write the values, see \ref t8_forest_vtk_put_int.
  * \param [in,out] columns An integer counting the number of written columns.
  *                         The callback should increase this value by the number
  *                         of values written to the file.
@@ -109,8 +389,9 @@ typedef enum { T8_VTK_KERNEL_INIT, T8_VTK_KERNEL_EXECUTE, T8_VTK_KERNEL_CLEANUP
  */
 typedef int (*t8_forest_vtk_cell_data_kernel) (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                                const t8_locidx_t element_index, const t8_element_t *element,
-                                               t8_eclass_scheme_c *ts, const int is_ghost, FILE *vtufile, int *columns,
-                                               void **data, T8_VTK_KERNEL_MODUS modus);
+                                               t8_eclass_scheme_c *ts, const int is_ghost,
+                                               t8_forest_vtk_stream_t *stream, int *columns, void **data,
+                                               T8_VTK_KERNEL_MODUS modus);
 
 #define T8_FOREST_VTK_QUADRATIC_ELEMENT_MAX_CORNERS 20
 /** Lookup table for number of nodes for curved eclasses. */
@@ -596,16 +877,275 @@ t8_forest_num_points (t8_forest_t forest, const int count_ghosts)
   return num_points;
 }
 
+/* Number the points of the local leaves, such that coincident corners are written only once.
+ * We identify the corners with t8_forest_number_local_nodes and then number the points in
+ * the order in which the vertices kernel writes them. */
+static void
+t8_forest_vtk_shared_points_init (t8_forest_t forest, t8_forest_vtk_shared_points_t *shared)
+{
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  t8_locidx_t *element_nodes, *node_points, num_nodes, inode;
+  t8_locidx_t itree, ielem, num_tree_elements, element_index, corner;
+  double vertex_coords[3], corner_coords[3];
+
+  num_nodes = t8_forest_number_local_nodes (forest, &shared->corner_offsets, &element_nodes);
+  shared->point_ids = T8_ALLOC (t8_locidx_t, shared->corner_offsets[num_elements]);
+  shared->is_first = T8_ALLOC_ZERO (int8_t, shared->corner_offsets[num_elements]);
+  node_points = T8_ALLOC (t8_locidx_t, num_nodes);
+  for (inode = 0; inode < num_nodes; inode++) {
+    node_points[inode] = -1;
+  }
+  shared->num_points = 0;
+
+  for (itree = 0, element_index = 0; itree < num_local_trees; itree++) {
+    const t8_eclass_t tree_class = t8_forest_get_tree_class (forest, itree);
+    const int dim = t8_eclass_to_dimension[tree_class];
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++, element_index++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      const t8_element_shape_t element_shape = ts->t8_element_shape (element);
+      const int num_corners = ts->t8_element_num_corners (element);
+      const t8_locidx_t first_corner = shared->corner_offsets[element_index];
+
+      for (int ivertex = 0; ivertex < t8_eclass_num_vertices[element_shape]; ivertex++) {
+        /* Find the element corner at the vtk vertex by comparing reference coordinates in the tree.
+         * The corner coordinates are computed from integer coordinates, we pick the closest one. */
+        ts->t8_element_reference_coords (element, t8_forest_vtk_point_to_element_ref_coords[element_shape][ivertex], 1,
+                                         vertex_coords);
+        int closest_corner = 0;
+        double min_dist = -1;
+        for (int icorner = 0; icorner < num_corners; icorner++) {
+          double dist = 0;
+          ts->t8_element_vertex_reference_coords (element, icorner, corner_coords);
+          for (int idim = 0; idim < dim; idim++) {
+            dist += (vertex_coords[idim] - corner_coords[idim]) * (vertex_coords[idim] - corner_coords[idim]);
+          }
+          if (min_dist < 0 || dist < min_dist) {
+            min_dist = dist;
+            closest_corner = icorner;
+          }
+        }
+        inode = element_nodes[first_corner + closest_corner];
+        corner = first_corner + ivertex;
+        if (node_points[inode] < 0) {
+          /* This is the first corner at this point */
+          node_points[inode] = shared->num_points++;
+          shared->is_first[corner] = 1;
+        }
+        shared->point_ids[corner] = node_points[inode];
+      }
+    }
+  }
+  T8_ASSERT (shared->num_points == num_nodes);
+  T8_FREE (element_nodes);
+  T8_FREE (node_points);
+}
+
+/* Free the memory of the shared points */
+static void
+t8_forest_vtk_shared_points_reset (t8_forest_vtk_shared_points_t *shared)
+{
+  T8_FREE (shared->corner_offsets);
+  T8_FREE (shared->point_ids);
+  T8_FREE (shared->is_first);
+}
+
+/* Free the contents of a geometry cache and release its forest. */
+static void
+t8_forest_vtk_geometry_cache_reset (t8_forest_vtk_geometry_cache_t *cache)
+{
+  t8_forest_vtk_items_reset (&cache->arrays);
+  if (cache->has_shared) {
+    t8_forest_vtk_shared_points_reset (&cache->shared);
+    cache->has_shared = 0;
+  }
+  if (cache->forest != NULL) {
+    t8_forest_unref (&cache->forest);
+  }
+}
+
+/* Compute the linear ids at the forest's maximum level of the first and the last descendant of an element.
+ * desc is an allocated element that is used as scratch memory. */
+static void
+t8_forest_vtk_desc_ids (const t8_forest_t forest, const t8_element_t *element, t8_eclass_scheme_c *ts,
+                        t8_element_t *desc, t8_linearidx_t *first_id, t8_linearidx_t *last_id)
+{
+  ts->t8_element_first_descendant (element, desc, forest->maxlevel);
+  *first_id = ts->t8_element_get_linear_id (desc, forest->maxlevel);
+  ts->t8_element_last_descendant (element, desc, forest->maxlevel);
+  *last_id = ts->t8_element_get_linear_id (desc, forest->maxlevel);
+}
+
+/* Compute the cells that we write if the elements are filtered.
+ * Leaves that are not selected are skipped. If all local leaves of an ancestor on the maximum
+ * output level are selected, they are merged into the ancestor. All other leaves, and the leaves
+ * of ghost trees, are written as they are, such that no two cells overlap.
+ * The geometry of a leaf is only evaluated by the select function, at most once per leaf.
+ * Returns the number of points of the cells. */
+static t8_locidx_t
+t8_forest_vtk_cells_init (t8_forest_t forest, const t8_forest_vtk_filter_t *filter, const int write_ghosts,
+                          sc_array_t *cells)
+{
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  const t8_locidx_t num_trees = num_local_trees + (write_ghosts ? t8_forest_ghost_num_trees (forest) : 0);
+  t8_locidx_t itree, ielem, jelem, num_tree_elements, num_points = 0;
+  t8_linearidx_t first_id, last_id, ancestor_first_id, ancestor_last_id, next_id;
+  t8_forest_vtk_select_tree_t select_tree;
+  t8_forest_vtk_cell_t *cell;
+  t8_element_t *ancestor, *desc;
+  std::vector<char> selected;
+
+  sc_array_init (cells, sizeof (t8_forest_vtk_cell_t));
+  for (itree = 0; itree < num_trees; itree++) {
+    const int is_ghost = itree >= num_local_trees;
+    const t8_eclass_t eclass = is_ghost ? t8_forest_ghost_get_tree_class (forest, itree - num_local_trees)
+                                        : t8_forest_get_tree_class (forest, itree);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+
+    select_tree = filter->select != NULL ? T8_VTK_SELECT_TREE_LEAVES : T8_VTK_SELECT_TREE_ALL;
+    if (filter->select_tree != NULL) {
+      select_tree = filter->select_tree (forest, itree, is_ghost, filter->select_data);
+      if (select_tree == T8_VTK_SELECT_TREE_LEAVES && filter->select == NULL) {
+        select_tree = T8_VTK_SELECT_TREE_ALL;
+      }
+    }
+    if (select_tree == T8_VTK_SELECT_TREE_NONE) {
+      /* No leaf of this tree is written */
+      continue;
+    }
+    num_tree_elements = is_ghost ? t8_forest_ghost_tree_num_elements (forest, itree - num_local_trees)
+                                 : t8_forest_get_tree_num_elements (forest, itree);
+    /* Decide once for each leaf whether it is written */
+    selected.assign (num_tree_elements, 1);
+    for (ielem = 0; ielem < num_tree_elements && select_tree == T8_VTK_SELECT_TREE_LEAVES; ielem++) {
+      const t8_element_t *leaf = is_ghost ? t8_forest_ghost_get_element (forest, itree - num_local_trees, ielem)
+                                          : t8_forest_get_element_in_tree (forest, itree, ielem);
+      selected[ielem] = filter->select (forest, itree, leaf, ts, is_ghost, filter->select_data) != 0;
+    }
+
+    ts->t8_element_new (1, &ancestor);
+    ts->t8_element_new (1, &desc);
+    for (ielem = 0; ielem < num_tree_elements; ielem = jelem) {
+      const t8_element_t *leaf = is_ghost ? t8_forest_ghost_get_element (forest, itree - num_local_trees, ielem)
+                                          : t8_forest_get_element_in_tree (forest, itree, ielem);
+      const int level = ts->t8_element_level (leaf);
+
+      jelem = ielem + 1;
+      if (!selected[ielem]) {
+        continue;
+      }
+      if (!is_ghost && filter->max_level >= 0 && level > filter->max_level) {
+        /* Compute the ancestor on the maximum output level */
+        ts->t8_element_copy (leaf, ancestor);
+        for (int ilevel = level; ilevel > filter->max_level; ilevel--) {
+          ts->t8_element_parent (ancestor, ancestor);
+        }
+        t8_forest_vtk_desc_ids (forest, ancestor, ts, desc, &ancestor_first_id, &ancestor_last_id);
+        t8_forest_vtk_desc_ids (forest, leaf, ts, desc, &first_id, &last_id);
+        if (first_id == ancestor_first_id) {
+          /* The leaf is the first leaf of the ancestor. Collect the following selected leaves
+           * as long as they continue the previous leaf in the ancestor. */
+          next_id = last_id + 1;
+          while (next_id <= ancestor_last_id && jelem < num_tree_elements && selected[jelem]) {
+            t8_forest_vtk_desc_ids (forest, t8_forest_get_element_in_tree (forest, itree, jelem), ts, desc, &first_id,
+                                    &last_id);
+            if (first_id != next_id) {
+              /* There is a gap before this leaf */
+              break;
+            }
+            next_id = last_id + 1;
+            jelem++;
+          }
+          if (next_id == ancestor_last_id + 1) {
+            /* The leaves cover the ancestor completely */
+            cell = (t8_forest_vtk_cell_t *) sc_array_push (cells);
+            ts->t8_element_new (1, &cell->element);
+            ts->t8_element_copy (ancestor, cell->element);
+            cell->is_ancestor = 1;
+            cell->ltree_id = itree;
+            cell->element_index = ielem;
+            cell->num_leaves = jelem - ielem;
+            cell->ts = ts;
+            num_points += ts->t8_element_num_corners (cell->element);
+            continue;
+          }
+          /* The family is incomplete, we write the leaf on its own and continue with the next leaf */
+          jelem = ielem + 1;
+        }
+      }
+      cell = (t8_forest_vtk_cell_t *) sc_array_push (cells);
+      cell->element = (t8_element_t *) leaf;
+      cell->is_ancestor = 0;
+      cell->ltree_id = itree;
+      cell->element_index = ielem;
+      cell->num_leaves = 1;
+      cell->ts = ts;
+      num_points += ts->t8_element_num_corners (cell->element);
+    }
+    ts->t8_element_destroy (1, &ancestor);
+    ts->t8_element_destroy (1, &desc);
+  }
+  return num_points;
+}
+
+/* Free the cells of t8_forest_vtk_cells_init */
+static void
+t8_forest_vtk_cells_reset (sc_array_t *cells)
+{
+  for (size_t icell = 0; icell < cells->elem_count; icell++) {
+    t8_forest_vtk_cell_t *cell = (t8_forest_vtk_cell_t *) sc_array_index (cells, icell);
+    if (cell->is_ancestor) {
+      cell->ts->t8_element_destroy (1, &cell->element);
+    }
+  }
+  sc_array_reset (cells);
+}
+
+/* Return one component of the user data of a local cell. For a coarse cell of several leaves,
+ * this is the average of the leaf values, weighted with the volume fraction of each leaf
+ * on the reference element. */
+static double
+t8_forest_vtk_cell_value (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_locidx_t element_index,
+                          const t8_element_t *element, t8_eclass_scheme_c *ts, const t8_forest_vtk_stream_t *stream,
+                          const double *values, const int num_components, const int icomponent)
+{
+  const t8_locidx_t offset = t8_forest_get_tree_element_offset (forest, ltree_id) + element_index;
+  const int level = ts->t8_element_level (element);
+  double value = 0, volume = 0;
+
+  if (stream->num_leaves == 1) {
+    return values[offset * num_components + icomponent];
+  }
+  for (t8_locidx_t ileaf = 0; ileaf < stream->num_leaves; ileaf++) {
+    const t8_element_t *leaf = t8_forest_get_element_in_tree (forest, ltree_id, element_index + ileaf);
+    const double leaf_volume = ldexp (1.0, -forest->dimension * (ts->t8_element_level (leaf) - level));
+    value += leaf_volume * values[(offset + ileaf) * num_components + icomponent];
+    volume += leaf_volume;
+  }
+  return value / volume;
+}
+
+/* Return the index of the first corner of a local element in the shared points */
+static t8_locidx_t
+t8_forest_vtk_shared_first_corner (t8_forest_t forest, const t8_forest_vtk_shared_points_t *shared,
+                                   const t8_locidx_t ltree_id, const t8_locidx_t element_index)
+{
+  return shared->corner_offsets[t8_forest_get_tree_element_offset (forest, ltree_id) + element_index];
+}
+
 static int
 t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                      const t8_locidx_t element_index, const t8_element_t *element,
-                                     t8_eclass_scheme_c *ts, const int is_ghost, FILE *vtufile, int *columns,
-                                     void **data, T8_VTK_KERNEL_MODUS modus)
+                                     t8_eclass_scheme_c *ts, const int is_ghost, t8_forest_vtk_stream_t *stream,
+                                     int *columns, void **data, T8_VTK_KERNEL_MODUS modus)
 {
   double element_coordinates[3];
   int num_el_vertices, ivertex;
   int freturn;
   t8_element_shape_t element_shape;
+  t8_locidx_t first_corner = -1;
 
   if (modus != T8_VTK_KERNEL_EXECUTE) {
     /* Nothing to do if we are in Init or clean up mode */
@@ -616,28 +1156,43 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, const t8_locidx_t ltree
    *       does this work too over tree->class or do we need something else?
    */
 
+  /* We switch of the column control of the surrounding function
+   * by keeping the columns value constant. */
+  *columns = 1;
+  if (stream->shared != NULL && !is_ghost) {
+    first_corner = t8_forest_vtk_shared_first_corner (forest, stream->shared, ltree_id, element_index);
+  }
   element_shape = ts->t8_element_shape (element);
   num_el_vertices = t8_eclass_num_vertices[element_shape];
   for (ivertex = 0; ivertex < num_el_vertices; ivertex++) {
     const double *ref_coords = t8_forest_vtk_point_to_element_ref_coords[element_shape][ivertex];
+    if (first_corner >= 0 && !stream->shared->is_first[first_corner + ivertex]) {
+      /* This point was already written for another element */
+      continue;
+    }
     t8_forest_element_from_ref_coords (forest, ltree_id, element, ref_coords, 1, element_coordinates);
-    freturn = fprintf (vtufile, "         ");
-    if (freturn <= 0) {
-      return 0;
+    if (stream->vtufile != NULL) {
+      freturn = fprintf (stream->vtufile, "         ");
+      if (freturn <= 0) {
+        return 0;
+      }
     }
+    for (int icoord = 0; icoord < 3; icoord++) {
 #ifdef T8_VTK_DOUBLES
-    freturn = fprintf (vtufile, " %24.16e %24.16e %24.16e\n", element_coordinates[0], element_coordinates[1],
-                       element_coordinates[2]);
+      freturn = t8_forest_vtk_put_float (stream, " %24.16e", element_coordinates[icoord]);
 #else
-    freturn = fprintf (vtufile, " %16.8e %16.8e %16.8e\n", element_coordinates[0], element_coordinates[1],
-                       element_coordinates[2]);
+      freturn = t8_forest_vtk_put_float (stream, " %16.8e", element_coordinates[icoord]);
 #endif
-    if (freturn <= 0) {
-      return 0;
+      if (!freturn) {
+        return 0;
+      }
+    }
+    if (stream->vtufile != NULL) {
+      freturn = fprintf (stream->vtufile, "\n");
+      if (freturn <= 0) {
+        return 0;
+      }
     }
-    /* We switch of the column control of the surrounding function
-     * by keeping the columns value constant. */
-    *columns = 1;
   }
   return 1;
 }
@@ -645,8 +1200,8 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, const t8_locidx_t ltree
 static int
 t8_forest_vtk_cells_connectivity_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                          const t8_locidx_t element_index, const t8_element_t *element,
-                                         t8_eclass_scheme_c *ts, const int is_ghost, FILE *vtufile, int *columns,
-                                         void **data, T8_VTK_KERNEL_MODUS modus)
+                                         t8_eclass_scheme_c *ts, const int is_ghost, t8_forest_vtk_stream_t *stream,
+                                         int *columns, void **data, T8_VTK_KERNEL_MODUS modus)
 {
   int ivertex, num_vertices;
   int freturn;
@@ -667,9 +1222,24 @@ t8_forest_vtk_cells_connectivity_kernel (t8_forest_t forest, const t8_locidx_t l
   count_vertices = (t8_locidx_t *) *data;
   element_shape = ts->t8_element_shape (element);
   num_vertices = t8_eclass_num_vertices[element_shape];
+  if (stream->shared != NULL && !is_ghost) {
+    /* The corners of local elements refer to the shared points */
+    const t8_locidx_t *point_ids
+      = stream->shared->point_ids + t8_forest_vtk_shared_first_corner (forest, stream->shared, ltree_id, element_index);
+    for (ivertex = 0; ivertex < num_vertices; ++ivertex) {
+      freturn = t8_forest_vtk_put_int (stream, " %lld", (long long) point_ids[ivertex]);
+      if (!freturn) {
+        return 0;
+      }
+    }
+    *columns += num_vertices;
+    return 1;
+  }
+  /* The points of ghost elements are written after the shared points */
+  const long long point_offset = stream->shared != NULL ? stream->shared->num_points : 0;
   for (ivertex = 0; ivertex < num_vertices; ++ivertex, (*count_vertices)++) {
-    freturn = fprintf (vtufile, " %ld", (long) *count_vertices);
-    if (freturn <= 0) {
+    freturn = t8_forest_vtk_put_int (stream, " %lld", point_offset + *count_vertices);
+    if (!freturn) {
       return 0;
     }
   }
@@ -680,7 +1250,7 @@ t8_forest_vtk_cells_connectivity_kernel (t8_forest_t forest, const t8_locidx_t l
 static int
 t8_forest_vtk_cells_offset_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                    const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                   const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                   const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                    T8_VTK_KERNEL_MODUS modus)
 {
   long long *offset;
@@ -701,8 +1271,8 @@ t8_forest_vtk_cells_offset_kernel (t8_forest_t forest, const t8_locidx_t ltree_i
 
   num_vertices = t8_eclass_num_vertices[ts->t8_element_shape (element)];
   *offset += num_vertices;
-  freturn = fprintf (vtufile, " %lld", *offset);
-  if (freturn <= 0) {
+  freturn = t8_forest_vtk_put_int (stream, " %lld", *offset);
+  if (!freturn) {
     return 0;
   }
   *columns += 1;
@@ -713,14 +1283,14 @@ t8_forest_vtk_cells_offset_kernel (t8_forest_t forest, const t8_locidx_t ltree_i
 static int
 t8_forest_vtk_cells_type_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                  const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                 const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                 const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                  T8_VTK_KERNEL_MODUS modus)
 {
   int freturn;
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     /* print the vtk type of the element */
-    freturn = fprintf (vtufile, " %d", t8_eclass_vtk_type[ts->t8_element_shape (element)]);
-    if (freturn <= 0) {
+    freturn = t8_forest_vtk_put_int (stream, " %lld", t8_eclass_vtk_type[ts->t8_element_shape (element)]);
+    if (!freturn) {
       return 0;
     }
     *columns += 1;
@@ -731,11 +1301,11 @@ t8_forest_vtk_cells_type_kernel (t8_forest_t forest, const t8_locidx_t ltree_id,
 static int
 t8_forest_vtk_cells_level_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                   const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                  const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                  const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                   T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
-    fprintf (vtufile, "%i ", ts->t8_element_level (element));
+    t8_forest_vtk_put_int (stream, "%lli ", ts->t8_element_level (element));
     *columns += 1;
   }
   return 1;
@@ -744,11 +1314,11 @@ t8_forest_vtk_cells_level_kernel (t8_forest_t forest, const t8_locidx_t ltree_id
 static int
 t8_forest_vtk_cells_rank_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                  const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                 const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                 const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                  T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
-    fprintf (vtufile, "%i ", forest->mpirank);
+    t8_forest_vtk_put_int (stream, "%lli ", forest->mpirank);
     *columns += 1;
   }
   return 1;
@@ -757,7 +1327,7 @@ t8_forest_vtk_cells_rank_kernel (t8_forest_t forest, const t8_locidx_t ltree_id,
 static int
 t8_forest_vtk_cells_treeid_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                    const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                   const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                   const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                    T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
@@ -770,7 +1340,7 @@ t8_forest_vtk_cells_treeid_kernel (t8_forest_t forest, const t8_locidx_t ltree_i
       /* Otherwise the global tree id */
       tree_id = (long long) ltree_id + forest->first_local_tree;
     }
-    fprintf (vtufile, "%lli ", tree_id);
+    t8_forest_vtk_put_int (stream, "%lli ", tree_id);
     *columns += 1;
   }
   return 1;
@@ -779,16 +1349,17 @@ t8_forest_vtk_cells_treeid_kernel (t8_forest_t forest, const t8_locidx_t ltree_i
 static int
 t8_forest_vtk_cells_elementid_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                       const t8_locidx_t element_index, const t8_element_t *element,
-                                      t8_eclass_scheme_c *ts, const int is_ghost, FILE *vtufile, int *columns,
-                                      void **data, T8_VTK_KERNEL_MODUS modus)
+                                      t8_eclass_scheme_c *ts, const int is_ghost, t8_forest_vtk_stream_t *stream,
+                                      int *columns, void **data, T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     if (!is_ghost) {
-      fprintf (vtufile, "%lli ",
-               element_index + tree->elements_offset + (long long) t8_forest_get_first_local_element_id (forest));
+      t8_forest_vtk_put_int (stream, "%lli ",
+                             element_index + tree->elements_offset
+                               + (long long) t8_forest_get_first_local_element_id (forest));
     }
     else {
-      fprintf (vtufile, "%lli ", (long long) -1);
+      t8_forest_vtk_put_int (stream, "%lli ", -1);
     }
     *columns += 1;
   }
@@ -798,22 +1369,21 @@ t8_forest_vtk_cells_elementid_kernel (t8_forest_t forest, const t8_locidx_t ltre
 static int
 t8_forest_vtk_cells_scalar_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                    const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                   const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                   const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                    T8_VTK_KERNEL_MODUS modus)
 {
   double element_value = 0;
-  t8_locidx_t scalar_index;
 
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     /* For local elements access the data array, for ghosts, write 0 */
     if (!is_ghost) {
-      scalar_index = t8_forest_get_tree_element_offset (forest, ltree_id) + element_index;
-      element_value = ((double *) *data)[scalar_index];
+      element_value
+        = t8_forest_vtk_cell_value (forest, ltree_id, element_index, element, ts, stream, (double *) *data, 1, 0);
     }
     else {
       element_value = 0;
     }
-    fprintf (vtufile, "%g ", element_value);
+    t8_forest_vtk_put_float (stream, "%g ", element_value);
     *columns += 1;
   }
   return 1;
@@ -822,27 +1392,24 @@ t8_forest_vtk_cells_scalar_kernel (t8_forest_t forest, const t8_locidx_t ltree_i
 static int
 t8_forest_vtk_cells_vector_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                    const t8_locidx_t element_index, const t8_element_t *element, t8_eclass_scheme_c *ts,
-                                   const int is_ghost, FILE *vtufile, int *columns, void **data,
+                                   const int is_ghost, t8_forest_vtk_stream_t *stream, int *columns, void **data,
                                    T8_VTK_KERNEL_MODUS modus)
 {
-  double *element_values, null_vec[3] = { 0, 0, 0 };
+  double element_values[3] = { 0, 0, 0 };
   int dim, idim;
-  t8_locidx_t tree_offset;
 
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     dim = 3;
     T8_ASSERT (forest->dimension <= 3);
     /* For local elements access the data array, for ghosts, write 0 */
     if (!is_ghost) {
-      tree_offset = t8_forest_get_tree_element_offset (forest, ltree_id);
-      /* Get a pointer to the start of the element's vector data */
-      element_values = ((double *) *data) + (tree_offset + element_index) * dim;
-    }
-    else {
-      element_values = null_vec;
+      for (idim = 0; idim < dim; idim++) {
+        element_values[idim] = t8_forest_vtk_cell_value (forest, ltree_id, element_index, element, ts, stream,
+                                                         (double *) *data, dim, idim);
+      }
     }
     for (idim = 0; idim < dim; idim++) {
-      fprintf (vtufile, "%g ", element_values[idim]);
+      t8_forest_vtk_put_float (stream, "%g ", element_values[idim]);
     }
     *columns += dim;
   }
@@ -853,26 +1420,30 @@ t8_forest_vtk_cells_vector_kernel (t8_forest_t forest, const t8_locidx_t ltree_i
 static int
 t8_forest_vtk_vertices_scalar_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                       const t8_locidx_t element_index, const t8_element_t *element,
-                                      t8_eclass_scheme_c *ts, const int is_ghost, FILE *vtufile, int *columns,
-                                      void **data, T8_VTK_KERNEL_MODUS modus)
+                                      t8_eclass_scheme_c *ts, const int is_ghost, t8_forest_vtk_stream_t *stream,
+                                      int *columns, void **data, T8_VTK_KERNEL_MODUS modus)
 {
   double element_value = 0;
   int num_vertex, ivertex;
-  t8_locidx_t scalar_index;
+  t8_locidx_t first_corner = -1;
 
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     num_vertex = ts->t8_element_num_corners (element);
+    if (stream->shared != NULL && !is_ghost) {
+      first_corner = t8_forest_vtk_shared_first_corner (forest, stream->shared, ltree_id, element_index);
+    }
+    /* For local elements access the data array, for ghosts, write 0 */
+    if (!is_ghost) {
+      element_value
+        = t8_forest_vtk_cell_value (forest, ltree_id, element_index, element, ts, stream, (double *) *data, 1, 0);
+    }
 
     for (ivertex = 0; ivertex < num_vertex; ivertex++) {
-      /* For local elements access the data array, for ghosts, write 0 */
-      if (!is_ghost) {
-        scalar_index = t8_forest_get_tree_element_offset (forest, ltree_id) + element_index;
-        element_value = ((double *) *data)[scalar_index];
+      if (first_corner >= 0 && !stream->shared->is_first[first_corner + ivertex]) {
+        /* A shared point gets the value of the first element that writes it */
+        continue;
       }
-      else {
-        element_value = 0;
-      }
-      fprintf (vtufile, "%g ", element_value);
+      t8_forest_vtk_put_float (stream, "%g ", element_value);
       *columns += 1;
     }
   }
@@ -883,30 +1454,35 @@ t8_forest_vtk_vertices_scalar_kernel (t8_forest_t forest, const t8_locidx_t ltre
 static int
 t8_forest_vtk_vertices_vector_kernel (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_tree_t tree,
                                       const t8_locidx_t element_index, const t8_element_t *element,
-                                      t8_eclass_scheme_c *ts, const int is_ghost, FILE *vtufile, int *columns,
-                                      void **data, T8_VTK_KERNEL_MODUS modus)
+                                      t8_eclass_scheme_c *ts, const int is_ghost, t8_forest_vtk_stream_t *stream,
+                                      int *columns, void **data, T8_VTK_KERNEL_MODUS modus)
 {
-  double *element_values, null_vec[3] = { 0, 0, 0 };
+  double element_values[3] = { 0, 0, 0 };
   int dim, idim;
   int num_vertex, ivertex;
-  t8_locidx_t tree_offset;
+  t8_locidx_t first_corner = -1;
 
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     num_vertex = ts->t8_element_num_corners (element);
-    for (ivertex = 0; ivertex < num_vertex; ivertex++) {
-      dim = 3;
-      T8_ASSERT (forest->dimension <= 3);
-      /* For local elements access the data array, for ghosts, write 0 */
-      if (!is_ghost) {
-        tree_offset = t8_forest_get_tree_element_offset (forest, ltree_id);
-        /* Get a pointer to the start of the element's vector data */
-        element_values = ((double *) *data) + (tree_offset + element_index) * dim;
+    if (stream->shared != NULL && !is_ghost) {
+      first_corner = t8_forest_vtk_shared_first_corner (forest, stream->shared, ltree_id, element_index);
+    }
+    dim = 3;
+    T8_ASSERT (forest->dimension <= 3);
+    /* For local elements access the data array, for ghosts, write 0 */
+    if (!is_ghost) {
+      for (idim = 0; idim < dim; idim++) {
+        element_values[idim] = t8_forest_vtk_cell_value (forest, ltree_id, element_index, element, ts, stream,
+                                                         (double *) *data, dim, idim);
       }
-      else {
-        element_values = null_vec;
+    }
+    for (ivertex = 0; ivertex < num_vertex; ivertex++) {
+      if (first_corner >= 0 && !stream->shared->is_first[first_corner + ivertex]) {
+        /* A shared point gets the value of the first element that writes it */
+        continue;
       }
       for (idim = 0; idim < dim; idim++) {
-        fprintf (vtufile, "%g ", element_values[idim]);
+        t8_forest_vtk_put_float (stream, "%g ", element_values[idim]);
       }
       *columns += dim;
     }
@@ -915,13 +1491,16 @@ t8_forest_vtk_vertices_vector_kernel (t8_forest_t forest, const t8_locidx_t ltre
 }
 
 /* Iterate over all cells and write cell data to the file using
- * the cell_data_kernel as callback */
+ * the cell_data_kernel as callback.
+ * In ascii mode the kernel prints the values directly to the file.
+ * Otherwise we collect the values and write the binary data array at once,
+ * or add it to the snapshot of the output. */
 static int
-t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile, const char *dataname, const char *datatype,
-                               const char *component_string, const int max_columns,
+t8_forest_vtk_write_cell_data (t8_forest_t forest, t8_forest_vtk_output_t *output, const char *dataname,
+                               const char *datatype, const char *component_string, const int max_columns,
                                t8_forest_vtk_cell_data_kernel kernel, const int write_ghosts, void *udata)
 {
-  int freturn;
+  int freturn = 1;
   int countcols;
   t8_tree_t tree;
   t8_locidx_t itree, ighost;
@@ -930,15 +1509,36 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile, const char *da
   t8_element_t *element;
   t8_eclass_scheme_c *ts;
   void *data = NULL;
+  t8_forest_vtk_stream_t stream;
+
+  T8_ASSERT (output->cache == NULL || (output->snapshot == NULL && output->file->format != T8_VTK_ASCII));
+  if (output->cache != NULL && udata == NULL) {
+    /* The values do not depend on user data, thus we can reuse them if we wrote the same forest before */
+    const t8_forest_vtk_snapshot_item_t *cached = t8_forest_vtk_items_find_array (&output->cache->arrays, dataname);
+    if (cached != NULL) {
+      return !t8_vtk_write_binary_data_array (output->file, datatype, dataname, component_string, cached->values->array,
+                                              cached->values->elem_count * cached->values->elem_size);
+    }
+  }
 
-  /* Write the connectivity information.
-   * Thus for each tree we write the indices of its corner vertices. */
-  freturn = fprintf (vtufile,
-                     "        <DataArray type=\"%s\" "
-                     "Name=\"%s\" %s format=\"ascii\">\n         ",
-                     datatype, dataname, component_string);
-  if (freturn <= 0) {
-    return 0;
+  stream.is_float = datatype[0] == 'F';
+  stream.shared = output->shared;
+  if (output->snapshot == NULL && output->file->format == T8_VTK_ASCII) {
+    stream.vtufile = output->file->vtufile;
+    stream.values = NULL;
+    /* Write the connectivity information.
+     * Thus for each tree we write the indices of its corner vertices. */
+    freturn = fprintf (stream.vtufile,
+                       "        <DataArray type=\"%s\" "
+                       "Name=\"%s\" %s format=\"ascii\">\n         ",
+                       datatype, dataname, component_string);
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+  else {
+    stream.vtufile = NULL;
+    stream.values = sc_array_new (t8_vtk_type_size (datatype));
   }
 
   /* if udata != NULL, use it as the data pointer, in this case, the kernel
@@ -950,89 +1550,128 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile, const char *da
   /* Call the kernel in initialization modus to possibly initialize the
    * data pointer */
   kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data, T8_VTK_KERNEL_INIT);
-  /* We iterate over the trees and count each trees vertices,
-   * we add this to the already counted vertices and write it to the file */
-  /* TODO: replace with an element iterator */
   num_local_trees = t8_forest_get_num_local_trees (forest);
-  for (itree = 0, countcols = 0; itree < num_local_trees; itree++) {
-    /* Get the tree that stores the elements */
-    tree = t8_forest_get_tree (forest, itree);
-    /* Get the eclass scheme of the tree */
-    ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
-    elems_in_tree = (t8_locidx_t) t8_element_array_get_count (&tree->elements);
-    for (element_index = 0; element_index < elems_in_tree; element_index++) {
-      /* Get a pointer to the element */
-      element = t8_forest_get_element (forest, tree->elements_offset + element_index, NULL);
-      T8_ASSERT (element != NULL);
-      /* Execute the given callback on each element */
-      if (!kernel (forest, itree, tree, element_index, element, ts, 0, vtufile, &countcols, &data,
-                   T8_VTK_KERNEL_EXECUTE)) {
-        /* call the kernel in clean-up modus */
-        kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-        return 0;
+  countcols = 0;
+  stream.num_leaves = 1;
+  if (output->cells != NULL) {
+    /* We only write the filtered cells, the skipped leaves are never passed to the kernel */
+    for (size_t icell = 0; icell < output->cells->elem_count; icell++) {
+      const t8_forest_vtk_cell_t *cell = (const t8_forest_vtk_cell_t *) sc_array_index (output->cells, icell);
+      const int is_ghost = cell->ltree_id >= num_local_trees;
+      tree = is_ghost ? NULL : t8_forest_get_tree (forest, cell->ltree_id);
+      stream.num_leaves = cell->num_leaves;
+      if (!kernel (forest, cell->ltree_id, tree, cell->element_index, cell->element, cell->ts, is_ghost, &stream,
+                   &countcols, &data, T8_VTK_KERNEL_EXECUTE)) {
+        goto t8_forest_vtk_cell_data_failure;
       }
       /* After max_columns we break the line */
-      if (!(countcols % max_columns)) {
-        freturn = fprintf (vtufile, "\n         ");
+      if (stream.vtufile != NULL && !(countcols % max_columns)) {
+        freturn = fprintf (stream.vtufile, "\n         ");
         if (freturn <= 0) {
-          /* call the kernel in clean-up modus */
-          kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-          return 0;
+          goto t8_forest_vtk_cell_data_failure;
         }
       }
-    } /* element loop ends here */
-    if (freturn <= 0) {
-      /* call the kernel in clean-up modus */
-      kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-      return 0;
     }
-  } /* tree loop ends here */
-
-  if (write_ghosts) {
-    t8_locidx_t num_ghosts_in_tree;
-    /* Iterate over the ghost elements */
+  }
+  else {
+    /* We iterate over the trees and count each trees vertices,
+     * we add this to the already counted vertices and write it to the file */
     /* TODO: replace with an element iterator */
-    num_ghost_trees = t8_forest_ghost_num_trees (forest);
-    for (ighost = 0; ighost < num_ghost_trees; ighost++) {
-      /* Get the eclass scheme of the ghost tree */
-      ts = t8_forest_get_eclass_scheme (forest, t8_forest_ghost_get_tree_class (forest, ighost));
-      /* The number of ghosts in this tree */
-      num_ghosts_in_tree = t8_forest_ghost_tree_num_elements (forest, ighost);
-      for (element_index = 0; element_index < num_ghosts_in_tree; element_index++) {
+    for (itree = 0; itree < num_local_trees; itree++) {
+      /* Get the tree that stores the elements */
+      tree = t8_forest_get_tree (forest, itree);
+      /* Get the eclass scheme of the tree */
+      ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+      elems_in_tree = (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+      for (element_index = 0; element_index < elems_in_tree; element_index++) {
         /* Get a pointer to the element */
-        element = t8_forest_ghost_get_element (forest, ighost, element_index);
+        element = t8_forest_get_element (forest, tree->elements_offset + element_index, NULL);
+        T8_ASSERT (element != NULL);
         /* Execute the given callback on each element */
-        if (!kernel (forest, ighost + num_local_trees, NULL, element_index, element, ts, 1, vtufile, &countcols, &data,
+        if (!kernel (forest, itree, tree, element_index, element, ts, 0, &stream, &countcols, &data,
                      T8_VTK_KERNEL_EXECUTE)) {
-          /* call the kernel in clean-up modus */
-          kernel (NULL, 0, NULL, 0, NULL, NULL, 1, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-          return 0;
+          goto t8_forest_vtk_cell_data_failure;
         }
         /* After max_columns we break the line */
-        if (!(countcols % max_columns)) {
-          freturn = fprintf (vtufile, "\n         ");
+        if (stream.vtufile != NULL && !(countcols % max_columns)) {
+          freturn = fprintf (stream.vtufile, "\n         ");
           if (freturn <= 0) {
-            /* call the kernel in clean-up modus */
-            kernel (NULL, 0, NULL, 0, NULL, NULL, 1, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-            return 0;
+            goto t8_forest_vtk_cell_data_failure;
           }
         }
       } /* element loop ends here */
       if (freturn <= 0) {
-        /* call the kernel in clean-up modus */
-        kernel (NULL, 0, NULL, 0, NULL, NULL, 1, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-        return 0;
+        goto t8_forest_vtk_cell_data_failure;
       }
-    } /* ghost loop ends here */
-  }   /* write_ghosts ends here */
+    } /* tree loop ends here */
+
+    if (write_ghosts) {
+      t8_locidx_t num_ghosts_in_tree;
+      /* Iterate over the ghost elements */
+      /* TODO: replace with an element iterator */
+      num_ghost_trees = t8_forest_ghost_num_trees (forest);
+      for (ighost = 0; ighost < num_ghost_trees; ighost++) {
+        /* Get the eclass scheme of the ghost tree */
+        ts = t8_forest_get_eclass_scheme (forest, t8_forest_ghost_get_tree_class (forest, ighost));
+        /* The number of ghosts in this tree */
+        num_ghosts_in_tree = t8_forest_ghost_tree_num_elements (forest, ighost);
+        for (element_index = 0; element_index < num_ghosts_in_tree; element_index++) {
+          /* Get a pointer to the element */
+          element = t8_forest_ghost_get_element (forest, ighost, element_index);
+          /* Execute the given callback on each element */
+          if (!kernel (forest, ighost + num_local_trees, NULL, element_index, element, ts, 1, &stream, &countcols,
+                       &data, T8_VTK_KERNEL_EXECUTE)) {
+            goto t8_forest_vtk_cell_data_failure;
+          }
+          /* After max_columns we break the line */
+          if (stream.vtufile != NULL && !(countcols % max_columns)) {
+            freturn = fprintf (stream.vtufile, "\n         ");
+            if (freturn <= 0) {
+              goto t8_forest_vtk_cell_data_failure;
+            }
+          }
+        } /* element loop ends here */
+        if (freturn <= 0) {
+          goto t8_forest_vtk_cell_data_failure;
+        }
+      } /* ghost loop ends here */
+    } /* write_ghosts ends here */
+  }
   /* call the kernel in clean-up modus */
   kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
-  freturn = fprintf (vtufile, "\n        </DataArray>\n");
-  if (freturn <= 0) {
-    return 0;
+  if (stream.vtufile != NULL) {
+    freturn = fprintf (stream.vtufile, "\n        </DataArray>\n");
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+  else if (output->snapshot != NULL) {
+    /* The snapshot takes over the values */
+    t8_forest_vtk_items_add_array (&output->snapshot->items, datatype, dataname, component_string, stream.values);
+  }
+  else {
+    freturn = t8_vtk_write_binary_data_array (output->file, datatype, dataname, component_string, stream.values->array,
+                                              stream.values->elem_count * stream.values->elem_size);
+    if (output->cache != NULL && udata == NULL) {
+      /* Keep the values for the next output of this forest */
+      t8_forest_vtk_items_add_array (&output->cache->arrays, datatype, dataname, component_string, stream.values);
+    }
+    else {
+      sc_array_destroy (stream.values);
+    }
+    if (freturn != 0) {
+      return 0;
+    }
   }
 
   return 1;
+t8_forest_vtk_cell_data_failure:
+  /* call the kernel in clean-up modus */
+  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data, T8_VTK_KERNEL_CLEANUP);
+  if (stream.values != NULL) {
+    sc_array_destroy (stream.values);
+  }
+  return 0;
 }
 
 /* Write the cell data to an open file stream.
@@ -1040,24 +1679,24 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE *vtufile, const char *da
  * After completion the file will remain open, whether writing
  * cells was successful or not. */
 static int
-t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_treeid, const int write_mpirank,
-                           const int write_level, const int write_element_id, const int write_ghosts,
-                           const int num_data, t8_vtk_data_field_t *data)
+t8_forest_vtk_write_cells (t8_forest_t forest, t8_forest_vtk_output_t *output, const int write_treeid,
+                           const int write_mpirank, const int write_level, const int write_element_id,
+                           const int write_ghosts, const int num_data, t8_vtk_data_field_t *data)
 {
   int freturn;
   int idata;
 
   T8_ASSERT (t8_forest_is_committed (forest));
-  T8_ASSERT (vtufile != NULL);
+  T8_ASSERT (output->file != NULL || output->snapshot != NULL);
 
-  freturn = fprintf (vtufile, "      <Cells>\n");
+  freturn = t8_forest_vtk_output_printf (output, "      <Cells>\n");
   if (freturn <= 0) {
     goto t8_forest_vtk_cell_failure;
   }
 
   /* Write the connectivity information.
    * Thus for each tree we write the indices of its corner vertices. */
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "connectivity", T8_VTK_LOCIDX, "", 8,
+  freturn = t8_forest_vtk_write_cell_data (forest, output, "connectivity", T8_VTK_LOCIDX, "", 8,
                                            t8_forest_vtk_cells_connectivity_kernel, write_ghosts, NULL);
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
@@ -1070,7 +1709,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
    * For example if the trees are a square and a triangle, the offsets would
    * be 4 and 7, since indices 0,1,2,3 refer to the vertices of the square
    * and indices 4,5,6 to the indices of the triangle. */
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "offsets", T8_VTK_LOCIDX, "", 8,
+  freturn = t8_forest_vtk_write_cell_data (forest, output, "offsets", T8_VTK_LOCIDX, "", 8,
                                            t8_forest_vtk_cells_offset_kernel, write_ghosts, NULL);
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
@@ -1080,19 +1719,19 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
   /* Write the element types. The type specifies the element class, thus
    * square/triangle/tet etc. */
 
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "types", "Int32", "", 8, t8_forest_vtk_cells_type_kernel,
+  freturn = t8_forest_vtk_write_cell_data (forest, output, "types", "Int32", "", 8, t8_forest_vtk_cells_type_kernel,
                                            write_ghosts, NULL);
 
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
   }
   /* Done with writing the types */
-  freturn = fprintf (vtufile, "      </Cells>\n");
+  freturn = t8_forest_vtk_output_printf (output, "      </Cells>\n");
   if (freturn <= 0) {
     goto t8_forest_vtk_cell_failure;
   }
   /* clang-format off */
-  freturn = fprintf (vtufile, "      <CellData Scalars =\"%s%s\">\n", "treeid,mpirank,level",
+  freturn = t8_forest_vtk_output_printf (output, "      <CellData Scalars =\"%s%s\">\n", "treeid,mpirank,level",
                      (write_element_id ? "id" : ""));
   /* clang-format on */
   if (freturn <= 0) {
@@ -1102,7 +1741,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
   if (write_treeid) {
     /* Write the tree ids. */
 
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "treeid", T8_VTK_GLOIDX, "", 8,
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "treeid", T8_VTK_GLOIDX, "", 8,
                                              t8_forest_vtk_cells_treeid_kernel, write_ghosts, NULL);
     if (!freturn) {
       goto t8_forest_vtk_cell_failure;
@@ -1112,7 +1751,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
   if (write_mpirank) {
     /* Write the mpiranks. */
 
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "mpirank", "Int32", "", 8,
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "mpirank", "Int32", "", 8,
                                              t8_forest_vtk_cells_rank_kernel, write_ghosts, NULL);
     if (!freturn) {
       goto t8_forest_vtk_cell_failure;
@@ -1122,7 +1761,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
   if (write_level) {
     /* Write the element refinement levels. */
 
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "level", "Int32", "", 8, t8_forest_vtk_cells_level_kernel,
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "level", "Int32", "", 8, t8_forest_vtk_cells_level_kernel,
                                              write_ghosts, NULL);
     if (!freturn) {
       goto t8_forest_vtk_cell_failure;
@@ -1136,7 +1775,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
 
     /* Use 32 bit ints if the global element count fits, 64 bit otherwise. */
     datatype = forest->global_num_elements > T8_LOCIDX_MAX ? T8_VTK_GLOIDX : T8_VTK_LOCIDX;
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "element_id", datatype, "", 8,
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "element_id", datatype, "", 8,
                                              t8_forest_vtk_cells_elementid_kernel, write_ghosts, NULL);
     if (!freturn) {
       goto t8_forest_vtk_cell_failure;
@@ -1147,14 +1786,14 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
   /* Write the user defined data fields per element */
   for (idata = 0; idata < num_data; idata++) {
     if (data[idata].type == T8_VTK_SCALAR) {
-      freturn = t8_forest_vtk_write_cell_data (forest, vtufile, data[idata].description, T8_VTK_FLOAT_NAME, "", 8,
+      freturn = t8_forest_vtk_write_cell_data (forest, output, data[idata].description, T8_VTK_FLOAT_NAME, "", 8,
                                                t8_forest_vtk_cells_scalar_kernel, write_ghosts, data[idata].data);
     }
     else {
       char component_string[BUFSIZ];
       T8_ASSERT (data[idata].type == T8_VTK_VECTOR);
       snprintf (component_string, BUFSIZ, "NumberOfComponents=\"3\"");
-      freturn = t8_forest_vtk_write_cell_data (forest, vtufile, data[idata].description, T8_VTK_FLOAT_NAME,
+      freturn = t8_forest_vtk_write_cell_data (forest, output, data[idata].description, T8_VTK_FLOAT_NAME,
                                                component_string, 8 * forest->dimension,
                                                t8_forest_vtk_cells_vector_kernel, write_ghosts, data[idata].data);
     }
@@ -1163,7 +1802,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE *vtufile, const int write_tr
     }
   }
 
-  freturn = fprintf (vtufile, "      </CellData>\n");
+  freturn = t8_forest_vtk_output_printf (output, "      </CellData>\n");
   if (freturn <= 0) {
     goto t8_forest_vtk_cell_failure;
   }
@@ -1181,8 +1820,8 @@ t8_forest_vtk_cell_failure:
  * After completion the file will remain open, whether writing
  * cells was successful or not. */
 static int
-t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile, const int write_ghosts, const int num_data,
-                            t8_vtk_data_field_t *data)
+t8_forest_vtk_write_points (t8_forest_t forest, t8_forest_vtk_output_t *output, const int write_ghosts,
+                            const int num_data, t8_vtk_data_field_t *data)
 {
   int freturn;
   int sreturn;
@@ -1190,20 +1829,20 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile, const int write_g
   char description[BUFSIZ];
 
   T8_ASSERT (t8_forest_is_committed (forest));
-  T8_ASSERT (vtufile != NULL);
+  T8_ASSERT (output->file != NULL || output->snapshot != NULL);
 
   /* Write the vertex coordinates */
 
-  freturn = fprintf (vtufile, "      <Points>\n");
+  freturn = t8_forest_vtk_output_printf (output, "      <Points>\n");
   if (freturn <= 0) {
     goto t8_forest_vtk_cell_failure;
   }
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "Position", T8_VTK_FLOAT_NAME, "NumberOfComponents=\"3\"",
-                                           8, t8_forest_vtk_cells_vertices_kernel, write_ghosts, NULL);
+  freturn = t8_forest_vtk_write_cell_data (forest, output, "Position", T8_VTK_FLOAT_NAME, "NumberOfComponents=\"3\"", 8,
+                                           t8_forest_vtk_cells_vertices_kernel, write_ghosts, NULL);
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
   }
-  freturn = fprintf (vtufile, "      </Points>\n");
+  freturn = t8_forest_vtk_output_printf (output, "      </Points>\n");
   if (freturn <= 0) {
     goto t8_forest_vtk_cell_failure;
   }
@@ -1211,7 +1850,7 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile, const int write_g
 
   /* Write the user defined data fields per element */
   if (num_data > 0) {
-    freturn = fprintf (vtufile, "      <PointData>\n");
+    freturn = t8_forest_vtk_output_printf (output, "      <PointData>\n");
     for (idata = 0; idata < num_data; idata++) {
       if (data[idata].type == T8_VTK_SCALAR) {
         /* Write the description string. */
@@ -1221,7 +1860,7 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile, const int write_g
           /* The output was truncated */
           t8_debugf ("Warning: Truncated vtk point data description to '%s'\n", description);
         }
-        freturn = t8_forest_vtk_write_cell_data (forest, vtufile, description, T8_VTK_FLOAT_NAME, "", 8,
+        freturn = t8_forest_vtk_write_cell_data (forest, output, description, T8_VTK_FLOAT_NAME, "", 8,
                                                  t8_forest_vtk_vertices_scalar_kernel, write_ghosts, data[idata].data);
       }
       else {
@@ -1238,7 +1877,7 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile, const int write_g
           t8_debugf ("Warning: Truncated vtk point data description to '%s'\n", description);
         }
 
-        freturn = t8_forest_vtk_write_cell_data (forest, vtufile, description, T8_VTK_FLOAT_NAME, component_string,
+        freturn = t8_forest_vtk_write_cell_data (forest, output, description, T8_VTK_FLOAT_NAME, component_string,
                                                  8 * forest->dimension, t8_forest_vtk_vertices_vector_kernel,
                                                  write_ghosts, data[idata].data);
       }
@@ -1246,7 +1885,7 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE *vtufile, const int write_g
         goto t8_forest_vtk_cell_failure;
       }
     }
-    freturn = fprintf (vtufile, "      </PointData>\n");
+    freturn = t8_forest_vtk_output_printf (output, "      </PointData>\n");
   }
   /* Function completed successfully */
   return 1;
@@ -1261,7 +1900,45 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix, const int
                           const int write_level, const int write_element_id, int write_ghosts, const int num_data,
                           t8_vtk_data_field_t *data)
 {
-  FILE *vtufile = NULL;
+  return t8_forest_vtk_write_file_ext (forest, fileprefix, write_treeid, write_mpirank, write_level, write_element_id,
+                                       write_ghosts, num_data, data, T8_VTK_ASCII, 0);
+}
+
+/* On process 0, write the .pvtu file that links the .vtu files of all processes.
+ * Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_write_pvtu (t8_forest_t forest, const char *fileprefix, const int write_treeid, const int write_mpirank,
+                          const int write_level, const int write_element_id, const int num_data,
+                          t8_vtk_data_field_t *data)
+{
+  if (forest->mpirank == 0
+      && t8_write_pvtu (fileprefix, forest->mpisize, write_treeid, write_mpirank, write_level, write_element_id,
+                        num_data, data)) {
+    t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
+    return 0;
+  }
+  return 1;
+}
+
+/* Write the .vtu file of this process.
+ * If \a snapshot is not NULL, the contents of the .vtu file are recorded in \a snapshot
+ * instead of being written, and \a format must not be T8_VTK_ASCII.
+ * If \a cache is not NULL, it must be empty or belong to \a forest. Then the data arrays
+ * and shared points that depend only on the forest are taken from the cache, or stored in
+ * the cache if they are not yet cached. Only the shared points are cached for ascii output.
+ * If \a filter is not NULL, only the cells selected by \a filter are written and points are not shared.
+ * Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_write_or_record (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                               const int write_mpirank, const int write_level, const int write_element_id,
+                               int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                               const t8_vtk_format_t format, const int share_points, t8_forest_vtk_snapshot_t *snapshot,
+                               t8_forest_vtk_geometry_cache_t *cache, const t8_forest_vtk_filter_t *filter)
+{
+  t8_vtk_file_t file;
+  t8_forest_vtk_output_t output;
+  t8_forest_vtk_shared_points_t shared_points, *shared = NULL;
+  sc_array_t cells;
   t8_locidx_t num_elements, num_points;
   char vtufilename[BUFSIZ];
   int freturn;
@@ -1269,28 +1946,45 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix, const int
   T8_ASSERT (forest != NULL);
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (fileprefix != NULL);
+  T8_ASSERT (snapshot == NULL || format != T8_VTK_ASCII);
+  T8_ASSERT (cache == NULL || (snapshot == NULL && (cache->forest == NULL || cache->forest == forest)));
+  T8_ASSERT (cache == NULL || filter == NULL);
+  file.vtufile = NULL;
   if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
     /* Never write ghost elements if there aren't any */
     write_ghosts = 0;
   }
   T8_ASSERT (forest->ghosts != NULL || !write_ghosts);
 
-  /* process 0 creates the .pvtu file */
-  if (forest->mpirank == 0) {
-    if (t8_write_pvtu (fileprefix, forest->mpisize, write_treeid, write_mpirank, write_level, write_element_id,
-                       num_data, data)) {
-      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
-      goto t8_forest_vtk_failure;
-    }
+  if (filter != NULL) {
+    /* Select the cells that we write, without evaluating the geometry of skipped leaves */
+    num_points = t8_forest_vtk_cells_init (forest, filter, write_ghosts, &cells);
+    num_elements = (t8_locidx_t) cells.elem_count;
   }
-
-  /* The local number of elements */
-  num_elements = t8_forest_get_local_num_elements (forest);
-  if (write_ghosts) {
-    num_elements += t8_forest_get_num_ghosts (forest);
+  else {
+    /* The local number of elements */
+    num_elements = t8_forest_get_local_num_elements (forest);
+    if (write_ghosts) {
+      num_elements += t8_forest_get_num_ghosts (forest);
+    }
+    /* The local number of points, counted with multiplicity */
+    num_points = t8_forest_num_points (forest, write_ghosts);
+    if (share_points) {
+      /* Each point of the local elements is written once, the points of the ghosts follow */
+      if (cache == NULL) {
+        shared = &shared_points;
+        t8_forest_vtk_shared_points_init (forest, shared);
+      }
+      else {
+        shared = &cache->shared;
+        if (!cache->has_shared) {
+          t8_forest_vtk_shared_points_init (forest, shared);
+          cache->has_shared = 1;
+        }
+      }
+      num_points += shared->num_points - shared->corner_offsets[t8_forest_get_local_num_elements (forest)];
+    }
   }
-  /* The local number of points, counted with multiplicity */
-  num_points = t8_forest_num_points (forest, write_ghosts);
 
   /* The filename for this processes file */
   freturn = snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, forest->mpirank);
@@ -1299,76 +1993,670 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix, const int
     goto t8_forest_vtk_failure;
   }
 
-  /* Open the vtufile to write to */
-  vtufile = fopen (vtufilename, "w");
-  if (vtufile == NULL) {
-    t8_errorf ("Error when opening file %s\n", vtufilename);
-    goto t8_forest_vtk_failure;
-  }
-  /* Write the header information in the .vtu file.
-   * xml type, Unstructured grid and number of points and elements. */
-  freturn = fprintf (vtufile, "<?xml version=\"1.0\"?>\n");
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-  freturn = fprintf (vtufile, "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
+  output.file = NULL;
+  output.snapshot = snapshot;
+  output.shared = shared;
+  output.cache = format != T8_VTK_ASCII ? cache : NULL;
+  output.cells = filter != NULL ? &cells : NULL;
+  if (snapshot != NULL) {
+    /* Record the header information, the file is opened when the snapshot is written. */
+    strcpy (snapshot->vtufilename, vtufilename);
+    snapshot->format = format;
+    snapshot->num_points = num_points;
+    snapshot->num_cells = num_elements;
   }
-#ifdef SC_IS_BIGENDIAN
-  freturn = fprintf (vtufile, " byte_order=\"BigEndian\">\n");
-#else
-  freturn = fprintf (vtufile, " byte_order=\"LittleEndian\">\n");
-#endif
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-  freturn = fprintf (vtufile, "  <UnstructuredGrid>\n");
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-  freturn = fprintf (vtufile, "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n", (long long) num_points,
-                     (long long) num_elements);
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
+  else {
+    /* Open the vtufile and write the header information.
+     * xml type, Unstructured grid and number of points and elements. */
+    if (t8_vtk_file_open (&file, vtufilename, format, num_points, num_elements)) {
+      t8_errorf ("Error when opening file %s\n", vtufilename);
+      goto t8_forest_vtk_failure;
+    }
+    output.file = &file;
   }
   /* write the point data */
-  if (!t8_forest_vtk_write_points (forest, vtufile, write_ghosts, num_data, data)) {
+  if (!t8_forest_vtk_write_points (forest, &output, write_ghosts, num_data, data)) {
     /* writings points was not successful */
     goto t8_forest_vtk_failure;
   }
   /* write the cell data */
-  if (!t8_forest_vtk_write_cells (forest, vtufile, write_treeid, write_mpirank, write_level, write_element_id,
+  if (!t8_forest_vtk_write_cells (forest, &output, write_treeid, write_mpirank, write_level, write_element_id,
                                   write_ghosts, num_data, data)) {
     /* Writing cells was not successful */
     goto t8_forest_vtk_failure;
   }
 
-  freturn = fprintf (vtufile, "    </Piece>\n"
-                              "  </UnstructuredGrid>\n"
-                              "</VTKFile>\n");
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-
-  freturn = fclose (vtufile);
-  /* We set it not NULL, even if fclose was not successful, since then any
-   * following call to fclose would result in undefined behaviour. */
-  vtufile = NULL;
-  if (freturn != 0) {
-    /* Closing failed, this usually means that the final write operation could
-     * not be completed. */
+  /* Write the appended data, if any, and close the file. The file is
+   * closed even if writing fails, since then any following call
+   * to fclose would result in undefined behaviour. */
+  if (file.vtufile != NULL && t8_vtk_file_close (&file)) {
     t8_global_errorf ("Error when closing file %s\n", vtufilename);
     goto t8_forest_vtk_failure;
   }
+  if (shared == &shared_points) {
+    t8_forest_vtk_shared_points_reset (shared);
+  }
+  if (filter != NULL) {
+    t8_forest_vtk_cells_reset (&cells);
+  }
   /* Writing was successful */
   return 1;
 t8_forest_vtk_failure:
-  if (vtufile != NULL) {
-    fclose (vtufile);
+  if (file.vtufile != NULL) {
+    fclose (file.vtufile);
+    sc_array_reset (&file.appended_data);
+  }
+  if (shared == &shared_points) {
+    t8_forest_vtk_shared_points_reset (shared);
+  }
+  if (filter != NULL) {
+    t8_forest_vtk_cells_reset (&cells);
   }
   t8_errorf ("Error when writing vtk file.\n");
   return 0;
 }
 
+int
+t8_forest_vtk_write_file_ext (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                              const int write_mpirank, const int write_level, const int write_element_id,
+                              int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                              const t8_vtk_format_t format, const int share_points)
+{
+  /* process 0 creates the .pvtu file */
+  if (!t8_forest_vtk_write_pvtu (forest, fileprefix, write_treeid, write_mpirank, write_level, write_element_id,
+                                 num_data, data)) {
+    return 0;
+  }
+  return t8_forest_vtk_write_or_record (forest, fileprefix, write_treeid, write_mpirank, write_level, write_element_id,
+                                        write_ghosts, num_data, data, format, share_points, NULL, NULL, NULL);
+}
+
+int
+t8_forest_vtk_write_file_filtered (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                                   const int write_mpirank, const int write_level, const int write_element_id,
+                                   int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                                   const t8_vtk_format_t format, const t8_forest_vtk_filter_t *filter)
+{
+  T8_ASSERT (filter != NULL);
+
+  /* process 0 creates the .pvtu file */
+  if (!t8_forest_vtk_write_pvtu (forest, fileprefix, write_treeid, write_mpirank, write_level, write_element_id,
+                                 num_data, data)) {
+    return 0;
+  }
+  return t8_forest_vtk_write_or_record (forest, fileprefix, write_treeid, write_mpirank, write_level, write_element_id,
+                                        write_ghosts, num_data, data, format, 0, NULL, NULL, filter);
+}
+
+void
+t8_forest_vtk_filter_init (t8_forest_vtk_filter_t *filter)
+{
+  T8_ASSERT (filter != NULL);
+  filter->select = NULL;
+  filter->select_tree = NULL;
+  filter->select_data = NULL;
+  filter->max_level = -1;
+}
+
+int
+t8_forest_vtk_select_bounding_box (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_element_t *element,
+                                   t8_eclass_scheme_c *ts, const int is_ghost, void *user_data)
+{
+  const double *box = (const double *) user_data;
+  double centroid[3];
+
+  T8_ASSERT (box != NULL);
+  t8_forest_element_centroid (forest, ltree_id, element, centroid);
+  for (int icoord = 0; icoord < 3; icoord++) {
+    if (centroid[icoord] < box[icoord] || centroid[icoord] > box[icoord + 3]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+t8_forest_vtk_select_tree_t
+t8_forest_vtk_select_tree_bounding_box (t8_forest_t forest, const t8_locidx_t ltree_id, const int is_ghost,
+                                        void *user_data)
+{
+  const double *box = (const double *) user_data;
+  double tree_lower[3], tree_upper[3];
+  int is_inside = 1;
+
+  T8_ASSERT (box != NULL);
+  if (is_ghost) {
+    /* The cmesh tree of a ghost tree need not be local, we test its leaves */
+    return T8_VTK_SELECT_TREE_LEAVES;
+  }
+  t8_cmesh_get_tree_bounding_box (t8_forest_get_cmesh (forest), t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltree_id),
+                                  tree_lower, tree_upper);
+  for (int icoord = 0; icoord < 3; icoord++) {
+    if (tree_upper[icoord] < box[icoord] || tree_lower[icoord] > box[icoord + 3]) {
+      /* No point of the tree lies inside the box */
+      return T8_VTK_SELECT_TREE_NONE;
+    }
+    is_inside = is_inside && box[icoord] <= tree_lower[icoord] && tree_upper[icoord] <= box[icoord + 3];
+  }
+  /* If the tree lies inside the box, so do the centroids of all its leaves */
+  return is_inside ? T8_VTK_SELECT_TREE_ALL : T8_VTK_SELECT_TREE_LEAVES;
+}
+
+#ifdef T8_ENABLE_MPIIO
+/** The largest number of bytes that we write with a count of MPI_BYTE. */
+#define T8_FOREST_VTK_CHUNK_SIZE ((size_t) 1 << 30)
+
+/* Write num_bytes bytes at an offset of a file. This function is collective.
+ * Since the count of MPI_File_write_at_all is an int, more than T8_FOREST_VTK_CHUNK_SIZE bytes
+ * are written as one struct of whole chunks followed by the remaining bytes. */
+static int
+t8_forest_vtk_write_at_all (MPI_File file, MPI_Offset offset, const void *buffer, const size_t num_bytes)
+{
+  MPI_Datatype chunk_type, datatype, types[2];
+  MPI_Aint displacements[2];
+  int blocklengths[2], mpiret;
+
+  if (num_bytes <= T8_FOREST_VTK_CHUNK_SIZE) {
+    return MPI_File_write_at_all (file, offset, buffer, (int) num_bytes, MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+  MPI_Type_contiguous ((int) T8_FOREST_VTK_CHUNK_SIZE, MPI_BYTE, &chunk_type);
+  blocklengths[0] = (int) (num_bytes / T8_FOREST_VTK_CHUNK_SIZE);
+  blocklengths[1] = (int) (num_bytes % T8_FOREST_VTK_CHUNK_SIZE);
+  displacements[0] = 0;
+  displacements[1] = (MPI_Aint) (num_bytes - blocklengths[1]);
+  types[0] = chunk_type;
+  types[1] = MPI_BYTE;
+  MPI_Type_create_struct (2, blocklengths, displacements, types, &datatype);
+  MPI_Type_commit (&datatype);
+  mpiret = MPI_File_write_at_all (file, offset, buffer, 1, datatype, MPI_STATUS_IGNORE);
+  MPI_Type_free (&datatype);
+  MPI_Type_free (&chunk_type);
+  return mpiret;
+}
+#endif
+
+/* Write the contents of the shared .vtu file at the offsets of this process.
+ * The xml of all processes comes first, followed by the appended data of all processes.
+ * This function is collective. Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_write_shared_contents (t8_forest_t forest, const char *filename, const std::string &xml,
+                                     const t8_gloidx_t xml_offset, const sc_array_t *appended,
+                                     const t8_gloidx_t appended_offset, const int num_aggregators)
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_File file;
+  MPI_Info info;
+  char value[BUFSIZ];
+  int mpiret;
+
+  MPI_Info_create (&info);
+  if (num_aggregators > 0) {
+    /* Let only num_aggregators processes access the file in the collective writes */
+    snprintf (value, BUFSIZ, "%i", num_aggregators);
+    MPI_Info_set (info, "cb_nodes", value);
+    MPI_Info_set (info, "romio_cb_write", "enable");
+  }
+  mpiret = MPI_File_open (forest->mpicomm, filename, MPI_MODE_WRONLY | MPI_MODE_CREATE, info, &file);
+  MPI_Info_free (&info);
+  if (mpiret != MPI_SUCCESS) {
+    return 0;
+  }
+  /* Remove the contents of an existing file */
+  mpiret = MPI_File_set_size (file, 0);
+  if (mpiret == MPI_SUCCESS) {
+    mpiret = t8_forest_vtk_write_at_all (file, xml_offset, xml.data (), xml.size ());
+  }
+  if (mpiret == MPI_SUCCESS) {
+    mpiret = t8_forest_vtk_write_at_all (file, appended_offset, appended->array, appended->elem_count);
+  }
+  MPI_File_close (&file);
+  return mpiret == MPI_SUCCESS;
+#else
+  FILE *file;
+  int success;
+
+  if (forest->mpisize > 1) {
+    t8_global_errorf ("Writing a shared vtk file on more than one process requires MPI I/O.\n");
+    return 0;
+  }
+  T8_ASSERT (xml_offset == 0);
+  file = fopen (filename, "wb");
+  if (file == NULL) {
+    return 0;
+  }
+  success = fwrite (xml.data (), 1, xml.size (), file) == xml.size ()
+            && fwrite (appended->array, 1, appended->elem_count, file) == appended->elem_count;
+  return !fclose (file) && success;
+#endif
+}
+
+int
+t8_forest_vtk_write_file_shared (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                                 const int write_mpirank, const int write_level, const int write_element_id,
+                                 int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                                 const int share_points, const int num_aggregators)
+{
+  t8_forest_vtk_snapshot_t snapshot;
+  std::string xml;
+  sc_array_t appended;
+  char filename[BUFSIZ], buffer[BUFSIZ];
+  const char *const footer = "\n  </AppendedData>\n</VTKFile>\n";
+  const int is_last = forest->mpirank == forest->mpisize - 1;
+  t8_gloidx_t local_size, offset, xml_offset, xml_size, appended_offset;
+  size_t iitem, num_bytes;
+  int success, all_success, mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (fileprefix != NULL);
+  T8_ASSERT (num_aggregators >= 0);
+
+  /* Record the piece of this process with appended data arrays */
+  t8_forest_vtk_snapshot_init (&snapshot);
+  success = snprintf (filename, BUFSIZ, "%s.vtu", fileprefix) < BUFSIZ;
+  if (!success) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+  }
+  success = success
+            && t8_forest_vtk_write_or_record (forest, fileprefix, write_treeid, write_mpirank, write_level,
+                                              write_element_id, write_ghosts, num_data, data, T8_VTK_APPENDED,
+                                              share_points, &snapshot, NULL, NULL);
+
+  /* Compute the size of the appended data of this process. Each array is preceded by its size. */
+  local_size = is_last ? strlen (footer) : 0;
+  for (iitem = 0; iitem < snapshot.items.elem_count; iitem++) {
+    t8_forest_vtk_snapshot_item_t *item = (t8_forest_vtk_snapshot_item_t *) sc_array_index (&snapshot.items, iitem);
+    if (item->text == NULL) {
+      num_bytes = item->values->elem_count * item->values->elem_size;
+      local_size += sizeof (uint64_t) + num_bytes;
+    }
+  }
+  mpiret = sc_MPI_Allreduce (&success, &all_success, 1, sc_MPI_INT, sc_MPI_LAND, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (!all_success) {
+    t8_forest_vtk_snapshot_reset (&snapshot);
+    t8_errorf ("Error when writing vtk file.\n");
+    return 0;
+  }
+  /* The offset of the appended data of this process within the AppendedData section */
+  mpiret = sc_MPI_Scan (&local_size, &offset, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  offset -= local_size;
+
+  /* Build the xml of this process and its appended data.
+   * Process 0 writes the header of the file and the last process the end of the xml and the footer. */
+  if (forest->mpirank == 0) {
+    xml = "<?xml version=\"1.0\"?>\n<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" header_type=\"UInt64\"";
+#ifdef SC_IS_BIGENDIAN
+    xml += " byte_order=\"BigEndian\">\n";
+#else
+    xml += " byte_order=\"LittleEndian\">\n";
+#endif
+    xml += "  <UnstructuredGrid>\n";
+  }
+  snprintf (buffer, BUFSIZ, "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n",
+            (long long) snapshot.num_points, (long long) snapshot.num_cells);
+  xml += buffer;
+  sc_array_init (&appended, sizeof (char));
+  for (iitem = 0; iitem < snapshot.items.elem_count; iitem++) {
+    t8_forest_vtk_snapshot_item_t *item = (t8_forest_vtk_snapshot_item_t *) sc_array_index (&snapshot.items, iitem);
+    if (item->text != NULL) {
+      xml += item->text;
+    }
+    else {
+      const uint64_t header = (uint64_t) item->values->elem_count * item->values->elem_size;
+      snprintf (buffer, BUFSIZ, "        <DataArray type=\"%s\" Name=\"%s\" %s format=\"appended\" offset=\"%lld\"/>\n",
+                item->type, item->name, item->component_string, (long long) (offset + appended.elem_count));
+      xml += buffer;
+      memcpy (sc_array_push_count (&appended, sizeof (header)), &header, sizeof (header));
+      if (header > 0) {
+        memcpy (sc_array_push_count (&appended, header), item->values->array, header);
+      }
+    }
+  }
+  xml += "    </Piece>\n";
+  if (is_last) {
+    /* The raw data starts after the underscore */
+    xml += "  </UnstructuredGrid>\n  <AppendedData encoding=\"raw\">\n_";
+    memcpy (sc_array_push_count (&appended, strlen (footer)), footer, strlen (footer));
+  }
+  T8_ASSERT ((t8_gloidx_t) appended.elem_count == local_size);
+  t8_forest_vtk_snapshot_reset (&snapshot);
+
+  /* The offset of the xml of this process and the size of the xml of all processes */
+  local_size = xml.size ();
+  mpiret = sc_MPI_Scan (&local_size, &xml_offset, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&local_size, &xml_size, 1, T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  xml_offset -= local_size;
+  appended_offset = xml_size + offset;
+
+  success = t8_forest_vtk_write_shared_contents (forest, filename, xml, xml_offset, &appended, appended_offset,
+                                                 num_aggregators);
+  sc_array_reset (&appended);
+  if (!success) {
+    t8_errorf ("Error when writing file %s\n", filename);
+  }
+  return success;
+}
+
+/* A time series of vtk output files with a .pvd collection file. */
+struct t8_forest_vtk_series
+{
+  char fileprefix[BUFSIZ]; /* The prefix of all files of the series. */
+  int write_treeid;        /* The flags of t8_forest_vtk_write_file_ext. */
+  int write_mpirank;
+  int write_level;
+  int write_element_id;
+  int write_ghosts;
+  t8_vtk_format_t format;
+  int share_points;
+  sc_array_t times;                     /* The time of each written step. */
+  t8_forest_vtk_geometry_cache_t cache; /* The data arrays of the forest of the last step. */
+};
+
+/* Write the .pvd file that lists the .pvtu files of all steps of a series.
+ * The file is rewritten after each step, thus it is valid while the series is running.
+ * Returns true on success and false otherwise. */
+static int
+t8_forest_vtk_series_write_pvd (t8_forest_vtk_series_t series)
+{
+  char pvdfilename[BUFSIZ];
+  const char *basename;
+  FILE *pvdfile;
+  size_t istep;
+
+  if (snprintf (pvdfilename, BUFSIZ, "%s.pvd", series->fileprefix) >= BUFSIZ) {
+    t8_errorf ("Error when writing pvd file. Filename too long.\n");
+    return 0;
+  }
+  pvdfile = fopen (pvdfilename, "w");
+  if (pvdfile == NULL) {
+    t8_errorf ("Could not open file %s for output.\n", pvdfilename);
+    return 0;
+  }
+  /* The .pvtu files are in the same directory as the .pvd file */
+  basename = strrchr (series->fileprefix, '/');
+  basename = basename != NULL ? basename + 1 : series->fileprefix;
+  fprintf (pvdfile, "<?xml version=\"1.0\"?>\n");
+  fprintf (pvdfile, "<VTKFile type=\"Collection\" version=\"0.1\">\n");
+  fprintf (pvdfile, "  <Collection>\n");
+  for (istep = 0; istep < series->times.elem_count; istep++) {
+    fprintf (pvdfile, "    <DataSet timestep=\"%.16g\" group=\"\" part=\"0\" file=\"%s_%04zu.pvtu\"/>\n",
+             *(double *) sc_array_index (&series->times, istep), basename, istep);
+  }
+  fprintf (pvdfile, "  </Collection>\n");
+  fprintf (pvdfile, "</VTKFile>\n");
+  if (ferror (pvdfile)) {
+    t8_errorf ("Error when writing file %s\n", pvdfilename);
+    fclose (pvdfile);
+    return 0;
+  }
+  if (fclose (pvdfile)) {
+    t8_errorf ("Error when closing file %s\n", pvdfilename);
+    return 0;
+  }
+  return 1;
+}
+
+t8_forest_vtk_series_t
+t8_forest_vtk_series_new (const char *fileprefix, const int write_treeid, const int write_mpirank,
+                          const int write_level, const int write_element_id, const int write_ghosts,
+                          const t8_vtk_format_t format, const int share_points)
+{
+  t8_forest_vtk_series_t series;
+
+  T8_ASSERT (fileprefix != NULL && strlen (fileprefix) < BUFSIZ);
+  series = T8_ALLOC (struct t8_forest_vtk_series, 1);
+  snprintf (series->fileprefix, BUFSIZ, "%s", fileprefix);
+  series->write_treeid = write_treeid;
+  series->write_mpirank = write_mpirank;
+  series->write_level = write_level;
+  series->write_element_id = write_element_id;
+  series->write_ghosts = write_ghosts;
+  series->format = format;
+  series->share_points = share_points;
+  sc_array_init (&series->times, sizeof (double));
+  series->cache.forest = NULL;
+  sc_array_init (&series->cache.arrays, sizeof (t8_forest_vtk_snapshot_item_t));
+  series->cache.has_shared = 0;
+  return series;
+}
+
+int
+t8_forest_vtk_series_write (t8_forest_vtk_series_t series, t8_forest_t forest, const double time, const int num_data,
+                            t8_vtk_data_field_t *data)
+{
+  char stepprefix[BUFSIZ];
+  int success;
+
+  T8_ASSERT (series != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (snprintf (stepprefix, BUFSIZ, "%s_%04zu", series->fileprefix, series->times.elem_count) >= BUFSIZ) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+    return 0;
+  }
+  if (series->cache.forest != forest) {
+    /* The forest changed, we have to compute its geometry again */
+    t8_forest_vtk_geometry_cache_reset (&series->cache);
+    t8_forest_ref (forest);
+    series->cache.forest = forest;
+  }
+  success = t8_forest_vtk_write_pvtu (forest, stepprefix, series->write_treeid, series->write_mpirank,
+                                      series->write_level, series->write_element_id, num_data, data)
+            && t8_forest_vtk_write_or_record (forest, stepprefix, series->write_treeid, series->write_mpirank,
+                                              series->write_level, series->write_element_id, series->write_ghosts,
+                                              num_data, data, series->format, series->share_points, NULL,
+                                              &series->cache, NULL);
+  /* We count the step even if writing failed, such that all processes agree on the file names */
+  *(double *) sc_array_push (&series->times) = time;
+  if (forest->mpirank == 0 && !t8_forest_vtk_series_write_pvd (series)) {
+    success = 0;
+  }
+  return success;
+}
+
+void
+t8_forest_vtk_series_destroy (t8_forest_vtk_series_t *pseries)
+{
+  t8_forest_vtk_series_t series;
+
+  T8_ASSERT (pseries != NULL && *pseries != NULL);
+  series = *pseries;
+  t8_forest_vtk_geometry_cache_reset (&series->cache);
+  sc_array_reset (&series->times);
+  T8_FREE (series);
+  *pseries = NULL;
+}
+
+/* A pending asynchronous write of the .vtu file of this process. */
+struct t8_forest_vtk_async_request
+{
+  t8_forest_vtk_snapshot_t snapshot;   /* The contents of the file. */
+  int done;                            /* True once the file was written or writing failed. */
+  int success;                         /* True if the file was written successfully. */
+  t8_forest_vtk_async_writer_t writer; /* The writer that writes the snapshot. */
+};
+
+/* A background thread that writes the snapshots in the order of their submission.
+ * The fields done and success of the requests and all fields below num_requests
+ * are protected by mutex. */
+struct t8_forest_vtk_async_writer
+{
+  int max_in_flight; /* The maximum number of snapshots that are not yet written. */
+  int num_requests;  /* The number of requests that were not yet waited for. */
+#ifdef SC_ENABLE_PTHREAD
+  int num_in_flight; /* The number of snapshots that are not yet written. */
+  int shutdown;      /* True if the thread should stop once the queue is empty. */
+  std::deque<t8_forest_vtk_async_request_t> queue; /* The snapshots to write. */
+  std::mutex mutex;
+  std::condition_variable cond; /* Signals a change of the queue or of a request. */
+  std::thread thread;           /* The i/o thread. */
+#endif
+};
+
+#ifdef SC_ENABLE_PTHREAD
+/* The main loop of the i/o thread of a writer. */
+static void
+t8_forest_vtk_async_run (t8_forest_vtk_async_writer_t writer)
+{
+  std::unique_lock<std::mutex> lock (writer->mutex);
+
+  for (;;) {
+    writer->cond.wait (lock, [writer] { return writer->shutdown || !writer->queue.empty (); });
+    if (writer->queue.empty ()) {
+      /* We were asked to shut down and all snapshots are written */
+      return;
+    }
+    t8_forest_vtk_async_request_t request = writer->queue.front ();
+    writer->queue.pop_front ();
+    /* Encode and write the snapshot without holding the lock */
+    lock.unlock ();
+    const int success = t8_forest_vtk_snapshot_write (&request->snapshot);
+    t8_forest_vtk_snapshot_reset (&request->snapshot);
+    lock.lock ();
+    request->success = success;
+    request->done = 1;
+    writer->num_in_flight--;
+    writer->cond.notify_all ();
+  }
+}
+#endif
+
+t8_forest_vtk_async_writer_t
+t8_forest_vtk_async_writer_new (const int max_in_flight)
+{
+  t8_forest_vtk_async_writer_t writer;
+
+  T8_ASSERT (max_in_flight > 0);
+  writer = new t8_forest_vtk_async_writer;
+  writer->max_in_flight = max_in_flight;
+  writer->num_requests = 0;
+#ifdef SC_ENABLE_PTHREAD
+  writer->num_in_flight = 0;
+  writer->shutdown = 0;
+  writer->thread = std::thread (t8_forest_vtk_async_run, writer);
+#endif
+  return writer;
+}
+
+void
+t8_forest_vtk_async_writer_destroy (t8_forest_vtk_async_writer_t *pwriter)
+{
+  t8_forest_vtk_async_writer_t writer;
+
+  T8_ASSERT (pwriter != NULL && *pwriter != NULL);
+  writer = *pwriter;
+  /* All requests must have been waited for */
+  T8_ASSERT (writer->num_requests == 0);
+#ifdef SC_ENABLE_PTHREAD
+  {
+    std::lock_guard<std::mutex> lock (writer->mutex);
+    writer->shutdown = 1;
+  }
+  writer->cond.notify_all ();
+  writer->thread.join ();
+#endif
+  delete writer;
+  *pwriter = NULL;
+}
+
+t8_forest_vtk_async_request_t
+t8_forest_vtk_write_file_async (t8_forest_vtk_async_writer_t writer, t8_forest_t forest, const char *fileprefix,
+                                const int write_treeid, const int write_mpirank, const int write_level,
+                                const int write_element_id, int write_ghosts, const int num_data,
+                                t8_vtk_data_field_t *data, t8_vtk_format_t format, const int share_points)
+{
+  t8_forest_vtk_async_request_t request;
+  int success;
+
+  T8_ASSERT (writer != NULL);
+  request = T8_ALLOC (struct t8_forest_vtk_async_request, 1);
+  t8_forest_vtk_snapshot_init (&request->snapshot);
+  request->done = 0;
+  request->success = 0;
+  request->writer = writer;
+  writer->num_requests++;
+  if (format == T8_VTK_ASCII) {
+    /* We only record binary data arrays */
+    format = T8_VTK_BINARY;
+  }
+
+#ifdef SC_ENABLE_PTHREAD
+  {
+    /* Wait until the number of snapshots in flight is below the limit.
+     * We reserve our place before recording to bound the memory used by snapshots. */
+    std::unique_lock<std::mutex> lock (writer->mutex);
+    writer->cond.wait (lock, [writer] { return writer->num_in_flight < writer->max_in_flight; });
+    writer->num_in_flight++;
+  }
+#endif
+
+  /* Take the snapshot on the calling thread, thus the i/o thread never accesses the forest.
+   * The small .pvtu file is written right away. */
+  success = t8_forest_vtk_write_pvtu (forest, fileprefix, write_treeid, write_mpirank, write_level, write_element_id,
+                                      num_data, data)
+            && t8_forest_vtk_write_or_record (forest, fileprefix, write_treeid, write_mpirank, write_level,
+                                              write_element_id, write_ghosts, num_data, data, format, share_points,
+                                              &request->snapshot, NULL, NULL);
+
+#ifdef SC_ENABLE_PTHREAD
+  {
+    std::lock_guard<std::mutex> lock (writer->mutex);
+    if (success) {
+      writer->queue.push_back (request);
+    }
+    else {
+      writer->num_in_flight--;
+      request->done = 1;
+    }
+  }
+  writer->cond.notify_all ();
+  if (!success) {
+    t8_forest_vtk_snapshot_reset (&request->snapshot);
+  }
+#else
+  /* Without thread support in libsc we write the snapshot right away */
+  if (success) {
+    success = t8_forest_vtk_snapshot_write (&request->snapshot);
+  }
+  t8_forest_vtk_snapshot_reset (&request->snapshot);
+  request->success = success;
+  request->done = 1;
+#endif
+  return request;
+}
+
+int
+t8_forest_vtk_async_test (t8_forest_vtk_async_request_t request)
+{
+  T8_ASSERT (request != NULL);
+#ifdef SC_ENABLE_PTHREAD
+  std::lock_guard<std::mutex> lock (request->writer->mutex);
+#endif
+  return request->done;
+}
+
+int
+t8_forest_vtk_async_wait (t8_forest_vtk_async_request_t *prequest)
+{
+  t8_forest_vtk_async_request_t request;
+  int success;
+
+  T8_ASSERT (prequest != NULL && *prequest != NULL);
+  request = *prequest;
+#ifdef SC_ENABLE_PTHREAD
+  {
+    std::unique_lock<std::mutex> lock (request->writer->mutex);
+    request->writer->cond.wait (lock, [request] { return request->done != 0; });
+  }
+#endif
+  T8_ASSERT (request->done);
+  success = request->success;
+  request->writer->num_requests--;
+  T8_FREE (request);
+  *prequest = NULL;
+  return success;
+}
+
 T8_EXTERN_C_END ();
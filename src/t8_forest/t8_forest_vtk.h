@@ -32,6 +32,61 @@
 #include <t8_forest/t8_forest_general.h>
 #include <t8_forest/t8_forest_geometrical.h>
 
+/** A writer that writes .vtu files on a background i/o thread, see \ref t8_forest_vtk_write_file_async. */
+typedef struct t8_forest_vtk_async_writer *t8_forest_vtk_async_writer_t;
+
+/** A handle to one asynchronous write of a forest, see \ref t8_forest_vtk_write_file_async. */
+typedef struct t8_forest_vtk_async_request *t8_forest_vtk_async_request_t;
+
+/** A time series of vtk output files of forests, see \ref t8_forest_vtk_series_new. */
+typedef struct t8_forest_vtk_series *t8_forest_vtk_series_t;
+
+/** Decide whether a leaf element is written by \ref t8_forest_vtk_write_file_filtered.
+ * \param [in]  forest    The forest.
+ * \param [in]  ltree_id  The local tree id of the element. For ghost elements, the ghost tree id
+ *                        plus the number of local trees, as for \ref t8_forest_element_centroid.
+ * \param [in]  element   The leaf element.
+ * \param [in]  ts        The eclass scheme of the element.
+ * \param [in]  is_ghost  True if the element is a ghost element.
+ * \param [in]  user_data The \a select_data of the filter.
+ * \return                True if the element is written.
+ */
+typedef int (*t8_forest_vtk_select_fn) (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_element_t *element,
+                                        t8_eclass_scheme_c *ts, const int is_ghost, void *user_data);
+
+/** The result of a \ref t8_forest_vtk_select_tree_fn. */
+typedef enum {
+  T8_VTK_SELECT_TREE_NONE = 0, /**< No leaf of the tree is written. */
+  T8_VTK_SELECT_TREE_LEAVES,   /**< The select function decides for each leaf of the tree. */
+  T8_VTK_SELECT_TREE_ALL       /**< All leaves of the tree are written. */
+} t8_forest_vtk_select_tree_t;
+
+/** Decide for all leaves of a tree at once whether they are written by \ref t8_forest_vtk_write_file_filtered.
+ * This is called once per tree before the select function of the leaves, such that the leaves
+ * of skipped trees are never evaluated.
+ * \param [in]  forest    The forest.
+ * \param [in]  ltree_id  The local tree id, see \ref t8_forest_vtk_select_fn.
+ * \param [in]  is_ghost  True if the tree is a ghost tree.
+ * \param [in]  user_data The \a select_data of the filter.
+ * \return                Whether none, some or all leaves of the tree are written.
+ */
+typedef t8_forest_vtk_select_tree_t (*t8_forest_vtk_select_tree_fn) (t8_forest_t forest, const t8_locidx_t ltree_id,
+                                                                     const int is_ghost, void *user_data);
+
+/** Options to reduce the output of \ref t8_forest_vtk_write_file_filtered.
+ * Initialize with \ref t8_forest_vtk_filter_init. */
+typedef struct
+{
+  t8_forest_vtk_select_fn select;           /**< If not NULL, only the leaves for which \a select returns true
+                                                 are written. */
+  t8_forest_vtk_select_tree_fn select_tree; /**< If not NULL, called for each tree before \a select. */
+  void *select_data;                        /**< Passed to \a select and \a select_tree. */
+  int max_level;                            /**< If non-negative, each complete family of local leaves finer than
+                                                 \a max_level, whose leaves are all selected, is written as its
+                                                 ancestor of level \a max_level, with averaged data.
+                                                 All other leaves are written as they are. */
+} t8_forest_vtk_filter_t;
+
 T8_EXTERN_C_BEGIN ();
 /* function declarations */
 
@@ -87,6 +142,245 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix, const int
                           const int write_level, const int write_element_id, int write_ghosts, const int num_data,
                           t8_vtk_data_field_t *data);
 
+/** Write the forest in .pvtu file format with a given encoding of the data arrays.
+ * As \ref t8_forest_vtk_write_file, which is this function with format \ref T8_VTK_ASCII.
+ * The binary formats write much smaller files and are faster to write and to read.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  write_ghosts If true, each process additionally writes its ghost elements.
+ *                           For ghost element the treeid is -1.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ *                        If scalar and vector fields are used, all scalar fields
+ *                        must come first in the array.
+ * \param [in]  format    The encoding of the data arrays in the .vtu files.
+ *                        \ref T8_VTK_BINARY_COMPRESSED requires libsc with zlib
+ *                        and falls back to \ref T8_VTK_BINARY otherwise.
+ * \param [in]  share_points If true, coincident corners of the local elements are written as one
+ *                        point, see \ref t8_forest_number_local_nodes. Otherwise each element has
+ *                        its own points. The point data of a shared point is the data of the first
+ *                        element at that point. Ghost elements always have their own points.
+ * \return  True if successful, false if not (process local).
+ */
+int
+t8_forest_vtk_write_file_ext (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                              const int write_mpirank, const int write_level, const int write_element_id,
+                              int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                              const t8_vtk_format_t format, const int share_points);
+
+/** Write the forest in .pvtu file format with only a part of the elements.
+ * As \ref t8_forest_vtk_write_file_ext, but the leaves are filtered before anything is written:
+ * Leaves that are not selected by \a filter are skipped, such that their geometry is never evaluated.
+ * If the maximum output level of \a filter is non-negative, consecutive selected leaves in a tree that
+ * are finer than this level are written as one cell, their ancestor on the maximum output level.
+ * The data of such a cell is the average of the data of its leaves, weighted with the volume fraction
+ * of each leaf in the ancestor. Its element id is the id of its first leaf and its level is the maximum
+ * output level.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  write_ghosts If true, each process additionally writes its ghost elements.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ * \param [in]  format    The encoding of the data arrays in the .vtu files.
+ * \param [in]  filter    The filter of the leaves.
+ * \return  True if successful, false if not (process local).
+ * \note The points of filtered elements are not shared, see \ref t8_forest_vtk_write_file_ext.
+ */
+int
+t8_forest_vtk_write_file_filtered (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                                   const int write_mpirank, const int write_level, const int write_element_id,
+                                   int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                                   const t8_vtk_format_t format, const t8_forest_vtk_filter_t *filter);
+
+/** Initialize a filter that writes all leaves.
+ * \param [out] filter    The filter.
+ */
+void
+t8_forest_vtk_filter_init (t8_forest_vtk_filter_t *filter);
+
+/** A select function for \ref t8_forest_vtk_filter_t that selects the elements whose centroid
+ * lies inside an axis aligned box. Only the centroid of each element is evaluated.
+ * \param [in]  forest    The forest.
+ * \param [in]  ltree_id  The local tree id of the element, see \ref t8_forest_vtk_select_fn.
+ * \param [in]  element   The leaf element.
+ * \param [in]  ts        The eclass scheme of the element.
+ * \param [in]  is_ghost  True if the element is a ghost element.
+ * \param [in]  user_data An array of 6 doubles, the minimum x, y and z and the maximum x, y and z
+ *                        coordinates of the box.
+ * \return                True if the centroid of \a element lies inside the box.
+ */
+int
+t8_forest_vtk_select_bounding_box (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_element_t *element,
+                                   t8_eclass_scheme_c *ts, const int is_ghost, void *user_data);
+
+/** A tree select function for \ref t8_forest_vtk_filter_t to use with \ref t8_forest_vtk_select_bounding_box.
+ * The bounding box of a local tree is taken from its cmesh tree, see \ref t8_cmesh_get_tree_bounding_box.
+ * Trees whose bounding box does not intersect the box are skipped and trees whose bounding box lies
+ * inside the box are written completely, without evaluating the geometry of their leaves.
+ * \param [in]  forest    The forest.
+ * \param [in]  ltree_id  The local tree id, see \ref t8_forest_vtk_select_fn.
+ * \param [in]  is_ghost  True if the tree is a ghost tree. The leaves of ghost trees are always tested.
+ * \param [in]  user_data The box, see \ref t8_forest_vtk_select_bounding_box.
+ * \return                Whether none, some or all leaves of the tree are written.
+ */
+t8_forest_vtk_select_tree_t
+t8_forest_vtk_select_tree_bounding_box (t8_forest_t forest, const t8_locidx_t ltree_id, const int is_ghost,
+                                        void *user_data);
+
+/** Write the forest to one .vtu file that is shared by all processes.
+ * Instead of one .vtu file per process and a .pvtu file, all processes write their piece
+ * with raw appended data arrays into the single file \a fileprefix.vtu. The offsets of the
+ * pieces in the file are computed with prefix sums and the pieces are written with collective
+ * MPI I/O. This avoids creating many small files on large numbers of processes.
+ * This function is collective over the communicator of \a forest.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output file. The file will be named \a fileprefix.vtu .
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  write_ghosts If true, each process additionally writes its ghost elements.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ * \param [in]  share_points If true, coincident corners of the local elements are written as one
+ *                        point, see \ref t8_forest_vtk_write_file_ext.
+ * \param [in]  num_aggregators If positive, the number of processes that access the file in the
+ *                        collective writes, passed to MPI I/O as the hint cb_nodes.
+ *                        If 0, MPI I/O chooses the aggregators.
+ * \return  True if successful, false if not. The result is the same on all processes if
+ *          recording the pieces fails and process local if writing the file fails.
+ * \note Without MPI I/O, this function can only be used on a single process.
+ */
+int
+t8_forest_vtk_write_file_shared (t8_forest_t forest, const char *fileprefix, const int write_treeid,
+                                 const int write_mpirank, const int write_level, const int write_element_id,
+                                 int write_ghosts, const int num_data, t8_vtk_data_field_t *data,
+                                 const int share_points, const int num_aggregators);
+
+/** Start a time series of vtk output files.
+ * Each step of the series is written as with \ref t8_forest_vtk_write_file_ext to the files
+ * \a fileprefix_NNNN.pvtu and \a fileprefix_NNNN_RRRR.vtu, where NNNN is the number of the step.
+ * Process 0 additionally writes \a fileprefix.pvd, which lists all steps with their times
+ * and can be opened in ParaView as one time dependent data set.
+ * If a step is written with the same forest as the previous step, the point coordinates,
+ * the connectivity and the other arrays that depend only on the forest are not computed again
+ * but reused from the previous step, such that the cost of the step is dominated by the user data.
+ * The series keeps a reference to the forest of the last step for this purpose.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  write_ghosts If true, each process additionally writes its ghost elements.
+ * \param [in]  format    The encoding of the data arrays in the .vtu files. With \ref T8_VTK_ASCII,
+ *                        only the shared points are reused between steps.
+ * \param [in]  share_points If true, coincident corners of the local elements are written as one
+ *                        point, see \ref t8_forest_vtk_write_file_ext.
+ * \return  The new series.
+ */
+t8_forest_vtk_series_t
+t8_forest_vtk_series_new (const char *fileprefix, const int write_treeid, const int write_mpirank,
+                          const int write_level, const int write_element_id, const int write_ghosts,
+                          const t8_vtk_format_t format, const int share_points);
+
+/** Write the next step of a time series.
+ * This function is collective over the communicator of \a forest.
+ * \param [in,out] series  The series.
+ * \param [in]  forest    The forest of this step. The series takes a reference of the forest
+ *                        that it releases when a step with a different forest is written or
+ *                        when the series is destroyed.
+ * \param [in]  time      The simulation time of this step.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ * \return  True if successful, false if not (process local).
+ */
+int
+t8_forest_vtk_series_write (t8_forest_vtk_series_t series, t8_forest_t forest, const double time, const int num_data,
+                            t8_vtk_data_field_t *data);
+
+/** Free a time series. The files of the series are complete after each step.
+ * \param [in,out] pseries  The series. Set to NULL on output.
+ */
+void
+t8_forest_vtk_series_destroy (t8_forest_vtk_series_t *pseries);
+
+/** Create a writer for asynchronous vtk output of forests.
+ * The writer starts an i/o thread that encodes and writes the .vtu files while the
+ * calling thread continues. The i/o thread is only used if libsc was configured with
+ * pthread support, since only then its memory bookkeeping is thread safe. Otherwise
+ * the files are written when they are submitted.
+ * \param [in]  max_in_flight  The maximum number of snapshots that are taken but not yet
+ *                             written. A further call to \ref t8_forest_vtk_write_file_async
+ *                             blocks until a snapshot was written. Must be positive.
+ * \return                     The new writer.
+ */
+t8_forest_vtk_async_writer_t
+t8_forest_vtk_async_writer_new (const int max_in_flight);
+
+/** Destroy an asynchronous writer. All submitted files are written before the i/o thread stops.
+ * \param [in,out] pwriter     The writer. All of its requests must have been completed with
+ *                             \ref t8_forest_vtk_async_wait. Set to NULL on output.
+ */
+void
+t8_forest_vtk_async_writer_destroy (t8_forest_vtk_async_writer_t *pwriter);
+
+/** Write the forest in .pvtu file format in the background.
+ * As \ref t8_forest_vtk_write_file_ext, but only the point coordinates and data arrays are
+ * computed on the calling thread and stored in a snapshot. Encoding and writing the .vtu file
+ * of this process happens on the i/o thread of \a writer. The snapshot does not reference
+ * \a forest or \a data, thus both may be modified or freed as soon as this function returns.
+ * The .pvtu file is written by process 0 before this function returns.
+ * The writer functions must be called from one thread only.
+ * \param [in,out] writer      The asynchronous writer.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  write_ghosts If true, each process additionally writes its ghost elements.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ * \param [in]  format    The encoding of the data arrays. \ref T8_VTK_ASCII is not supported
+ *                        for asynchronous output and is written as \ref T8_VTK_BINARY.
+ * \param [in]  share_points If true, coincident corners of the local elements are written as one
+ *                        point, see \ref t8_forest_vtk_write_file_ext.
+ * \return  A handle to the request, which must be completed with \ref t8_forest_vtk_async_wait.
+ */
+t8_forest_vtk_async_request_t
+t8_forest_vtk_write_file_async (t8_forest_vtk_async_writer_t writer, t8_forest_t forest, const char *fileprefix,
+                                const int write_treeid, const int write_mpirank, const int write_level,
+                                const int write_element_id, int write_ghosts, const int num_data,
+                                t8_vtk_data_field_t *data, t8_vtk_format_t format, const int share_points);
+
+/** Query whether an asynchronous write has finished, without blocking.
+ * \param [in]  request   A request of \ref t8_forest_vtk_write_file_async.
+ * \return                True if the file of this process was written or writing failed.
+ */
+int
+t8_forest_vtk_async_test (t8_forest_vtk_async_request_t request);
+
+/** Wait until an asynchronous write has finished and free the request.
+ * \param [in,out] prequest  A request of \ref t8_forest_vtk_write_file_async. Set to NULL on output.
+ * \return                True if the .vtu file of this process was written successfully,
+ *                        false if not (process local).
+ */
+int
+t8_forest_vtk_async_wait (t8_forest_vtk_async_request_t *prequest);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_VTK_H */
@@ -30,6 +30,23 @@
 #include <t8_forest/t8_forest_general.h>
 #include <t8_netcdf.h>
 
+/** Options for the storage and the parallel access of the variables of a forest netCDF-4 file.
+ * Initialize them with \ref t8_forest_netcdf_options_init and change the fields that should differ from the defaults.
+ */
+typedef struct
+{
+  int storage_mode;      /**< NC_CONTIGUOUS (default) or NC_CHUNKED. */
+  size_t chunk_elements; /**< Chunk size along the element dimension for NC_CHUNKED, 0 for netCDF's default. */
+  size_t chunk_nodes;    /**< Chunk size along the node dimension for NC_CHUNKED, 0 for netCDF's default. */
+  int deflate_level;     /**< Level (1 to 9) of the deflate filter, 0 (default) disables the filter. */
+  int shuffle;           /**< If true, the shuffle filter is applied before the deflate filter. */
+  int mpi_access;        /**< NC_INDEPENDENT (default) or NC_COLLECTIVE. */
+  int cb_nodes;          /**< Number of MPI-IO aggregators for collective writes, 0 for the MPI default. */
+  int cb_buffer_size;    /**< Size in bytes of the collective buffer of each aggregator, 0 for the MPI default. */
+  int time_dependent;    /**< If true, the user-defined variables get an unlimited 'time' dimension. */
+  double time;           /**< The time of the first time step if \a time_dependent is true. */
+} t8_forest_netcdf_options_t;
+
 T8_EXTERN_C_BEGIN ();
 
 /** Creates a netCDF-4 file containing the (geometrical) information about the given forest mesh and additional elementwise data variables
@@ -63,6 +80,49 @@ t8_forest_write_netcdf_ext (t8_forest_t forest, const char *file_prefix, const c
                             int num_extern_netcdf_vars, t8_netcdf_variable_t *ext_variables[], sc_MPI_Comm comm,
                             int netcdf_var_storage_mode, int netcdf_var_mpi_access);
 
+/** Initialize the options for netCDF output with the defaults of \ref t8_forest_write_netcdf.
+ * \param [out] options  The options to initialize.
+ */
+void
+t8_forest_netcdf_options_init (t8_forest_netcdf_options_t *options);
+
+/** Creates a netCDF-4 file containing the (geometrical) information about the given forest mesh and additional elementwise data variables
+ * \param [in]  forest    A forest.
+ * \param [in]  file_prefix    A string which holds the file's name (output file will be 'file_prefix.nc').
+ * \param [in]  file_title    A string to caption the NetCDF-File.
+ * \param [in]  dim    The Dimension of the forest mesh (2D or 3D).
+ * \param [in]  num_extern_netcdf_vars    The number of extern user-defined variables which hold elementwise data (if none, set it to 0).
+ * \param [in]  ext_variables An array of pointers of the herein before mentioned user-defined variables (if none, set it to NULL).
+ * \param [in]  comm The sc_MPI_Communicator to use.
+ * \param [in]  options The storage and access options of the variables.
+ * \note Variables with filters are stored in chunks. In a parallel configuration, they and all variables with a time
+ *       dimension are written collectively, since netCDF does not support independent writes to them.
+ * \note If \a options->time_dependent is true, the user-defined variables are written as the first time step.
+ *       Further time steps can be appended with \ref t8_forest_write_netcdf_time_step.
+ */
+void
+t8_forest_write_netcdf_opt (t8_forest_t forest, const char *file_prefix, const char *file_title, int dim,
+                            int num_extern_netcdf_vars, t8_netcdf_variable_t *ext_variables[], sc_MPI_Comm comm,
+                            const t8_forest_netcdf_options_t *options);
+
+/** Append a time step of the user-defined variables to a time dependent netCDF-4 file of a forest.
+ * The mesh variables of the file are not written again.
+ * \param [in]  forest    The forest that was written with \ref t8_forest_write_netcdf_opt, or a forest with the
+ *                        same elements. Aborts if the number of elements or mesh nodes differs from the file.
+ * \param [in]  file_prefix    The file prefix that was passed to \ref t8_forest_write_netcdf_opt.
+ * \param [in]  dim    The Dimension of the forest mesh (2D or 3D).
+ * \param [in]  time    The time of the new time step.
+ * \param [in]  num_extern_netcdf_vars    The number of user-defined variables to write.
+ * \param [in]  ext_variables The user-defined variables. They must have been written to the file with the same names.
+ * \param [in]  comm The sc_MPI_Communicator to use.
+ * \param [in]  options The options that were used to create the file, only the MPI-IO hints are used.
+ *                      May be NULL to use the defaults.
+ */
+void
+t8_forest_write_netcdf_time_step (t8_forest_t forest, const char *file_prefix, int dim, double time,
+                                  int num_extern_netcdf_vars, t8_netcdf_variable_t *ext_variables[],
+                                  sc_MPI_Comm comm, const t8_forest_netcdf_options_t *options);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_NETCDF_H */
@@ -21,6 +21,7 @@
 */
 
 #include <t8_vtk.h>
+#include <sc_io.h>
 
 /* Writes the pvtu header file that links to the processor local files.
  * This function should only be called by one process.
@@ -269,3 +270,131 @@ t8_write_pvtu (const char *filename, int num_procs, int write_tree, int write_ra
   }
   return 0;
 }
+
+int
+t8_vtk_file_open (t8_vtk_file_t *file, const char *filename, t8_vtk_format_t format, t8_gloidx_t num_points,
+                  t8_gloidx_t num_cells)
+{
+  T8_ASSERT (file != NULL);
+  T8_ASSERT (filename != NULL);
+
+#ifndef SC_HAVE_ZLIB
+  if (format == T8_VTK_BINARY_COMPRESSED) {
+    t8_debugf ("libsc was built without zlib, writing uncompressed binary vtk data.\n");
+    format = T8_VTK_BINARY;
+  }
+#endif
+  file->format = format;
+  sc_array_init (&file->appended_data, sizeof (char));
+  file->vtufile = fopen (filename, "wb");
+  if (file->vtufile == NULL) {
+    t8_global_errorf ("Could not open file %s for output.\n", filename);
+    return -1;
+  }
+  fprintf (file->vtufile, "<?xml version=\"1.0\"?>\n");
+  fprintf (file->vtufile, "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
+  if (format == T8_VTK_BINARY_COMPRESSED) {
+    fprintf (file->vtufile, " compressor=\"vtkZLibDataCompressor\"");
+  }
+#ifdef SC_IS_BIGENDIAN
+  fprintf (file->vtufile, " byte_order=\"BigEndian\">\n");
+#else
+  fprintf (file->vtufile, " byte_order=\"LittleEndian\">\n");
+#endif
+  fprintf (file->vtufile, "  <UnstructuredGrid>\n");
+  fprintf (file->vtufile, "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n", (long long) num_points,
+           (long long) num_cells);
+  if (ferror (file->vtufile)) {
+    t8_global_errorf ("Error when writing file %s.\n", filename);
+    fclose (file->vtufile);
+    file->vtufile = NULL;
+    sc_array_reset (&file->appended_data);
+    return -1;
+  }
+  return 0;
+}
+
+size_t
+t8_vtk_type_size (const char *type)
+{
+  if (!strcmp (type, "Int8") || !strcmp (type, "UInt8")) {
+    return 1;
+  }
+  if (!strcmp (type, "Int16") || !strcmp (type, "UInt16")) {
+    return 2;
+  }
+  if (!strcmp (type, "Int32") || !strcmp (type, "UInt32") || !strcmp (type, "Float32")) {
+    return 4;
+  }
+  T8_ASSERT (!strcmp (type, "Int64") || !strcmp (type, "UInt64") || !strcmp (type, "Float64"));
+  return 8;
+}
+
+int
+t8_vtk_write_binary_data_array (t8_vtk_file_t *file, const char *type, const char *name,
+                                const char *component_string, const void *values, size_t num_bytes)
+{
+  uint32_t header;
+  int retval;
+
+  T8_ASSERT (file != NULL && file->vtufile != NULL);
+  T8_ASSERT (file->format != T8_VTK_ASCII);
+
+  if (file->format == T8_VTK_APPENDED) {
+    /* The data is written at the end of the file. Each array is preceded by its size in bytes. */
+    if (num_bytes > UINT32_MAX) {
+      t8_global_errorf ("vtk data array %s exceeds 4 GB.\n", name);
+      return -1;
+    }
+    fprintf (file->vtufile,
+             "        <DataArray type=\"%s\" Name=\"%s\" %s format=\"appended\" offset=\"%llu\"/>\n", type,
+             name, component_string, (unsigned long long) file->appended_data.elem_count);
+    header = (uint32_t) num_bytes;
+    memcpy (sc_array_push_count (&file->appended_data, sizeof (header)), &header, sizeof (header));
+    if (num_bytes > 0) {
+      memcpy (sc_array_push_count (&file->appended_data, num_bytes), values, num_bytes);
+    }
+    return ferror (file->vtufile) ? -1 : 0;
+  }
+
+  fprintf (file->vtufile, "        <DataArray type=\"%s\" Name=\"%s\" %s format=\"binary\">\n          ", type, name,
+           component_string);
+#ifdef SC_HAVE_ZLIB
+  if (file->format == T8_VTK_BINARY_COMPRESSED) {
+    retval = sc_vtk_write_compressed (file->vtufile, (char *) values, num_bytes);
+  }
+  else
+#endif
+  {
+    retval = sc_vtk_write_binary (file->vtufile, (char *) values, num_bytes);
+  }
+  fprintf (file->vtufile, "\n        </DataArray>\n");
+  return retval || ferror (file->vtufile) ? -1 : 0;
+}
+
+int
+t8_vtk_file_close (t8_vtk_file_t *file)
+{
+  int retval;
+
+  T8_ASSERT (file != NULL && file->vtufile != NULL);
+
+  fprintf (file->vtufile, "    </Piece>\n"
+                          "  </UnstructuredGrid>\n");
+  if (file->format == T8_VTK_APPENDED) {
+    /* The raw data starts after the underscore */
+    fprintf (file->vtufile, "  <AppendedData encoding=\"raw\">\n_");
+    if (file->appended_data.elem_count > 0) {
+      fwrite (file->appended_data.array, 1, file->appended_data.elem_count, file->vtufile);
+    }
+    fprintf (file->vtufile, "\n  </AppendedData>\n");
+  }
+  fprintf (file->vtufile, "</VTKFile>\n");
+  retval = ferror (file->vtufile) ? -1 : 0;
+  if (fclose (file->vtufile)) {
+    retval = -1;
+  }
+  file->vtufile = NULL;
+  sc_array_reset (&file->appended_data);
+  return retval;
+}
@@ -60,6 +60,23 @@ typedef enum {
   T8_VTK_VECTOR  /* 3 double values per element */
 } t8_vtk_data_type_t;
 
+/** The encoding of the data arrays in the .vtu files written without the VTK library. */
+typedef enum {
+  T8_VTK_ASCII,             /**< Human readable text. */
+  T8_VTK_BINARY,            /**< Base64 encoded binary data inside the DataArray elements. */
+  T8_VTK_BINARY_COMPRESSED, /**< As T8_VTK_BINARY, but compressed with zlib. Falls back to
+                                 T8_VTK_BINARY if libsc was built without zlib. */
+  T8_VTK_APPENDED           /**< Raw binary data in an AppendedData section at the end of the file. */
+} t8_vtk_format_t;
+
+/** An open .vtu file that is written without the VTK library. */
+typedef struct
+{
+  FILE *vtufile;            /**< The file stream. */
+  t8_vtk_format_t format;   /**< The encoding of the data arrays. */
+  sc_array_t appended_data; /**< The contents of the AppendedData section if \a format is T8_VTK_APPENDED. */
+} t8_vtk_file_t;
+
 typedef struct
 {
   t8_vtk_data_type_t type;  /**< Describes of which type the data array is */
@@ -81,6 +98,46 @@ int
 t8_write_pvtu (const char *filename, int num_procs, int write_tree, int write_rank, int write_level, int write_id,
                int num_data, t8_vtk_data_field_t *data);
 
+/** Open a .vtu file and write its header up to the opening Piece element.
+ * \param [out] file         The file to initialize.
+ * \param [in]  filename     The name of the file.
+ * \param [in]  format       The encoding of the data arrays.
+ * \param [in]  num_points   The number of points of the piece.
+ * \param [in]  num_cells    The number of cells of the piece.
+ * \return                   0 on success, -1 if the file could not be opened or written.
+ *                           On error, the file is closed.
+ */
+int
+t8_vtk_file_open (t8_vtk_file_t *file, const char *filename, t8_vtk_format_t format, t8_gloidx_t num_points,
+                  t8_gloidx_t num_cells);
+
+/** Return the number of bytes of one value of a VTK data type.
+ * \param [in]  type         A VTK data type name, such as "Int32" or \ref T8_VTK_FLOAT_NAME.
+ * \return                   The size of the type in bytes.
+ */
+size_t
+t8_vtk_type_size (const char *type);
+
+/** Write a complete binary DataArray element to a .vtu file.
+ * \param [in,out] file      A file opened with \ref t8_vtk_file_open with a binary format.
+ * \param [in]  type         The VTK data type name of the values.
+ * \param [in]  name         The name of the data array.
+ * \param [in]  component_string  Additional attributes, for example NumberOfComponents="3", or "".
+ * \param [in]  values       The values in the byte order of this machine.
+ * \param [in]  num_bytes    The number of bytes of \a values.
+ * \return                   0 on success, -1 on error.
+ */
+int
+t8_vtk_write_binary_data_array (t8_vtk_file_t *file, const char *type, const char *name,
+                                const char *component_string, const void *values, size_t num_bytes);
+
+/** Write the end of the Piece, the AppendedData section if needed and close the file.
+ * \param [in,out] file      A file opened with \ref t8_vtk_file_open.
+ * \return                   0 on success, -1 on error.
+ */
+int
+t8_vtk_file_close (t8_vtk_file_t *file);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_VTK_H */
@@ -0,0 +1,150 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this test we write a forest with a time dependent user variable to a chunked and
+ * compressed netCDF-4 file and append two more time steps.
+ * We read the file back and check the time steps and the data of the last step.
+ * The file is removed at the end.
+ * If t8code was not configured with --with-netcdf then this test does nothing.
+ */
+
+#include <gtest/gtest.h>
+#include <t8.h>
+#if T8_WITH_NETCDF
+#include <netcdf.h>
+#endif
+#if T8_WITH_NETCDF_PAR
+#include <netcdf_par.h>
+#endif
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <t8_forest_netcdf.h>
+#include <t8_netcdf.h>
+#include <cstdio>
+
+#define T8_TEST_NETCDF_FILE_PREFIX "test_netcdf_writer"
+
+TEST (t8_gtest_netcdf_writer, append_time_steps)
+{
+#if T8_WITH_NETCDF
+  t8_forest_t forest
+    = t8_forest_new_uniform (t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0), t8_scheme_new_default_cxx (), 2,
+                             0, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  const t8_gloidx_t first_element = t8_forest_get_first_local_element_id (forest);
+  const int num_steps = 3;
+  sc_array_t *values = sc_array_new_count (sizeof (double), num_elements);
+  t8_netcdf_variable_t *var = t8_netcdf_create_double_var ("value", "Element id plus time", "1", values);
+  t8_forest_netcdf_options_t options;
+  char file_name[BUFSIZ];
+  int mpirank, mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  t8_forest_netcdf_options_init (&options);
+  options.storage_mode = NC_CHUNKED;
+  options.chunk_elements = 16;
+  options.deflate_level = 1;
+  options.shuffle = 1;
+  options.time_dependent = 1;
+  for (int istep = 0; istep < num_steps; istep++) {
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+      *(double *) sc_array_index_int (values, ielem) = first_element + ielem + istep;
+    }
+    if (istep == 0) {
+      t8_forest_write_netcdf_opt (forest, T8_TEST_NETCDF_FILE_PREFIX, "Test forest", 3, 1, &var, sc_MPI_COMM_WORLD,
+                                  &options);
+    }
+    else {
+      t8_forest_write_netcdf_time_step (forest, T8_TEST_NETCDF_FILE_PREFIX, 3, istep, 1, &var, sc_MPI_COMM_WORLD,
+                                        &options);
+    }
+  }
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+
+  /* Without parallel netCDF, each process writes its own file */
+#if T8_WITH_NETCDF_PAR
+  snprintf (file_name, BUFSIZ, "%s.nc", T8_TEST_NETCDF_FILE_PREFIX);
+#else
+  if (mpisize > 1) {
+    snprintf (file_name, BUFSIZ, "%s_rank_%d.nc", T8_TEST_NETCDF_FILE_PREFIX, mpirank);
+  }
+  else {
+    snprintf (file_name, BUFSIZ, "%s.nc", T8_TEST_NETCDF_FILE_PREFIX);
+  }
+#endif
+
+  int ncid, dimid, varid;
+  size_t num_file_steps;
+  ASSERT_EQ (nc_open (file_name, NC_NOWRITE, &ncid), NC_NOERR);
+  ASSERT_EQ (nc_inq_dimid (ncid, "time", &dimid), NC_NOERR);
+  ASSERT_EQ (nc_inq_dimlen (ncid, dimid, &num_file_steps), NC_NOERR);
+  EXPECT_EQ (num_file_steps, (size_t) num_steps);
+
+  /* Check the time of each step */
+  double times[3];
+  size_t start = 0;
+  size_t count = num_steps;
+  ASSERT_EQ (nc_inq_varid (ncid, "time", &varid), NC_NOERR);
+  ASSERT_EQ (nc_get_vara_double (ncid, varid, &start, &count, times), NC_NOERR);
+  for (int istep = 0; istep < num_steps; istep++) {
+    EXPECT_EQ (times[istep], istep);
+  }
+
+  /* Check the local data of the last time step */
+  if (num_elements > 0) {
+    double *read_values = T8_ALLOC (double, num_elements);
+    const size_t start_data[2] = { (size_t) num_steps - 1, (size_t) first_element };
+    const size_t count_data[2] = { 1, (size_t) num_elements };
+    ASSERT_EQ (nc_inq_varid (ncid, "value", &varid), NC_NOERR);
+    ASSERT_EQ (nc_get_vara_double (ncid, varid, start_data, count_data, read_values), NC_NOERR);
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+      EXPECT_EQ (read_values[ielem], first_element + ielem + num_steps - 1);
+    }
+    T8_FREE (read_values);
+  }
+  EXPECT_EQ (nc_close (ncid), NC_NOERR);
+
+  /* Remove the file once all processes have read it */
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+#if T8_WITH_NETCDF_PAR
+  if (mpirank == 0) {
+    EXPECT_EQ (remove (file_name), 0);
+  }
+#else
+  EXPECT_EQ (remove (file_name), 0);
+#endif
+
+  t8_netcdf_variable_destroy (var);
+  sc_array_destroy (values);
+  t8_forest_unref (&forest);
+#else
+  t8_debugf ("This version of t8code is not compiled with netcdf support.\n");
+#endif
+}
@@ -0,0 +1,610 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh_vtk_writer.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_vtk.h>
+#include <t8_forest/t8_forest_global_nodes.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/* In this test we write a forest and a cmesh with each encoding of the native vtk writers
+ * and check that the .vtu files declare the expected format of their data arrays.
+ * Files written in the background must be the same as those written directly.
+ * A shared file written by all processes must contain one piece per process, and each of its
+ * data arrays must be preceded by its size at the offset given in the xml.
+ * In a time series, a step that reuses the geometry of the previous step must not differ from it.
+ * Filtered output must contain only the selected or coarsened cells, and trees outside of or inside
+ * the selection box must not test their leaves.
+ * Each test removes the files that it wrote. */
+
+static const char *t8_test_vtk_format_names[4] = { "ascii", "binary", "binary_compressed", "appended" };
+
+/* Return the contents of a file as a string */
+static std::string
+t8_test_vtk_read_file (const char *filename)
+{
+  std::ifstream file (filename, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf ();
+  return contents.str ();
+}
+
+/* Return the number of points or cells of the piece of a .vtu file */
+static long long
+t8_test_vtk_piece_size (const char *filename, const char *name)
+{
+  const std::string contents = t8_test_vtk_read_file (filename);
+  const std::string attribute = std::string (name) + "=\"";
+  const size_t position = contents.find (attribute);
+
+  if (position == std::string::npos) {
+    return -1;
+  }
+  return std::stoll (contents.substr (position + attribute.size ()));
+}
+
+/* Return the value of an attribute of the xml tag that starts at position, or an empty string */
+static std::string
+t8_test_vtk_attribute (const std::string &contents, const size_t position, const char *name)
+{
+  const size_t tag_end = contents.find ('>', position);
+  const std::string attribute = std::string (" ") + name + "=\"";
+  const size_t start = contents.find (attribute, position);
+
+  if (start == std::string::npos || start > tag_end) {
+    return "";
+  }
+  const size_t value = start + attribute.size ();
+  return contents.substr (value, contents.find ('"', value) - value);
+}
+
+/* Return the number of bytes of a value of a vtk data type */
+static size_t
+t8_test_vtk_type_size (const std::string &type)
+{
+  if (type == "Int8" || type == "UInt8") {
+    return 1;
+  }
+  if (type == "Int16" || type == "UInt16") {
+    return 2;
+  }
+  if (type == "Int32" || type == "UInt32" || type == "Float32") {
+    return 4;
+  }
+  return 8;
+}
+
+/* Return the position of the last of two tags before position in the range [begin, position),
+ * or std::string::npos if neither occurs there */
+static size_t
+t8_test_vtk_last_tag (const std::string &contents, const size_t begin, const size_t position, const char *tag_a,
+                      const char *tag_b)
+{
+  size_t last = std::string::npos;
+  for (const char *tag : { tag_a, tag_b }) {
+    const size_t found = contents.rfind (tag, position);
+    if (found != std::string::npos && found >= begin && (last == std::string::npos || found > last)) {
+      last = found;
+    }
+  }
+  return last;
+}
+
+/* Check the appended data of a shared .vtu file with a UInt64 header.
+ * The data arrays of all pieces follow each other in the AppendedData section in the order of
+ * their offsets, each preceded by its size in bytes. */
+static void
+t8_test_vtk_check_appended (const std::string &contents)
+{
+  const std::string appended_tag = "<AppendedData encoding=\"raw\">\n_";
+  const char *const footer = "\n  </AppendedData>\n</VTKFile>\n";
+  const size_t appended_position = contents.find (appended_tag);
+  uint64_t expected_offset = 0;
+
+  ASSERT_NE (contents.find ("header_type=\"UInt64\""), std::string::npos);
+  ASSERT_NE (appended_position, std::string::npos);
+  const size_t appended_start = appended_position + appended_tag.size ();
+  for (size_t piece = contents.find ("<Piece "); piece < appended_position;
+       piece = contents.find ("<Piece ", piece + 1)) {
+    const size_t piece_end = contents.find ("</Piece>", piece);
+    const uint64_t num_points = std::stoull (t8_test_vtk_attribute (contents, piece, "NumberOfPoints"));
+    const uint64_t num_cells = std::stoull (t8_test_vtk_attribute (contents, piece, "NumberOfCells"));
+    uint64_t connectivity_bytes = 0, connectivity_type_size = 0, num_vertices = 0;
+
+    for (size_t array = contents.find ("<DataArray ", piece); array < piece_end;
+         array = contents.find ("<DataArray ", array + 1)) {
+      const std::string name = t8_test_vtk_attribute (contents, array, "Name");
+      const std::string components = t8_test_vtk_attribute (contents, array, "NumberOfComponents");
+      const uint64_t num_components = components.empty () ? 1 : std::stoull (components);
+      const size_t type_size = t8_test_vtk_type_size (t8_test_vtk_attribute (contents, array, "type"));
+      const uint64_t array_offset = std::stoull (t8_test_vtk_attribute (contents, array, "offset"));
+      uint64_t num_bytes;
+
+      /* The array follows the previous array */
+      EXPECT_EQ (array_offset, expected_offset) << "Wrong offset of " << name;
+      ASSERT_LE (appended_start + array_offset + sizeof (num_bytes), contents.size ());
+      memcpy (&num_bytes, contents.data () + appended_start + array_offset, sizeof (num_bytes));
+      ASSERT_LE (appended_start + array_offset + sizeof (num_bytes) + num_bytes, contents.size ());
+      expected_offset = array_offset + sizeof (num_bytes) + num_bytes;
+
+      /* The number of values depends on the section of the array */
+      const size_t point_section = t8_test_vtk_last_tag (contents, piece, array, "<Points>", "<PointData");
+      const size_t cell_section = t8_test_vtk_last_tag (contents, piece, array, "<Cells>", "<CellData");
+      if (name == "connectivity") {
+        /* Its length is the last entry of the offsets, which follow */
+        connectivity_bytes = num_bytes;
+        connectivity_type_size = type_size;
+      }
+      else if (point_section != std::string::npos
+               && (cell_section == std::string::npos || point_section > cell_section)) {
+        EXPECT_EQ (num_bytes, num_points * num_components * type_size) << "Wrong size of " << name;
+      }
+      else {
+        EXPECT_EQ (num_bytes, num_cells * num_components * type_size) << "Wrong size of " << name;
+      }
+      if (name == "offsets" && num_cells > 0) {
+        /* The last offset is the number of vertices of all cells */
+        const char *last = contents.data () + appended_start + expected_offset - type_size;
+        if (type_size == sizeof (int32_t)) {
+          int32_t value;
+          memcpy (&value, last, sizeof (value));
+          num_vertices = value;
+        }
+        else {
+          int64_t value;
+          memcpy (&value, last, sizeof (value));
+          num_vertices = value;
+        }
+      }
+    }
+    EXPECT_EQ (connectivity_bytes, num_vertices * connectivity_type_size);
+  }
+  /* The footer follows the last array */
+  EXPECT_EQ (appended_start + expected_offset, contents.size () - strlen (footer));
+}
+
+/* Check the xml structure of a .vtu file written with a given format */
+static void
+t8_test_vtk_check_file (const char *filename, t8_vtk_format_t format)
+{
+  const std::string contents = t8_test_vtk_read_file (filename);
+
+  ASSERT_EQ (contents.rfind ("<?xml version=\"1.0\"?>", 0), 0u) << "Missing xml header in " << filename;
+  EXPECT_NE (contents.find ("</VTKFile>"), std::string::npos) << "Incomplete file " << filename;
+  EXPECT_NE (contents.find ("Name=\"Position\""), std::string::npos);
+  EXPECT_NE (contents.find ("Name=\"connectivity\""), std::string::npos);
+  switch (format) {
+  case T8_VTK_ASCII:
+    EXPECT_EQ (contents.find ("format=\"binary\""), std::string::npos);
+    EXPECT_EQ (contents.find ("format=\"appended\""), std::string::npos);
+    break;
+  case T8_VTK_BINARY:
+  case T8_VTK_BINARY_COMPRESSED:
+    EXPECT_EQ (contents.find ("format=\"ascii\""), std::string::npos);
+    EXPECT_NE (contents.find ("format=\"binary\""), std::string::npos);
+    break;
+  case T8_VTK_APPENDED:
+    EXPECT_EQ (contents.find ("format=\"ascii\""), std::string::npos);
+    EXPECT_NE (contents.find ("format=\"appended\" offset=\"0\""), std::string::npos);
+    EXPECT_NE (contents.find ("<AppendedData encoding=\"raw\">"), std::string::npos);
+    break;
+  }
+}
+
+/* The selection box and the number of tested leaves.
+ * The box is the first member, such that the struct can be passed to the bounding box functions. */
+typedef struct
+{
+  double box[6];
+  long long num_tested;
+} t8_test_vtk_select_t;
+
+/* Select the leaves in the box and count them */
+static int
+t8_test_vtk_select_count (t8_forest_t forest, const t8_locidx_t ltree_id, const t8_element_t *element,
+                          t8_eclass_scheme_c *ts, const int is_ghost, void *user_data)
+{
+  t8_test_vtk_select_t *select = (t8_test_vtk_select_t *) user_data;
+
+  select->num_tested++;
+  return t8_forest_vtk_select_bounding_box (forest, ltree_id, element, ts, is_ghost, select->box);
+}
+
+/* Return whether all leaves of a local tree are local */
+static int
+t8_test_vtk_tree_is_whole (t8_forest_t forest, const t8_locidx_t itree)
+{
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+
+  return !(itree == 0 && t8_forest_first_tree_shared (forest))
+         && !(itree == num_local_trees - 1 && t8_forest_last_tree_shared (forest));
+}
+
+/* Remove the .vtu piece of this process, if it wrote one, and on process 0 the .pvtu file
+ * of a vtk output once all processes are done with the files. */
+static void
+t8_test_vtk_remove_files (const char *fileprefix, const int mpirank, const int has_piece)
+{
+  char filename[BUFSIZ];
+  int mpiret;
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  if (has_piece) {
+    snprintf (filename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+    EXPECT_EQ (remove (filename), 0) << "Could not remove " << filename;
+  }
+  if (mpirank == 0) {
+    snprintf (filename, BUFSIZ, "%s.pvtu", fileprefix);
+    EXPECT_EQ (remove (filename), 0) << "Could not remove " << filename;
+  }
+}
+
+class vtk_writer: public testing::TestWithParam<t8_vtk_format_t> {
+ protected:
+  void
+  SetUp () override
+  {
+    format = GetParam ();
+    snprintf (fileprefix, BUFSIZ, "test_vtk_writer_%s", t8_test_vtk_format_names[format]);
+    mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+    SC_CHECK_MPI (mpiret);
+  }
+  t8_vtk_format_t format;
+  char fileprefix[BUFSIZ];
+  char vtufilename[BUFSIZ];
+  int mpirank, mpiret;
+};
+
+TEST_P (vtk_writer, write_forest)
+{
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 2, 1, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  double *element_data = T8_ALLOC (double, 3 * num_elements);
+  t8_vtk_data_field_t data[2];
+
+  for (t8_locidx_t ielem = 0; ielem < 3 * num_elements; ielem++) {
+    element_data[ielem] = ielem;
+  }
+  data[0].type = T8_VTK_SCALAR;
+  data[0].data = element_data;
+  snprintf (data[0].description, BUFSIZ, "scalar");
+  data[1].type = T8_VTK_VECTOR;
+  data[1].data = element_data;
+  snprintf (data[1].description, BUFSIZ, "vector");
+
+  EXPECT_TRUE (t8_forest_vtk_write_file_ext (forest, fileprefix, 1, 1, 1, 1, 1, 2, data, format, 0));
+  snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+  t8_test_vtk_check_file (vtufilename, format);
+  t8_test_vtk_remove_files (fileprefix, mpirank, 1);
+
+  T8_FREE (element_data);
+  t8_forest_unref (&forest);
+}
+
+TEST_P (vtk_writer, write_forest_shared_points)
+{
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 2, 0, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  t8_locidx_t *element_offsets, *element_nodes;
+  double *element_data = T8_ALLOC_ZERO (double, num_elements);
+  t8_vtk_data_field_t data;
+
+  data.type = T8_VTK_SCALAR;
+  data.data = element_data;
+  snprintf (data.description, BUFSIZ, "scalar");
+
+  EXPECT_TRUE (t8_forest_vtk_write_file_ext (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, format, 1));
+  snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+  t8_test_vtk_check_file (vtufilename, format);
+
+  /* Each vertex of the local elements is written exactly once */
+  const t8_locidx_t num_nodes = t8_forest_number_local_nodes (forest, &element_offsets, &element_nodes);
+  EXPECT_EQ (t8_test_vtk_piece_size (vtufilename, "NumberOfPoints"), num_nodes);
+  EXPECT_LE (num_nodes, element_offsets[num_elements]);
+  if (num_elements == t8_forest_get_global_num_elements (forest)) {
+    EXPECT_LT (num_nodes, element_offsets[num_elements]) << "No vertices were shared.";
+  }
+  t8_test_vtk_remove_files (fileprefix, mpirank, 1);
+
+  T8_FREE (element_offsets);
+  T8_FREE (element_nodes);
+  T8_FREE (element_data);
+  t8_forest_unref (&forest);
+}
+
+TEST_P (vtk_writer, write_forest_async)
+{
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 2, 0, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  /* Asynchronous output is never ascii */
+  const t8_vtk_format_t async_format = format == T8_VTK_ASCII ? T8_VTK_BINARY : format;
+  double *element_data = T8_ALLOC (double, 3 * num_elements);
+  t8_forest_vtk_async_request_t requests[2];
+  char async_fileprefix[BUFSIZ];
+  t8_vtk_data_field_t data;
+
+  for (t8_locidx_t ielem = 0; ielem < 3 * num_elements; ielem++) {
+    element_data[ielem] = ielem;
+  }
+  data.type = T8_VTK_VECTOR;
+  data.data = element_data;
+  snprintf (data.description, BUFSIZ, "vector");
+
+  EXPECT_TRUE (t8_forest_vtk_write_file_ext (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, async_format, 0));
+
+  /* With one snapshot in flight the second write waits for the first one */
+  t8_forest_vtk_async_writer_t writer = t8_forest_vtk_async_writer_new (1);
+  for (int iwrite = 0; iwrite < 2; iwrite++) {
+    snprintf (async_fileprefix, BUFSIZ, "%s_async%i", fileprefix, iwrite);
+    requests[iwrite] = t8_forest_vtk_write_file_async (writer, forest, async_fileprefix, 1, 1, 1, 1, 0, 1, &data,
+                                                       format, 0);
+  }
+  /* The snapshots do not reference the forest and the data */
+  T8_FREE (element_data);
+  t8_forest_unref (&forest);
+  for (int iwrite = 0; iwrite < 2; iwrite++) {
+    EXPECT_TRUE (t8_forest_vtk_async_wait (&requests[iwrite]));
+    EXPECT_EQ (requests[iwrite], nullptr);
+  }
+  t8_forest_vtk_async_writer_destroy (&writer);
+  EXPECT_EQ (writer, nullptr);
+
+  /* The asynchronous files are the same as the synchronous one */
+  snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+  const std::string contents = t8_test_vtk_read_file (vtufilename);
+  for (int iwrite = 0; iwrite < 2; iwrite++) {
+    char async_vtufilename[BUFSIZ];
+    snprintf (async_vtufilename, BUFSIZ, "%s_async%i_%04d.vtu", fileprefix, iwrite, mpirank);
+    t8_test_vtk_check_file (async_vtufilename, async_format);
+    EXPECT_EQ (t8_test_vtk_read_file (async_vtufilename), contents);
+  }
+  t8_test_vtk_remove_files (fileprefix, mpirank, 1);
+  for (int iwrite = 0; iwrite < 2; iwrite++) {
+    snprintf (async_fileprefix, BUFSIZ, "%s_async%i", fileprefix, iwrite);
+    t8_test_vtk_remove_files (async_fileprefix, mpirank, 1);
+  }
+}
+
+TEST_P (vtk_writer, write_forest_shared_file)
+{
+  int mpisize;
+
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+#ifndef T8_ENABLE_MPIIO
+  if (mpisize > 1) {
+    GTEST_SKIP () << "A shared vtk file on more than one process requires MPI I/O.";
+  }
+#endif
+  /* The shared file is always written in appended format */
+  if (format != T8_VTK_APPENDED) {
+    GTEST_SKIP ();
+  }
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 2, 0, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  double *element_data = T8_ALLOC_ZERO (double, num_elements);
+  t8_vtk_data_field_t data;
+
+  data.type = T8_VTK_SCALAR;
+  data.data = element_data;
+  snprintf (data.description, BUFSIZ, "scalar");
+
+  EXPECT_TRUE (t8_forest_vtk_write_file_shared (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, 0, 0));
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+
+  /* The file has one piece for each process */
+  snprintf (vtufilename, BUFSIZ, "%s.vtu", fileprefix);
+  t8_test_vtk_check_file (vtufilename, format);
+  const std::string contents = t8_test_vtk_read_file (vtufilename);
+  int num_pieces = 0;
+  for (size_t position = contents.find ("<Piece "); position != std::string::npos;
+       position = contents.find ("<Piece ", position + 1)) {
+    num_pieces++;
+  }
+  EXPECT_EQ (num_pieces, mpisize);
+  EXPECT_EQ (contents.size () - contents.rfind ("</VTKFile>\n"), strlen ("</VTKFile>\n"));
+  t8_test_vtk_check_appended (contents);
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    EXPECT_EQ (remove (vtufilename), 0);
+  }
+
+  T8_FREE (element_data);
+  t8_forest_unref (&forest);
+}
+
+TEST_P (vtk_writer, write_series)
+{
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 1, 0, sc_MPI_COMM_WORLD);
+  double *element_data = T8_ALLOC_ZERO (double, 3 * t8_forest_get_local_num_elements (forest));
+  t8_vtk_data_field_t data;
+
+  data.type = T8_VTK_VECTOR;
+  data.data = element_data;
+  snprintf (data.description, BUFSIZ, "vector");
+
+  /* Write the same forest twice, then a refined forest */
+  t8_forest_vtk_series_t series = t8_forest_vtk_series_new (fileprefix, 1, 1, 1, 1, 0, format, 1);
+  EXPECT_TRUE (t8_forest_vtk_series_write (series, forest, 0.0, 1, &data));
+  EXPECT_TRUE (t8_forest_vtk_series_write (series, forest, 0.5, 1, &data));
+  T8_FREE (element_data);
+  t8_cmesh_ref (t8_forest_get_cmesh (forest));
+  t8_forest_t forest_fine = t8_forest_new_uniform (t8_forest_get_cmesh (forest), t8_scheme_new_default_cxx (), 2, 0,
+                                                   sc_MPI_COMM_WORLD);
+  element_data = T8_ALLOC_ZERO (double, 3 * t8_forest_get_local_num_elements (forest_fine));
+  data.data = element_data;
+  EXPECT_TRUE (t8_forest_vtk_series_write (series, forest_fine, 1.0, 1, &data));
+  t8_forest_vtk_series_destroy (&series);
+  EXPECT_EQ (series, nullptr);
+
+  /* The step with the reused geometry is the same as the step before */
+  char step_vtufilename[BUFSIZ];
+  snprintf (vtufilename, BUFSIZ, "%s_0000_%04d.vtu", fileprefix, mpirank);
+  snprintf (step_vtufilename, BUFSIZ, "%s_0001_%04d.vtu", fileprefix, mpirank);
+  t8_test_vtk_check_file (step_vtufilename, format);
+  EXPECT_EQ (t8_test_vtk_read_file (step_vtufilename), t8_test_vtk_read_file (vtufilename));
+  snprintf (step_vtufilename, BUFSIZ, "%s_0002_%04d.vtu", fileprefix, mpirank);
+  t8_test_vtk_check_file (step_vtufilename, format);
+  EXPECT_NE (t8_test_vtk_read_file (step_vtufilename), t8_test_vtk_read_file (vtufilename));
+
+  /* The collection file lists all steps */
+  if (mpirank == 0) {
+    char pvdfilename[BUFSIZ];
+    snprintf (pvdfilename, BUFSIZ, "%s.pvd", fileprefix);
+    const std::string contents = t8_test_vtk_read_file (pvdfilename);
+    for (int istep = 0; istep < 3; istep++) {
+      char step_pvtufilename[BUFSIZ];
+      snprintf (step_pvtufilename, BUFSIZ, "file=\"%s_%04d.pvtu\"", fileprefix, istep);
+      EXPECT_NE (contents.find (step_pvtufilename), std::string::npos);
+    }
+    EXPECT_NE (contents.find ("timestep=\"0.5\""), std::string::npos);
+  }
+  for (int istep = 0; istep < 3; istep++) {
+    char stepprefix[BUFSIZ];
+    snprintf (stepprefix, BUFSIZ, "%s_%04d", fileprefix, istep);
+    t8_test_vtk_remove_files (stepprefix, mpirank, 1);
+  }
+  if (mpirank == 0) {
+    char pvdfilename[BUFSIZ];
+    snprintf (pvdfilename, BUFSIZ, "%s.pvd", fileprefix);
+    EXPECT_EQ (remove (pvdfilename), 0);
+  }
+
+  T8_FREE (element_data);
+  t8_forest_unref (&forest);
+  t8_forest_unref (&forest_fine);
+}
+
+TEST_P (vtk_writer, write_forest_filtered)
+{
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 2, 0, sc_MPI_COMM_WORLD);
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  double *element_data = T8_ALLOC (double, num_elements);
+  t8_test_vtk_select_t select = { { 0, 0, 0, 0.5, 1, 1 }, 0 };
+  const t8_test_vtk_select_t outside = { { 2, 2, 2, 3, 3, 3 }, 0 };
+  const t8_test_vtk_select_t inside = { { -1, -1, -1, 2, 2, 2 }, 0 };
+  t8_forest_vtk_filter_t filter;
+  t8_vtk_data_field_t data;
+
+  for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+    element_data[ielem] = 1;
+  }
+  data.type = T8_VTK_SCALAR;
+  data.data = element_data;
+  snprintf (data.description, BUFSIZ, "scalar");
+  snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+
+  /* Only the elements in the box are written */
+  t8_forest_vtk_filter_init (&filter);
+  filter.select = t8_test_vtk_select_count;
+  filter.select_tree = t8_forest_vtk_select_tree_bounding_box;
+  filter.select_data = &select;
+  EXPECT_TRUE (t8_forest_vtk_write_file_filtered (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, format, &filter));
+  t8_test_vtk_check_file (vtufilename, format);
+  EXPECT_LE (select.num_tested, (long long) num_elements);
+  long long num_selected = 0;
+  long long num_coarse_cells = 0;
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    const t8_locidx_t num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    t8_locidx_t num_tree_selected = 0;
+    for (t8_locidx_t ielem = 0; ielem < num_tree_elements; ielem++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_tree_selected += t8_forest_vtk_select_bounding_box (forest, itree, element, ts, 0, select.box);
+    }
+    num_selected += num_tree_selected;
+    /* On level 0, a tree is written as one cell if all its leaves are local and selected */
+    const int is_merged = num_tree_selected == num_tree_elements && t8_test_vtk_tree_is_whole (forest, itree);
+    num_coarse_cells += is_merged ? 1 : num_tree_selected;
+  }
+  EXPECT_EQ (t8_test_vtk_piece_size (vtufilename, "NumberOfCells"), num_selected);
+
+  /* Trees outside of the box are skipped without testing their leaves */
+  t8_test_vtk_select_t select_tree = outside;
+  filter.select_data = &select_tree;
+  EXPECT_TRUE (t8_forest_vtk_write_file_filtered (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, format, &filter));
+  EXPECT_EQ (t8_test_vtk_piece_size (vtufilename, "NumberOfCells"), 0);
+  EXPECT_EQ (select_tree.num_tested, 0);
+
+  /* Trees inside of the box are written without testing their leaves */
+  select_tree = inside;
+  EXPECT_TRUE (t8_forest_vtk_write_file_filtered (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, format, &filter));
+  EXPECT_EQ (t8_test_vtk_piece_size (vtufilename, "NumberOfCells"), num_elements);
+  EXPECT_EQ (select_tree.num_tested, 0);
+
+  /* Only completely selected families are coarsened, the other selected leaves are written as they are */
+  filter.select_data = &select;
+  filter.max_level = 0;
+  EXPECT_TRUE (t8_forest_vtk_write_file_filtered (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, format, &filter));
+  t8_test_vtk_check_file (vtufilename, format);
+  EXPECT_EQ (t8_test_vtk_piece_size (vtufilename, "NumberOfCells"), num_coarse_cells);
+
+  /* On level 0, all leaves of a tree are written as the tree, unless the tree is shared with another process */
+  t8_forest_vtk_filter_init (&filter);
+  filter.max_level = 0;
+  EXPECT_TRUE (t8_forest_vtk_write_file_filtered (forest, fileprefix, 1, 1, 1, 1, 0, 1, &data, format, &filter));
+  t8_test_vtk_check_file (vtufilename, format);
+  long long num_tree_cells = 0;
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    num_tree_cells += t8_test_vtk_tree_is_whole (forest, itree) ? 1 : t8_forest_get_tree_num_elements (forest, itree);
+  }
+  EXPECT_EQ (t8_test_vtk_piece_size (vtufilename, "NumberOfCells"), num_tree_cells);
+  t8_test_vtk_remove_files (fileprefix, mpirank, 1);
+
+  T8_FREE (element_data);
+  t8_forest_unref (&forest);
+}
+
+TEST_P (vtk_writer, write_cmesh)
+{
+  t8_cmesh_t cmesh = t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 0, 0);
+
+  EXPECT_EQ (t8_cmesh_vtk_write_file_format (cmesh, fileprefix, 1, format), 0);
+  /* A replicated cmesh is written by rank 0 only */
+  if (mpirank == 0) {
+    snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+    t8_test_vtk_check_file (vtufilename, format);
+  }
+  t8_test_vtk_remove_files (fileprefix, mpirank, mpirank == 0);
+  t8_cmesh_destroy (&cmesh);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_vtk_writer, vtk_writer,
+                          testing::Values (T8_VTK_ASCII, T8_VTK_BINARY, T8_VTK_BINARY_COMPRESSED, T8_VTK_APPENDED));
@@ -0,0 +1,125 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_cmesh/t8_cmesh_locate.h>
+#include <test/t8_gtest_macros.hxx>
+
+/* Test the tree bounding boxes and candidate tree lookup on a
+ * unit cube that is divided into 3 sub-cubes in each direction. */
+class cmesh_locate: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    /* t8_cmesh_new_hypercube_pad does not support pyramids */
+    skip = eclass == T8_ECLASS_VERTEX || eclass == T8_ECLASS_PYRAMID;
+    if (skip) {
+      GTEST_SKIP ();
+    }
+    const double boundary[24] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1 };
+    cmesh = t8_cmesh_new_hypercube_pad (eclass, sc_MPI_COMM_WORLD, boundary, 3, 3, 3, 0);
+  }
+  void
+  TearDown () override
+  {
+    if (!skip) {
+      t8_cmesh_destroy (&cmesh);
+    }
+  }
+
+  t8_cmesh_t cmesh;
+  t8_eclass eclass;
+  int skip;
+};
+
+TEST_P (cmesh_locate, tree_bounding_box_contains_vertices)
+{
+  const t8_locidx_t num_trees = t8_cmesh_get_num_local_trees (cmesh);
+  for (t8_locidx_t itree = 0; itree < num_trees; ++itree) {
+    double lower[3], upper[3];
+    t8_cmesh_get_tree_bounding_box (cmesh, itree, lower, upper);
+    const double *vertices = t8_cmesh_get_tree_vertices (cmesh, itree);
+    const int num_vertices = t8_eclass_num_vertices[t8_cmesh_get_tree_class (cmesh, itree)];
+    for (int ivertex = 0; ivertex < num_vertices; ++ivertex) {
+      for (int idim = 0; idim < 3; ++idim) {
+        EXPECT_LE (lower[idim], vertices[3 * ivertex + idim]) << "Vertex outside of bounding box of tree " << itree;
+        EXPECT_GE (upper[idim], vertices[3 * ivertex + idim]) << "Vertex outside of bounding box of tree " << itree;
+      }
+    }
+    /* The trees of this cmesh have a diameter of at most 1/3 */
+    for (int idim = 0; idim < 3; ++idim) {
+      EXPECT_LE (upper[idim] - lower[idim], 1. / 3 + 1e-8) << "Bounding box of tree " << itree << " too large.";
+    }
+  }
+}
+
+TEST_P (cmesh_locate, candidates_contain_tree_of_point)
+{
+  const t8_locidx_t num_trees = t8_cmesh_get_num_local_trees (cmesh);
+  sc_array_t candidates;
+  sc_array_init (&candidates, sizeof (t8_locidx_t));
+
+  for (t8_locidx_t itree = 0; itree < num_trees; ++itree) {
+    /* The centroid of the tree's vertices lies inside the tree */
+    const double *vertices = t8_cmesh_get_tree_vertices (cmesh, itree);
+    const int num_vertices = t8_eclass_num_vertices[t8_cmesh_get_tree_class (cmesh, itree)];
+    double centroid[3] = { 0, 0, 0 };
+    for (int ivertex = 0; ivertex < num_vertices; ++ivertex) {
+      for (int idim = 0; idim < 3; ++idim) {
+        centroid[idim] += vertices[3 * ivertex + idim] / num_vertices;
+      }
+    }
+    sc_array_truncate (&candidates);
+    t8_cmesh_locate_candidate_trees (cmesh, centroid, 0, &candidates);
+
+    int found = 0;
+    for (size_t icandidate = 0; icandidate < candidates.elem_count; ++icandidate) {
+      const t8_locidx_t candidate = *(t8_locidx_t *) sc_array_index (&candidates, icandidate);
+      found = found || candidate == itree;
+      if (icandidate > 0) {
+        EXPECT_LT (*(t8_locidx_t *) sc_array_index (&candidates, icandidate - 1), candidate)
+          << "Candidate trees are not sorted and unique.";
+      }
+    }
+    EXPECT_TRUE (found) << "Tree " << itree << " is not a candidate for its centroid.";
+    /* Only trees of the sub-cube of the centroid or of its neighbors can be candidates */
+    EXPECT_LT (candidates.elem_count, (size_t) num_trees) << "All trees are candidates.";
+  }
+
+  /* A point outside of the cube has no candidates */
+  const double outside[3] = { 5, 5, 5 };
+  sc_array_truncate (&candidates);
+  t8_cmesh_locate_candidate_trees (cmesh, outside, 0.1, &candidates);
+  EXPECT_EQ (candidates.elem_count, (size_t) 0) << "Found candidate trees for a point outside of the mesh.";
+
+  /* With a large tolerance all trees are candidates */
+  t8_cmesh_locate_candidate_trees (cmesh, outside, 10, &candidates);
+  EXPECT_EQ (candidates.elem_count, (size_t) num_trees) << "Not all trees are candidates for a large tolerance.";
+
+  sc_array_reset (&candidates);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_cmesh_locate, cmesh_locate, AllEclasses, print_eclass);
@@ -0,0 +1,477 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_face_connectivity.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+#include <algorithm>
+#include <vector>
+
+/* In this test we build the face connectivity table of uniform and adapted balanced
+ * forests and check it against a brute-force reference: two leaves are face neighbors
+ * if the corners of one leaf's face lie in the face of the other leaf. */
+
+class forest_face_connectivity: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    default_scheme = t8_scheme_new_default_cxx ();
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  }
+  void
+  TearDown () override
+  {
+    t8_cmesh_destroy (&cmesh);
+    t8_scheme_cxx_unref (&default_scheme);
+  }
+  t8_eclass_t eclass;
+  t8_cmesh_t cmesh;
+  t8_scheme_cxx_t *default_scheme;
+};
+
+/* Refine every third element */
+static int
+t8_test_face_connectivity_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                                 t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                                 const int num_elements, t8_element_t *elements[])
+{
+  return lelement_id % 3 == 0;
+}
+
+/* Refine every third element recursively up to level 4, without balancing */
+static int
+t8_test_face_connectivity_adapt_unbalanced (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                                            t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                                            const int num_elements, t8_element_t *elements[])
+{
+  return lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) < 4;
+}
+
+/* A face of a local or ghost leaf with the physical coordinates of its corners */
+typedef struct
+{
+  t8_locidx_t element_index; /* Local index of the leaf, or num_local_elements + ghost index */
+  int face;                  /* The face number of the leaf */
+  int level;                 /* The level of the leaf */
+  int num_corners;           /* The number of corners of the face */
+  double coords[4][3];       /* The coordinates of the corners */
+} t8_test_leaf_face_t;
+
+static double
+t8_test_triangle_area (const double *a, const double *b, const double *c)
+{
+  const double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+  const double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+  const double cross[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+  return 0.5 * sqrt (cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+}
+
+static double
+t8_test_distance (const double *a, const double *b)
+{
+  return sqrt ((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+/* Return true if the point lies in the (convex) face. Since the corners of a face may be in any order,
+ * we test the point against each triangle of three corners, whose union is the face. */
+static int
+t8_test_face_contains_point (const t8_test_leaf_face_t *face, const double *point)
+{
+  const double tol = 1e-10;
+
+  switch (face->num_corners) {
+  case 1:
+    return t8_test_distance (face->coords[0], point) < tol;
+  case 2: {
+    const double length = t8_test_distance (face->coords[0], face->coords[1]);
+    return t8_test_distance (face->coords[0], point) + t8_test_distance (point, face->coords[1]) - length
+           < tol * length;
+  }
+  default:
+    for (int iskip = 0; iskip < (face->num_corners == 4 ? 4 : 1); iskip++) {
+      const double *corner[3];
+      for (int icorner = 0, itri = 0; icorner < face->num_corners; icorner++) {
+        if (face->num_corners == 3 || icorner != iskip) {
+          corner[itri++] = face->coords[icorner];
+        }
+      }
+      const double area = t8_test_triangle_area (corner[0], corner[1], corner[2]);
+      const double sum = t8_test_triangle_area (point, corner[0], corner[1])
+                         + t8_test_triangle_area (point, corner[1], corner[2])
+                         + t8_test_triangle_area (point, corner[2], corner[0]);
+      if (sum - area < tol * area) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+}
+
+/* Return true if all corners of inner lie in outer */
+static int
+t8_test_face_contains_face (const t8_test_leaf_face_t *outer, const t8_test_leaf_face_t *inner)
+{
+  for (int icorner = 0; icorner < inner->num_corners; icorner++) {
+    if (!t8_test_face_contains_point (outer, inner->coords[icorner])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Append the faces of all leaves of a local or ghost tree to faces */
+static void
+t8_test_collect_leaf_faces (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_array_t *leaves,
+                            t8_locidx_t first_index, std::vector<t8_test_leaf_face_t> &faces)
+{
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, ltreeid));
+  const size_t num_leaves = t8_element_array_get_count (leaves);
+
+  for (size_t ileaf = 0; ileaf < num_leaves; ileaf++) {
+    const t8_element_t *leaf = t8_element_array_index_locidx ((t8_element_array_t *) leaves, ileaf);
+    for (int iface = 0; iface < ts->t8_element_num_faces (leaf); iface++) {
+      t8_test_leaf_face_t face;
+      face.element_index = first_index + ileaf;
+      face.face = iface;
+      face.level = ts->t8_element_level (leaf);
+      face.num_corners = t8_eclass_num_vertices[ts->t8_element_face_shape (leaf, iface)];
+      for (int icorner = 0; icorner < face.num_corners; icorner++) {
+        t8_forest_element_coordinate (forest, ltreeid, leaf, ts->t8_element_get_face_corner (leaf, iface, icorner),
+                                      face.coords[icorner]);
+      }
+      faces.push_back (face);
+    }
+  }
+}
+
+static void
+t8_test_face_connectivity_compare (t8_forest_t forest)
+{
+  t8_forest_build_face_connectivity (forest, 1);
+  ASSERT_TRUE (t8_forest_has_face_connectivity (forest));
+
+  /* Collect the faces of all local and ghost leaves */
+  std::vector<t8_test_leaf_face_t> local_faces, all_faces;
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest);
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    t8_test_collect_leaf_faces (forest, itree, t8_forest_tree_get_leaves (forest, itree),
+                                t8_forest_get_tree_element_offset (forest, itree), local_faces);
+  }
+  all_faces = local_faces;
+  for (t8_locidx_t ighost_tree = 0; ighost_tree < t8_forest_ghost_num_trees (forest); ighost_tree++) {
+    t8_test_collect_leaf_faces (forest, num_local_trees + ighost_tree,
+                                t8_forest_ghost_get_tree_elements (forest, ighost_tree),
+                                num_local_elements + t8_forest_ghost_get_tree_element_offset (forest, ighost_tree),
+                                all_faces);
+  }
+
+  for (const t8_test_leaf_face_t &face : local_faces) {
+    /* Find the neighbors by brute force. A leaf with a face that contains or is contained in our face
+     * is a neighbor, leaves on the same side only share parts of the face's boundary. */
+    std::vector<std::pair<t8_locidx_t, int>> reference;
+    int neigh_level = face.level;
+    for (const t8_test_leaf_face_t &other : all_faces) {
+      if (other.element_index != face.element_index
+          && (t8_test_face_contains_face (&face, &other) || t8_test_face_contains_face (&other, &face))) {
+        reference.push_back (std::make_pair (other.element_index, other.face));
+        neigh_level = other.level;
+      }
+    }
+
+    int num_neighbors, hanging;
+    const t8_locidx_t *neighbor_ids;
+    const int *dual_faces;
+    t8_forest_face_connectivity_get (forest, face.element_index, face.face, &num_neighbors, &neighbor_ids, &dual_faces,
+                                     NULL, &hanging);
+    std::vector<std::pair<t8_locidx_t, int>> table;
+    for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      table.push_back (std::make_pair (neighbor_ids[ineigh], dual_faces[ineigh]));
+    }
+    std::sort (reference.begin (), reference.end ());
+    std::sort (table.begin (), table.end ());
+    EXPECT_EQ (table, reference) << "element " << face.element_index << " face " << face.face;
+
+    const int expected_hanging = neigh_level < face.level   ? T8_FACE_CONNECTIVITY_COARSER
+                                 : neigh_level > face.level ? T8_FACE_CONNECTIVITY_FINER
+                                                            : T8_FACE_CONNECTIVITY_CONFORMING;
+    EXPECT_EQ (hanging, expected_hanging) << "element " << face.element_index << " face " << face.face;
+  }
+}
+
+/* Check that the unbalanced leaf face neighbor search finds the same neighbors
+ * as the search for balanced forests. The forest must be balanced. */
+static void
+t8_test_leaf_face_neighbors_compare_balanced (t8_forest_t forest)
+{
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree); ielem++) {
+      const t8_element_t *leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      for (int iface = 0; iface < ts->t8_element_num_faces (leaf); iface++) {
+        t8_element_t **neighbors[2];
+        t8_locidx_t *element_indices[2];
+        t8_eclass_scheme_c *neigh_scheme[2];
+        int *dual_faces[2];
+        int num_neighbors[2];
+
+        for (int ibalanced = 0; ibalanced < 2; ibalanced++) {
+          t8_forest_leaf_face_neighbors (forest, itree, leaf, &neighbors[ibalanced], iface, &dual_faces[ibalanced],
+                                         &num_neighbors[ibalanced], &element_indices[ibalanced],
+                                         &neigh_scheme[ibalanced], ibalanced);
+        }
+        ASSERT_EQ (num_neighbors[0], num_neighbors[1]) << "tree " << itree << " element " << ielem << " face " << iface;
+        for (int ineigh = 0; ineigh < num_neighbors[0]; ineigh++) {
+          EXPECT_EQ (element_indices[0][ineigh], element_indices[1][ineigh]);
+          EXPECT_EQ (dual_faces[0][ineigh], dual_faces[1][ineigh]);
+          EXPECT_TRUE (neigh_scheme[0]->t8_element_equal (neighbors[0][ineigh], neighbors[1][ineigh]));
+        }
+        for (int ibalanced = 0; ibalanced < 2 && num_neighbors[0] > 0; ibalanced++) {
+          neigh_scheme[ibalanced]->t8_element_destroy (num_neighbors[ibalanced], neighbors[ibalanced]);
+          T8_FREE (neighbors[ibalanced]);
+          T8_FREE (element_indices[ibalanced]);
+          T8_FREE (dual_faces[ibalanced]);
+        }
+      }
+    }
+  }
+}
+
+TEST_P (forest_face_connectivity, test_uniform_and_adapted)
+{
+  const int level = 2;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (default_scheme);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, level, 1, sc_MPI_COMM_WORLD);
+  t8_test_face_connectivity_compare (forest);
+  t8_test_leaf_face_neighbors_compare_balanced (forest);
+
+  /* Adapt, balance and partition the forest and build the table for the new forest */
+  t8_forest_t forest_adapt;
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest, t8_test_face_connectivity_adapt, 0);
+  t8_forest_set_balance (forest_adapt, NULL, 0);
+  t8_forest_set_partition (forest_adapt, NULL, 0);
+  t8_forest_set_ghost (forest_adapt, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_adapt);
+  t8_test_face_connectivity_compare (forest_adapt);
+  t8_test_leaf_face_neighbors_compare_balanced (forest_adapt);
+  t8_forest_unref (&forest_adapt);
+}
+
+/* Build an unbalanced forest and check that the face neighbor relation is symmetric
+ * for all local leaves. */
+TEST_P (forest_face_connectivity, test_unbalanced_symmetric)
+{
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (default_scheme);
+  t8_forest_t forest_uniform = t8_forest_new_uniform (cmesh, default_scheme, 1, 0, sc_MPI_COMM_WORLD);
+  t8_forest_t forest;
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_uniform, t8_test_face_connectivity_adapt_unbalanced, 1);
+  t8_forest_set_partition (forest, NULL, 0);
+  t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest);
+
+  t8_forest_build_face_connectivity (forest, 0);
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest);
+  t8_locidx_t element_index = 0;
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree); ielem++, element_index++) {
+      const t8_element_t *leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      for (int iface = 0; iface < ts->t8_element_num_faces (leaf); iface++) {
+        int num_neighbors, hanging;
+        const t8_locidx_t *neighbor_ids;
+        const int *dual_faces;
+
+        t8_forest_face_connectivity_get (forest, element_index, iface, &num_neighbors, &neighbor_ids, &dual_faces,
+                                         NULL, &hanging);
+        for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+          if (neighbor_ids[ineigh] >= num_local_elements) {
+            /* We can only check local neighbors */
+            continue;
+          }
+          int back_num_neighbors, back_hanging;
+          const t8_locidx_t *back_ids;
+          const int *back_dual_faces;
+          t8_forest_face_connectivity_get (forest, neighbor_ids[ineigh], dual_faces[ineigh], &back_num_neighbors,
+                                           &back_ids, &back_dual_faces, NULL, &back_hanging);
+          int found = 0;
+          for (int iback = 0; iback < back_num_neighbors; iback++) {
+            if (back_ids[iback] == element_index) {
+              EXPECT_EQ (back_dual_faces[iback], iface);
+              found = 1;
+            }
+          }
+          EXPECT_TRUE (found) << "Leaf " << element_index << " is not a neighbor of its neighbor "
+                              << neighbor_ids[ineigh];
+          if (hanging == T8_FACE_CONNECTIVITY_FINER) {
+            EXPECT_EQ (back_hanging, T8_FACE_CONNECTIVITY_COARSER);
+          }
+        }
+      }
+    }
+  }
+  t8_forest_unref (&forest);
+}
+
+/* Refine the first child of the root recursively up to level 3 */
+static int
+t8_test_face_connectivity_adapt_first_child (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                                             t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                                             const int num_elements, t8_element_t *elements[])
+{
+  const int level = ts->t8_element_level (elements[0]);
+  return level < 3 && ts->t8_element_get_linear_id (elements[0], 1) == 0;
+}
+
+/* Refine the first child of a level 1 quad or hex to level 3, such that its face neighbor
+ * in x-direction (the second child) has a level jump of 2 across its face 0.
+ * This face has 2^(2 * (dim - 1)) neighbors of level 3, each of which has the second child
+ * as only neighbor across its face 1. */
+TEST (forest_face_connectivity_unbalanced, test_level_jump)
+{
+  const t8_eclass_t eclasses[2] = { T8_ECLASS_QUAD, T8_ECLASS_HEX };
+
+  for (int ieclass = 0; ieclass < 2; ieclass++) {
+    const t8_eclass_t eclass = eclasses[ieclass];
+    const int expected_num_neighbors = t8_eclass_to_dimension[eclass] == 2 ? 4 : 16;
+    t8_cmesh_t cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_SELF, 0, 0, 0);
+    t8_forest_t forest_uniform = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 1, 0, sc_MPI_COMM_SELF);
+    t8_forest_t forest = t8_forest_new_adapt (forest_uniform, t8_test_face_connectivity_adapt_first_child, 1, 0, NULL);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+
+    /* The second child of the root comes after the 2^(2 * dim) leaves of level 3 */
+    const t8_locidx_t coarse_index = 1 << (2 * t8_eclass_to_dimension[eclass]);
+    ASSERT_EQ (t8_forest_get_local_num_elements (forest), coarse_index + (1 << t8_eclass_to_dimension[eclass]) - 1);
+    const t8_element_t *coarse_leaf = t8_forest_get_element_in_tree (forest, 0, coarse_index);
+    ASSERT_EQ (ts->t8_element_level (coarse_leaf), 1);
+    ASSERT_EQ (ts->t8_element_child_id (coarse_leaf), 1);
+
+    t8_element_t **neighbors;
+    t8_locidx_t *element_indices;
+    t8_eclass_scheme_c *neigh_scheme;
+    int *dual_faces;
+    int num_neighbors;
+    t8_forest_leaf_face_neighbors (forest, 0, coarse_leaf, &neighbors, 0, &dual_faces, &num_neighbors,
+                                   &element_indices, &neigh_scheme, 0);
+    ASSERT_EQ (num_neighbors, expected_num_neighbors);
+    for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      EXPECT_EQ (neigh_scheme->t8_element_level (neighbors[ineigh]), 3);
+      EXPECT_EQ (dual_faces[ineigh], 1);
+
+      /* The neighbor's only neighbor across face 1 is the coarse leaf */
+      t8_element_t **back_neighbors;
+      t8_locidx_t *back_indices;
+      t8_eclass_scheme_c *back_scheme;
+      int *back_dual_faces;
+      int back_num_neighbors;
+      t8_forest_leaf_face_neighbors (forest, 0, neighbors[ineigh], &back_neighbors, 1, &back_dual_faces,
+                                     &back_num_neighbors, &back_indices, &back_scheme, 0);
+      ASSERT_EQ (back_num_neighbors, 1);
+      EXPECT_EQ (back_indices[0], coarse_index);
+      EXPECT_EQ (back_dual_faces[0], 0);
+      back_scheme->t8_element_destroy (1, back_neighbors);
+      T8_FREE (back_neighbors);
+      T8_FREE (back_indices);
+      T8_FREE (back_dual_faces);
+    }
+    neigh_scheme->t8_element_destroy (num_neighbors, neighbors);
+    T8_FREE (neighbors);
+    T8_FREE (element_indices);
+    T8_FREE (dual_faces);
+    t8_forest_unref (&forest);
+  }
+}
+
+/* Count the visits of each local leaf face and check that the finer side comes first */
+static void
+t8_test_count_face_visits (t8_forest_t forest, const t8_forest_face_side_t sides[2], int orientation, int is_hanging,
+                           void *user_data)
+{
+  int *visits = (int *) user_data;
+  const int level0 = sides[0].ts->t8_element_level (sides[0].element);
+  const int level1 = sides[1].ts->t8_element_level (sides[1].element);
+
+  EXPECT_EQ (is_hanging, level0 != level1);
+  EXPECT_GE (level0, level1);
+  EXPECT_TRUE (!sides[0].is_ghost || !sides[1].is_ghost);
+  for (int iside = 0; iside < 2; iside++) {
+    if (!sides[iside].is_ghost) {
+      visits[sides[iside].element_index * T8_ECLASS_MAX_FACES + sides[iside].face]++;
+    }
+  }
+}
+
+/* Iterate over all interior faces of an unbalanced forest and check that each
+ * face is visited once for each of its neighbor leaves. */
+TEST_P (forest_face_connectivity, test_iterate_interior_faces)
+{
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (default_scheme);
+  t8_forest_t forest_uniform = t8_forest_new_uniform (cmesh, default_scheme, 1, 0, sc_MPI_COMM_WORLD);
+  t8_forest_t forest;
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_uniform, t8_test_face_connectivity_adapt_unbalanced, 1);
+  t8_forest_set_partition (forest, NULL, 0);
+  t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest);
+
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest);
+  int *visits = T8_ALLOC_ZERO (int, num_local_elements * T8_ECLASS_MAX_FACES);
+  t8_forest_iterate_interior_faces (forest, 0, t8_test_count_face_visits, visits);
+
+  t8_forest_build_face_connectivity (forest, 0);
+  t8_locidx_t element_index = 0;
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree); ielem++, element_index++) {
+      const t8_element_t *leaf = t8_forest_get_element_in_tree (forest, itree, ielem);
+      for (int iface = 0; iface < ts->t8_element_num_faces (leaf); iface++) {
+        int num_neighbors;
+        const t8_locidx_t *neighbor_ids;
+        const int *dual_faces;
+
+        t8_forest_face_connectivity_get (forest, element_index, iface, &num_neighbors, &neighbor_ids, &dual_faces,
+                                         NULL, NULL);
+        EXPECT_EQ (visits[element_index * T8_ECLASS_MAX_FACES + iface], num_neighbors)
+          << "element " << element_index << " face " << iface;
+      }
+    }
+  }
+  T8_FREE (visits);
+  t8_forest_unref (&forest);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_face_connectivity, forest_face_connectivity, AllEclasses);
@@ -170,4 +170,37 @@ TEST_P (forest_find_owner, find_multiple_owners)
   sc_array_reset (&owners);
 }
 
+/* Find the owners of all elements of a level in reverse order with the batched search
+ * and compare them with the owners found one by one. */
+TEST_P (forest_find_owner, find_owners_batched)
+{
+  const int level = 3;
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, level, 0, sc_MPI_COMM_WORLD);
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, eclass);
+  const size_t num_elements = ts->t8_element_count_leaves_from_root (level);
+  t8_element_t **elements = T8_ALLOC (t8_element_t *, num_elements);
+  t8_gloidx_t *gtreeids = T8_ALLOC (t8_gloidx_t, num_elements);
+  t8_eclass_t *eclasses = T8_ALLOC (t8_eclass_t, num_elements);
+  int *owners = T8_ALLOC (int, num_elements);
+
+  ts->t8_element_new (num_elements, elements);
+  for (size_t ielement = 0; ielement < num_elements; ielement++) {
+    ts->t8_element_set_linear_id (elements[ielement], level, num_elements - 1 - ielement);
+    gtreeids[ielement] = 0;
+    eclasses[ielement] = eclass;
+  }
+  t8_forest_element_find_owners (forest, num_elements, gtreeids, elements, eclasses, owners);
+  for (size_t ielement = 0; ielement < num_elements; ielement++) {
+    ASSERT_EQ (owners[ielement], t8_forest_element_find_owner (forest, 0, elements[ielement], eclass))
+      << "Batched owner search failed for element " << ielement << ".";
+  }
+
+  ts->t8_element_destroy (num_elements, elements);
+  T8_FREE (elements);
+  T8_FREE (gtreeids);
+  T8_FREE (eclasses);
+  T8_FREE (owners);
+  t8_forest_unref (&forest);
+}
+
 INSTANTIATE_TEST_SUITE_P (t8_gtest_find_owner, forest_find_owner, AllEclasses, print_eclass);
@@ -0,0 +1,336 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_io.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+#include <cstdio>
+
+/* In this test we save an adapted forest together with element data to a checkpoint file.
+ * We load the forest and the data again and check that we get the same leaves,
+ * the same partition and the same data.
+ * We also write a checkpoint on a subset of the processes and load it on all processes, and vice versa.
+ * A hybrid forest with several blocks of leaves in the checkpoint is saved and loaded as well as
+ * a forest from which elements were removed. */
+
+#define T8_TEST_FOREST_SAVE_FILE "test_forest_save.t8f"
+#define T8_TEST_FOREST_SAVE_MAXLEVEL 3
+
+/* The number of leaves in a block of a checkpoint file */
+#define T8_TEST_FOREST_SAVE_BLOCK_SIZE 1024
+
+/* Refine every first child up to the maximum level given as user data of the forest.
+ * The result does not depend on the partition of the forest. */
+static int
+t8_test_forest_save_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                           t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                           const int num_elements, t8_element_t *elements[])
+{
+  const int *maxlevel = (const int *) t8_forest_get_user_data (forest);
+  return ts->t8_element_child_id (elements[0]) == 0 && ts->t8_element_level (elements[0]) < *maxlevel;
+}
+
+/* Remove every fourth leaf of a tree. No tree becomes empty. */
+static int
+t8_test_forest_save_remove (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                            t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                            const int num_elements, t8_element_t *elements[])
+{
+  return lelement_id % 4 == 3 ? -2 : 0;
+}
+
+/* Create the adapted test forest */
+static t8_forest_t
+t8_test_forest_save_new_forest (t8_eclass_t eclass, t8_scheme_cxx_t *scheme, sc_MPI_Comm comm)
+{
+  static int maxlevel = T8_TEST_FOREST_SAVE_MAXLEVEL;
+  t8_forest_t forest = t8_forest_new_uniform (t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0), scheme, 1, 0, comm);
+  return t8_forest_new_adapt (forest, t8_test_forest_save_adapt, 1, 0, &maxlevel);
+}
+
+/* Create an adapted forest on the hybrid hypercube with more than one block of leaves */
+static t8_forest_t
+t8_test_forest_save_new_hybrid_forest (t8_scheme_cxx_t *scheme, sc_MPI_Comm comm)
+{
+  static int maxlevel = T8_TEST_FOREST_SAVE_MAXLEVEL + 1;
+  t8_forest_t forest = t8_forest_new_uniform (t8_cmesh_new_hypercube_hybrid (comm, 0, 0), scheme,
+                                              T8_TEST_FOREST_SAVE_MAXLEVEL, 0, comm);
+  return t8_forest_new_adapt (forest, t8_test_forest_save_adapt, 1, 0, &maxlevel);
+}
+
+/* Load the checkpoint file on the processes of comm */
+static t8_forest_t
+t8_test_forest_save_load (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme, sc_MPI_Comm comm)
+{
+  t8_forest_t forest_loaded;
+
+  t8_forest_init (&forest_loaded);
+  t8_forest_set_cmesh (forest_loaded, cmesh, comm);
+  t8_forest_set_scheme (forest_loaded, scheme);
+  t8_forest_set_load (forest_loaded, T8_TEST_FOREST_SAVE_FILE);
+  t8_forest_commit (forest_loaded);
+  return forest_loaded;
+}
+
+/* Remove the checkpoint file after all processes are done with it */
+static void
+t8_test_forest_save_remove_file (void)
+{
+  int mpirank, mpiret;
+
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    remove (T8_TEST_FOREST_SAVE_FILE);
+  }
+}
+
+/* Store the global element index of each local element as data */
+static sc_array_t *
+t8_test_forest_save_new_data (t8_forest_t forest)
+{
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest);
+  const t8_gloidx_t first_element = t8_forest_get_first_local_element_id (forest);
+  sc_array_t *element_data = sc_array_new_count (sizeof (double), num_local_elements);
+
+  for (t8_locidx_t ielem = 0; ielem < num_local_elements; ielem++) {
+    *(double *) sc_array_index_int (element_data, ielem) = first_element + ielem;
+  }
+  return element_data;
+}
+
+/* Check that two forests have the same local leaves */
+static void
+t8_test_forest_save_compare (t8_forest_t forest, t8_forest_t forest_loaded)
+{
+  ASSERT_EQ (t8_forest_get_global_num_elements (forest_loaded), t8_forest_get_global_num_elements (forest));
+  ASSERT_EQ (t8_forest_get_local_num_elements (forest_loaded), t8_forest_get_local_num_elements (forest));
+  ASSERT_EQ (t8_forest_get_first_local_element_id (forest_loaded), t8_forest_get_first_local_element_id (forest));
+  ASSERT_EQ (t8_forest_get_num_local_trees (forest_loaded), t8_forest_get_num_local_trees (forest));
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ASSERT_EQ (t8_forest_global_tree_id (forest_loaded, itree), t8_forest_global_tree_id (forest, itree));
+    const t8_locidx_t num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    ASSERT_EQ (t8_forest_get_tree_num_elements (forest_loaded, itree), num_tree_elements);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    for (t8_locidx_t ielem = 0; ielem < num_tree_elements; ielem++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      const t8_element_t *element_loaded = t8_forest_get_element_in_tree (forest_loaded, itree, ielem);
+      ASSERT_TRUE (ts->t8_element_equal (element, element_loaded)) << "Loaded element differs from saved element.";
+    }
+  }
+}
+
+/* Check that the data loaded for a forest is the data of t8_test_forest_save_new_data */
+static void
+t8_test_forest_save_check_data (t8_forest_t forest_loaded)
+{
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest_loaded);
+  const t8_gloidx_t first_element = t8_forest_get_first_local_element_id (forest_loaded);
+  sc_array_t *loaded_data = sc_array_new (sizeof (double));
+
+  ASSERT_TRUE (t8_forest_load_element_data (forest_loaded, T8_TEST_FOREST_SAVE_FILE, loaded_data));
+  ASSERT_EQ (loaded_data->elem_count, (size_t) num_local_elements);
+  for (t8_locidx_t ielem = 0; ielem < num_local_elements; ielem++) {
+    ASSERT_EQ (*(double *) sc_array_index_int (loaded_data, ielem), first_element + ielem);
+  }
+  sc_array_destroy (loaded_data);
+}
+
+class forest_save: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    scheme = t8_scheme_new_default_cxx ();
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_test_forest_save_new_forest (eclass, scheme, sc_MPI_COMM_WORLD);
+  }
+  void
+  TearDown () override
+  {
+    t8_forest_unref (&forest);
+    t8_scheme_cxx_unref (&scheme);
+    t8_test_forest_save_remove_file ();
+  }
+  t8_eclass_t eclass;
+  t8_scheme_cxx_t *scheme;
+  t8_forest_t forest;
+};
+
+TEST_P (forest_save, save_and_load)
+{
+  sc_array_t *element_data = t8_test_forest_save_new_data (forest);
+  ASSERT_TRUE (t8_forest_save (forest, T8_TEST_FOREST_SAVE_FILE, element_data));
+  sc_array_destroy (element_data);
+
+  t8_cmesh_ref (t8_forest_get_cmesh (forest));
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t forest_loaded = t8_test_forest_save_load (t8_forest_get_cmesh (forest), scheme, sc_MPI_COMM_WORLD);
+
+  /* The loaded forest must have the same leaves and the same partition */
+  t8_test_forest_save_compare (forest, forest_loaded);
+  t8_test_forest_save_check_data (forest_loaded);
+  t8_forest_unref (&forest_loaded);
+}
+
+TEST_P (forest_save, load_on_different_number_of_processes)
+{
+  int mpirank, mpisize, mpiret;
+  sc_MPI_Comm comm_save;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  /* Write the checkpoint on the first half of the processes */
+  const int num_save_procs = (mpisize + 1) / 2;
+  mpiret = sc_MPI_Comm_split (sc_MPI_COMM_WORLD, mpirank < num_save_procs, mpirank, &comm_save);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank < num_save_procs) {
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_t forest_save = t8_test_forest_save_new_forest (eclass, scheme, comm_save);
+    sc_array_t *element_data = t8_test_forest_save_new_data (forest_save);
+    EXPECT_TRUE (t8_forest_save (forest_save, T8_TEST_FOREST_SAVE_FILE, element_data));
+    sc_array_destroy (element_data);
+    t8_forest_unref (&forest_save);
+  }
+  mpiret = sc_MPI_Comm_free (&comm_save);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+
+  /* Load the checkpoint on all processes with a partitioned cmesh */
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t forest_loaded
+    = t8_test_forest_save_load (t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 1, 0), scheme, sc_MPI_COMM_WORLD);
+
+  /* The loaded forest must have the same leaves as the forest on all processes with a uniform partition */
+  t8_forest_t forest_partition;
+  t8_forest_init (&forest_partition);
+  t8_forest_ref (forest);
+  t8_forest_set_partition (forest_partition, forest, 0);
+  t8_forest_commit (forest_partition);
+  t8_test_forest_save_compare (forest_partition, forest_loaded);
+  t8_test_forest_save_check_data (forest_loaded);
+  t8_forest_unref (&forest_partition);
+  t8_forest_unref (&forest_loaded);
+}
+
+TEST_P (forest_save, load_on_fewer_processes)
+{
+  int mpirank, mpisize, mpiret;
+  sc_MPI_Comm comm_load;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  /* Write the checkpoint on all processes */
+  sc_array_t *element_data = t8_test_forest_save_new_data (forest);
+  ASSERT_TRUE (t8_forest_save (forest, T8_TEST_FOREST_SAVE_FILE, element_data));
+  sc_array_destroy (element_data);
+
+  /* Load the checkpoint on the first half of the processes */
+  const int num_load_procs = (mpisize + 1) / 2;
+  mpiret = sc_MPI_Comm_split (sc_MPI_COMM_WORLD, mpirank < num_load_procs, mpirank, &comm_load);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank < num_load_procs) {
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_t forest_loaded
+      = t8_test_forest_save_load (t8_cmesh_new_hypercube (eclass, comm_load, 0, 0, 0), scheme, comm_load);
+
+    /* The loaded forest must have the same leaves as the forest on these processes with a uniform partition */
+    t8_forest_t forest_partition;
+    t8_forest_init (&forest_partition);
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_set_partition (forest_partition, t8_test_forest_save_new_forest (eclass, scheme, comm_load), 0);
+    t8_forest_commit (forest_partition);
+    t8_test_forest_save_compare (forest_partition, forest_loaded);
+    t8_test_forest_save_check_data (forest_loaded);
+    t8_forest_unref (&forest_partition);
+    t8_forest_unref (&forest_loaded);
+  }
+  mpiret = sc_MPI_Comm_free (&comm_load);
+  SC_CHECK_MPI (mpiret);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_forest_save, forest_save, AllEclasses);
+
+/* Save and load a hybrid forest with leaves in more than one block of the checkpoint */
+TEST (forest_save_hybrid, save_and_load_multiple_blocks)
+{
+  t8_scheme_cxx_t *scheme = t8_scheme_new_default_cxx ();
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t forest = t8_test_forest_save_new_hybrid_forest (scheme, sc_MPI_COMM_WORLD);
+  ASSERT_GT (t8_forest_get_global_num_elements (forest), 2 * T8_TEST_FOREST_SAVE_BLOCK_SIZE);
+
+  sc_array_t *element_data = t8_test_forest_save_new_data (forest);
+  ASSERT_TRUE (t8_forest_save (forest, T8_TEST_FOREST_SAVE_FILE, element_data));
+  sc_array_destroy (element_data);
+
+  /* Load on a partitioned cmesh */
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t forest_loaded
+    = t8_test_forest_save_load (t8_cmesh_new_hypercube_hybrid (sc_MPI_COMM_WORLD, 1, 0), scheme, sc_MPI_COMM_WORLD);
+  t8_test_forest_save_compare (forest, forest_loaded);
+  t8_test_forest_save_check_data (forest_loaded);
+  t8_forest_unref (&forest_loaded);
+  t8_forest_unref (&forest);
+  t8_scheme_cxx_unref (&scheme);
+  t8_test_forest_save_remove_file ();
+}
+
+/* Save and load a forest from which elements were removed */
+TEST (forest_save_hybrid, save_and_load_incomplete)
+{
+  t8_scheme_cxx_t *scheme = t8_scheme_new_default_cxx ();
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t forest = t8_test_forest_save_new_hybrid_forest (scheme, sc_MPI_COMM_WORLD);
+  forest = t8_forest_new_adapt (forest, t8_test_forest_save_remove, 0, 0, NULL);
+  ASSERT_TRUE (forest->incomplete_trees);
+
+  sc_array_t *element_data = t8_test_forest_save_new_data (forest);
+  ASSERT_TRUE (t8_forest_save (forest, T8_TEST_FOREST_SAVE_FILE, element_data));
+  sc_array_destroy (element_data);
+
+  t8_cmesh_ref (t8_forest_get_cmesh (forest));
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_t forest_loaded = t8_test_forest_save_load (t8_forest_get_cmesh (forest), scheme, sc_MPI_COMM_WORLD);
+  EXPECT_TRUE (forest_loaded->incomplete_trees);
+  t8_test_forest_save_compare (forest, forest_loaded);
+  t8_test_forest_save_check_data (forest_loaded);
+  t8_forest_unref (&forest_loaded);
+  t8_forest_unref (&forest);
+  t8_scheme_cxx_unref (&scheme);
+  t8_test_forest_save_remove_file ();
+}
@@ -0,0 +1,364 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+#include <t8_vec.h>
+#include <vector>
+
+/* In this test we create face, edge and vertex ghost layers of the same forest.
+ * We check that each ghost is owned by the process that it is stored for and
+ * that the face ghosts are edge ghosts and the edge ghosts are vertex ghosts.
+ * We also check that the ghost layers are complete by comparing them to a brute force
+ * reference that tests the vertices of all pairs of leaves for containment, on the
+ * hypercubes and on the periodic unit cubes. */
+
+class forest_ghost_corners: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    default_scheme = t8_scheme_new_default_cxx ();
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  }
+  void
+  TearDown () override
+  {
+    t8_cmesh_destroy (&cmesh);
+    t8_scheme_cxx_unref (&default_scheme);
+  }
+  t8_eclass_t eclass;
+  t8_cmesh_t cmesh;
+  t8_scheme_cxx_t *default_scheme;
+};
+
+/* Refine every third element up to level 3 */
+static int
+t8_test_ghost_corners_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                             t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                             const int num_elements, t8_element_t *elements[])
+{
+  if (lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) < 3) {
+    return 1;
+  }
+  return 0;
+}
+
+/* Return a copy of forest with a ghost layer of the given type. forest is not unreferenced. */
+static t8_forest_t
+t8_test_ghost_corners_copy (t8_forest_t forest, t8_ghost_type_t ghost_type)
+{
+  t8_forest_t forest_ghost;
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_ghost);
+  t8_forest_set_copy (forest_ghost, forest);
+  t8_forest_set_ghost (forest_ghost, 1, ghost_type);
+  t8_forest_commit (forest_ghost);
+  return forest_ghost;
+}
+
+/* Return true if the ghost layer of forest contains element */
+static int
+t8_test_ghost_corners_contains (t8_forest_t forest, t8_gloidx_t gtreeid, const t8_element_t *element)
+{
+  const t8_locidx_t lghost_tree = t8_forest_ghost_get_ghost_treeid (forest, gtreeid);
+
+  if (lghost_tree < 0) {
+    return 0;
+  }
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_ghost_get_tree_class (forest, lghost_tree));
+  const t8_locidx_t num_elements = t8_forest_ghost_tree_num_elements (forest, lghost_tree);
+  for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+    if (ts->t8_element_equal (t8_forest_ghost_get_element (forest, lghost_tree, ielem), element)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Check that all ghosts of forest are found in the ghost layer of forest_larger and have the correct owner. */
+static void
+t8_test_ghost_corners_check (t8_forest_t forest, t8_forest_t forest_larger)
+{
+  const t8_locidx_t num_ghost_trees = t8_forest_ghost_num_trees (forest);
+
+  ASSERT_LE (t8_forest_get_num_ghosts (forest), t8_forest_get_num_ghosts (forest_larger));
+  for (t8_locidx_t itree = 0; itree < num_ghost_trees; itree++) {
+    const t8_gloidx_t gtreeid = t8_forest_ghost_get_global_treeid (forest, itree);
+    const t8_eclass_t tree_class = t8_forest_ghost_get_tree_class (forest, itree);
+    const t8_locidx_t num_elements = t8_forest_ghost_tree_num_elements (forest, itree);
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+      t8_element_t *ghost = t8_forest_ghost_get_element (forest, itree, ielem);
+      const int owner = t8_forest_element_find_owner (forest, gtreeid, ghost, tree_class);
+      ASSERT_NE (owner, forest->mpirank) << "Local element in ghost layer.";
+      ASSERT_TRUE (t8_test_ghost_corners_contains (forest_larger, gtreeid, ghost))
+        << "Ghost element is missing in the larger ghost layer.";
+    }
+  }
+}
+
+/* A leaf with the physical coordinates of its vertices, gathered on all processes */
+typedef struct
+{
+  t8_gloidx_t gtreeid;
+  t8_linearidx_t linear_id;
+  int level;
+  int owner;
+  t8_eclass_t tree_class;
+  t8_eclass_t shape;
+  double vertices[3 * T8_ECLASS_MAX_CORNERS];
+  double lower[3];
+  double upper[3];
+} t8_test_ghost_leaf_t;
+
+/* Gather the leaves of all processes */
+static std::vector<t8_test_ghost_leaf_t>
+t8_test_ghost_corners_gather (t8_forest_t forest)
+{
+  std::vector<t8_test_ghost_leaf_t> local_leaves;
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  int mpisize, mpiret;
+
+  for (t8_locidx_t itree = 0; itree < num_local_trees; itree++) {
+    const t8_eclass_t tree_class = t8_forest_get_tree_class (forest, itree);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree); ielem++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      t8_test_ghost_leaf_t leaf;
+      memset (&leaf, 0, sizeof (leaf));
+      leaf.gtreeid = t8_forest_global_tree_id (forest, itree);
+      leaf.level = ts->t8_element_level (element);
+      leaf.linear_id = ts->t8_element_get_linear_id (element, leaf.level);
+      leaf.owner = forest->mpirank;
+      leaf.tree_class = tree_class;
+      leaf.shape = ts->t8_element_shape (element);
+      for (int icorner = 0; icorner < t8_eclass_num_vertices[leaf.shape]; icorner++) {
+        t8_forest_element_coordinate (forest, itree, element, icorner, leaf.vertices + 3 * icorner);
+        for (int idim = 0; idim < 3; idim++) {
+          const double coord = leaf.vertices[3 * icorner + idim];
+          leaf.lower[idim] = icorner == 0 ? coord : SC_MIN (leaf.lower[idim], coord);
+          leaf.upper[idim] = icorner == 0 ? coord : SC_MAX (leaf.upper[idim], coord);
+        }
+      }
+      local_leaves.push_back (leaf);
+    }
+  }
+
+  mpiret = sc_MPI_Comm_size (forest->mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  std::vector<int> counts (mpisize), displs (mpisize + 1, 0);
+  int local_bytes = local_leaves.size () * sizeof (t8_test_ghost_leaf_t);
+  mpiret = sc_MPI_Allgather (&local_bytes, 1, sc_MPI_INT, counts.data (), 1, sc_MPI_INT, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (int irank = 0; irank < mpisize; irank++) {
+    displs[irank + 1] = displs[irank] + counts[irank];
+  }
+  std::vector<t8_test_ghost_leaf_t> leaves (displs[mpisize] / sizeof (t8_test_ghost_leaf_t));
+  mpiret = sc_MPI_Allgatherv (local_leaves.data (), local_bytes, sc_MPI_BYTE, leaves.data (), counts.data (),
+                              displs.data (), sc_MPI_BYTE, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  return leaves;
+}
+
+/* Return true if point (shifted by shift) lies in the closed convex element leaf.
+ * For each face of the element, the point must be on the same side of the face as the centroid. */
+static int
+t8_test_ghost_corners_point_inside (const t8_test_ghost_leaf_t *leaf, const double *point, const double *shift)
+{
+  const double eps = 1e-10;
+  const int num_vertices = t8_eclass_num_vertices[leaf->shape];
+  const int num_faces = t8_eclass_num_faces[leaf->shape];
+  double shifted[3], centroid[3] = { 0, 0, 0 }, normal[3], axes[2][3], to_point[3];
+
+  t8_vec_axpyz (shift, point, shifted, 1);
+  for (int idim = 0; idim < 3; idim++) {
+    if (shifted[idim] < leaf->lower[idim] - eps || shifted[idim] > leaf->upper[idim] + eps) {
+      return 0;
+    }
+  }
+  if (num_faces == 0) {
+    return t8_vec_dist (shifted, leaf->vertices) < eps;
+  }
+  for (int ivertex = 0; ivertex < num_vertices; ivertex++) {
+    t8_vec_axpy (leaf->vertices + 3 * ivertex, centroid, 1.0 / num_vertices);
+  }
+  for (int iface = 0; iface < num_faces; iface++) {
+    const t8_eclass_t face_class = (t8_eclass_t) t8_eclass_face_types[leaf->shape][iface];
+    const int *face_vertices = t8_face_vertex_to_tree_vertex[leaf->shape][iface];
+    const double *origin = leaf->vertices + 3 * face_vertices[0];
+    const int num_axes = SC_MIN (t8_eclass_num_vertices[face_class] - 1, 2);
+    /* The normal is the part of the direction to the centroid that is orthogonal to the face */
+    t8_vec_axpyz (origin, centroid, normal, -1);
+    for (int iaxis = 0; iaxis < num_axes; iaxis++) {
+      t8_vec_axpyz (origin, leaf->vertices + 3 * face_vertices[iaxis + 1], axes[iaxis], -1);
+      for (int jaxis = 0; jaxis < iaxis; jaxis++) {
+        t8_vec_axpy (axes[jaxis], axes[iaxis], -t8_vec_dot (axes[iaxis], axes[jaxis]));
+      }
+      t8_vec_ax (axes[iaxis], 1.0 / t8_vec_norm (axes[iaxis]));
+      t8_vec_axpy (axes[iaxis], normal, -t8_vec_dot (normal, axes[iaxis]));
+    }
+    t8_vec_axpyz (origin, shifted, to_point, -1);
+    if (t8_vec_dot (normal, to_point) < -eps * t8_vec_norm (normal)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Count the vertices of leaf_a that lie in leaf_b. If periodic, the vertices may be shifted by
+ * -1, 0 or 1 in each of the first dim coordinate directions. */
+static int
+t8_test_ghost_corners_count_inside (const t8_test_ghost_leaf_t *leaf_a, const t8_test_ghost_leaf_t *leaf_b,
+                                    int periodic, int dim)
+{
+  const int num_shifts = periodic ? (dim == 1 ? 3 : dim == 2 ? 9 : 27) : 1;
+  int num_inside = 0;
+
+  for (int ivertex = 0; ivertex < t8_eclass_num_vertices[leaf_a->shape]; ivertex++) {
+    int inside = 0;
+    for (int ishift = 0; ishift < num_shifts && !inside; ishift++) {
+      double shift[3] = { 0, 0, 0 };
+      for (int idim = 0, code = ishift; periodic && idim < dim; idim++, code /= 3) {
+        shift[idim] = code % 3 - 1;
+      }
+      inside = t8_test_ghost_corners_point_inside (leaf_b, leaf_a->vertices + 3 * ivertex, shift);
+    }
+    num_inside += inside;
+  }
+  return num_inside;
+}
+
+/* Check that the ghost layer of forest contains all leaves of other processes that share at least
+ * one vertex (vertex ghosts), two vertices (edge ghosts) or dim vertices (face ghosts) with a local leaf.
+ * Since the intersection of two leaves is a sub-entity of the smaller leaf, it suffices to count
+ * the vertices of one leaf that lie in the other. */
+static void
+t8_test_ghost_corners_check_complete (t8_forest_t forest, t8_ghost_type_t ghost_type, int periodic, int dim)
+{
+  const std::vector<t8_test_ghost_leaf_t> leaves = t8_test_ghost_corners_gather (forest);
+  const int min_touch = ghost_type == T8_GHOST_VERTICES ? 1 : ghost_type == T8_GHOST_EDGES ? 2 : SC_MAX (dim, 1);
+  const int mpirank = forest->mpirank;
+
+  for (const t8_test_ghost_leaf_t &remote_leaf : leaves) {
+    if (remote_leaf.owner == mpirank) {
+      continue;
+    }
+    int touches = 0;
+    for (const t8_test_ghost_leaf_t &local_leaf : leaves) {
+      if (local_leaf.owner != mpirank) {
+        continue;
+      }
+      if (t8_test_ghost_corners_count_inside (&remote_leaf, &local_leaf, periodic, dim) >= min_touch
+          || t8_test_ghost_corners_count_inside (&local_leaf, &remote_leaf, periodic, dim) >= min_touch) {
+        touches = 1;
+        break;
+      }
+    }
+    if (!touches) {
+      continue;
+    }
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, remote_leaf.tree_class);
+    t8_element_t *element;
+    ts->t8_element_new (1, &element);
+    ts->t8_element_set_linear_id (element, remote_leaf.level, remote_leaf.linear_id);
+    EXPECT_TRUE (t8_test_ghost_corners_contains (forest, remote_leaf.gtreeid, element))
+      << "Leaf of tree " << remote_leaf.gtreeid << " on process " << remote_leaf.owner
+      << " touches a local leaf but is missing in the ghost layer.";
+    ts->t8_element_destroy (1, &element);
+  }
+}
+
+TEST_P (forest_ghost_corners, test_ghost_layers_complete)
+{
+  const int dim = t8_eclass_to_dimension[eclass];
+  for (int adapt = 0; adapt <= 1; adapt++) {
+    t8_scheme_cxx_ref (default_scheme);
+    t8_cmesh_ref (cmesh);
+    t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, 2, 0, sc_MPI_COMM_WORLD);
+    if (adapt) {
+      forest = t8_forest_new_adapt (forest, t8_test_ghost_corners_adapt, 1, 0, NULL);
+    }
+    for (int ghost_type = T8_GHOST_FACES; ghost_type <= T8_GHOST_VERTICES; ghost_type++) {
+      t8_forest_t forest_ghost = t8_test_ghost_corners_copy (forest, (t8_ghost_type_t) ghost_type);
+      t8_test_ghost_corners_check_complete (forest_ghost, (t8_ghost_type_t) ghost_type, 0, dim);
+      t8_forest_unref (&forest_ghost);
+    }
+    t8_forest_unref (&forest);
+  }
+}
+
+/* The periodic unit cubes consist of a single tree that is connected to itself across each face. */
+TEST (forest_ghost_corners_periodic, test_ghost_layers_complete)
+{
+  for (int dim = 1; dim <= 3; dim++) {
+    for (int adapt = 0; adapt <= 1; adapt++) {
+      t8_forest_t forest = t8_forest_new_uniform (t8_cmesh_new_periodic (sc_MPI_COMM_WORLD, dim),
+                                                  t8_scheme_new_default_cxx (), 2, 0, sc_MPI_COMM_WORLD);
+      if (adapt) {
+        forest = t8_forest_new_adapt (forest, t8_test_ghost_corners_adapt, 1, 0, NULL);
+      }
+      for (int ghost_type = T8_GHOST_FACES; ghost_type <= T8_GHOST_VERTICES; ghost_type++) {
+        t8_forest_t forest_ghost = t8_test_ghost_corners_copy (forest, (t8_ghost_type_t) ghost_type);
+        t8_test_ghost_corners_check_complete (forest_ghost, (t8_ghost_type_t) ghost_type, 1, dim);
+        t8_forest_unref (&forest_ghost);
+      }
+      t8_forest_unref (&forest);
+    }
+  }
+}
+
+TEST_P (forest_ghost_corners, test_ghost_layers_nested)
+{
+  for (int adapt = 0; adapt <= 1; adapt++) {
+    t8_scheme_cxx_ref (default_scheme);
+    t8_cmesh_ref (cmesh);
+    t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, 2, 0, sc_MPI_COMM_WORLD);
+    if (adapt) {
+      forest = t8_forest_new_adapt (forest, t8_test_ghost_corners_adapt, 1, 0, NULL);
+    }
+    t8_forest_t forest_faces = t8_test_ghost_corners_copy (forest, T8_GHOST_FACES);
+    t8_forest_t forest_edges = t8_test_ghost_corners_copy (forest, T8_GHOST_EDGES);
+    t8_forest_t forest_vertices = t8_test_ghost_corners_copy (forest, T8_GHOST_VERTICES);
+
+    t8_test_ghost_corners_check (forest_faces, forest_edges);
+    t8_test_ghost_corners_check (forest_edges, forest_vertices);
+    t8_test_ghost_corners_check (forest_vertices, forest_vertices);
+
+    t8_forest_unref (&forest_faces);
+    t8_forest_unref (&forest_edges);
+    t8_forest_unref (&forest_vertices);
+    t8_forest_unref (&forest);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_ghost_corners, forest_ghost_corners, AllEclasses);
@@ -0,0 +1,147 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+
+/* In this test we adapt a forest with a ghost layer twice, once with an incremental
+ * ghost layer and once with a ghost layer created from scratch.
+ * We check that both ghost layers are equal. */
+
+class forest_ghost_incremental: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    default_scheme = t8_scheme_new_default_cxx ();
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  }
+  void
+  TearDown () override
+  {
+    t8_cmesh_destroy (&cmesh);
+    t8_scheme_cxx_unref (&default_scheme);
+  }
+  t8_eclass_t eclass;
+  t8_cmesh_t cmesh;
+  t8_scheme_cxx_t *default_scheme;
+};
+
+/* Refine the first element of every tree and coarsen every family in which the last
+ * element has an index divisible by 5. Thus, only some regions change. */
+static int
+t8_test_ghost_incremental_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                                 t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                                 const int num_elements, t8_element_t *elements[])
+{
+  if (lelement_id == 0 && ts->t8_element_level (elements[0]) < 4) {
+    return 1;
+  }
+  if (is_family && (lelement_id + num_elements - 1) % 5 == 0) {
+    return -1;
+  }
+  return 0;
+}
+
+/* Adapt forest and create a face ghost layer. forest is not unreferenced. */
+static t8_forest_t
+t8_test_ghost_incremental_new (t8_forest_t forest, int incremental, int copy)
+{
+  t8_forest_t forest_new;
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_new);
+  if (copy) {
+    t8_forest_set_copy (forest_new, forest);
+  }
+  else {
+    t8_forest_set_adapt (forest_new, forest, t8_test_ghost_incremental_adapt, 0);
+  }
+  t8_forest_set_ghost (forest_new, 1, T8_GHOST_FACES);
+  t8_forest_set_ghost_incremental (forest_new, incremental);
+  t8_forest_commit (forest_new);
+  return forest_new;
+}
+
+/* Check that two forests have equal ghost layers */
+static void
+t8_test_ghost_incremental_compare (t8_forest_t forest_a, t8_forest_t forest_b)
+{
+  const t8_locidx_t num_ghost_trees = t8_forest_ghost_num_trees (forest_a);
+  int num_remotes_a, num_remotes_b;
+
+  ASSERT_EQ (t8_forest_get_num_ghosts (forest_a), t8_forest_get_num_ghosts (forest_b));
+  ASSERT_EQ (num_ghost_trees, t8_forest_ghost_num_trees (forest_b));
+  if (t8_forest_get_num_ghosts (forest_a) > 0) {
+    const int *remotes_a = t8_forest_ghost_get_remotes (forest_a, &num_remotes_a);
+    const int *remotes_b = t8_forest_ghost_get_remotes (forest_b, &num_remotes_b);
+    ASSERT_EQ (num_remotes_a, num_remotes_b);
+    for (int iremote = 0; iremote < num_remotes_a; iremote++) {
+      ASSERT_EQ (remotes_a[iremote], remotes_b[iremote]);
+    }
+  }
+  for (t8_locidx_t itree = 0; itree < num_ghost_trees; itree++) {
+    const t8_gloidx_t gtreeid = t8_forest_ghost_get_global_treeid (forest_a, itree);
+    ASSERT_EQ (gtreeid, t8_forest_ghost_get_global_treeid (forest_b, itree));
+    const t8_locidx_t num_elements = t8_forest_ghost_tree_num_elements (forest_a, itree);
+    ASSERT_EQ (num_elements, t8_forest_ghost_tree_num_elements (forest_b, itree));
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest_a, t8_forest_ghost_get_tree_class (forest_a, itree));
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+      ASSERT_TRUE (ts->t8_element_equal (t8_forest_ghost_get_element (forest_a, itree, ielem),
+                                         t8_forest_ghost_get_element (forest_b, itree, ielem)))
+        << "Ghost elements differ.";
+    }
+  }
+}
+
+TEST_P (forest_ghost_incremental, test_adapt_and_copy)
+{
+  t8_scheme_cxx_ref (default_scheme);
+  t8_cmesh_ref (cmesh);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, 2, 1, sc_MPI_COMM_WORLD);
+
+  for (int copy = 0; copy <= 1; copy++) {
+    t8_forest_t forest_incremental = t8_test_ghost_incremental_new (forest, 1, copy);
+    t8_forest_t forest_full = t8_test_ghost_incremental_new (forest, 0, copy);
+    t8_test_ghost_incremental_compare (forest_incremental, forest_full);
+
+    /* Adapt the incrementally derived forest again */
+    t8_forest_t forest_incremental2 = t8_test_ghost_incremental_new (forest_incremental, 1, copy);
+    t8_forest_t forest_full2 = t8_test_ghost_incremental_new (forest_incremental, 0, copy);
+    t8_test_ghost_incremental_compare (forest_incremental2, forest_full2);
+
+    t8_forest_unref (&forest_incremental);
+    t8_forest_unref (&forest_full);
+    t8_forest_unref (&forest_incremental2);
+    t8_forest_unref (&forest_full2);
+  }
+  t8_forest_unref (&forest);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_ghost_incremental, forest_ghost_incremental, AllEclasses);
@@ -0,0 +1,392 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_face_connectivity.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+/* In this test we create ghost layers of width 1, 2 and 3 of the same forest.
+ * We check that no ghost is a local element and that each ghost layer
+ * contains the ghost layers of smaller width.
+ * We gather the face neighbor graph of all leaves and check that the ghost layer of
+ * width k consists of exactly the leaves of other processes within k face neighbor steps
+ * of a local leaf. Thus, the layer of width k + 1 contains every face neighbor of the layer
+ * of width k. The layer of width 1 must equal the default face ghost layer.
+ * We also check that the face connectivity table is rebuilt when the ghost layer is replaced. */
+
+class forest_ghost_width: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    default_scheme = t8_scheme_new_default_cxx ();
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+  }
+  void
+  TearDown () override
+  {
+    t8_cmesh_destroy (&cmesh);
+    t8_scheme_cxx_unref (&default_scheme);
+  }
+  t8_eclass_t eclass;
+  t8_cmesh_t cmesh;
+  t8_scheme_cxx_t *default_scheme;
+};
+
+/* Refine every third element up to level 3 */
+static int
+t8_test_ghost_width_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                             t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                             const int num_elements, t8_element_t *elements[])
+{
+  if (lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) < 3) {
+    return 1;
+  }
+  return 0;
+}
+
+/* Return a copy of forest with a face ghost layer of the given width. forest is not unreferenced. */
+static t8_forest_t
+t8_test_ghost_width_copy (t8_forest_t forest, int ghost_width)
+{
+  t8_forest_t forest_ghost;
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_ghost);
+  t8_forest_set_copy (forest_ghost, forest);
+  t8_forest_set_ghost (forest_ghost, 1, T8_GHOST_FACES);
+  t8_forest_set_ghost_width (forest_ghost, ghost_width);
+  t8_forest_commit (forest_ghost);
+  return forest_ghost;
+}
+
+/* Return true if the ghost layer of forest contains element */
+static int
+t8_test_ghost_width_contains (t8_forest_t forest, t8_gloidx_t gtreeid, const t8_element_t *element)
+{
+  const t8_locidx_t lghost_tree = t8_forest_ghost_get_ghost_treeid (forest, gtreeid);
+
+  if (lghost_tree < 0) {
+    return 0;
+  }
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_ghost_get_tree_class (forest, lghost_tree));
+  const t8_locidx_t num_elements = t8_forest_ghost_tree_num_elements (forest, lghost_tree);
+  for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+    if (ts->t8_element_equal (t8_forest_ghost_get_element (forest, lghost_tree, ielem), element)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Check that all ghosts of forest are found in the ghost layer of forest_larger and have the correct owner. */
+static void
+t8_test_ghost_width_check (t8_forest_t forest, t8_forest_t forest_larger)
+{
+  const t8_locidx_t num_ghost_trees = t8_forest_ghost_num_trees (forest);
+
+  ASSERT_LE (t8_forest_get_num_ghosts (forest), t8_forest_get_num_ghosts (forest_larger));
+  for (t8_locidx_t itree = 0; itree < num_ghost_trees; itree++) {
+    const t8_gloidx_t gtreeid = t8_forest_ghost_get_global_treeid (forest, itree);
+    const t8_eclass_t tree_class = t8_forest_ghost_get_tree_class (forest, itree);
+    const t8_locidx_t num_elements = t8_forest_ghost_tree_num_elements (forest, itree);
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+      t8_element_t *ghost = t8_forest_ghost_get_element (forest, itree, ielem);
+      const int owner = t8_forest_element_find_owner (forest, gtreeid, ghost, tree_class);
+      ASSERT_NE (owner, forest->mpirank) << "Local element in ghost layer.";
+      ASSERT_TRUE (t8_test_ghost_width_contains (forest_larger, gtreeid, ghost))
+        << "Ghost element is missing in the larger ghost layer.";
+    }
+  }
+}
+
+/* A leaf is identified by its global tree, its level and its linear id */
+typedef struct t8_test_leaf_key
+{
+  t8_gloidx_t gtreeid;
+  t8_linearidx_t linear_id;
+  int level;
+
+  bool
+  operator< (const struct t8_test_leaf_key &other) const
+  {
+    return std::tie (gtreeid, level, linear_id) < std::tie (other.gtreeid, other.level, other.linear_id);
+  }
+  bool
+  operator== (const struct t8_test_leaf_key &other) const
+  {
+    return gtreeid == other.gtreeid && level == other.level && linear_id == other.linear_id;
+  }
+} t8_test_leaf_key_t;
+
+static t8_test_leaf_key_t
+t8_test_ghost_width_key (t8_eclass_scheme_c *ts, t8_gloidx_t gtreeid, const t8_element_t *element)
+{
+  t8_test_leaf_key_t key;
+
+  memset (&key, 0, sizeof (key));
+  key.gtreeid = gtreeid;
+  key.level = ts->t8_element_level (element);
+  key.linear_id = ts->t8_element_get_linear_id (element, key.level);
+  return key;
+}
+
+/* Return the keys of the local leaves and of the ghosts of forest, in the order of their indices */
+static void
+t8_test_ghost_width_keys (t8_forest_t forest, std::vector<t8_test_leaf_key_t> &local_keys,
+                          std::vector<t8_test_leaf_key_t> &ghost_keys)
+{
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest, itree));
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree); ielem++) {
+      local_keys.push_back (t8_test_ghost_width_key (ts, t8_forest_global_tree_id (forest, itree),
+                                                     t8_forest_get_element_in_tree (forest, itree, ielem)));
+    }
+  }
+  for (t8_locidx_t itree = 0; itree < t8_forest_ghost_num_trees (forest); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, t8_forest_ghost_get_tree_class (forest, itree));
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_ghost_tree_num_elements (forest, itree); ielem++) {
+      ghost_keys.push_back (t8_test_ghost_width_key (ts, t8_forest_ghost_get_global_treeid (forest, itree),
+                                                     t8_forest_ghost_get_element (forest, itree, ielem)));
+    }
+  }
+}
+
+/* Gather the face neighbor graph of all leaves from the face connectivity tables of all processes.
+ * forest must have a face ghost layer of width 1. */
+static std::map<t8_test_leaf_key_t, std::vector<t8_test_leaf_key_t>>
+t8_test_ghost_width_gather_graph (t8_forest_t forest)
+{
+  std::vector<t8_test_leaf_key_t> local_keys, ghost_keys;
+  std::vector<t8_test_leaf_key_t> local_edges;
+  std::map<t8_test_leaf_key_t, std::vector<t8_test_leaf_key_t>> graph;
+  const t8_locidx_t num_local_elements = t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t *neighbor_ids;
+  const int *dual_faces;
+  int num_neighbors, mpiret;
+
+  t8_test_ghost_width_keys (forest, local_keys, ghost_keys);
+  t8_forest_build_face_connectivity (forest, 0);
+  for (t8_locidx_t lelement = 0; lelement < num_local_elements; lelement++) {
+    const int num_faces
+      = forest->face_connectivity->element_offsets[lelement + 1] - forest->face_connectivity->element_offsets[lelement];
+    for (int iface = 0; iface < num_faces; iface++) {
+      t8_forest_face_connectivity_get (forest, lelement, iface, &num_neighbors, &neighbor_ids, &dual_faces, NULL, NULL);
+      for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+        local_edges.push_back (local_keys[lelement]);
+        local_edges.push_back (neighbor_ids[ineigh] < num_local_elements
+                                 ? local_keys[neighbor_ids[ineigh]]
+                                 : ghost_keys[neighbor_ids[ineigh] - num_local_elements]);
+      }
+    }
+  }
+
+  std::vector<int> counts (forest->mpisize), displs (forest->mpisize + 1, 0);
+  int local_bytes = local_edges.size () * sizeof (t8_test_leaf_key_t);
+  mpiret = sc_MPI_Allgather (&local_bytes, 1, sc_MPI_INT, counts.data (), 1, sc_MPI_INT, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (int irank = 0; irank < forest->mpisize; irank++) {
+    displs[irank + 1] = displs[irank] + counts[irank];
+  }
+  std::vector<t8_test_leaf_key_t> edges (displs[forest->mpisize] / sizeof (t8_test_leaf_key_t));
+  mpiret = sc_MPI_Allgatherv (local_edges.data (), local_bytes, sc_MPI_BYTE, edges.data (), counts.data (),
+                              displs.data (), sc_MPI_BYTE, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (size_t iedge = 0; iedge < edges.size (); iedge += 2) {
+    graph[edges[iedge]].push_back (edges[iedge + 1]);
+  }
+  return graph;
+}
+
+/* Check that the ghosts of forest are exactly the leaves of other processes within ghost_width face neighbor
+ * steps of a local leaf and that every face neighbor of a ghost in a layer of smaller width is a ghost or local. */
+static void
+t8_test_ghost_width_check_layers (t8_forest_t forest, int ghost_width,
+                                  std::map<t8_test_leaf_key_t, std::vector<t8_test_leaf_key_t>> &graph)
+{
+  std::vector<t8_test_leaf_key_t> local_keys, ghost_keys;
+  std::map<t8_test_leaf_key_t, int> distance;
+  std::vector<t8_test_leaf_key_t> front, next;
+
+  t8_test_ghost_width_keys (forest, local_keys, ghost_keys);
+  const std::set<t8_test_leaf_key_t> ghosts (ghost_keys.begin (), ghost_keys.end ());
+  ASSERT_EQ (ghosts.size (), ghost_keys.size ()) << "A ghost is stored twice.";
+  for (const t8_test_leaf_key_t &key : local_keys) {
+    distance[key] = 0;
+    front.push_back (key);
+  }
+  for (int width = 1; width <= ghost_width; width++) {
+    next.clear ();
+    for (const t8_test_leaf_key_t &key : front) {
+      for (const t8_test_leaf_key_t &neighbor : graph[key]) {
+        if (distance.find (neighbor) == distance.end ()) {
+          distance[neighbor] = width;
+          next.push_back (neighbor);
+          EXPECT_TRUE (ghosts.count (neighbor)) << "Face neighbor of layer " << width - 1 << " is not in layer "
+                                                << width << " of a ghost layer of width " << ghost_width << ".";
+        }
+      }
+    }
+    front.swap (next);
+  }
+  for (const t8_test_leaf_key_t &key : ghost_keys) {
+    auto found = distance.find (key);
+    EXPECT_TRUE (found != distance.end () && found->second > 0)
+      << "Ghost is local or farther than " << ghost_width << " face neighbor steps from the local leaves.";
+  }
+}
+
+/* Return a copy of forest with the default face ghost layer. forest is not unreferenced. */
+static t8_forest_t
+t8_test_ghost_width_copy_default (t8_forest_t forest)
+{
+  t8_forest_t forest_ghost;
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_ghost);
+  t8_forest_set_copy (forest_ghost, forest);
+  t8_forest_set_ghost (forest_ghost, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_ghost);
+  return forest_ghost;
+}
+
+TEST_P (forest_ghost_width, test_ghost_layers_neighbors)
+{
+  for (int adapt = 0; adapt <= 1; adapt++) {
+    t8_scheme_cxx_ref (default_scheme);
+    t8_cmesh_ref (cmesh);
+    t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, 2, 0, sc_MPI_COMM_WORLD);
+    if (adapt) {
+      forest = t8_forest_new_adapt (forest, t8_test_ghost_width_adapt, 1, 0, NULL);
+    }
+    t8_forest_t forest_default = t8_test_ghost_width_copy_default (forest);
+    t8_forest_t forest_width1 = t8_test_ghost_width_copy (forest, 1);
+    std::map<t8_test_leaf_key_t, std::vector<t8_test_leaf_key_t>> graph
+      = t8_test_ghost_width_gather_graph (forest_default);
+
+    /* Width 1 is the default face ghost layer */
+    std::vector<t8_test_leaf_key_t> local_keys, default_ghosts, width1_ghosts;
+    t8_test_ghost_width_keys (forest_default, local_keys, default_ghosts);
+    local_keys.clear ();
+    t8_test_ghost_width_keys (forest_width1, local_keys, width1_ghosts);
+    EXPECT_EQ (default_ghosts, width1_ghosts);
+
+    for (int width = 1; width <= 3; width++) {
+      t8_forest_t forest_width = t8_test_ghost_width_copy (forest, width);
+      t8_test_ghost_width_check_layers (forest_width, width, graph);
+      t8_forest_unref (&forest_width);
+    }
+
+    t8_forest_unref (&forest_default);
+    t8_forest_unref (&forest_width1);
+    t8_forest_unref (&forest);
+  }
+}
+
+/* Replace the ghost layer of a forest with a face connectivity table and check that the table
+ * refers to the new ghosts. */
+TEST_P (forest_ghost_width, test_face_connectivity_after_new_ghosts)
+{
+  t8_scheme_cxx_ref (default_scheme);
+  t8_cmesh_ref (cmesh);
+  t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, 2, 0, sc_MPI_COMM_WORLD);
+  forest = t8_forest_new_adapt (forest, t8_test_ghost_width_adapt, 1, 0, NULL);
+  t8_forest_t forest_ghost = t8_test_ghost_width_copy (forest, 1);
+  t8_forest_unref (&forest);
+
+  t8_forest_build_face_connectivity (forest_ghost, 0);
+  /* Replace the face ghost layer by a layer of width 2 */
+  forest_ghost->ghost_width = 2;
+  t8_forest_ghost_create (forest_ghost);
+  ASSERT_TRUE (t8_forest_has_face_connectivity (forest_ghost));
+
+  const t8_locidx_t *neighbor_ids;
+  const int *dual_faces;
+  t8_element_t **neighbors;
+  t8_locidx_t *element_indices;
+  t8_eclass_scheme_c *neigh_scheme;
+  int *leaf_dual_faces, num_neighbors, leaf_num_neighbors;
+  for (t8_locidx_t itree = 0, lelement = 0; itree < t8_forest_get_num_local_trees (forest_ghost); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest_ghost, t8_forest_get_tree_class (forest_ghost, itree));
+    for (t8_locidx_t ielem = 0; ielem < t8_forest_get_tree_num_elements (forest_ghost, itree); ielem++, lelement++) {
+      const t8_element_t *leaf = t8_forest_get_element_in_tree (forest_ghost, itree, ielem);
+      for (int iface = 0; iface < ts->t8_element_num_faces (leaf); iface++) {
+        t8_forest_face_connectivity_get (forest_ghost, lelement, iface, &num_neighbors, &neighbor_ids, &dual_faces,
+                                         NULL, NULL);
+        t8_forest_leaf_face_neighbors (forest_ghost, itree, leaf, &neighbors, iface, &leaf_dual_faces,
+                                       &leaf_num_neighbors, &element_indices, &neigh_scheme, 0);
+        ASSERT_EQ (num_neighbors, leaf_num_neighbors);
+        for (int ineigh = 0; ineigh < num_neighbors; ineigh++) {
+          EXPECT_EQ (neighbor_ids[ineigh], element_indices[ineigh]);
+          EXPECT_EQ (dual_faces[ineigh], leaf_dual_faces[ineigh]);
+        }
+        if (leaf_num_neighbors > 0) {
+          neigh_scheme->t8_element_destroy (leaf_num_neighbors, neighbors);
+          T8_FREE (neighbors);
+          T8_FREE (element_indices);
+          T8_FREE (leaf_dual_faces);
+        }
+      }
+    }
+  }
+  t8_forest_unref (&forest_ghost);
+}
+
+TEST_P (forest_ghost_width, test_ghost_layers_nested)
+{
+  for (int adapt = 0; adapt <= 1; adapt++) {
+    t8_scheme_cxx_ref (default_scheme);
+    t8_cmesh_ref (cmesh);
+    t8_forest_t forest = t8_forest_new_uniform (cmesh, default_scheme, 2, 0, sc_MPI_COMM_WORLD);
+    if (adapt) {
+      forest = t8_forest_new_adapt (forest, t8_test_ghost_width_adapt, 1, 0, NULL);
+    }
+    t8_forest_t forest_width1 = t8_test_ghost_width_copy (forest, 1);
+    t8_forest_t forest_width2 = t8_test_ghost_width_copy (forest, 2);
+    t8_forest_t forest_width3 = t8_test_ghost_width_copy (forest, 3);
+    ASSERT_EQ (t8_forest_get_ghost_width (forest_width3), 3);
+
+    t8_test_ghost_width_check (forest_width1, forest_width2);
+    t8_test_ghost_width_check (forest_width2, forest_width3);
+    t8_test_ghost_width_check (forest_width3, forest_width3);
+
+    t8_forest_unref (&forest_width1);
+    t8_forest_unref (&forest_width2);
+    t8_forest_unref (&forest_width3);
+    t8_forest_unref (&forest);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_ghost_width, forest_ghost_width, AllEclasses);
@@ -0,0 +1,215 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_global_nodes.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+#include <array>
+#include <cmath>
+#include <map>
+#include <vector>
+
+/* In this test we number the vertices of a uniform forest on the unit hypercube.
+ * The vertices of a uniform level L forest are the points of a lattice with spacing 2^-L,
+ * hence there are (2^L + 1)^dim global nodes. We check that vertices at the same position
+ * have the same global id and that the owned nodes are numbered consecutively.
+ * We also number the vertices of adapted forests on the periodic unit cubes, in which
+ * positions that differ by the period are the same vertex. */
+
+#define T8_TEST_GLOBAL_NODES_LEVEL 2
+
+class forest_global_nodes: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    t8_forest_init (&forest);
+    t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0), sc_MPI_COMM_WORLD);
+    t8_forest_set_scheme (forest, t8_scheme_new_default_cxx ());
+    t8_forest_set_level (forest, T8_TEST_GLOBAL_NODES_LEVEL);
+    t8_forest_set_ghost (forest, 1, T8_GHOST_VERTICES);
+    t8_forest_commit (forest);
+    t8_forest_build_global_nodes (forest);
+  }
+  void
+  TearDown () override
+  {
+    t8_forest_unref (&forest);
+  }
+  t8_eclass_t eclass;
+  t8_forest_t forest;
+};
+
+TEST_P (forest_global_nodes, test_global_node_count)
+{
+  const int dim = t8_eclass_to_dimension[eclass];
+  const t8_gloidx_t num_lattice_points = 1 << T8_TEST_GLOBAL_NODES_LEVEL;
+  t8_gloidx_t expected = 1;
+
+  for (int idim = 0; idim < dim; idim++) {
+    expected *= num_lattice_points + 1;
+  }
+  EXPECT_EQ (t8_forest_get_global_num_nodes (forest), expected);
+}
+
+TEST_P (forest_global_nodes, test_global_node_ids)
+{
+  const t8_locidx_t num_local_nodes = t8_forest_get_num_local_nodes (forest);
+  const t8_gloidx_t first_owned = t8_forest_get_first_owned_node (forest);
+  const double lattice_scale = 1 << T8_TEST_GLOBAL_NODES_LEVEL;
+  std::map<std::array<long, 3>, t8_gloidx_t> position_to_id;
+  std::map<t8_gloidx_t, std::array<long, 3>> id_to_position;
+  t8_locidx_t num_owned = 0;
+  int mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* Each owned node has an id in the range of this process */
+  for (t8_locidx_t lnode = 0; lnode < num_local_nodes; lnode++) {
+    const t8_gloidx_t global_id = t8_forest_global_nodes_get_global_id (forest, lnode);
+    const int owner = t8_forest_global_nodes_get_owner (forest, lnode);
+    ASSERT_LE (owner, mpirank);
+    ASSERT_GE (global_id, 0);
+    ASSERT_LT (global_id, t8_forest_get_global_num_nodes (forest));
+    if (owner == mpirank) {
+      ASSERT_GE (global_id, first_owned);
+      ASSERT_LT (global_id, first_owned + t8_forest_get_num_owned_nodes (forest));
+      num_owned++;
+    }
+  }
+  ASSERT_EQ (num_owned, t8_forest_get_num_owned_nodes (forest));
+
+  /* Vertices at the same position have the same global id and vice versa */
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (t8_locidx_t itree = 0, element_index = 0; itree < num_local_trees; itree++) {
+    const t8_locidx_t num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++, element_index++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      int num_nodes;
+      const t8_locidx_t *element_nodes = t8_forest_global_nodes_get_element (forest, element_index, &num_nodes);
+      for (int icorner = 0; icorner < num_nodes; icorner++) {
+        double coords[3] = { 0, 0, 0 };
+        t8_forest_element_coordinate (forest, itree, element, icorner, coords);
+        const std::array<long, 3> position
+          = { std::lround (coords[0] * lattice_scale), std::lround (coords[1] * lattice_scale),
+              std::lround (coords[2] * lattice_scale) };
+        const t8_gloidx_t global_id = t8_forest_global_nodes_get_global_id (forest, element_nodes[icorner]);
+        auto found_id = position_to_id.emplace (position, global_id);
+        ASSERT_EQ (found_id.first->second, global_id) << "Vertex at the same position with different ids.";
+        auto found_position = id_to_position.emplace (global_id, position);
+        ASSERT_EQ (found_position.first->second, position) << "Vertices at different positions with the same id.";
+      }
+    }
+  }
+  ASSERT_EQ ((size_t) num_local_nodes, position_to_id.size ());
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_global_nodes, forest_global_nodes, AllEclasses);
+
+/* Refine every third element up to level T8_TEST_GLOBAL_NODES_LEVEL + 1 */
+static int
+t8_test_global_nodes_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                            t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                            const int num_elements, t8_element_t *elements[])
+{
+  return lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) <= T8_TEST_GLOBAL_NODES_LEVEL;
+}
+
+/* The periodic unit cubes consist of a single tree that is connected to itself across each face.
+ * We gather the positions of all vertices, wrapped into the unit cube, and their global ids and check that
+ * positions and global ids correspond one to one. */
+TEST (forest_global_nodes_periodic, test_global_node_ids_adapted)
+{
+  const double lattice_scale = 1 << (T8_TEST_GLOBAL_NODES_LEVEL + 1);
+  int mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  for (int dim = 1; dim <= 3; dim++) {
+    t8_forest_t forest_uniform = t8_forest_new_uniform (t8_cmesh_new_periodic (sc_MPI_COMM_WORLD, dim),
+                                                        t8_scheme_new_default_cxx (), T8_TEST_GLOBAL_NODES_LEVEL, 0,
+                                                        sc_MPI_COMM_WORLD);
+    t8_forest_t forest;
+    t8_forest_init (&forest);
+    t8_forest_set_adapt (forest, forest_uniform, t8_test_global_nodes_adapt, 0);
+    t8_forest_set_partition (forest, NULL, 0);
+    t8_forest_set_ghost (forest, 1, T8_GHOST_VERTICES);
+    t8_forest_commit (forest);
+    t8_forest_build_global_nodes (forest);
+
+    /* Collect the wrapped lattice positions and the global ids of the local vertices */
+    std::vector<std::array<long, 4>> local_nodes;
+    const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+    for (t8_locidx_t itree = 0, element_index = 0; itree < num_local_trees; itree++) {
+      const t8_locidx_t num_elements = t8_forest_get_tree_num_elements (forest, itree);
+      for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++, element_index++) {
+        const t8_element_t *element = t8_forest_get_element_in_tree (forest, itree, ielem);
+        int num_nodes;
+        const t8_locidx_t *element_nodes = t8_forest_global_nodes_get_element (forest, element_index, &num_nodes);
+        for (int icorner = 0; icorner < num_nodes; icorner++) {
+          double coords[3] = { 0, 0, 0 };
+          std::array<long, 4> node;
+          t8_forest_element_coordinate (forest, itree, element, icorner, coords);
+          for (int idim = 0; idim < 3; idim++) {
+            node[idim] = std::lround (coords[idim] * lattice_scale) % (long) lattice_scale;
+          }
+          node[3] = t8_forest_global_nodes_get_global_id (forest, element_nodes[icorner]);
+          ASSERT_GE (node[3], 0);
+          local_nodes.push_back (node);
+        }
+      }
+    }
+
+    /* Gather the vertices of all processes */
+    std::vector<int> counts (mpisize), displs (mpisize + 1, 0);
+    int local_count = 4 * local_nodes.size ();
+    mpiret = sc_MPI_Allgather (&local_count, 1, sc_MPI_INT, counts.data (), 1, sc_MPI_INT, sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    for (int irank = 0; irank < mpisize; irank++) {
+      displs[irank + 1] = displs[irank] + counts[irank];
+    }
+    std::vector<std::array<long, 4>> nodes (displs[mpisize] / 4);
+    mpiret = sc_MPI_Allgatherv (local_nodes.data (), local_count, sc_MPI_LONG, nodes.data (), counts.data (),
+                                displs.data (), sc_MPI_LONG, sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+
+    std::map<std::array<long, 3>, long> position_to_id;
+    std::map<long, std::array<long, 3>> id_to_position;
+    for (const std::array<long, 4> &node : nodes) {
+      const std::array<long, 3> position = { node[0], node[1], node[2] };
+      auto found_id = position_to_id.emplace (position, node[3]);
+      ASSERT_EQ (found_id.first->second, node[3]) << "Vertex at the same position with different ids.";
+      auto found_position = id_to_position.emplace (node[3], position);
+      ASSERT_EQ (found_position.first->second, position) << "Vertices at different positions with the same id.";
+    }
+    EXPECT_EQ ((t8_gloidx_t) position_to_id.size (), t8_forest_get_global_num_nodes (forest));
+    t8_forest_unref (&forest);
+  }
+}
@@ -0,0 +1,134 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+
+/* In this test we compare the binary searches in the local trees of a forest with cached
+ * linear ids to those of a copy of the forest without the cache.
+ * We search for the linear ids of each leaf, its predecessor, the last descendant of
+ * the leaf and its successor, and check whether the leaf and its parent have descendant leaves. */
+
+#define T8_TEST_LINEAR_ID_CACHE_LEVEL 2
+
+static int
+t8_test_linear_id_cache_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                               t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                               const int num_elements, t8_element_t *elements[])
+{
+  return lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) <= T8_TEST_LINEAR_ID_CACHE_LEVEL;
+}
+
+class forest_linear_id_cache: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+    t8_forest_t forest_uniform
+      = t8_forest_new_uniform (t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0),
+                               t8_scheme_new_default_cxx (), T8_TEST_LINEAR_ID_CACHE_LEVEL, 0, sc_MPI_COMM_WORLD);
+    t8_forest_init (&forest_cached);
+    t8_forest_set_adapt (forest_cached, forest_uniform, t8_test_linear_id_cache_adapt, 1);
+    t8_forest_set_linear_id_cache (forest_cached, 1);
+    t8_forest_set_partition (forest_cached, NULL, 0);
+    t8_forest_commit (forest_cached);
+
+    t8_forest_ref (forest_cached);
+    t8_forest_init (&forest_uncached);
+    /* The cache is disabled on default */
+    t8_forest_set_copy (forest_uncached, forest_cached);
+    t8_forest_commit (forest_uncached);
+  }
+  void
+  TearDown () override
+  {
+    t8_forest_unref (&forest_cached);
+    t8_forest_unref (&forest_uncached);
+  }
+  t8_eclass_t eclass;
+  t8_forest_t forest_cached;
+  t8_forest_t forest_uncached;
+};
+
+TEST_P (forest_linear_id_cache, test_cached_bin_search)
+{
+  t8_element_t *last_desc, *parent;
+
+  ASSERT_EQ (t8_forest_get_num_local_trees (forest_cached), t8_forest_get_num_local_trees (forest_uncached));
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest_cached); itree++) {
+    const t8_gloidx_t gtreeid = t8_forest_global_tree_id (forest_cached, itree);
+    const t8_locidx_t num_elements = t8_forest_get_tree_num_elements (forest_cached, itree);
+    const t8_eclass_t tree_class = t8_forest_get_tree_class (forest_cached, itree);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest_cached, tree_class);
+    const int8_t *levels;
+    const t8_linearidx_t *linear_ids = t8_forest_tree_get_linear_ids (forest_cached, itree, &levels);
+
+    ASSERT_TRUE (linear_ids != NULL);
+    ASSERT_TRUE (levels != NULL);
+    ASSERT_TRUE (t8_forest_tree_get_linear_ids (forest_uncached, itree, NULL) == NULL);
+    ASSERT_EQ (num_elements, t8_forest_get_tree_num_elements (forest_uncached, itree));
+    ts->t8_element_new (1, &last_desc);
+    ts->t8_element_new (1, &parent);
+    for (t8_locidx_t ielem = 0; ielem < num_elements; ielem++) {
+      const t8_element_t *element = t8_forest_get_element_in_tree (forest_cached, itree, ielem);
+      const t8_linearidx_t element_id = ts->t8_element_get_linear_id (element, forest_cached->maxlevel);
+      ts->t8_element_last_descendant (element, last_desc, forest_cached->maxlevel);
+      const t8_linearidx_t last_desc_id = ts->t8_element_get_linear_id (last_desc, forest_cached->maxlevel);
+
+      /* The cache stores the linear id and the level of each leaf */
+      ASSERT_EQ (linear_ids[ielem], element_id);
+      ASSERT_EQ (levels[ielem], ts->t8_element_level (element));
+
+      /* Search the ids with and without the cache */
+      const t8_linearidx_t query_ids[4] = { element_id, element_id > 0 ? element_id - 1 : 0, last_desc_id,
+                                            last_desc_id + 1 };
+      for (int iquery = 0; iquery < 4; iquery++) {
+        const t8_locidx_t index_cached = t8_forest_tree_bin_search_lower (forest_cached, itree, query_ids[iquery]);
+        const t8_locidx_t index_uncached
+          = t8_forest_tree_bin_search_lower (forest_uncached, itree, query_ids[iquery]);
+        ASSERT_EQ (index_cached, index_uncached) << "Different search results for linear id " << query_ids[iquery];
+      }
+      ASSERT_EQ (t8_forest_tree_bin_search_lower (forest_cached, itree, element_id), ielem);
+      ASSERT_EQ (t8_forest_tree_bin_search_lower (forest_cached, itree, last_desc_id), ielem);
+
+      /* Check for descendant leaves of the leaf and its parent with and without the cache */
+      ASSERT_FALSE (t8_forest_element_has_leaf_desc (forest_cached, gtreeid, element, ts));
+      ASSERT_FALSE (t8_forest_element_has_leaf_desc (forest_uncached, gtreeid, element, ts));
+      if (ts->t8_element_level (element) > 0) {
+        ts->t8_element_parent (element, parent);
+        ASSERT_EQ (t8_forest_element_has_leaf_desc (forest_cached, gtreeid, parent, ts),
+                   t8_forest_element_has_leaf_desc (forest_uncached, gtreeid, parent, ts));
+      }
+    }
+    ts->t8_element_destroy (1, &last_desc);
+    ts->t8_element_destroy (1, &parent);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_linear_id_cache, forest_linear_id_cache, AllEclasses);
@@ -0,0 +1,122 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2024 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_geometrical.h>
+#include <t8_forest/t8_forest_locate.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+
+/* In this test every process locates the centroids of all elements of a
+ * uniform partitioned forest. Since the centroids are gathered in the order of the
+ * global element indices, the expected element of the i-th centroid is i. */
+
+class forest_locate_points: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+
+    t8_scheme_cxx_t *scheme = t8_scheme_new_default_cxx ();
+    t8_cmesh_t cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+    const int level = eclass == T8_ECLASS_VERTEX ? 0 : 2;
+    forest = t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+  }
+  void
+  TearDown () override
+  {
+    t8_forest_unref (&forest);
+  }
+  t8_eclass_t eclass;
+  t8_forest_t forest;
+};
+
+TEST_P (forest_locate_points, locate_all_centroids)
+{
+  int mpisize;
+  int mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  /* Compute the centroids of the local elements */
+  const t8_locidx_t num_local = t8_forest_get_local_num_elements (forest);
+  const t8_gloidx_t num_global = t8_forest_get_global_num_elements (forest);
+  double *local_centroids = T8_ALLOC (double, 3 * SC_MAX (num_local, 1));
+  for (t8_locidx_t ielement = 0; ielement < num_local; ++ielement) {
+    t8_locidx_t ltreeid;
+    const t8_element_t *element = t8_forest_get_element (forest, ielement, &ltreeid);
+    t8_forest_element_centroid (forest, ltreeid, element, local_centroids + 3 * ielement);
+  }
+
+  /* Gather the centroids of all elements and the element offsets of all processes */
+  int *counts = T8_ALLOC (int, mpisize);
+  int *displs = T8_ALLOC (int, mpisize);
+  int *first_element = T8_ALLOC (int, mpisize + 1);
+  const int local_count = 3 * num_local;
+  mpiret = sc_MPI_Allgather (&local_count, 1, sc_MPI_INT, counts, 1, sc_MPI_INT, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  first_element[0] = displs[0] = 0;
+  for (int iproc = 0; iproc < mpisize; ++iproc) {
+    if (iproc > 0) {
+      displs[iproc] = displs[iproc - 1] + counts[iproc - 1];
+    }
+    first_element[iproc + 1] = first_element[iproc] + counts[iproc] / 3;
+  }
+  ASSERT_EQ (first_element[mpisize], num_global);
+  /* We add one point outside of the domain */
+  const t8_locidx_t num_points = num_global + 1;
+  double *points = T8_ALLOC (double, 3 * num_points);
+  mpiret = sc_MPI_Allgatherv (local_centroids, local_count, sc_MPI_DOUBLE, points, counts, displs, sc_MPI_DOUBLE,
+                              sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  points[3 * num_global] = points[3 * num_global + 1] = points[3 * num_global + 2] = 10;
+
+  int *out_rank = T8_ALLOC (int, num_points);
+  t8_gloidx_t *out_tree = T8_ALLOC (t8_gloidx_t, num_points);
+  t8_gloidx_t *out_element = T8_ALLOC (t8_gloidx_t, num_points);
+  t8_forest_locate_points (forest, points, num_points, 1e-8, out_rank, out_tree, out_element);
+
+  for (t8_gloidx_t ipoint = 0; ipoint < num_global; ++ipoint) {
+    ASSERT_EQ (out_element[ipoint], ipoint) << "Wrong element for point " << ipoint;
+    ASSERT_GE (out_rank[ipoint], 0) << "No owner for point " << ipoint;
+    ASSERT_LE (first_element[out_rank[ipoint]], ipoint) << "Wrong owner for point " << ipoint;
+    ASSERT_LT (ipoint, first_element[out_rank[ipoint] + 1]) << "Wrong owner for point " << ipoint;
+    ASSERT_GE (out_tree[ipoint], 0) << "No tree for point " << ipoint;
+  }
+  EXPECT_EQ (out_rank[num_global], -1) << "Found an owner for a point outside of the domain.";
+  EXPECT_EQ (out_element[num_global], -1) << "Found an element for a point outside of the domain.";
+
+  T8_FREE (local_centroids);
+  T8_FREE (counts);
+  T8_FREE (displs);
+  T8_FREE (first_element);
+  T8_FREE (points);
+  T8_FREE (out_rank);
+  T8_FREE (out_tree);
+  T8_FREE (out_element);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_locate_points, forest_locate_points, AllEclasses, print_eclass);
@@ -0,0 +1,261 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_examples.h>
+#include <t8_forest/t8_forest_general.h>
+#include <t8_forest/t8_forest_partition.h>
+#include <t8_forest/t8_forest_profiling.h>
+#include <t8_schemes/t8_default/t8_default_cxx.hxx>
+#include <test/t8_gtest_macros.hxx>
+
+/* In this test we record element costs on a uniform forest, such that
+ * the elements in the first half of the SFC are three times as expensive
+ * as the others. We then partition the forest and check that the
+ * costs are balanced among the processes afterwards.
+ * We also concentrate the costs on the first element, adapt recursively and partition
+ * in one step, and check that the costs were carried over to the adapted elements. */
+
+class forest_partition_weights: public testing::TestWithParam<t8_eclass> {
+ protected:
+  void
+  SetUp () override
+  {
+    eclass = GetParam ();
+
+    scheme = t8_scheme_new_default_cxx ();
+    cmesh = t8_cmesh_new_hypercube (eclass, sc_MPI_COMM_WORLD, 0, 0, 0);
+    level = eclass == T8_ECLASS_VERTEX ? 0 : 3;
+    forest = t8_forest_new_uniform (cmesh, scheme, level, 0, sc_MPI_COMM_WORLD);
+  }
+  void
+  TearDown () override
+  {
+    t8_forest_unref (&forest);
+  }
+  t8_eclass_t eclass;
+  int level;
+  t8_cmesh_t cmesh;
+  t8_scheme_cxx_t *scheme;
+  t8_forest_t forest;
+};
+
+/* Record a cost of 3 for all elements in the first half of the SFC
+ * and a cost of 1 for all others. */
+static void
+t8_test_record_costs (t8_forest_t forest)
+{
+  const t8_gloidx_t first_element = t8_forest_get_first_local_element_id (forest);
+  const t8_gloidx_t num_global = t8_forest_get_global_num_elements (forest);
+  for (t8_locidx_t ielement = 0; ielement < t8_forest_get_local_num_elements (forest); ielement++) {
+    const double cost = 2 * (first_element + ielement) < num_global ? 3 : 1;
+    t8_forest_cost_add_range (forest, ielement, 1, cost);
+  }
+}
+
+TEST_P (forest_partition_weights, test_weighted_partition)
+{
+  int mpisize;
+  int mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  t8_test_record_costs (forest);
+  if (mpisize == 1) {
+    /* A single process is always balanced */
+    EXPECT_FALSE (t8_forest_should_repartition (forest, 1.01));
+  }
+
+  /* Partition the forest with the recorded costs as weights */
+  t8_forest_ref (forest);
+  t8_forest_t forest_partition;
+  t8_forest_init (&forest_partition);
+  t8_forest_set_partition (forest_partition, forest, 0);
+  t8_forest_commit (forest_partition);
+  EXPECT_EQ (t8_forest_get_global_num_elements (forest_partition), t8_forest_get_global_num_elements (forest));
+
+  /* Ship the costs to the new partition and record them there */
+  sc_array_t *costs_in = sc_array_new_data ((void *) t8_forest_cost_get_array (forest), sizeof (double),
+                                            t8_forest_get_local_num_elements (forest));
+  sc_array_t *costs_out = sc_array_new_count (sizeof (double), t8_forest_get_local_num_elements (forest_partition));
+  t8_forest_partition_data (forest, forest_partition, costs_in, costs_out);
+  double local_cost = 0;
+  for (t8_locidx_t ielement = 0; ielement < t8_forest_get_local_num_elements (forest_partition); ielement++) {
+    const double cost = *(double *) t8_sc_array_index_locidx (costs_out, ielement);
+    t8_forest_cost_add_range (forest_partition, ielement, 1, cost);
+    local_cost += cost;
+  }
+
+  /* Each process may deviate from the average by at most the largest element cost */
+  double global_cost;
+  mpiret = sc_MPI_Allreduce (&local_cost, &global_cost, 1, sc_MPI_DOUBLE, sc_MPI_SUM, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  EXPECT_LE (local_cost, global_cost / mpisize + 3 + T8_PRECISION_EPS);
+  const double imbalance = t8_forest_compute_cost_imbalance (forest_partition);
+  EXPECT_GE (imbalance, 1);
+  EXPECT_FALSE (t8_forest_should_repartition (forest_partition, imbalance + 1));
+
+  sc_array_destroy (costs_in);
+  sc_array_destroy (costs_out);
+  t8_forest_unref (&forest_partition);
+}
+
+/* Recursively refine every first child up to two levels finer than the uniform forest */
+static int
+t8_test_partition_weights_adapt (t8_forest_t forest, t8_forest_t forest_from, t8_locidx_t which_tree,
+                                 t8_locidx_t lelement_id, t8_eclass_scheme_c *ts, const int is_family,
+                                 const int num_elements, t8_element_t *elements[])
+{
+  return ts->t8_element_child_id (elements[0]) == 0 && ts->t8_element_level (elements[0]) < 5;
+}
+
+/* Record a cost equal to the global number of elements for the first element
+ * and a cost of 1 for all others. */
+static void
+t8_test_record_concentrated_costs (t8_forest_t forest)
+{
+  const t8_gloidx_t first_element = t8_forest_get_first_local_element_id (forest);
+  const t8_gloidx_t num_global = t8_forest_get_global_num_elements (forest);
+  for (t8_locidx_t ielement = 0; ielement < t8_forest_get_local_num_elements (forest); ielement++) {
+    const double cost = first_element + ielement == 0 ? num_global : 1;
+    t8_forest_cost_add_range (forest, ielement, 1, cost);
+  }
+}
+
+/* Compute the costs that the leaves of forest_adapt should carry over from the uniform forest
+ * of the given level, from which forest_adapt was refined without partitioning.
+ * Each element of forest passes its cost evenly to its descendants in forest_adapt. */
+static void
+t8_test_carried_costs (t8_forest_t forest, t8_forest_t forest_adapt, const int level, sc_array_t *costs)
+{
+  const double *costs_old = t8_forest_cost_get_array (forest);
+  t8_element_t *ancestor, *group_ancestor;
+
+  ASSERT_EQ (t8_forest_get_num_local_trees (forest), t8_forest_get_num_local_trees (forest_adapt));
+  for (t8_locidx_t itree = 0; itree < t8_forest_get_num_local_trees (forest_adapt); itree++) {
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest_adapt, t8_forest_get_tree_class (forest_adapt, itree));
+    const t8_locidx_t num_new = t8_forest_get_tree_num_elements (forest_adapt, itree);
+    const t8_locidx_t offset_old = t8_forest_get_tree_element_offset (forest, itree);
+    const t8_locidx_t offset_new = t8_forest_get_tree_element_offset (forest_adapt, itree);
+    t8_locidx_t iold = 0;
+    t8_locidx_t first_in_group = 0;
+
+    ts->t8_element_new (1, &ancestor);
+    ts->t8_element_new (1, &group_ancestor);
+    /* The leaves with the same ancestor on the uniform level are the descendants of one old element */
+    for (t8_locidx_t inew = 0; inew <= num_new; inew++) {
+      if (inew < num_new) {
+        ts->t8_element_copy (t8_forest_get_element_in_tree (forest_adapt, itree, inew), ancestor);
+        while (ts->t8_element_level (ancestor) > level) {
+          ts->t8_element_parent (ancestor, ancestor);
+        }
+      }
+      if (inew > 0 && (inew == num_new || !ts->t8_element_equal (ancestor, group_ancestor))) {
+        const double cost = costs_old[offset_old + iold] / (inew - first_in_group);
+        for (t8_locidx_t igroup = first_in_group; igroup < inew; igroup++) {
+          *(double *) t8_sc_array_index_locidx (costs, offset_new + igroup) = cost;
+        }
+        first_in_group = inew;
+        iold++;
+      }
+      ts->t8_element_copy (ancestor, group_ancestor);
+    }
+    EXPECT_EQ (iold, t8_forest_get_tree_num_elements (forest, itree));
+    ts->t8_element_destroy (1, &ancestor);
+    ts->t8_element_destroy (1, &group_ancestor);
+  }
+}
+
+TEST_P (forest_partition_weights, test_recursive_adapt_partition)
+{
+  if (eclass == T8_ECLASS_VERTEX) {
+    GTEST_SKIP ();
+  }
+  int mpisize;
+  int mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  t8_test_record_concentrated_costs (forest);
+
+  /* Adapt recursively and partition with the carried over costs as weights */
+  t8_forest_ref (forest);
+  t8_forest_t forest_weighted;
+  t8_forest_init (&forest_weighted);
+  t8_forest_set_adapt (forest_weighted, forest, t8_test_partition_weights_adapt, 1);
+  t8_forest_set_partition (forest_weighted, NULL, 0);
+  t8_forest_commit (forest_weighted);
+
+  /* The weights must not change the leaves, only their partition */
+  t8_forest_ref (forest);
+  t8_forest_t forest_adapt = t8_forest_new_adapt (forest, t8_test_partition_weights_adapt, 1, 0, NULL);
+  EXPECT_EQ (t8_forest_get_global_num_elements (forest_weighted), t8_forest_get_global_num_elements (forest_adapt));
+  EXPECT_GT (t8_forest_get_global_num_elements (forest_adapt), t8_forest_get_global_num_elements (forest));
+
+  /* Compute the costs of the adapted leaves and ship them to the weighted partition */
+  sc_array_t *costs_in = sc_array_new_count (sizeof (double), t8_forest_get_local_num_elements (forest_adapt));
+  sc_array_t *costs_out = sc_array_new_count (sizeof (double), t8_forest_get_local_num_elements (forest_weighted));
+  t8_test_carried_costs (forest, forest_adapt, level, costs_in);
+  t8_forest_partition_data (forest_adapt, forest_weighted, costs_in, costs_out);
+  double local_cost = 0;
+  double max_element_cost = 0;
+  for (t8_locidx_t ielement = 0; ielement < t8_forest_get_local_num_elements (forest_weighted); ielement++) {
+    const double cost = *(double *) t8_sc_array_index_locidx (costs_out, ielement);
+    local_cost += cost;
+    max_element_cost = SC_MAX (max_element_cost, cost);
+  }
+
+  /* Each process may deviate from the average by at most the largest element cost */
+  double global_cost, global_max_element_cost;
+  mpiret = sc_MPI_Allreduce (&local_cost, &global_cost, 1, sc_MPI_DOUBLE, sc_MPI_SUM, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  mpiret
+    = sc_MPI_Allreduce (&max_element_cost, &global_max_element_cost, 1, sc_MPI_DOUBLE, sc_MPI_MAX, sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  EXPECT_NEAR (global_cost, 2 * t8_forest_get_global_num_elements (forest) - 1, T8_PRECISION_EPS * global_cost);
+  EXPECT_LE (local_cost, global_cost / mpisize + global_max_element_cost + T8_PRECISION_EPS * global_cost);
+
+  /* The concentrated costs move the partition boundaries compared to the partition by element count */
+  if (mpisize > 1) {
+    t8_forest_ref (forest_adapt);
+    t8_forest_t forest_unweighted;
+    t8_forest_init (&forest_unweighted);
+    t8_forest_set_partition (forest_unweighted, forest_adapt, 0);
+    t8_forest_commit (forest_unweighted);
+    const t8_gloidx_t first_unweighted = t8_forest_get_first_local_element_id (forest_unweighted);
+    const t8_gloidx_t first_weighted = t8_forest_get_first_local_element_id (forest_weighted);
+    const int local_differs = first_unweighted != first_weighted
+                              || t8_forest_get_local_num_elements (forest_unweighted)
+                                   != t8_forest_get_local_num_elements (forest_weighted);
+    int global_differs;
+    mpiret = sc_MPI_Allreduce (&local_differs, &global_differs, 1, sc_MPI_INT, sc_MPI_LOR, sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    EXPECT_TRUE (global_differs);
+    t8_forest_unref (&forest_unweighted);
+  }
+
+  sc_array_destroy (costs_in);
+  sc_array_destroy (costs_out);
+  t8_forest_unref (&forest_adapt);
+  t8_forest_unref (&forest_weighted);
+}
+
+INSTANTIATE_TEST_SUITE_P (t8_gtest_partition_weights, forest_partition_weights, AllEclasses, print_eclass);
@@ -27,6 +27,7 @@
 #include <t8_cmesh/t8_cmesh_examples.h>
 #include <t8_forest/t8_forest_general.h>
 #include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_ghost.h>
 #include <t8_schemes/t8_default/t8_default_cxx.hxx>
 #include <test/t8_gtest_macros.hxx>
 
@@ -155,4 +156,220 @@ TEST_P (forest_search, test_search_one_query_matches_all)
   sc_array_reset (&queries);
 }
 
+TEST_P (forest_search, test_search_threaded_one_query_matches_all)
+{
+  const int query = 42;
+  sc_array_t queries;
+  sc_array_t matched_leaves;
+
+  sc_array_init_size (&queries, sizeof (int), 1);
+  *(int *) sc_array_index (&queries, 0) = query;
+
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  sc_array_init_size (&matched_leaves, sizeof (int), num_elements);
+  for (t8_locidx_t ielement = 0; ielement < num_elements; ++ielement) {
+    *(int *) t8_sc_array_index_locidx (&matched_leaves, ielement) = 0;
+  }
+  t8_forest_set_user_data (forest, &matched_leaves);
+
+  /* Each leaf is visited by exactly one thread, thus the search callback may write
+   * to matched_leaves without synchronization. */
+  t8_forest_search_threaded (forest, t8_test_search_all_fn, t8_test_search_query_all_fn, &queries, 4, 2);
+
+  for (t8_locidx_t ielement = 0; ielement < num_elements; ++ielement) {
+    ASSERT_TRUE (*(int *) t8_sc_array_index_locidx (&matched_leaves, ielement))
+      << "Threaded search did not match all leaves. First mismatch at leaf " << ielement;
+  }
+
+  t8_forest_unref (&forest);
+  sc_array_reset (&matched_leaves);
+  sc_array_reset (&queries);
+}
+
+/* A search function that matches all ghost elements.
+ * This function assumes that the forest user pointer is an sc_array
+ * with one int for each ghost leaf.
+ * If this function is called for a leaf, it sets the corresponding entry to 1.
+ */
+static int
+t8_test_search_ghosts_fn (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_t *element,
+                          const int is_leaf, const t8_element_array_t *leaf_elements,
+                          const t8_locidx_t tree_leaf_index, void *queries, sc_array_t *query_indices,
+                          int *query_matches, const size_t num_active_queries)
+{
+  const t8_locidx_t num_local_trees = t8_forest_get_num_local_trees (forest);
+  EXPECT_GE (ltreeid, num_local_trees) << "Ghost search called for a local tree.";
+  if (is_leaf) {
+    sc_array_t *matched_ghosts = (sc_array_t *) t8_forest_get_user_data (forest);
+    const t8_locidx_t lghost_tree = ltreeid - num_local_trees;
+    const t8_eclass_t tree_class = t8_forest_get_tree_class (forest, ltreeid);
+    t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    const t8_locidx_t ghost_offset = t8_forest_ghost_get_tree_element_offset (forest, lghost_tree);
+
+    *(int *) t8_sc_array_index_locidx (matched_ghosts, ghost_offset + tree_leaf_index) += 1;
+    /* Test whether tree_leaf_index is actually the index of the ghost element */
+    const t8_element_t *test_element = t8_forest_ghost_get_element (forest, lghost_tree, tree_leaf_index);
+    EXPECT_ELEM_EQ (ts, element, test_element);
+  }
+  return 1;
+}
+
+TEST_P (forest_search, test_search_ghosts_matches_all)
+{
+  sc_array_t matched_ghosts;
+
+  /* Create a copy of the forest with a face ghost layer */
+  t8_forest_t forest_ghost;
+  t8_forest_init (&forest_ghost);
+  t8_forest_set_partition (forest_ghost, forest, 0);
+  t8_forest_set_ghost (forest_ghost, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_ghost);
+
+  const t8_locidx_t num_ghosts = t8_forest_get_num_ghosts (forest_ghost);
+  sc_array_init_size (&matched_ghosts, sizeof (int), num_ghosts);
+  for (t8_locidx_t ighost = 0; ighost < num_ghosts; ++ighost) {
+    *(int *) t8_sc_array_index_locidx (&matched_ghosts, ighost) = 0;
+  }
+  t8_forest_set_user_data (forest_ghost, &matched_ghosts);
+
+  t8_forest_search_ghosts (forest_ghost, t8_test_search_ghosts_fn, NULL, NULL);
+
+  /* Each ghost must have been found exactly once */
+  for (t8_locidx_t ighost = 0; ighost < num_ghosts; ++ighost) {
+    ASSERT_EQ (*(int *) t8_sc_array_index_locidx (&matched_ghosts, ighost), 1)
+      << "Ghost search did not match ghost " << ighost << " exactly once.";
+  }
+
+  t8_forest_unref (&forest_ghost);
+  sc_array_reset (&matched_ghosts);
+}
+
+/* A batched query callback. Each query is the local index of a leaf element and
+ * matches exactly the ancestors of this leaf.
+ * This function assumes that the forest user pointer is an sc_array
+ * with one int for each local leaf. If a query matches a leaf, the corresponding
+ * entry of this leaf is increased. */
+static void
+t8_test_search_batch_query_fn (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_t *element,
+                               const int is_leaf, const t8_element_array_t *leaf_elements,
+                               const t8_locidx_t tree_leaf_index, sc_array_t *queries, const size_t *query_indices,
+                               int *query_matches, const size_t num_active_queries)
+{
+  sc_array_t *matched_leaves = (sc_array_t *) t8_forest_get_user_data (forest);
+  const t8_eclass_t tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, tree_class);
+  t8_element_t *nca;
+
+  EXPECT_GT (num_active_queries, (size_t) 0) << "Query callback called without active queries.";
+  ts->t8_element_new (1, &nca);
+  for (size_t iquery = 0; iquery < num_active_queries; iquery++) {
+    ASSERT_LT (query_indices[iquery], queries->elem_count) << "Invalid query index.";
+    const t8_locidx_t query_leaf = *(t8_locidx_t *) sc_array_index (queries, query_indices[iquery]);
+    t8_locidx_t query_ltreeid;
+    const t8_element_t *leaf = t8_forest_get_element (forest, query_leaf, &query_ltreeid);
+    query_matches[iquery] = 0;
+    if (query_ltreeid == ltreeid) {
+      /* The query matches if element is an ancestor of the query's leaf */
+      ts->t8_element_nca (element, leaf, nca);
+      query_matches[iquery] = ts->t8_element_equal (nca, element);
+    }
+    if (is_leaf && query_matches[iquery]) {
+      const t8_locidx_t tree_offset = t8_forest_get_tree_element_offset (forest, ltreeid);
+      EXPECT_EQ (tree_offset + tree_leaf_index, query_leaf) << "Query matched a wrong leaf.";
+      *(int *) t8_sc_array_index_locidx (matched_leaves, tree_offset + tree_leaf_index) += 1;
+    }
+  }
+  ts->t8_element_destroy (1, &nca);
+}
+
+static int
+t8_test_search_batch_search_fn (t8_forest_t forest, const t8_locidx_t ltreeid, const t8_element_t *element,
+                                const int is_leaf, const t8_element_array_t *leaf_elements,
+                                const t8_locidx_t tree_leaf_index, void *queries, sc_array_t *query_indices,
+                                int *query_matches, const size_t num_active_queries)
+{
+  EXPECT_TRUE (queries == NULL) << "Search callback must not be called with query argument.";
+  return 1;
+}
+
+/* Sort the queries in reverse order of their leaf indices */
+static t8_linearidx_t
+t8_test_search_batch_key_fn (t8_forest_t forest, const void *query)
+{
+  return (t8_linearidx_t) (t8_forest_get_local_num_elements (forest) - *(const t8_locidx_t *) query);
+}
+
+/* Search each query only in the tree of its leaf. Queries of leaves with odd index are not searched. */
+static t8_locidx_t
+t8_test_search_batch_tree_fn (t8_forest_t forest, const void *query)
+{
+  const t8_locidx_t query_leaf = *(const t8_locidx_t *) query;
+  t8_locidx_t query_ltreeid;
+
+  if (query_leaf % 2 == 1) {
+    return -1;
+  }
+  t8_forest_get_element (forest, query_leaf, &query_ltreeid);
+  return query_ltreeid;
+}
+
+TEST_P (forest_search, test_search_batched_one_query_per_leaf)
+{
+  sc_array_t queries;
+  sc_array_t matched_leaves;
+
+  const t8_locidx_t num_elements = t8_forest_get_local_num_elements (forest);
+  /* One query for each local leaf */
+  sc_array_init_size (&queries, sizeof (t8_locidx_t), num_elements);
+  sc_array_init_size (&matched_leaves, sizeof (int), num_elements);
+  for (t8_locidx_t ielement = 0; ielement < num_elements; ++ielement) {
+    *(t8_locidx_t *) t8_sc_array_index_locidx (&queries, ielement) = ielement;
+    *(int *) t8_sc_array_index_locidx (&matched_leaves, ielement) = 0;
+  }
+  t8_forest_set_user_data (forest, &matched_leaves);
+
+  /* Search once with the queries in input order and once sorted by key */
+  for (int use_keys = 0; use_keys < 2; use_keys++) {
+    t8_forest_search_batched (forest, t8_test_search_batch_search_fn, t8_test_search_batch_query_fn, &queries,
+                              use_keys ? t8_test_search_batch_key_fn : NULL);
+    /* Each leaf must have been matched by exactly one query in each search */
+    for (t8_locidx_t ielement = 0; ielement < num_elements; ++ielement) {
+      ASSERT_EQ (*(int *) t8_sc_array_index_locidx (&matched_leaves, ielement), use_keys + 1)
+        << "Batched search did not match leaf " << ielement << " exactly once.";
+    }
+  }
+
+  /* Restrict each query to the tree of its leaf */
+  t8_forest_search_batched_trees (forest, t8_test_search_batch_search_fn, t8_test_search_batch_query_fn, &queries,
+                                  t8_test_search_batch_key_fn, t8_test_search_batch_tree_fn);
+  for (t8_locidx_t ielement = 0; ielement < num_elements; ++ielement) {
+    ASSERT_EQ (*(int *) t8_sc_array_index_locidx (&matched_leaves, ielement), ielement % 2 == 1 ? 2 : 3)
+      << "Batched search restricted to trees did not match leaf " << ielement << " correctly.";
+  }
+
+  t8_forest_unref (&forest);
+  sc_array_reset (&matched_leaves);
+  sc_array_reset (&queries);
+}
+
+TEST (forest_search_morton_key, test_morton_key_order)
+{
+  const double lower[3] = { 0, 0, 0 };
+  const double upper[3] = { 1, 1, 1 };
+  const double origin[3] = { 0, 0, 0 };
+  const double corner[3] = { 1, 1, 1 };
+  const double outside[3] = { 2, 3, 4 };
+  const double below[3] = { -1, -1, -1 };
+  const double x_half[3] = { 0.5, 0, 0 };
+  const double y_half[3] = { 0, 0.5, 0 };
+
+  EXPECT_EQ (t8_forest_search_morton_key (origin, lower, upper), (t8_linearidx_t) 0);
+  EXPECT_EQ (t8_forest_search_morton_key (below, lower, upper), (t8_linearidx_t) 0);
+  /* Points outside of the bounding box are clamped */
+  EXPECT_EQ (t8_forest_search_morton_key (outside, lower, upper), t8_forest_search_morton_key (corner, lower, upper));
+  /* The x-coordinate is interleaved into the lowest bit, y into the next */
+  EXPECT_LT (t8_forest_search_morton_key (x_half, lower, upper), t8_forest_search_morton_key (y_half, lower, upper));
+  EXPECT_LT (t8_forest_search_morton_key (y_half, lower, upper), t8_forest_search_morton_key (corner, lower, upper));
+}
+
 INSTANTIATE_TEST_SUITE_P (t8_gtest_search, forest_search, testing::Combine (AllEclasses, testing::Range (0, 6)));